@@ -27,6 +27,9 @@
 #endif
 
 
+#include <string>
+#include <unordered_set>
+
 #include "json_defs.h"
 #include "jsonval.h"
 
@@ -41,6 +44,7 @@ enum {
     wxJSONREADER_COMMENTS_AFTER  = 32,
     wxJSONREADER_NOUTF8_STREAM   = 64,
     wxJSONREADER_MEMORYBUFF      = 128,
+    wxJSONREADER_ARENA           = 256,
 
     wxJSONREADER_TOLERANT        = wxJSONREADER_ALLOW_COMMENTS | wxJSONREADER_CASE |
                                  wxJSONREADER_MISSING | wxJSONREADER_MULTISTRING,
@@ -56,6 +60,7 @@ public:
 
     int Parse( const wxString& doc, wxJSONValue* val );
     int Parse( wxInputStream& doc, wxJSONValue* val );
+    int Parse( const char* doc, size_t len, wxJSONValue* val );
 
     int   GetDepth() const;
     int   GetErrorCount() const;
@@ -73,6 +78,7 @@ public:
 
 protected:
 
+    int  DoParse( wxInputStream& is, wxJSONValue* val );
     int  DoRead( wxInputStream& doc, wxJSONValue& val );
     void AddError( const wxString& descr );
     void AddError( const wxString& fmt, const wxString& str );
@@ -82,11 +88,12 @@ protected:
     int  ReadChar( wxInputStream& is );
     int  PeekChar( wxInputStream& is );
     void StoreValue( int ch, const wxString& key, wxJSONValue& value, wxJSONValue& parent );
+    void MoveValue( wxJSONValue& value, wxJSONValue& dest );
     int  SkipWhiteSpace( wxInputStream& is );
     int  SkipComment( wxInputStream& is );
     void StoreComment( const wxJSONValue* parent );
     int  ReadString(  wxInputStream& is, wxJSONValue& val );
-    int  ReadToken(  wxInputStream& is, int ch, wxString& s );
+    int  ReadToken(  wxInputStream& is, int ch, std::string& s );
     int  ReadValue(  wxInputStream& is, int ch, wxJSONValue& val );
     int  ReadUES(  wxInputStream& is, char* uesBuffer );
     int  AppendUES( wxMemoryBuffer& utf8Buff, const char* uesBuffer );
@@ -138,6 +145,21 @@ protected:
 
     //! ANSI: do not convert UTF-8 strings
     bool        m_noUtf8;
+
+    //! The next byte of the buffer read by Parse( const char*, ... ), NULL for streams
+    const char*   m_buf;
+
+    //! The end of the buffer read by Parse( const char*, ... )
+    const char*   m_bufEnd;
+
+    //! A read or peek past the end of the buffer was attempted
+    bool        m_bufEof;
+
+    //! The bytes of the literal read by ReadToken(), reused between values
+    std::string   m_token;
+
+    //! wxJSONREADER_ARENA: one shared copy of every member name of the document
+    std::unordered_set<wxString, wxStringHash, wxStringEqual> m_keys;
 };
 
 
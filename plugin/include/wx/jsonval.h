@@ -112,6 +112,10 @@ public:
     wxJSONValue( const wxJSONValue& other );
     virtual ~wxJSONValue();
 
+    // heap or reader's arena allocation (see wxJSONREADER_ARENA)
+    static void* operator new( size_t size );
+    static void  operator delete( void* p, size_t size );
+
     // functions for retrieving the value type
     wxJSONType  GetType() const;
     bool IsValid() const;
@@ -365,6 +369,10 @@ public:
     wxJSONRefData();
     virtual ~wxJSONRefData();
 
+    // heap or reader's arena allocation (see wxJSONREADER_ARENA)
+    static void* operator new( size_t size );
+    static void  operator delete( void* p, size_t size );
+
     int GetRefCount() const;
 
     // there is no need to define copy ctor
@@ -42,7 +42,8 @@ enum {
     wxJSONWRITER_TAB_INDENT         = 512,
     wxJSONWRITER_NO_INDENTATION     = 1024,
     wxJSONWRITER_NOUTF8_STREAM      = 2048,
-    wxJSONWRITER_MEMORYBUFF         = 4096
+    wxJSONWRITER_MEMORYBUFF         = 4096,
+    wxJSONWRITER_RECOGNIZE_DOUBLE   = 8192
 };
 
 // class declaration
@@ -104,7 +105,8 @@ private:
     // Flag used in ANSI mode that controls UTF-8 conversion
     bool  m_noUtf8;
 
-    // The format string for printing doubles
+    // The format string for printing doubles, NULL for the shortest
+    // round-trip form
     char* m_fmt;
 };
 
@@ -0,0 +1,93 @@
+#include "age_fade.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define AGE_FADE_SSE2 1   // SSE2 is part of x86-64
+#include <emmintrin.h>
+#endif
+
+uint16_t AgeBucket(int64_t time, int64_t now) {
+    if (time == TIME_UNKNOWN) return AGE_BUCKET_UNKNOWN;
+    if (time >= now) return 0;
+    // time < now here, so the subtraction can only overflow for ages far
+    // beyond the fade; compare against the limit instead.
+    if (time < now - AGE_FADE_SECONDS) return AGE_BUCKET_OLD;
+    return static_cast<uint16_t>((now - time) / 60);
+}
+
+#ifdef AGE_FADE_SSE2
+
+// The ages are now - time in 64-bit lanes (wrapping, like the CPU). Their
+// 32-bit halves are regrouped so the tests run on four lanes at once: an
+// age is in the fade iff its high half is 0 and its low half <= the fade
+// length, in the future iff the high half is negative; an age that
+// overflowed has the sign of now instead. Minutes come from
+// (age + 0.5) / 60 in float, which truncates correctly for ages this small.
+static size_t AgeBucketsSSE2(const int64_t *times, size_t n, int64_t now,
+                             uint16_t *out) {
+    const __m128i vnow = _mm_set1_epi64x(now);
+    const __m128i now_hi = _mm_set1_epi32(static_cast<int32_t>(now >> 32));
+    const __m128i now_neg = _mm_set1_epi32(now < 0 ? -1 : 0);
+    const __m128i sign = _mm_set1_epi32(INT32_MIN);
+    const __m128i fade_max = _mm_set1_epi32(
+        static_cast<int32_t>(AGE_FADE_SECONDS) ^ INT32_MIN);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i old_bucket = _mm_set1_epi32(AGE_BUCKET_OLD);
+    const __m128i unknown_bucket = _mm_set1_epi32(AGE_BUCKET_UNKNOWN);
+    const __m128 half = _mm_set1_ps(0.5f), per_minute = _mm_set1_ps(1.0f / 60);
+
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i t01 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(times + i));
+        __m128i t23 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(times + i + 2));
+        __m128i a01 = _mm_sub_epi64(vnow, t01);
+        __m128i a23 = _mm_sub_epi64(vnow, t23);
+
+        // [lo0 lo1 hi0 hi1], [lo2 lo3 hi2 hi3] -> [lo0..lo3], [hi0..hi3]
+        __m128i a_x = _mm_shuffle_epi32(a01, _MM_SHUFFLE(3, 1, 2, 0));
+        __m128i a_y = _mm_shuffle_epi32(a23, _MM_SHUFFLE(3, 1, 2, 0));
+        __m128i lo = _mm_unpacklo_epi64(a_x, a_y);
+        __m128i hi = _mm_unpackhi_epi64(a_x, a_y);
+        __m128i t_x = _mm_shuffle_epi32(t01, _MM_SHUFFLE(3, 1, 2, 0));
+        __m128i t_y = _mm_shuffle_epi32(t23, _MM_SHUFFLE(3, 1, 2, 0));
+        __m128i t_lo = _mm_unpacklo_epi64(t_x, t_y);
+        __m128i t_hi = _mm_unpackhi_epi64(t_x, t_y);
+
+        __m128i unknown = _mm_and_si128(_mm_cmpeq_epi32(t_hi, sign),
+                                        _mm_cmpeq_epi32(t_lo, zero));
+        __m128i future = _mm_cmplt_epi32(hi, zero);
+        __m128i old = _mm_or_si128(
+            _mm_cmpgt_epi32(hi, zero),
+            _mm_and_si128(_mm_cmpeq_epi32(hi, zero),
+                          _mm_cmpgt_epi32(_mm_xor_si128(lo, sign), fade_max)));
+        __m128i overflow = _mm_srai_epi32(
+            _mm_and_si128(_mm_xor_si128(now_hi, t_hi), _mm_xor_si128(now_hi, hi)), 31);
+        future = _mm_or_si128(_mm_andnot_si128(overflow, future),
+                              _mm_and_si128(overflow, now_neg));
+        old = _mm_or_si128(_mm_andnot_si128(overflow, old),
+                           _mm_andnot_si128(now_neg, overflow));
+
+        __m128 age = _mm_cvtepi32_ps(lo);   // exact for ages in the fade
+        __m128i minutes = _mm_cvttps_epi32(
+            _mm_mul_ps(_mm_add_ps(age, half), per_minute));
+
+        __m128i b = _mm_andnot_si128(_mm_or_si128(future, old), minutes);
+        b = _mm_or_si128(b, _mm_and_si128(old, old_bucket));
+        b = _mm_or_si128(_mm_andnot_si128(unknown, b),
+                         _mm_and_si128(unknown, unknown_bucket));
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(out + i),
+                         _mm_packs_epi32(b, b));
+    }
+    return i;
+}
+
+#endif // AGE_FADE_SSE2
+
+void AgeBuckets(const int64_t *times, size_t n, int64_t now, uint16_t *out) {
+    size_t i = 0;
+#ifdef AGE_FADE_SSE2
+    i = AgeBucketsSSE2(times, n, now, out);
+#endif
+    for (; i < n; i++) out[i] = AgeBucket(times[i], now);
+}
+
+constexpr AgeOpacityTable AGE_OPACITY;
@@ -0,0 +1,53 @@
+#ifndef _AGE_FADE_H_
+#define _AGE_FADE_H_
+
+// Marker opacity by observation age — no wx dependencies.
+//
+// Fresh observations are fully opaque and fade linearly to 0.3 at 24 h;
+// older ones are drawn at 0.15, and ones without a time at 0.5. Within the
+// fade, age counts in whole minutes (the overlay redraws for age once a
+// minute), so a frame turns the whole time column into bucket numbers in
+// one pass and each marker's opacity is a table lookup.
+
+#include "history_store.h"
+
+#include <cstddef>
+#include <cstdint>
+
+static const int64_t AGE_FADE_SECONDS = 24 * 3600;
+
+// Buckets 0..AGE_FADE_SECONDS / 60 are minutes of age (future times count
+// as 0), then:
+static const uint16_t AGE_BUCKET_OLD = AGE_FADE_SECONDS / 60 + 1;   // > 24 h
+static const uint16_t AGE_BUCKET_UNKNOWN = AGE_BUCKET_OLD + 1;      // TIME_UNKNOWN
+static const size_t AGE_BUCKET_COUNT = AGE_BUCKET_UNKNOWN + 1;
+
+uint16_t AgeBucket(int64_t time, int64_t now);
+
+// AgeBucket() of times[0, n), 4 at a time with SSE2 where available.
+void AgeBuckets(const int64_t *times, size_t n, int64_t now, uint16_t *out);
+
+// Opacity of each bucket, filled at compile time; markers read it once per
+// frame each, so the lookup is inline.
+struct AgeOpacityTable {
+    float opacity[AGE_BUCKET_COUNT];
+    constexpr AgeOpacityTable() : opacity() {
+        const int minutes = static_cast<int>(AGE_FADE_SECONDS / 60);
+        // Linear fade from 1.0 at 0 h to 0.3 at 24 h
+        for (int m = 0; m <= minutes; m++)
+            opacity[m] = static_cast<float>(1.0 - 0.7 * m / minutes);
+        opacity[AGE_BUCKET_OLD] = 0.15f;
+        opacity[AGE_BUCKET_UNKNOWN] = 0.5f;
+    }
+};
+extern const AgeOpacityTable AGE_OPACITY;
+
+inline float AgeBucketOpacity(uint16_t bucket) {
+    return AGE_OPACITY.opacity[bucket < AGE_BUCKET_COUNT ? bucket : AGE_BUCKET_OLD];
+}
+
+inline float AgeOpacity(int64_t time, int64_t now) {
+    return AgeBucketOpacity(AgeBucket(time, now));
+}
+
+#endif // _AGE_FADE_H_
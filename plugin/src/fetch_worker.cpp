@@ -0,0 +1,350 @@
+#include "fetch_worker.h"
+#include "http_client.h"
+#include "server_client.h"
+#include "station_view.h"
+#include "url_builder.h"
+
+#include <wx/intl.h>
+#include <wx/log.h>
+#include <wx/time.h>
+#include <algorithm>
+#include <chrono>
+#include <climits>
+
+wxDEFINE_EVENT(EVT_SHIPOBS_FETCH_PROGRESS, wxThreadEvent);
+wxDEFINE_EVENT(EVT_SHIPOBS_FETCH_DONE, wxThreadEvent);
+wxDEFINE_EVENT(EVT_SHIPOBS_FETCH_STATIONS, wxThreadEvent);
+
+// Minimum interval between progress events, so a fast link doesn't flood
+// the GUI thread's event queue.
+static const long PROGRESS_INTERVAL_MS = 100;
+
+// Minimum interval between partial station sets: each one re-projects
+// every station on the chart.
+static const long STATIONS_INTERVAL_MS = 250;
+
+// Clock of the auto-refresh schedule: unlike wxGetLocalTimeMillis() it
+// doesn't jump when the system time is set (e.g. from GPS on board).
+static int64_t MonotonicMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Bridges FetchObservations() progress hooks to throttled wx events and
+// the worker's cancellation state.
+class WorkerProgress : public FetchProgress {
+public:
+    // With stream, new stations are passed on as FetchPartial events.
+    WorkerProgress(FetchWorker *worker, unsigned id, wxEvtHandler *sink,
+                   bool stream)
+        : m_worker(worker), m_id(id), m_sink(sink), m_stream(stream),
+          m_last_post(0), m_last_stations(0) {}
+
+    bool OnDownload(size_t received, size_t /*total*/) {
+        if (m_worker->IsCancelled(m_id)) return false;
+        if (received > 0 && Due(m_last_post, PROGRESS_INTERVAL_MS))
+            Post(FETCH_STAGE_DOWNLOAD, received);
+        return true;
+    }
+
+    void OnStations(const StationView &stations, size_t first) {
+        if (!m_stream) return;
+        if (!m_partial) {
+            m_partial = std::make_shared<FetchPartial>();
+            m_partial->job_id = m_id;
+        }
+        for (size_t i = first; i < stations.count; i++)
+            AppendStation(stations, i, m_partial->stations);
+        if (!Due(m_last_stations, STATIONS_INTERVAL_MS)) return;
+        wxThreadEvent *evt = new wxThreadEvent(EVT_SHIPOBS_FETCH_STATIONS);
+        evt->SetPayload(m_partial);
+        wxQueueEvent(m_sink, evt);
+        m_partial.reset();
+    }
+
+private:
+    static bool Due(wxLongLong &last, long interval) {
+        wxLongLong now = wxGetLocalTimeMillis();
+        if (now - last < interval) return false;
+        last = now;
+        return true;
+    }
+
+    void Post(int stage, size_t value) {
+        wxThreadEvent *evt = new wxThreadEvent(EVT_SHIPOBS_FETCH_PROGRESS);
+        evt->SetInt(stage);
+        evt->SetExtraLong(static_cast<long>(value));
+        wxQueueEvent(m_sink, evt);
+    }
+
+    FetchWorker *m_worker;
+    unsigned m_id;
+    wxEvtHandler *m_sink;
+    bool m_stream;
+    wxLongLong m_last_post;
+    wxLongLong m_last_stations;
+    FetchPartialPtr m_partial;   // stations not posted yet
+};
+
+FetchWorker::FetchWorker(HttpClient *http, ResponseCache *cache,
+                         TileCache *tiles)
+    : wxThread(wxTHREAD_JOINABLE), m_http(http), m_cache(cache), m_tiles(tiles),
+      m_next_id(0), m_cancel_upto(0), m_pending(0), m_uncounted(0),
+      m_schedule(static_cast<uint32_t>(MonotonicMs())),
+      m_follow_viewport(false), m_auto_sink(nullptr) {}
+
+unsigned FetchWorker::Enqueue(const FetchJob &job, wxEvtHandler *sink) {
+    QueuedJob q;
+    q.id   = ++m_next_id;
+    q.job  = job;
+    q.sink = sink;
+    m_pending++;
+    m_queue.Post(q);
+    return q.id;
+}
+
+void FetchWorker::WarmUp(const wxString &server_url) {
+    QueuedJob q;
+    q.job.server_url = server_url;
+    q.warm_up = true;
+    m_queue.Post(q);
+}
+
+void FetchWorker::StartAutoRefresh(const FetchJob &job, const RefreshOptions &opt,
+                                   bool follow_viewport, wxEvtHandler *sink) {
+    {
+        wxCriticalSectionLocker lock(m_auto_lock);
+        m_auto_job = job;
+        m_auto_job.automatic = true;
+        m_auto_job.base.reset();   // merged on the GUI thread only
+        m_follow_viewport = follow_viewport;
+        m_auto_sink = sink;
+        m_schedule.Start(opt, {job.lat_min, job.lat_max, job.lon_min, job.lon_max},
+                         MonotonicMs());
+    }
+    QueuedJob q;
+    q.wake = true;
+    m_queue.Post(q);
+}
+
+void FetchWorker::StopAutoRefresh() {
+    wxCriticalSectionLocker lock(m_auto_lock);
+    m_schedule.Stop();
+}
+
+bool FetchWorker::IsAutoRefreshing() {
+    wxCriticalSectionLocker lock(m_auto_lock);
+    return m_schedule.Active();
+}
+
+void FetchWorker::SetViewport(const BBox &vp) {
+    bool sooner;
+    {
+        wxCriticalSectionLocker lock(m_auto_lock);
+        if (!m_follow_viewport || !m_schedule.Active()) return;
+        int64_t before = m_schedule.NextWake();
+        m_schedule.SetArea(vp, MonotonicMs());
+        sooner = m_schedule.NextWake() < before;
+    }
+    if (sooner) {
+        QueuedJob q;
+        q.wake = true;
+        m_queue.Post(q);
+    }
+}
+
+void FetchWorker::CancelAll() {
+    m_cancel_upto = m_next_id.load();
+}
+
+void FetchWorker::Stop() {
+    CancelAll();
+    m_queue.Post(QueuedJob());  // id 0: stop request
+    Wait();
+}
+
+wxThread::ExitCode FetchWorker::Entry() {
+    for (;;) {
+        QueuedJob q;
+        long wait = AutoRefreshWait();
+        wxMessageQueueError err = wait < 0 ? m_queue.Receive(q)
+                                           : m_queue.ReceiveTimeout(wait, q);
+        if (err == wxMSGQUEUE_TIMEOUT) {
+            RunAutoRefresh();
+            continue;
+        }
+        if (err != wxMSGQUEUE_NO_ERROR) break;
+        if (q.wake) continue;
+        if (q.warm_up) {
+            std::string url(q.job.server_url.mb_str(wxConvUTF8));
+            uint64_t traffic = m_http->GetTrafficBytes();
+            if (m_http->WarmUp(url))
+                wxLogMessage("ShipObs: connection to %s ready (%.0f ms)",
+                             url.c_str(), m_http->LastStats().total_ms);
+            m_uncounted += m_http->GetTrafficBytes() - traffic;
+            continue;
+        }
+        if (q.id == 0) break;
+        RunJob(q);
+    }
+    return static_cast<ExitCode>(0);
+}
+
+// Milliseconds until the next automatic refresh, -1 if none is scheduled.
+long FetchWorker::AutoRefreshWait() {
+    wxCriticalSectionLocker lock(m_auto_lock);
+    int64_t next = m_schedule.NextWake();
+    if (next == REFRESH_NEVER) return -1;
+    int64_t wait = next - MonotonicMs();
+    return static_cast<long>(std::max<int64_t>(0, std::min<int64_t>(wait, LONG_MAX)));
+}
+
+void FetchWorker::RunAutoRefresh() {
+    QueuedJob q;
+    {
+        wxCriticalSectionLocker lock(m_auto_lock);
+        BBox area;
+        if (!m_schedule.Due(MonotonicMs(), area)) return;
+        q.job = m_auto_job;
+        q.job.lat_min = area.lat_min;
+        q.job.lat_max = area.lat_max;
+        q.job.lon_min = area.lon_min;
+        q.job.lon_max = area.lon_max;
+        q.sink = m_auto_sink;
+    }
+    q.id = ++m_next_id;
+    m_pending++;
+    wxLogMessage("ShipObs: auto-refresh");
+    FetchResultPtr result = RunJob(q);
+
+    // A schedule restarted meanwhile ignores this.
+    wxCriticalSectionLocker lock(m_auto_lock);
+    if (result->cancelled)
+        m_schedule.Skipped(MonotonicMs());
+    else
+        m_schedule.Done(result->ok, MonotonicMs());
+    if (!result->ok && !result->cancelled)
+        wxLogMessage("ShipObs: auto-refresh failed, next attempt in %.1f s",
+                     (m_schedule.NextWake() - MonotonicMs()) / 1000.0);
+}
+
+FetchResultPtr FetchWorker::RunJob(const QueuedJob &q) {
+    FetchResultPtr result = std::make_shared<FetchResult>();
+    result->job_id = q.id;
+    result->job    = q.job;
+
+    if (IsCancelled(q.id)) {
+        result->cancelled = true;
+    } else {
+        // Auto-refreshes replace what is shown only once complete; a delta
+        // fetch is merged into its base first.
+        WorkerProgress progress(this, q.id, q.sink,
+                                !q.job.automatic && !q.job.base);
+        const FetchJob &j = q.job;
+        uint64_t traffic = m_http->GetTrafficBytes();
+        if (j.tiled) {
+            result->ok = RunTiled(j, &progress, *result);
+        } else {
+            int64_t since = j.base ? j.since : TIME_UNKNOWN;
+            StationColumns delta;
+            result->ok = FetchObservations(*m_http, j.server_url,
+                                           j.lat_min, j.lat_max, j.lon_min, j.lon_max,
+                                           j.max_age, j.types, j.profile,
+                                           since, m_cache,
+                                           j.base ? delta : result->stations,
+                                           result->error, &progress);
+            if (result->ok && j.base) {
+                long long max_age = MaxAgeSeconds(ToUTF8String(j.max_age));
+                int64_t cutoff = max_age > 0
+                    ? EpochFromDateTime(wxDateTime::Now().ToUTC()) - max_age
+                    : TIME_UNKNOWN;
+                result->merge = MergeStations(j.base->View(), delta.View(), cutoff,
+                                              result->stations, &result->carry);
+                wxLogMessage("ShipObs: delta since %s: %zu updated, %zu new, "
+                             "%zu expired, %zu unchanged",
+                             FormatIsoTime(since).c_str(), result->merge.updated,
+                             result->merge.added, result->merge.expired,
+                             result->merge.kept);
+            }
+        }
+        result->bytes = m_http->GetTrafficBytes() - traffic + m_uncounted;
+        m_uncounted = 0;
+        result->cancelled = !result->ok && IsCancelled(q.id);
+    }
+
+    PostResult(q, result);
+    return result;
+}
+
+// Bring the tiles covering the job's area up to date, one request per
+// rectangle of missing or stale tiles, all sent at once (at most
+// max_parallel at a time), then cut the area out of them. An area across
+// the antimeridian is planned and cut as its two halves.
+bool FetchWorker::RunTiled(const FetchJob &j, FetchProgress *progress,
+                           FetchResult &result) {
+    std::string max_age = ToUTF8String(j.max_age);
+    std::string query = ToUTF8String(j.server_url) + "|" + max_age + "|" +
+                        NormalizeTypes(ToUTF8String(j.types)) +
+                        j.profile.Query();
+    BBox parts[2];
+    int n = SplitBbox(j.lat_min, j.lat_max, j.lon_min, j.lon_max, parts);
+    int64_t now = EpochFromDateTime(wxDateTime::Now().ToUTC());
+    long long max_age_s = MaxAgeSeconds(max_age);
+    int64_t cutoff = max_age_s > 0 ? now - max_age_s : TIME_UNKNOWN;
+
+    std::vector<TileRequest> requests;
+    TileStats &stats = result.tiles;
+    for (int p = 0; p < n; p++) {
+        TilePlan plan = m_tiles->Plan(query, parts[p], now, j.delta);
+        requests.insert(requests.end(), plan.requests.begin(), plan.requests.end());
+        stats.cached     += plan.stats.cached;
+        stats.refreshed  += plan.stats.refreshed;
+        stats.downloaded += plan.stats.downloaded;
+        stats.requests   += plan.stats.requests;
+    }
+
+    std::vector<AreaRequest> areas(requests.size());
+    for (size_t i = 0; i < requests.size(); i++) {
+        BBox tb = TileBounds(requests[i].rect);
+        areas[i].lat_min = tb.lat_min;
+        areas[i].lat_max = tb.lat_max;
+        areas[i].lon_min = tb.lon_min;
+        areas[i].lon_max = tb.lon_max;
+        areas[i].since   = requests[i].since;
+    }
+    if (!areas.empty() &&
+        !FetchAreas(*m_http, j.server_url, j.max_age, j.types, j.profile, areas,
+                    m_cache, j.max_parallel, result.error, progress))
+        return false;
+    for (size_t i = 0; i < requests.size(); i++)
+        m_tiles->Apply(query, requests[i], areas[i].stations.View(), now, cutoff);
+    wxLogMessage("ShipObs: tiles  %zu cached, %zu refreshed, %zu downloaded "
+                 "in %zu request(s)", stats.cached, stats.refreshed,
+                 stats.downloaded, stats.requests);
+
+    bool complete = true;
+    if (n == 1) {
+        complete = m_tiles->Assemble(query, parts[0], cutoff, result.stations);
+    } else {
+        StationColumns halves[2], both;
+        for (int p = 0; p < n; p++) {
+            complete &= m_tiles->Assemble(query, parts[p], cutoff, halves[p]);
+            StationView v = halves[p].View();
+            for (size_t i = 0; i < v.count; i++) AppendStation(v, i, both);
+        }
+        // A ship crossing the antimeridian may be in both halves.
+        MergeStations(StationView(), both.View(), cutoff, result.stations, nullptr);
+    }
+    if (!complete) {
+        result.error = _("Tile cache incomplete");
+        return false;
+    }
+    return true;
+}
+
+void FetchWorker::PostResult(const QueuedJob &q, const FetchResultPtr &result) {
+    m_pending--;
+    wxThreadEvent *evt = new wxThreadEvent(EVT_SHIPOBS_FETCH_DONE);
+    evt->SetPayload(result);
+    wxQueueEvent(q.sink, evt);
+}
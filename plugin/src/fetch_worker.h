@@ -0,0 +1,165 @@
+#ifndef _FETCH_WORKER_H_
+#define _FETCH_WORKER_H_
+
+#include "refresh_schedule.h"
+#include "station_merge.h"
+#include "station_store.h"
+#include "tile_cache.h"
+
+#include <atomic>
+#include <memory>
+#include <wx/event.h>
+#include <wx/msgqueue.h>
+#include <wx/string.h>
+#include <wx/thread.h>
+
+class FetchProgress;
+class HttpClient;
+
+// Parameters of one queued fetch (see FetchObservations()).
+struct FetchJob {
+    wxString server_url;
+    double lat_min, lat_max, lon_min, lon_max;
+    wxString max_age;
+    wxString types;
+    // Delta fetch: stations of an earlier fetch of the same area, and the
+    // newest observation time among them. Only newer stations are
+    // downloaded and merged into a copy of base (see MergeStations()).
+    std::shared_ptr<const StationColumns> base;
+    int64_t since;
+    // Fetch through the tile cache (see TileCache) instead; delta then
+    // refreshes stale tiles with only their newer reports.
+    bool tiled;
+    bool delta;
+    int max_parallel;   // concurrent requests of a tiled fetch
+    FetchProfile profile;
+    bool automatic;     // started by the auto-refresh schedule
+    FetchJob() : lat_min(0), lat_max(0), lon_min(0), lon_max(0),
+                 since(TIME_UNKNOWN), tiled(false), delta(false),
+                 max_parallel(4), automatic(false) {}
+};
+
+// Outcome of a job, delivered on the GUI thread as the payload of
+// EVT_SHIPOBS_FETCH_DONE (std::shared_ptr<FetchResult>).
+struct FetchResult {
+    unsigned job_id;
+    FetchJob job;
+    bool ok;
+    bool cancelled;
+    StationColumns stations;   // packed on the worker thread
+    // Delta fetch only: base index of each station (see MergeStations())
+    // and what the merge did.
+    std::vector<uint32_t> carry;
+    MergeStats merge;
+    TileStats tiles;           // tiled fetch only
+    uint64_t bytes;            // sent and received, headers included
+    wxString error;
+    FetchResult() : job_id(0), ok(false), cancelled(false), bytes(0) {}
+};
+
+typedef std::shared_ptr<FetchResult> FetchResultPtr;
+
+// Stations of a running job parsed since its previous FetchPartial,
+// delivered on the GUI thread as the payload of EVT_SHIPOBS_FETCH_STATIONS
+// (std::shared_ptr<FetchPartial>) so the first markers appear before the
+// download ends. Only full downloads of jobs started by the user report
+// them; the job's FetchResult replaces them all.
+struct FetchPartial {
+    unsigned job_id;
+    StationColumns stations;
+    FetchPartial() : job_id(0) {}
+};
+
+typedef std::shared_ptr<FetchPartial> FetchPartialPtr;
+
+// Progress stage carried in wxThreadEvent::GetInt() of
+// EVT_SHIPOBS_FETCH_PROGRESS; GetExtraLong() holds bytes received.
+// Parsing runs during the download, so it has no stage of its own.
+enum { FETCH_STAGE_DOWNLOAD = 0 };
+
+wxDECLARE_EVENT(EVT_SHIPOBS_FETCH_PROGRESS, wxThreadEvent);
+wxDECLARE_EVENT(EVT_SHIPOBS_FETCH_DONE, wxThreadEvent);
+wxDECLARE_EVENT(EVT_SHIPOBS_FETCH_STATIONS, wxThreadEvent);
+
+// Background thread that runs queued fetches one after another so the GUI
+// thread (and with it the chart canvas) never blocks on the network.
+// Results are only handed back through events; the caller applies them
+// (AppendFetch/SetStations) on the GUI thread.
+class FetchWorker : public wxThread {
+public:
+    // http, cache and tiles are used on the worker thread only and must
+    // outlive it; cache may be null.
+    FetchWorker(HttpClient *http, ResponseCache *cache, TileCache *tiles);
+
+    // Queue a job; progress and result events are posted to sink.
+    // Returns the job id (also in FetchResult::job_id).
+    unsigned Enqueue(const FetchJob &job, wxEvtHandler *sink);
+
+    // Open the connection to server_url in the background, ahead of the
+    // first fetch. Posts no events; its bytes are added to those of the
+    // next result.
+    void WarmUp(const wxString &server_url);
+
+    // Cancel the running job and every job queued so far.
+    void CancelAll();
+
+    // Refresh job's area from now on, as RefreshSchedule decides, posting
+    // results to sink as Enqueue() does (with job.automatic set). With
+    // follow_viewport, the area is the one last given to SetViewport()
+    // instead. Timing and fetching both happen on the worker thread.
+    void StartAutoRefresh(const FetchJob &job, const RefreshOptions &opt,
+                          bool follow_viewport, wxEvtHandler *sink);
+    void StopAutoRefresh();
+    bool IsAutoRefreshing();
+
+    // The chart viewport changed; cheap enough to call on every render.
+    void SetViewport(const BBox &vp);
+
+    // True once job id was cancelled; its events may still be queued.
+    bool IsCancelled(unsigned id) const { return id <= m_cancel_upto; }
+
+    // Jobs queued or running that have not delivered a result yet.
+    unsigned GetPendingCount() const { return m_pending; }
+
+    // Cancel everything and join the thread. Call before the sink dies.
+    void Stop();
+
+protected:
+    virtual ExitCode Entry();
+
+private:
+    struct QueuedJob {
+        unsigned id;          // 0 = stop request (unless warm_up)
+        FetchJob job;
+        wxEvtHandler *sink;
+        bool warm_up;         // open a connection to job.server_url only
+        bool wake;            // look at the auto-refresh schedule again
+        QueuedJob() : id(0), sink(nullptr), warm_up(false), wake(false) {}
+    };
+
+    FetchResultPtr RunJob(const QueuedJob &q);
+    long AutoRefreshWait();
+    void RunAutoRefresh();
+    bool RunTiled(const FetchJob &j, FetchProgress *progress,
+                  FetchResult &result);
+    void PostResult(const QueuedJob &q, const FetchResultPtr &result);
+
+    HttpClient *m_http;
+    ResponseCache *m_cache;
+    TileCache *m_tiles;
+    wxMessageQueue<QueuedJob> m_queue;
+    std::atomic<unsigned> m_next_id;
+    std::atomic<unsigned> m_cancel_upto;  // ids <= this are cancelled
+    std::atomic<unsigned> m_pending;
+    uint64_t m_uncounted;   // warm-up bytes not in a result yet (fetch thread)
+
+    wxCriticalSection m_auto_lock;   // guards the members below
+    RefreshSchedule m_schedule;
+    FetchJob m_auto_job;
+    bool m_follow_viewport;
+    wxEvtHandler *m_auto_sink;
+
+    friend class WorkerProgress;
+};
+
+#endif // _FETCH_WORKER_H_
@@ -0,0 +1,85 @@
+#include "glyph_atlas.h"
+
+#include <algorithm>
+
+uint32_t NextCodePoint(const char *&p, const char *end) {
+    const unsigned char *s = reinterpret_cast<const unsigned char *>(p);
+    unsigned char c = s[0];
+    int len;
+    uint32_t cp;
+    if (c < 0x80)                { p++; return c; }
+    else if ((c & 0xE0) == 0xC0) { len = 2; cp = c & 0x1F; }
+    else if ((c & 0xF0) == 0xE0) { len = 3; cp = c & 0x0F; }
+    else if ((c & 0xF8) == 0xF0) { len = 4; cp = c & 0x07; }
+    else                         { p++; return 0xFFFD; }
+
+    if (end - p < len) { p++; return 0xFFFD; }
+    for (int i = 1; i < len; i++) {
+        if ((s[i] & 0xC0) != 0x80) { p++; return 0xFFFD; }
+        cp = (cp << 6) | (s[i] & 0x3F);
+    }
+    p += len;
+    return cp;
+}
+
+GlyphAtlas::GlyphAtlas(int width, int height)
+    : m_width(width), m_height(height),
+      m_pixels(static_cast<size_t>(width) * height, 0), m_generation(0) {
+    Reset();
+}
+
+const GlyphCell *GlyphAtlas::Find(uint32_t cp) const {
+    auto it = m_cells.find(cp);
+    return it == m_cells.end() ? nullptr : &it->second;
+}
+
+GlyphCell *GlyphAtlas::Add(uint32_t cp, int w, int h) {
+    if (w > m_width - 1 || h > m_height - 1) return nullptr;
+    if (m_shelf_x + w + 1 > m_width) {  // next shelf
+        m_shelf_y += m_shelf_h + 1;
+        m_shelf_x = 1;
+        m_shelf_h = 0;
+    }
+    if (m_shelf_y + h + 1 > m_height) return nullptr;
+
+    GlyphCell cell = {m_shelf_x, m_shelf_y, w, h};
+    m_shelf_x += w + 1;
+    m_shelf_h = std::max(m_shelf_h, h);
+    m_dirty = true;
+    return &(m_cells[cp] = cell);
+}
+
+void GlyphAtlas::Reset() {
+    std::fill(m_pixels.begin(), m_pixels.end(), 0);
+    m_cells.clear();
+    m_shelf_x = m_shelf_y = 1;
+    m_shelf_h = 0;
+    m_dirty = true;
+    m_generation++;
+}
+
+float GlyphAtlas::AppendLabel(const char *s, size_t n, float x, float y,
+                              BatchColor color, std::vector<LabelVertex> &out,
+                              std::vector<uint32_t> *missing) const {
+    const float su = 1.0f / m_width, sv = 1.0f / m_height;
+    const char *p = s, *end = s + n;
+    float pen = x;
+    while (p < end) {
+        uint32_t cp = NextCodePoint(p, end);
+        const GlyphCell *g = Find(cp);
+        if (!g) {
+            if (missing) missing->push_back(cp);
+            continue;
+        }
+        float x0 = pen, x1 = pen + g->w, y0 = y, y1 = y + g->h;
+        float u0 = g->x * su, u1 = (g->x + g->w) * su;
+        float v0 = g->y * sv, v1 = (g->y + g->h) * sv;
+        LabelVertex quad[6] = {
+            {x0, y0, u0, v0, color}, {x1, y0, u1, v0, color},
+            {x1, y1, u1, v1, color}, {x0, y0, u0, v0, color},
+            {x1, y1, u1, v1, color}, {x0, y1, u0, v1, color}};
+        out.insert(out.end(), quad, quad + 6);
+        pen += g->w;
+    }
+    return pen - x;
+}
@@ -0,0 +1,81 @@
+#ifndef _GLYPH_ATLAS_H_
+#define _GLYPH_ATLAS_H_
+
+// Glyph atlas for GL station labels — no wx or GL dependencies.
+//
+// Every glyph a label needs is rasterised once into a single coverage
+// (alpha) bitmap; labels are then laid out as textured quads into one
+// vertex array and drawn with one texture bind and one glDrawArrays.
+// Glyphs are independent of the station set, so switching fetches costs
+// nothing here. The wx side rasterises glyphs the atlas reports missing
+// (see RenderStationsGL).
+
+#include "marker_batch.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Cell of one glyph in the atlas; its width is also the advance.
+struct GlyphCell {
+    int x, y, w, h;
+};
+
+// glTexCoordPointer(2, GL_FLOAT, ...) at u; otherwise as BatchVertex.
+struct LabelVertex {
+    float x, y;
+    float u, v;
+    BatchColor color;
+};
+
+// Next code point of a UTF-8 string; malformed input yields U+FFFD and
+// skips one byte.
+uint32_t NextCodePoint(const char *&p, const char *end);
+
+class GlyphAtlas {
+public:
+    GlyphAtlas(int width, int height);
+
+    int Width() const { return m_width; }
+    int Height() const { return m_height; }
+
+    // Coverage, Width() x Height() bytes, row-major from the top.
+    const std::vector<uint8_t> &Pixels() const { return m_pixels; }
+    uint8_t *Row(int y) { return &m_pixels[static_cast<size_t>(y) * m_width]; }
+
+    // Set when pixels change; the texture owner re-uploads and clears it.
+    bool IsDirty() const { return m_dirty; }
+    void ClearDirty() { m_dirty = false; }
+
+    const GlyphCell *Find(uint32_t cp) const;
+
+    // Reserve a w x h cell for cp (shelf packing with a 1px gutter) and
+    // mark the atlas dirty; the caller fills the cell's pixels. Returns
+    // null when the atlas is full.
+    GlyphCell *Add(uint32_t cp, int w, int h);
+
+    // Forget every glyph, e.g. when the atlas fills up.
+    void Reset();
+
+    // Changes with every Reset(): a layout made before a change lacks
+    // glyphs it did not report missing.
+    unsigned Generation() const { return m_generation; }
+
+    // Append two triangles per glyph of a UTF-8 label with its top-left
+    // corner at (x, y). Code points not in the atlas are skipped and, if
+    // missing is non-null, appended to it. Returns the label's width.
+    float AppendLabel(const char *s, size_t n, float x, float y,
+                      BatchColor color, std::vector<LabelVertex> &out,
+                      std::vector<uint32_t> *missing) const;
+
+private:
+    int m_width, m_height;
+    std::vector<uint8_t> m_pixels;
+    std::unordered_map<uint32_t, GlyphCell> m_cells;
+    int m_shelf_x, m_shelf_y, m_shelf_h;  // packing cursor
+    bool m_dirty;
+    unsigned m_generation;
+};
+
+#endif // _GLYPH_ATLAS_H_
@@ -1,6 +1,8 @@
 #include "gpx_builder.h"
+#include "station_view.h"
 
 #include <cmath>
+#include <utility>
 #include <wx/intl.h>
 
 static wxString FmtObs(const wxString &label, double val, const wxString &unit) {
@@ -9,44 +11,60 @@ static wxString FmtObs(const wxString &label, double val, const wxString &unit)
 }
 
 wxString BuildGPXString(const wxDateTime &fetched_at,
-                        const ObservationList &stations) {
+                        const StationStore &stations) {
     wxString gpx;
     gpx += wxT("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
     gpx += wxT("<gpx version=\"1.1\" creator=\"shipobs_pi\"\n");
     gpx += wxT("  xmlns=\"http://www.topografix.com/GPX/1/1\">\n");
 
-    for (size_t i = 0; i < stations.size(); i++) {
-        const ObservationStation &st = stations[i];
-        if (std::isnan(st.lat) || std::isnan(st.lon)) continue;
+    for (size_t i = 0; i < stations.Size(); i++) {
+        double lat = stations.Lat(i), lon = stations.Lon(i);
+        if (std::isnan(lat) || std::isnan(lon)) continue;
+
+        // Read straight from the columns; only the strings this waypoint
+        // prints are converted.
+        wxString id      = StationString(stations, stations.IdIndex(i));
+        wxString type    = StationString(stations, stations.TypeIndex(i));
+        wxDateTime time  = DateTimeFromEpoch(stations.Time(i));
+        double wind_dir  = stations.Metric(METRIC_WIND_DIR, i);
+        double wind_spd  = stations.Metric(METRIC_WIND_SPD, i);
+        double gust      = stations.Metric(METRIC_GUST, i);
+        double pressure  = stations.Metric(METRIC_PRESSURE, i);
+        double air_temp  = stations.Metric(METRIC_AIR_TEMP, i);
+        double sea_temp  = stations.Metric(METRIC_SEA_TEMP, i);
+        double wave_ht   = stations.Metric(METRIC_WAVE_HT, i);
+        double vis       = stations.Metric(METRIC_VIS, i);
 
         gpx += wxString::Format(
-            wxT("  <wpt lat=\"%.6f\" lon=\"%.6f\">\n"), st.lat, st.lon);
-        gpx += wxString::Format(wxT("    <name>%s</name>\n"), st.id);
+            wxT("  <wpt lat=\"%.6f\" lon=\"%.6f\">\n"), lat, lon);
+        gpx += wxString::Format(wxT("    <name>%s</name>\n"), id);
         gpx += wxT("    <sym>Float</sym>\n");
 
         wxString desc;
-        if (st.time.IsValid())
+        if (time.IsValid())
             desc += wxString::Format(_("Timestamp: %s UTC\n"),
-                                     st.time.Format(wxT("%b %d, %Y %H:%M")));
-        desc += wxString::Format(_("Station: %s (%s)\n"), st.id, st.type);
-        if (!st.country.IsEmpty())
-            desc += wxString::Format(_("Country: %s\n"), st.country);
-        if (!std::isnan(st.wind_dir))
+                                     time.Format(wxT("%b %d, %Y %H:%M")));
+        desc += wxString::Format(_("Station: %s (%s)\n"), id, type);
+        uint32_t country = stations.CountryIndex(i);
+        if (stations.StringLength(country) > 0)
+            desc += wxString::Format(_("Country: %s\n"),
+                                     StationString(stations, country));
+        if (!std::isnan(wind_dir))
             desc += wxString::Format(_("Wind direction: %d\u00b0T\n"),
-                                     (int)std::round(st.wind_dir));
-        if (!std::isnan(st.wind_spd))
+                                     (int)std::round(wind_dir));
+        if (!std::isnan(wind_spd))
             desc += wxString::Format(_("Wind speed: %.1f kts\n"),
-                                     st.wind_spd * 1.94384);
-        if (!std::isnan(st.gust))
+                                     wind_spd * 1.94384);
+        if (!std::isnan(gust))
             desc += wxString::Format(_("Gust: %.1f kts\n"),
-                                     st.gust * 1.94384);
-        desc += FmtObs(_("Pressure"),    st.pressure, wxT("hPa"));
-        if (!std::isnan(st.air_temp))
-            desc += wxString::Format(_("Air temperature: %.1f \u00b0C\n"), st.air_temp);
-        if (!std::isnan(st.sea_temp))
-            desc += wxString::Format(_("Sea temperature: %.1f \u00b0C\n"), st.sea_temp);
-        desc += FmtObs(_("Wave height"), st.wave_ht,  wxT("m"));
-        desc += FmtObs(_("Visibility"),  st.vis,      wxT("nm"));
+                                     gust * 1.94384);
+        desc += FmtObs(_("Pressure"),    pressure, wxT("hPa"));
+        if (!std::isnan(air_temp))
+            desc += wxString::Format(_("Air temperature: %.1f \u00b0C\n"), air_temp);
+        if (!std::isnan(sea_temp))
+            desc += wxString::Format(_("Sea temperature: %.1f \u00b0C\n"), sea_temp);
+        desc += FmtObs(_("Wave height"), wave_ht,  wxT("m"));
+        desc += FmtObs(_("Visibility"),  vis,      wxT("nm"));
         desc.Trim();
         if (fetched_at.IsValid())
             desc += wxString::Format(_("\n\nFetched: %s"),
@@ -54,11 +72,20 @@ wxString BuildGPXString(const wxDateTime &fetched_at,
 
         gpx += wxString::Format(wxT("    <desc>%s</desc>\n"), desc);
 
-        if (st.time.IsValid())
+        if (time.IsValid())
             gpx += wxString::Format(wxT("    <time>%s</time>\n"),
-                                    st.time.Format(wxT("%Y-%m-%dT%H:%M:%SZ")));
+                                    time.Format(wxT("%Y-%m-%dT%H:%M:%SZ")));
         gpx += wxT("  </wpt>\n");
     }
     gpx += wxT("</gpx>\n");
     return gpx;
 }
+
+wxString BuildGPXString(const wxDateTime &fetched_at,
+                        const ObservationList &stations) {
+    StationColumns cols;
+    StationsToColumns(stations, cols);
+    StationStore store;
+    store.SetColumns(std::move(cols));
+    return BuildGPXString(fetched_at, store);
+}
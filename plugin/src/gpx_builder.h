@@ -2,12 +2,17 @@
 #define _GPX_BUILDER_H_
 
 #include "observation.h"
+#include "station_store.h"
 #include <wx/datetime.h>
 #include <wx/string.h>
 
 // Build a GPX document string from a list of stations.
 // fetched_at: timestamp of the fetch (appended to each waypoint description).
 // Stations with NaN lat/lon are skipped.
+wxString BuildGPXString(const wxDateTime &fetched_at,
+                        const StationStore &stations);
+
+// Same, for stations held as an ObservationList.
 wxString BuildGPXString(const wxDateTime &fetched_at,
                         const ObservationList &stations);
 
@@ -0,0 +1,721 @@
+#include "history_store.h"
+
+#include <cstdio>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+static const char INDEX_MAGIC[4] = {'S', 'O', 'B', 'I'};
+static const char BLOCK_MAGIC[4] = {'S', 'O', 'B', 'R'};
+static const uint32_t INDEX_VERSION = 1;
+static const uint32_t BLOCK_VERSION = 1;
+static const uint64_t BLOCK_HEADER_SIZE = 32;
+
+// Don't bother compacting for less dead space than this (unless the store
+// is empty, which makes compaction free).
+static const uint64_t COMPACT_MIN_BYTES = 256 * 1024;
+
+// ---------- Dates ----------
+// Howard Hinnant's days_from_civil / civil_from_days.
+
+int64_t DaysFromCivil(int year, int month, int day) {
+    int64_t y = year - (month <= 2 ? 1 : 0);
+    int64_t era = (y >= 0 ? y : y - 399) / 400;
+    int64_t yoe = y - era * 400;
+    int64_t doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+void CivilFromDays(int64_t days, int &year, int &month, int &day) {
+    days += 719468;
+    int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    int64_t doe = days - era * 146097;
+    int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    int64_t mp = (5 * doy + 2) / 153;
+    day   = static_cast<int>(doy - (153 * mp + 2) / 5 + 1);
+    month = static_cast<int>(mp < 10 ? mp + 3 : mp - 9);
+    year  = static_cast<int>(yoe + era * 400 + (month <= 2 ? 1 : 0));
+}
+
+std::string FormatIsoTime(int64_t t) {
+    int64_t days = (t >= 0 ? t : t - 86399) / 86400;
+    int64_t secs = t - days * 86400;
+    int year, month, day;
+    CivilFromDays(days, year, month, day);
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%04d-%02d-%02dT%02d:%02d:%02dZ",
+                  year, month, day, static_cast<int>(secs / 3600),
+                  static_cast<int>(secs / 60 % 60), static_cast<int>(secs % 60));
+    return buf;
+}
+
+// Two digits at s, or -1.
+static int Digits2(const char *s) {
+    unsigned d0 = static_cast<unsigned char>(s[0]) - '0';
+    unsigned d1 = static_cast<unsigned char>(s[1]) - '0';
+    return d0 < 10 && d1 < 10 ? static_cast<int>(d0 * 10 + d1) : -1;
+}
+
+int64_t ParseIsoTime(const char *s, size_t len) {
+    // YYYY-MM-DDTHH:MM:SSZ
+    // 0123456789...      19
+    if (len != 20 || s[4] != '-' || s[7] != '-' || s[10] != 'T' ||
+        s[13] != ':' || s[16] != ':' || s[19] != 'Z')
+        return TIME_UNKNOWN;
+    int century = Digits2(s), yy = Digits2(s + 2);
+    int month = Digits2(s + 5), day = Digits2(s + 8);
+    int hour = Digits2(s + 11), minute = Digits2(s + 14), sec = Digits2(s + 17);
+    if (century < 0 || yy < 0 || month < 1 || month > 12 || day < 1 ||
+        hour < 0 || hour > 23 || minute < 0 || minute > 59 || sec < 0 || sec > 59)
+        return TIME_UNKNOWN;
+    int year = century * 100 + yy;
+    static const int DAYS_IN_MONTH[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+    if (day > DAYS_IN_MONTH[month - 1] + (month == 2 && leap ? 1 : 0))
+        return TIME_UNKNOWN;
+    return DaysFromCivil(year, month, day) * 86400 + hour * 3600 + minute * 60 + sec;
+}
+
+// ---------- StationView / StationColumns ----------
+
+StationView::StationView()
+    : count(0), lat(nullptr), lon(nullptr), time(nullptr),
+      id(nullptr), type(nullptr), country(nullptr),
+      string_count(0), string_offsets(nullptr), string_bytes(nullptr) {
+    for (int m = 0; m < METRIC_COUNT; m++) metric[m] = nullptr;
+}
+
+void StationColumns::Clear() {
+    lat.clear();
+    lon.clear();
+    time.clear();
+    for (int m = 0; m < METRIC_COUNT; m++) metric[m].clear();
+    id.clear();
+    type.clear();
+    country.clear();
+    string_offsets.assign(2, 0);  // just ""
+    string_bytes.clear();
+    m_lookup.clear();
+}
+
+void StationColumns::Reserve(size_t n) {
+    lat.reserve(n);
+    lon.reserve(n);
+    time.reserve(n);
+    for (int m = 0; m < METRIC_COUNT; m++) metric[m].reserve(n);
+    id.reserve(n);
+    type.reserve(n);
+    country.reserve(n);
+}
+
+uint32_t StationColumns::Intern(const std::string &s) {
+    // The table may have been filled directly (DecodeBlock); index lazily.
+    if (m_lookup.size() != StringCount()) {
+        m_lookup.clear();
+        for (uint32_t i = 0; i < StringCount(); i++)
+            m_lookup.emplace(String(i), i);
+    }
+    auto it = m_lookup.find(s);
+    if (it != m_lookup.end()) return it->second;
+    uint32_t idx = StringCount();
+    string_bytes += s;
+    string_offsets.push_back(static_cast<uint32_t>(string_bytes.size()));
+    m_lookup.emplace(s, idx);
+    return idx;
+}
+
+StationView StationColumns::View() const {
+    StationView v;
+    v.count = Size();
+    v.lat   = lat.data();
+    v.lon   = lon.data();
+    v.time  = time.data();
+    for (int m = 0; m < METRIC_COUNT; m++) v.metric[m] = metric[m].data();
+    v.id      = id.data();
+    v.type    = type.data();
+    v.country = country.data();
+    v.string_count   = StringCount();
+    v.string_offsets = string_offsets.data();
+    v.string_bytes   = string_bytes.data();
+    return v;
+}
+
+// ---------- Block encoding ----------
+
+static uint64_t Align8(uint64_t n) { return (n + 7) & ~static_cast<uint64_t>(7); }
+
+BlockLayout::BlockLayout(uint32_t count, uint32_t string_count,
+                         uint64_t string_len) {
+    uint64_t pos = BLOCK_HEADER_SIZE;
+    lat  = pos; pos += Align8(8ull * count);
+    lon  = pos; pos += Align8(8ull * count);
+    time = pos; pos += Align8(8ull * count);
+    for (int m = 0; m < METRIC_COUNT; m++) {
+        metric[m] = pos;
+        pos += Align8(4ull * count);
+    }
+    id      = pos; pos += Align8(4ull * count);
+    type    = pos; pos += Align8(4ull * count);
+    country = pos; pos += Align8(4ull * count);
+    string_offsets = pos; pos += Align8(4ull * (string_count + 1ull));
+    string_bytes   = pos; pos += Align8(string_len);
+    total = pos;
+}
+
+template <typename T>
+static void PutColumn(std::string &buf, uint64_t at, const std::vector<T> &col) {
+    if (!col.empty())
+        std::memcpy(&buf[at], col.data(), col.size() * sizeof(T));
+}
+
+std::string EncodeBlock(const StationColumns &cols) {
+    uint32_t count = static_cast<uint32_t>(cols.Size());
+    uint32_t string_count = cols.StringCount();
+    uint64_t string_len = cols.string_bytes.size();
+
+    BlockLayout lay(count, string_count, string_len);
+    std::string buf(static_cast<size_t>(lay.total), '\0');
+
+    std::memcpy(&buf[0], BLOCK_MAGIC, 4);
+    std::memcpy(&buf[4], &BLOCK_VERSION, 4);
+    std::memcpy(&buf[8], &count, 4);
+    std::memcpy(&buf[12], &string_count, 4);
+    std::memcpy(&buf[16], &string_len, 8);
+
+    PutColumn(buf, lay.lat, cols.lat);
+    PutColumn(buf, lay.lon, cols.lon);
+    PutColumn(buf, lay.time, cols.time);
+    for (int m = 0; m < METRIC_COUNT; m++)
+        PutColumn(buf, lay.metric[m], cols.metric[m]);
+    PutColumn(buf, lay.id, cols.id);
+    PutColumn(buf, lay.type, cols.type);
+    PutColumn(buf, lay.country, cols.country);
+    PutColumn(buf, lay.string_offsets, cols.string_offsets);
+    if (string_len)
+        std::memcpy(&buf[lay.string_bytes], cols.string_bytes.data(), string_len);
+    return buf;
+}
+
+static bool IndicesValid(const uint32_t *col, size_t n, uint32_t limit) {
+    for (size_t i = 0; i < n; i++)
+        if (col[i] >= limit) return false;
+    return true;
+}
+
+bool ViewBlock(const char *data, size_t len, StationView &out) {
+    if (reinterpret_cast<uintptr_t>(data) % 8 != 0) return false;
+    if (len < BLOCK_HEADER_SIZE) return false;
+    if (std::memcmp(data, BLOCK_MAGIC, 4) != 0) return false;
+
+    uint32_t version, count, string_count;
+    uint64_t string_len;
+    std::memcpy(&version, data + 4, 4);
+    std::memcpy(&count, data + 8, 4);
+    std::memcpy(&string_count, data + 12, 4);
+    std::memcpy(&string_len, data + 16, 8);
+    if (version != BLOCK_VERSION || string_count == 0) return false;
+    if (string_len > len) return false;
+
+    BlockLayout lay(count, string_count, string_len);
+    if (lay.total > len) return false;
+
+    const uint32_t *offsets =
+        reinterpret_cast<const uint32_t *>(data + lay.string_offsets);
+    if (offsets[0] != 0 || offsets[string_count] != string_len) return false;
+    for (uint32_t i = 0; i < string_count; i++)
+        if (offsets[i] > offsets[i + 1]) return false;
+
+    StationView v;
+    v.count = count;
+    v.lat   = reinterpret_cast<const double *>(data + lay.lat);
+    v.lon   = reinterpret_cast<const double *>(data + lay.lon);
+    v.time  = reinterpret_cast<const int64_t *>(data + lay.time);
+    for (int m = 0; m < METRIC_COUNT; m++)
+        v.metric[m] = reinterpret_cast<const float *>(data + lay.metric[m]);
+    v.id      = reinterpret_cast<const uint32_t *>(data + lay.id);
+    v.type    = reinterpret_cast<const uint32_t *>(data + lay.type);
+    v.country = reinterpret_cast<const uint32_t *>(data + lay.country);
+    v.string_count   = string_count;
+    v.string_offsets = offsets;
+    v.string_bytes   = data + lay.string_bytes;
+
+    if (!IndicesValid(v.id, count, string_count) ||
+        !IndicesValid(v.type, count, string_count) ||
+        !IndicesValid(v.country, count, string_count))
+        return false;
+    out = v;
+    return true;
+}
+
+bool DecodeBlock(const char *data, size_t len, StationColumns &out) {
+    // ViewBlock needs an 8-aligned start; copy if the caller's isn't.
+    std::vector<uint64_t> aligned;
+    if (reinterpret_cast<uintptr_t>(data) % 8 != 0) {
+        aligned.resize((len + 7) / 8);
+        std::memcpy(aligned.data(), data, len);
+        data = reinterpret_cast<const char *>(aligned.data());
+    }
+    StationView v;
+    if (!ViewBlock(data, len, v)) return false;
+
+    out.Clear();
+    size_t n = v.count;
+    out.lat.assign(v.lat, v.lat + n);
+    out.lon.assign(v.lon, v.lon + n);
+    out.time.assign(v.time, v.time + n);
+    for (int m = 0; m < METRIC_COUNT; m++)
+        out.metric[m].assign(v.metric[m], v.metric[m] + n);
+    out.id.assign(v.id, v.id + n);
+    out.type.assign(v.type, v.type + n);
+    out.country.assign(v.country, v.country + n);
+    out.string_offsets.assign(v.string_offsets,
+                              v.string_offsets + v.string_count + 1);
+    out.string_bytes.assign(v.string_bytes, v.string_offsets[v.string_count]);
+    return true;
+}
+
+// ---------- File helpers (UTF-8 paths on every platform) ----------
+
+#ifdef _WIN32
+static std::wstring Widen(const std::string &s) {
+    int n = MultiByteToWideChar(CP_UTF8, 0, s.c_str(), -1, nullptr, 0);
+    std::wstring w(n > 0 ? n - 1 : 0, L'\0');
+    if (n > 1) MultiByteToWideChar(CP_UTF8, 0, s.c_str(), -1, &w[0], n);
+    return w;
+}
+#endif
+
+static FILE *FileOpen(const std::string &path, const char *mode) {
+#ifdef _WIN32
+    return _wfopen(Widen(path).c_str(), Widen(mode).c_str());
+#else
+    return std::fopen(path.c_str(), mode);
+#endif
+}
+
+static bool FileSeek(FILE *f, uint64_t pos) {
+#ifdef _WIN32
+    return _fseeki64(f, static_cast<__int64>(pos), SEEK_SET) == 0;
+#else
+    return fseeko(f, static_cast<off_t>(pos), SEEK_SET) == 0;
+#endif
+}
+
+static bool FileRename(const std::string &from, const std::string &to) {
+#ifdef _WIN32
+    return MoveFileExW(Widen(from).c_str(), Widen(to).c_str(),
+                       MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    return std::rename(from.c_str(), to.c_str()) == 0;
+#endif
+}
+
+void FileRemove(const std::string &path) {
+#ifdef _WIN32
+    _wremove(Widen(path).c_str());
+#else
+    std::remove(path.c_str());
+#endif
+}
+
+bool ReadFileBytes(const std::string &path, std::string &out) {
+    FILE *f = FileOpen(path, "rb");
+    if (!f) return false;
+    out.clear();
+    char chunk[16384];
+    size_t n;
+    while ((n = std::fread(chunk, 1, sizeof(chunk), f)) > 0)
+        out.append(chunk, n);
+    bool ok = !std::ferror(f);
+    std::fclose(f);
+    return ok;
+}
+
+bool WriteFileAtomic(const std::string &path, const std::string &buf) {
+    std::string tmp = path + ".tmp";
+    FILE *f = FileOpen(tmp, "wb");
+    if (!f) return false;
+    bool ok = std::fwrite(buf.data(), 1, buf.size(), f) == buf.size();
+    ok = (std::fclose(f) == 0) && ok;
+    if (ok) ok = FileRename(tmp, path);
+    if (!ok) FileRemove(tmp);
+    return ok;
+}
+
+// ---------- Index encoding ----------
+
+template <typename T>
+static void Put(std::string &buf, const T &v) {
+    buf.append(reinterpret_cast<const char *>(&v), sizeof(T));
+}
+
+// Bounds-checked sequential reader over the index file contents.
+struct IndexReader {
+    const char *p, *end;
+    bool ok;
+    IndexReader(const std::string &s) : p(s.data()), end(s.data() + s.size()), ok(true) {}
+
+    template <typename T>
+    T Get() {
+        T v = T();
+        if (ok && static_cast<size_t>(end - p) >= sizeof(T)) {
+            std::memcpy(&v, p, sizeof(T));
+            p += sizeof(T);
+        } else {
+            ok = false;
+        }
+        return v;
+    }
+
+    std::string GetBytes(uint32_t n) {
+        if (!ok || static_cast<size_t>(end - p) < n) {
+            ok = false;
+            return std::string();
+        }
+        std::string s(p, n);
+        p += n;
+        return s;
+    }
+};
+
+// ---------- HistoryStore ----------
+
+HistoryStore::HistoryStore()
+    : m_data_gen(0), m_data_size(0), m_dead_bytes(0),
+      m_open(false), m_is_new(false) {}
+
+std::string HistoryStore::DataPathFor(uint32_t gen) const {
+    return m_base_path + "." + std::to_string(gen) + ".dat";
+}
+
+bool HistoryStore::Open(const std::string &base_path) {
+    m_base_path  = base_path;
+    m_index_path = base_path + ".idx";
+    m_records.clear();
+    m_data_gen = 0;
+    m_data_size = 0;
+    m_dead_bytes = 0;
+    m_open = false;
+
+    FILE *f = FileOpen(m_index_path, "rb");
+    m_is_new = (f == nullptr);
+    if (f) std::fclose(f);
+
+    if (!m_is_new && !ReadIndex()) return false;
+    m_data_path = DataPathFor(m_data_gen);
+    // The previous generation outlives Compact() if it was still mapped
+    // (Windows won't delete a mapped file); it is garbage by now.
+    if (m_data_gen > 0) FileRemove(DataPathFor(m_data_gen - 1));
+    m_open = true;
+    return true;
+}
+
+bool HistoryStore::ReadIndex() {
+    std::string buf;
+    if (!ReadFileBytes(m_index_path, buf)) return false;
+
+    IndexReader r(buf);
+    if (r.GetBytes(4) != std::string(INDEX_MAGIC, 4)) return false;
+    if (r.Get<uint32_t>() != INDEX_VERSION) return false;
+    uint32_t count = r.Get<uint32_t>();
+    uint32_t gen   = r.Get<uint32_t>();
+    uint64_t data_size = r.Get<uint64_t>();
+    if (!r.ok) return false;
+
+    std::vector<HistoryRecordInfo> records;
+    uint64_t live = 0;
+    for (uint32_t i = 0; i < count && r.ok; i++) {
+        HistoryRecordInfo info;
+        info.fetched_at    = r.Get<int64_t>();
+        info.lat_min       = r.Get<double>();
+        info.lat_max       = r.Get<double>();
+        info.lon_min       = r.Get<double>();
+        info.lon_max       = r.Get<double>();
+        info.offset        = r.Get<uint64_t>();
+        info.size          = r.Get<uint64_t>();
+        info.station_count = r.Get<uint32_t>();
+        uint32_t label_len = r.Get<uint32_t>();
+        info.label         = r.GetBytes(label_len);
+        // Compared so that a corrupt index cannot wrap around.
+        if (info.size > data_size - live || info.offset > data_size - info.size)
+            r.ok = false;
+        live += info.size;
+        records.push_back(info);
+    }
+    if (!r.ok) return false;
+
+    m_records.swap(records);
+    m_data_gen   = gen;
+    m_data_size  = data_size;
+    m_dead_bytes = data_size - live;
+    return true;
+}
+
+bool HistoryStore::WriteIndex() const {
+    std::string buf;
+    buf.reserve(32 + m_records.size() * 80);
+    buf.append(INDEX_MAGIC, 4);
+    Put(buf, INDEX_VERSION);
+    Put(buf, static_cast<uint32_t>(m_records.size()));
+    Put(buf, m_data_gen);
+    Put(buf, m_data_size);
+    for (const HistoryRecordInfo &info : m_records) {
+        Put(buf, info.fetched_at);
+        Put(buf, info.lat_min);
+        Put(buf, info.lat_max);
+        Put(buf, info.lon_min);
+        Put(buf, info.lon_max);
+        Put(buf, info.offset);
+        Put(buf, info.size);
+        Put(buf, info.station_count);
+        Put(buf, static_cast<uint32_t>(info.label.size()));
+        buf += info.label;
+    }
+    return WriteFileAtomic(m_index_path, buf);
+}
+
+bool HistoryStore::Append(const HistoryRecordInfo &info,
+                          const StationColumns &cols) {
+    if (!m_open) return false;
+    std::string block = EncodeBlock(cols);
+
+    // Write the block past the last live one (overwriting any orphan left
+    // by an earlier append whose index update failed), then publish it.
+    FILE *f = FileOpen(m_data_path, "r+b");
+    if (!f) f = FileOpen(m_data_path, "w+b");
+    if (!f) return false;
+    bool ok = FileSeek(f, m_data_size) &&
+              std::fwrite(block.data(), 1, block.size(), f) == block.size();
+    ok = (std::fclose(f) == 0) && ok;
+    if (!ok) return false;
+
+    HistoryRecordInfo rec = info;
+    rec.offset = m_data_size;
+    rec.size = block.size();
+    rec.station_count = static_cast<uint32_t>(cols.Size());
+    m_records.push_back(rec);
+    m_data_size += block.size();
+    if (!WriteIndex()) {
+        m_records.pop_back();
+        m_data_size -= block.size();
+        return false;
+    }
+    return true;
+}
+
+bool HistoryStore::Remove(size_t index) {
+    if (!m_open || index >= m_records.size()) return false;
+    HistoryRecordInfo removed = m_records[index];
+    m_records.erase(m_records.begin() + index);
+    if (!WriteIndex()) {
+        m_records.insert(m_records.begin() + index, removed);
+        return false;
+    }
+    m_dead_bytes += removed.size;
+    MaybeCompact();
+    return true;
+}
+
+bool HistoryStore::TrimTo(size_t keep) {
+    if (!m_open) return false;
+    if (m_records.size() <= keep) return true;
+    size_t drop = m_records.size() - keep;
+    std::vector<HistoryRecordInfo> old = m_records;
+    uint64_t freed = 0;
+    for (size_t i = 0; i < drop; i++) freed += m_records[i].size;
+    m_records.erase(m_records.begin(), m_records.begin() + drop);
+    if (!WriteIndex()) {
+        m_records.swap(old);
+        return false;
+    }
+    m_dead_bytes += freed;
+    MaybeCompact();
+    return true;
+}
+
+bool HistoryStore::Load(size_t index, StationColumns &out) const {
+    if (!m_open || index >= m_records.size()) return false;
+    const HistoryRecordInfo &info = m_records[index];
+
+    FILE *f = FileOpen(m_data_path, "rb");
+    if (!f) return false;
+    std::vector<uint64_t> buf(static_cast<size_t>((info.size + 7) / 8));
+    size_t len = static_cast<size_t>(info.size);
+    bool ok = FileSeek(f, info.offset) && std::fread(buf.data(), 1, len, f) == len;
+    std::fclose(f);
+    if (!ok || !DecodeBlock(reinterpret_cast<const char *>(buf.data()), len, out))
+        return false;
+    return out.Size() == info.station_count;
+}
+
+// ---------- Memory mapping ----------
+
+MappedRecord::MappedRecord() : m_base(nullptr), m_length(0) {}
+
+MappedRecord::~MappedRecord() { Reset(); }
+
+void MappedRecord::Reset() {
+    if (m_base) {
+#ifdef _WIN32
+        UnmapViewOfFile(m_base);
+#else
+        munmap(m_base, m_length);
+#endif
+    }
+    m_base = nullptr;
+    m_length = 0;
+    m_view = StationView();
+}
+
+bool HistoryStore::Map(size_t index, MappedRecord &out) const {
+    out.Reset();
+    if (!m_open || index >= m_records.size()) return false;
+    const HistoryRecordInfo &info = m_records[index];
+    if (info.size == 0) return false;
+
+    // Mappings must start on a page (Windows: allocation granularity)
+    // boundary; blocks start on 8-byte boundaries, so the block keeps its
+    // alignment at data + delta.
+#ifdef _WIN32
+    SYSTEM_INFO si;
+    GetSystemInfo(&si);
+    uint64_t gran = si.dwAllocationGranularity;
+#else
+    uint64_t gran = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+#endif
+    uint64_t start = info.offset - info.offset % gran;
+    size_t delta = static_cast<size_t>(info.offset - start);
+    size_t length = delta + static_cast<size_t>(info.size);
+
+#ifdef _WIN32
+    HANDLE file = CreateFileW(Widen(m_data_path).c_str(), GENERIC_READ,
+                              FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                              nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (!mapping) return false;
+    // The view keeps the mapping (and file) alive after the handles close.
+    void *base = MapViewOfFile(mapping, FILE_MAP_READ,
+                               static_cast<DWORD>(start >> 32),
+                               static_cast<DWORD>(start & 0xffffffffu), length);
+    CloseHandle(mapping);
+    if (!base) return false;
+#else
+    int fd = open(m_data_path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    void *base = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd,
+                      static_cast<off_t>(start));
+    close(fd);
+    if (base == MAP_FAILED) return false;
+#endif
+    out.m_base = base;
+    out.m_length = length;
+
+    const char *block = static_cast<const char *>(base) + delta;
+    if (!ViewBlock(block, static_cast<size_t>(info.size), out.m_view) ||
+        out.m_view.count != info.station_count) {
+        out.Reset();
+        return false;
+    }
+    return true;
+}
+
+void HistoryStore::Clear() {
+    FileRemove(m_index_path);
+    FileRemove(m_data_path);
+    m_records.clear();
+    m_data_gen = 0;
+    m_data_size = 0;
+    m_dead_bytes = 0;
+    m_data_path = DataPathFor(0);
+    m_is_new = true;
+}
+
+bool HistoryStore::MoveTo(const std::string &base_path) {
+    if (!m_open) return false;
+    std::string index_path = base_path + ".idx";
+    std::string data_path = base_path + "." + std::to_string(m_data_gen) + ".dat";
+
+    // Nothing written yet: there are no files to move.
+    FILE *f = FileOpen(m_index_path, "rb");
+    if (f) {
+        std::fclose(f);
+        // The data first: the index only names a store once it is complete.
+        if (!FileRename(m_data_path, data_path)) return false;
+        if (!FileRename(m_index_path, index_path)) {
+            FileRename(data_path, m_data_path);
+            return false;
+        }
+    }
+    m_base_path  = base_path;
+    m_index_path = index_path;
+    m_data_path  = data_path;
+    return true;
+}
+
+void HistoryStore::MaybeCompact() {
+    uint64_t live = m_data_size - m_dead_bytes;
+    if (m_dead_bytes == 0 || m_dead_bytes < live) return;
+    if (m_dead_bytes < COMPACT_MIN_BYTES && !m_records.empty()) return;
+    Compact();
+}
+
+bool HistoryStore::Compact() {
+    if (!m_open) return false;
+    uint32_t new_gen = m_data_gen + 1;
+    std::string new_path = DataPathFor(new_gen);
+
+    std::vector<HistoryRecordInfo> records = m_records;
+    uint64_t pos = 0;
+    bool ok = true;
+    FILE *in = m_records.empty() ? nullptr : FileOpen(m_data_path, "rb");
+    FILE *out = FileOpen(new_path, "wb");
+    if (!out || (!in && !m_records.empty())) ok = false;
+
+    std::string buf;
+    for (size_t i = 0; ok && i < records.size(); i++) {
+        HistoryRecordInfo &info = records[i];
+        buf.resize(static_cast<size_t>(info.size));
+        ok = FileSeek(in, info.offset) &&
+             std::fread(&buf[0], 1, buf.size(), in) == buf.size() &&
+             std::fwrite(buf.data(), 1, buf.size(), out) == buf.size();
+        info.offset = pos;
+        pos += info.size;
+    }
+    if (in) std::fclose(in);
+    if (out) ok = (std::fclose(out) == 0) && ok;
+    if (!ok) {
+        FileRemove(new_path);
+        return false;
+    }
+
+    // Publish the new generation; the old file stays valid until the index
+    // names the new one.
+    std::vector<HistoryRecordInfo> old_records;
+    old_records.swap(m_records);
+    m_records.swap(records);
+    uint32_t old_gen = m_data_gen;
+    uint64_t old_size = m_data_size;
+    m_data_gen = new_gen;
+    m_data_size = pos;
+    if (!WriteIndex()) {
+        m_records.swap(old_records);
+        m_data_gen = old_gen;
+        m_data_size = old_size;
+        FileRemove(new_path);
+        return false;
+    }
+    FileRemove(m_data_path);
+    m_data_path = new_path;
+    m_dead_bytes = 0;
+    return true;
+}
@@ -0,0 +1,232 @@
+#ifndef _HISTORY_STORE_H_
+#define _HISTORY_STORE_H_
+
+// Binary fetch-history store — no wx dependencies.
+//
+// Two files:
+//   <base>.idx        small index: one entry per fetch record (label,
+//                     fetched_at, bbox, station count, location of its block
+//                     in the data file). Rewritten atomically (temp + rename)
+//                     on every change.
+//   <base>.<gen>.dat  append-only data: one self-contained, column-oriented
+//                     block per fetch record. Deleted records leave dead
+//                     space; Compact() copies the live blocks into the next
+//                     generation's file, so the index always names a data
+//                     file its offsets are valid for.
+//
+// Appending or deleting a record touches only that record's block plus the
+// index; loading a record is one seek and one read, or a single mapping.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Observation values stored per station, in column order.
+enum StationMetric {
+    METRIC_WIND_DIR, METRIC_WIND_SPD, METRIC_GUST, METRIC_PRESSURE,
+    METRIC_AIR_TEMP, METRIC_SEA_TEMP, METRIC_WAVE_HT, METRIC_VIS,
+    METRIC_COUNT
+};
+
+// Marker for "no time" in int64 epoch-second columns.
+static const int64_t TIME_UNKNOWN = INT64_MIN;
+
+// Days since 1970-01-01 for a proleptic Gregorian date (month 1..12), and
+// the inverse.
+int64_t DaysFromCivil(int year, int month, int day);
+void CivilFromDays(int64_t days, int &year, int &month, int &day);
+
+// Epoch seconds as ISO-8601 UTC, "YYYY-MM-DDTHH:MM:SSZ".
+std::string FormatIsoTime(int64_t t);
+
+// The inverse: epoch seconds of a string in exactly that form, with a valid
+// date and time (seconds 0..59). TIME_UNKNOWN for anything else. Doesn't
+// allocate.
+int64_t ParseIsoTime(const char *s, size_t len);
+
+// Read-only view of station columns: a history block mapped from disk
+// (MappedRecord) or StationColumns in memory. Strings (id, type, country)
+// are interned; each string column holds an index into the string table.
+// The view does not own its data.
+struct StationView {
+    size_t count;
+    const double   *lat, *lon;
+    const int64_t  *time;                  // epoch seconds (UTC)
+    const float    *metric[METRIC_COUNT];  // NaN = missing
+    const uint32_t *id, *type, *country;
+    uint32_t        string_count;
+    const uint32_t *string_offsets;        // string_count + 1 entries
+    const char     *string_bytes;
+
+    StationView();
+    size_t Size() const { return count; }
+    bool Empty() const { return count == 0; }
+
+    // UTF-8 bytes of interned string idx (not NUL-terminated).
+    const char *StringData(uint32_t idx) const {
+        return string_bytes + string_offsets[idx];
+    }
+    size_t StringLength(uint32_t idx) const {
+        return string_offsets[idx + 1] - string_offsets[idx];
+    }
+    bool StringEquals(uint32_t idx, const char *s, size_t n) const {
+        return StringLength(idx) == n && std::memcmp(StringData(idx), s, n) == 0;
+    }
+    bool StringEquals(uint32_t idx, const std::string &s) const {
+        return StringEquals(idx, s.data(), s.size());
+    }
+};
+
+// Stations of one fetch record as parallel columns, owned in memory.
+struct StationColumns {
+    std::vector<double>   lat, lon;
+    std::vector<int64_t>  time;
+    std::vector<float>    metric[METRIC_COUNT];
+    std::vector<uint32_t> id, type, country;
+    std::vector<uint32_t> string_offsets;  // string 0 is always ""
+    std::string           string_bytes;
+
+    StationColumns() { Clear(); }
+    size_t Size() const { return lat.size(); }
+    uint32_t StringCount() const {
+        return static_cast<uint32_t>(string_offsets.size() - 1);
+    }
+    std::string String(uint32_t idx) const {
+        return string_bytes.substr(string_offsets[idx],
+                                   string_offsets[idx + 1] - string_offsets[idx]);
+    }
+    void Clear();
+    void Reserve(size_t n);
+    uint32_t Intern(const std::string &s);
+
+    // Valid until the columns are modified or destroyed.
+    StationView View() const;
+
+private:
+    std::unordered_map<std::string, uint32_t> m_lookup;
+};
+
+struct HistoryRecordInfo {
+    std::string label;        // UTF-8
+    int64_t fetched_at;       // epoch seconds (UTC), TIME_UNKNOWN if unset
+    double lat_min, lat_max, lon_min, lon_max;
+    uint32_t station_count;
+    uint64_t offset;          // block position in the data file
+    uint64_t size;            // block length in bytes
+    HistoryRecordInfo()
+        : fetched_at(TIME_UNKNOWN), lat_min(0), lat_max(0), lon_min(0),
+          lon_max(0), station_count(0), offset(0), size(0) {}
+};
+
+// Byte offsets of each column inside a data block. Every section starts on
+// an 8-byte boundary so a block read into (or mapped at) an 8-aligned
+// address can be used in place.
+struct BlockLayout {
+    uint64_t lat, lon, time, metric[METRIC_COUNT];
+    uint64_t id, type, country;
+    uint64_t string_offsets;  // uint32[string_count + 1]
+    uint64_t string_bytes;
+    uint64_t total;
+    BlockLayout(uint32_t count, uint32_t string_count, uint64_t string_len);
+};
+
+// A history block mapped read-only into memory (mmap / MapViewOfFile).
+// Nothing is copied: View() points straight into the mapping, which stays
+// valid until Reset() or destruction — even if the record is removed from
+// the store or the data file is compacted meanwhile.
+class MappedRecord {
+public:
+    MappedRecord();
+    ~MappedRecord();
+    bool IsValid() const { return m_base != nullptr; }
+    const StationView &View() const { return m_view; }
+    void Reset();
+
+private:
+    MappedRecord(const MappedRecord &);
+    MappedRecord &operator=(const MappedRecord &);
+
+    void *m_base;        // start of the mapping (page/granularity aligned)
+    size_t m_length;
+    StationView m_view;
+
+    friend class HistoryStore;
+};
+
+class HistoryStore {
+public:
+    HistoryStore();
+
+    // Open (or create) the store; base_path is UTF-8, without extension.
+    // A missing index is an empty store; an unreadable one is a failure.
+    bool Open(const std::string &base_path);
+    bool IsOpen() const { return m_open; }
+
+    // True if no index file existed when Open() was called.
+    bool IsNew() const { return m_is_new; }
+
+    const std::vector<HistoryRecordInfo> &Records() const { return m_records; }
+
+    // Append a record; info.offset/size/station_count are filled in.
+    bool Append(const HistoryRecordInfo &info, const StationColumns &cols);
+
+    // Drop one record, or all but the newest `keep` records.
+    bool Remove(size_t index);
+    bool TrimTo(size_t keep);
+
+    // Read one record's stations with a single seek + read.
+    bool Load(size_t index, StationColumns &out) const;
+
+    // Map one record's block instead of reading it (zero-copy).
+    bool Map(size_t index, MappedRecord &out) const;
+
+    // Bytes in the data file no longer referenced by the index.
+    uint64_t GetDeadBytes() const { return m_dead_bytes; }
+
+    // Rewrite the data file with live blocks only. Called automatically by
+    // Remove()/TrimTo() once dead space exceeds the live data.
+    bool Compact();
+
+    // Delete the store's files and forget every record; the store stays
+    // open, as if new.
+    void Clear();
+
+    // Move the store's files to base_path (UTF-8, without extension), where
+    // no index may exist yet, and go on from there.
+    bool MoveTo(const std::string &base_path);
+
+    const std::string &GetDataPath() const { return m_data_path; }
+
+private:
+    bool ReadIndex();
+    bool WriteIndex() const;
+    void MaybeCompact();
+    std::string DataPathFor(uint32_t gen) const;
+
+    std::string m_base_path;
+    std::string m_index_path;
+    std::string m_data_path;
+    uint32_t m_data_gen;
+    std::vector<HistoryRecordInfo> m_records;
+    uint64_t m_data_size;    // end of the last block in the data file
+    uint64_t m_dead_bytes;
+    bool m_open;
+    bool m_is_new;
+};
+
+// Serialise / deserialise one data block (exposed for tests). ViewBlock
+// validates a block in place; data must be 8-byte aligned.
+std::string EncodeBlock(const StationColumns &cols);
+bool ViewBlock(const char *data, size_t len, StationView &out);
+bool DecodeBlock(const char *data, size_t len, StationColumns &out);
+
+// Whole-file helpers on UTF-8 paths. WriteFileAtomic writes a temp file and
+// renames it over path only once it is complete.
+bool ReadFileBytes(const std::string &path, std::string &out);
+bool WriteFileAtomic(const std::string &path, const std::string &buf);
+void FileRemove(const std::string &path);
+
+#endif // _HISTORY_STORE_H_
@@ -0,0 +1,162 @@
+#include "http_client.h"
+
+// Idle connections are probed after this long, so a NAT or satellite
+// modem between fetches doesn't silently drop them.
+static const long KEEPALIVE_IDLE_S = 60;
+static const long KEEPALIVE_INTERVAL_S = 30;
+// Server addresses rarely change; re-resolve every 10 minutes rather than
+// curl's default of every minute.
+static const long DNS_CACHE_S = 600;
+
+HttpClient::HttpClient()
+    : m_multi(nullptr), m_share(nullptr), m_requests(0), m_reused(0),
+      m_traffic(0) {}
+
+HttpClient::~HttpClient() {
+    Close();
+}
+
+void HttpClient::Close() {
+    for (CURL *h : m_handles)
+        if (h) curl_easy_cleanup(h);
+    m_handles.clear();
+    if (m_multi) {
+        curl_multi_cleanup(m_multi);
+        m_multi = nullptr;
+    }
+    if (m_share) {
+        curl_share_cleanup(m_share);
+        m_share = nullptr;
+    }
+}
+
+CURL *HttpClient::Prepare(const std::string &url, size_t slot) {
+    if (!m_share) {
+        m_share = curl_share_init();
+        if (m_share) {
+            curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+            curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+#if LIBCURL_VERSION_NUM >= 0x073900  // 7.57.0
+            curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+#endif
+        }
+    }
+    if (slot >= m_handles.size()) m_handles.resize(slot + 1, nullptr);
+    CURL *&curl = m_handles[slot];
+    if (!curl) {
+        curl = curl_easy_init();
+        if (!curl) return nullptr;
+    } else {
+        // Clears per-request options; open connections and caches survive.
+        curl_easy_reset(curl);
+    }
+
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    if (m_share) curl_easy_setopt(curl, CURLOPT_SHARE, m_share);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 15L);
+    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 5L);
+    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);  // worker thread
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPIDLE, KEEPALIVE_IDLE_S);
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPINTVL, KEEPALIVE_INTERVAL_S);
+    curl_easy_setopt(curl, CURLOPT_DNS_CACHE_TIMEOUT, DNS_CACHE_S);
+    return curl;
+}
+
+HttpStats HttpClient::Record(CURL *curl, CURLcode res) {
+    HttpStats s;
+    double t = 0;
+    long new_connections = 0, header_size = 0, request_size = 0;
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &s.http_code);
+    if (curl_easy_getinfo(curl, CURLINFO_NAMELOOKUP_TIME, &t) == CURLE_OK)
+        s.name_lookup_ms = t * 1000;
+    if (curl_easy_getinfo(curl, CURLINFO_CONNECT_TIME, &t) == CURLE_OK)
+        s.connect_ms = t * 1000;
+    if (curl_easy_getinfo(curl, CURLINFO_APPCONNECT_TIME, &t) == CURLE_OK)
+        s.tls_ms = t * 1000;
+    if (curl_easy_getinfo(curl, CURLINFO_STARTTRANSFER_TIME, &t) == CURLE_OK)
+        s.first_byte_ms = t * 1000;
+    if (curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME, &t) == CURLE_OK)
+        s.total_ms = t * 1000;
+    curl_easy_getinfo(curl, CURLINFO_SIZE_DOWNLOAD_T, &s.bytes);
+    curl_easy_getinfo(curl, CURLINFO_HEADER_SIZE, &header_size);
+    curl_easy_getinfo(curl, CURLINFO_REQUEST_SIZE, &request_size);
+    s.header_bytes = header_size + request_size;
+    curl_easy_getinfo(curl, CURLINFO_NUM_CONNECTS, &new_connections);
+    s.reused = (res == CURLE_OK && new_connections == 0);
+
+    m_last = s;
+    m_requests++;
+    if (s.reused) m_reused++;
+    m_traffic += static_cast<uint64_t>(s.bytes) + s.header_bytes;
+    return s;
+}
+
+CURLcode HttpClient::Perform() {
+    if (m_handles.empty() || !m_handles[0]) return CURLE_FAILED_INIT;
+    CURLcode res = curl_easy_perform(m_handles[0]);
+    Record(m_handles[0], res);
+    return res;
+}
+
+void HttpClient::PerformMany(size_t count, int max_parallel,
+                             std::vector<CURLcode> &results,
+                             std::vector<HttpStats> &stats) {
+    results.assign(count, CURLE_FAILED_INIT);
+    stats.assign(count, HttpStats());
+    if (count > m_handles.size()) count = m_handles.size();
+    if (!m_multi) m_multi = curl_multi_init();
+    if (!m_multi) return;
+    size_t limit = static_cast<size_t>(max_parallel > 0 ? max_parallel : 1);
+
+    size_t next = 0, running = 0;
+    while (next < count || running > 0) {
+        // Keep up to `limit` transfers in flight.
+        while (next < count && running < limit) {
+            CURL *h = m_handles[next];
+            if (h && curl_multi_add_handle(m_multi, h) == CURLM_OK) {
+                curl_easy_setopt(h, CURLOPT_PRIVATE, reinterpret_cast<char *>(next));
+                running++;
+            }
+            next++;
+        }
+
+        int still_running = 0;
+        if (curl_multi_perform(m_multi, &still_running) != CURLM_OK) break;
+
+        int queued = 0;
+        while (CURLMsg *msg = curl_multi_info_read(m_multi, &queued)) {
+            if (msg->msg != CURLMSG_DONE) continue;
+            CURL *h = msg->easy_handle;
+            char *priv = nullptr;
+            curl_easy_getinfo(h, CURLINFO_PRIVATE, &priv);
+            size_t slot = reinterpret_cast<size_t>(priv);
+            results[slot] = msg->data.result;
+            stats[slot] = Record(h, msg->data.result);
+            curl_multi_remove_handle(m_multi, h);
+            running--;
+        }
+
+#if LIBCURL_VERSION_NUM >= 0x074200  // 7.66.0
+        if (running > 0 &&
+            curl_multi_poll(m_multi, nullptr, 0, 1000, nullptr) != CURLM_OK)
+            break;
+#else
+        if (running > 0 &&
+            curl_multi_wait(m_multi, nullptr, 0, 1000, nullptr) != CURLM_OK)
+            break;
+#endif
+    }
+
+    // Only after a multi error: detach whatever is still attached.
+    for (size_t i = 0; i < count; i++)
+        if (m_handles[i]) curl_multi_remove_handle(m_multi, m_handles[i]);
+}
+
+bool HttpClient::WarmUp(const std::string &base_url) {
+    CURL *curl = Prepare(base_url);
+    if (!curl) return false;
+    curl_easy_setopt(curl, CURLOPT_NOBODY, 1L);
+    return Perform() == CURLE_OK;
+}
@@ -0,0 +1,89 @@
+#ifndef _HTTP_CLIENT_H_
+#define _HTTP_CLIENT_H_
+
+// Long-lived HTTP client — libcurl only, no wx dependencies.
+//
+// One curl easy handle is kept for the plugin's lifetime instead of one per
+// fetch, so the connection to the server stays open between fetches
+// (keep-alive), and DNS results and TLS sessions are cached. On a
+// high-latency link that saves the lookup, the TCP handshake and a full
+// TLS handshake — several round trips — on every fetch after the first.
+// A share handle holds the DNS, TLS-session and connection caches so the
+// further easy handles used for concurrent requests (PerformMany(), through
+// a curl multi handle) reuse them too.
+//
+// Not thread-safe: use from one thread at a time (the fetch worker).
+
+#include <curl/curl.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Timings of one request, from curl_easy_getinfo. Times are milliseconds
+// from the start of the request; each includes the steps before it.
+struct HttpStats {
+    long http_code;
+    double name_lookup_ms;   // DNS done
+    double connect_ms;       // TCP connected
+    double tls_ms;           // TLS handshake done (0 for plain HTTP)
+    double first_byte_ms;    // first response byte
+    double total_ms;
+    curl_off_t bytes;        // response body bytes received
+    long header_bytes;       // response headers received plus request sent
+    bool reused;             // ran on an already open connection
+    HttpStats()
+        : http_code(0), name_lookup_ms(0), connect_ms(0), tls_ms(0),
+          first_byte_ms(0), total_ms(0), bytes(0), header_bytes(0),
+          reused(false) {}
+};
+
+class HttpClient {
+public:
+    HttpClient();
+    ~HttpClient();
+
+    // Reset handle `slot` for a request to url and apply the client-wide
+    // options (timeouts, keep-alive, caches). Request-specific options
+    // (write callback, progress, headers) go on the returned handle before
+    // Perform() / PerformMany(). Null if curl could not be initialised.
+    CURL *Prepare(const std::string &url, size_t slot = 0);
+
+    // Run the request prepared in slot 0 and record its stats.
+    CURLcode Perform();
+
+    // Run the requests prepared in slots 0..count-1 concurrently, at most
+    // max_parallel at a time, and record their outcome and stats (indexed
+    // by slot). Returns once all have finished.
+    void PerformMany(size_t count, int max_parallel,
+                     std::vector<CURLcode> &results,
+                     std::vector<HttpStats> &stats);
+
+    const HttpStats &LastStats() const { return m_last; }
+    unsigned long GetRequestCount() const { return m_requests; }
+    unsigned long GetReusedCount() const { return m_reused; }
+    // Bytes sent and received by all requests so far, headers included.
+    uint64_t GetTrafficBytes() const { return m_traffic; }
+
+    // Open a connection to base_url ahead of the first fetch (a HEAD
+    // request; its status does not matter, only the open connection).
+    bool WarmUp(const std::string &base_url);
+
+    // Close the connection and drop the caches.
+    void Close();
+
+private:
+    HttpClient(const HttpClient &);
+    HttpClient &operator=(const HttpClient &);
+
+    HttpStats Record(CURL *curl, CURLcode res);
+
+    std::vector<CURL *> m_handles;   // slot 0 serves single requests
+    CURLM *m_multi;
+    CURLSH *m_share;
+    HttpStats m_last;
+    unsigned long m_requests;
+    unsigned long m_reused;
+    uint64_t m_traffic;
+};
+
+#endif // _HTTP_CLIENT_H_
@@ -0,0 +1,424 @@
+#include "json_number.h"
+#include "json_number_tables.h"
+
+#include <cfloat>
+#include <cstring>
+#include <locale>
+#include <sstream>
+#include <string>
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+// Clinger's fast path needs double arithmetic to round to double; x87
+// builds that evaluate in extended precision skip it.
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD != 0 && !defined(_MSC_VER)
+#define JSON_NUMBER_NO_FAST_PATH 1
+#endif
+
+// ---- helpers ---------------------------------------------------------------
+
+static inline void Mul64(uint64_t a, uint64_t b, uint64_t *hi, uint64_t *lo) {
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 p = static_cast<unsigned __int128>(a) * b;
+    *hi = static_cast<uint64_t>(p >> 64);
+    *lo = static_cast<uint64_t>(p);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    *lo = _umul128(a, b, hi);
+#else
+    uint64_t a_lo = a & 0xffffffffu, a_hi = a >> 32;
+    uint64_t b_lo = b & 0xffffffffu, b_hi = b >> 32;
+    uint64_t p0 = a_lo * b_lo, p1 = a_lo * b_hi, p2 = a_hi * b_lo, p3 = a_hi * b_hi;
+    uint64_t mid = (p0 >> 32) + (p1 & 0xffffffffu) + (p2 & 0xffffffffu);
+    *hi = p3 + (p1 >> 32) + (p2 >> 32) + (mid >> 32);
+    *lo = (mid << 32) | (p0 & 0xffffffffu);
+#endif
+}
+
+// x != 0
+static inline int LeadingZeros(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_clzll(x);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    unsigned long i;
+    _BitScanReverse64(&i, x);
+    return 63 - static_cast<int>(i);
+#else
+    int n = 0;
+    while (!(x & (uint64_t(1) << 63))) { x <<= 1; n++; }
+    return n;
+#endif
+}
+
+static inline double DoubleFromBits(uint64_t bits) {
+    double d;
+    std::memcpy(&d, &bits, sizeof d);
+    return d;
+}
+
+static inline uint64_t BitsFromDouble(double d) {
+    uint64_t bits;
+    std::memcpy(&bits, &d, sizeof bits);
+    return bits;
+}
+
+static inline bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+
+// ---- integers --------------------------------------------------------------
+
+static bool ParseDigits(const char *p, const char *end, uint64_t *out) {
+    if (p == end) return false;
+    uint64_t v = 0;
+    for (; p < end; p++) {
+        if (!IsDigit(*p)) return false;
+        unsigned d = static_cast<unsigned>(*p - '0');
+        if (v > (UINT64_MAX - d) / 10) return false;
+        v = v * 10 + d;
+    }
+    *out = v;
+    return true;
+}
+
+bool JsonParseInt64(const char *s, size_t len, int64_t *out) {
+    const char *p = s, *end = s + len;
+    bool neg = false;
+    if (p < end && (*p == '+' || *p == '-')) neg = (*p++ == '-');
+    uint64_t u;
+    if (!ParseDigits(p, end, &u)) return false;
+    const uint64_t limit = uint64_t(INT64_MAX) + (neg ? 1 : 0);
+    if (u > limit) return false;
+    if (!neg)
+        *out = static_cast<int64_t>(u);
+    else
+        *out = u == limit ? INT64_MIN : -static_cast<int64_t>(u);
+    return true;
+}
+
+bool JsonParseUInt64(const char *s, size_t len, uint64_t *out) {
+    const char *p = s, *end = s + len;
+    if (p < end && *p == '+') p++;
+    return ParseDigits(p, end, out);
+}
+
+// ---- parsing doubles -------------------------------------------------------
+
+// w * 10^q rounded to nearest, for w != 0 and q within the POW5_128 table
+// (Lemire, "Number Parsing at a Gigabyte per Second", 2021). Returns false
+// when the 128-bit product cannot decide the rounding or the result is
+// subnormal or infinite; the caller then takes the slow path.
+static bool EiselLemire(uint64_t w, int q, bool neg, double *out) {
+    const uint64_t *pow5 = POW5_128[q - POW5_128_MIN];
+    int lz = LeadingZeros(w);
+    w <<= lz;
+    uint64_t hi, lo;
+    Mul64(w, pow5[0], &hi, &lo);
+    if ((hi & 0x1ff) == 0x1ff && lo + w < lo) {
+        // The low bits may carry into the mantissa: use the next 64 bits of
+        // the power as well.
+        uint64_t hi2, lo2;
+        Mul64(w, pow5[1], &hi2, &lo2);
+        uint64_t mid = lo + hi2;
+        if (mid < lo) hi++;
+        if (mid + 1 == 0 && (hi & 0x1ff) == 0x1ff && lo2 + w < lo2) return false;
+        lo = mid;
+    }
+    uint64_t upper_bit = hi >> 63;
+    uint64_t mantissa = hi >> (upper_bit + 9);
+    lz += static_cast<int>(1 ^ upper_bit);
+    // Exactly halfway between two doubles: let the slow path round to even.
+    if (lo == 0 && (hi & 0x1ff) == 0 && (mantissa & 3) == 1) return false;
+    mantissa += mantissa & 1;
+    mantissa >>= 1;
+    if (mantissa >= (uint64_t(1) << 53)) {
+        mantissa = uint64_t(1) << 52;
+        lz--;
+    }
+    mantissa &= ~(uint64_t(1) << 52);
+    // floor(log2(10^q)) + bias + 63
+    int64_t exponent = (((152170 + 65536) * static_cast<int64_t>(q)) >> 16) + 1024 + 63;
+    int64_t biased = exponent - lz;
+    if (biased < 1 || biased > 2046) return false;
+    *out = DoubleFromBits(mantissa | (static_cast<uint64_t>(biased) << 52) |
+                          (static_cast<uint64_t>(neg) << 63));
+    return true;
+}
+
+static bool ParseDoubleSlow(const char *s, size_t len, double *out) {
+    std::istringstream iss(std::string(s, len));
+    iss.imbue(std::locale::classic());
+    double d = 0;
+    iss >> d;
+    if (iss.fail()) return false;   // out of range
+    *out = d;
+    return true;
+}
+
+bool JsonParseDouble(const char *s, size_t len, double *out) {
+    static const double POW10[] = {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10,
+        1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21,
+        1e22};
+    const char *p = s, *end = s + len;
+    bool neg = false;
+    if (p < end && (*p == '+' || *p == '-')) neg = (*p++ == '-');
+
+    // The first 19 significant digits go into w (< 10^19 < 2^64); the value
+    // is w * 10^exp10, plus whatever the dropped digits add (truncated).
+    uint64_t w = 0;
+    int significant = 0;
+    int64_t exp10 = 0;
+    bool truncated = false;
+    size_t digits = 0;
+    for (; p < end && IsDigit(*p); p++, digits++) {
+        if (significant < 19) {
+            w = w * 10 + static_cast<unsigned>(*p - '0');
+            if (w) significant++;
+        } else {
+            truncated |= *p != '0';
+            exp10++;
+        }
+    }
+    if (p < end && *p == '.') {
+        for (p++; p < end && IsDigit(*p); p++, digits++) {
+            if (significant < 19) {
+                w = w * 10 + static_cast<unsigned>(*p - '0');
+                if (w) significant++;
+                exp10--;
+            } else {
+                truncated |= *p != '0';
+            }
+        }
+    }
+    if (digits == 0) return false;
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        p++;
+        bool eneg = false;
+        if (p < end && (*p == '+' || *p == '-')) eneg = (*p++ == '-');
+        if (p == end || !IsDigit(*p)) return false;
+        int64_t e = 0;
+        for (; p < end && IsDigit(*p); p++)
+            if (e < 100000) e = e * 10 + (*p - '0');
+        exp10 += eneg ? -e : e;
+    }
+    if (p != end) return false;
+
+    if (w == 0 || exp10 < POW5_128_MIN) {
+        *out = neg ? -0.0 : 0.0;
+        return true;
+    }
+    if (exp10 > POW5_128_MAX) return false;   // beyond DBL_MAX
+    int q = static_cast<int>(exp10);
+
+#ifndef JSON_NUMBER_NO_FAST_PATH
+    // Clinger: w and 10^|q| are both exact doubles, so one rounding.
+    if (!truncated && w <= (uint64_t(1) << 53) && q >= -22 && q <= 22) {
+        double d = static_cast<double>(w);
+        d = q < 0 ? d / POW10[-q] : d * POW10[q];
+        *out = neg ? -d : d;
+        return true;
+    }
+#endif
+
+    double d;
+    if (EiselLemire(w, q, neg, &d)) {
+        double d_up;
+        // The dropped digits put the value in [w, w + 1) * 10^q.
+        if (!truncated || (EiselLemire(w + 1, q, neg, &d_up) && d_up == d)) {
+            *out = d;
+            return true;
+        }
+    }
+    return ParseDoubleSlow(s, len, out);
+}
+
+// ---- formatting doubles ----------------------------------------------------
+//
+// Grisu2 (Loitsch, "Printing Floating-Point Numbers Quickly and Accurately
+// with Integers", 2010), in the form used by nlohmann/json: always the
+// nearest double when read back, and the shortest digits in nearly all
+// cases.
+
+struct DiyFp {
+    uint64_t f;
+    int e;
+};
+
+static inline DiyFp Sub(DiyFp x, DiyFp y) { return {x.f - y.f, x.e}; }
+
+// Upper 64 bits of the product, rounded.
+static inline DiyFp Mul(DiyFp x, DiyFp y) {
+    uint64_t hi, lo;
+    Mul64(x.f, y.f, &hi, &lo);
+    return {hi + (lo >> 63), x.e + y.e + 64};
+}
+
+static inline DiyFp Normalize(DiyFp x) {
+    int s = LeadingZeros(x.f);
+    return {x.f << s, x.e - s};
+}
+
+static inline DiyFp NormalizeTo(DiyFp x, int e) {
+    return {x.f << (x.e - e), e};
+}
+
+// Rounds the last digit towards w (dist from the upper boundary) while the
+// result stays within the boundaries.
+static void Grisu2Round(char *buf, int len, uint64_t dist, uint64_t delta,
+                        uint64_t rest, uint64_t ten_k) {
+    while (rest < dist && delta - rest >= ten_k &&
+           (rest + ten_k < dist || dist - rest > rest + ten_k - dist)) {
+        buf[len - 1]--;
+        rest += ten_k;
+    }
+}
+
+// Digits of the shortest number in [M-, M+], close to w. The exponents of
+// all three are in [-60, -32].
+static int Grisu2DigitGen(char *buf, int &dec_exp, DiyFp m_minus, DiyFp w,
+                          DiyFp m_plus) {
+    uint64_t delta = Sub(m_plus, m_minus).f;
+    uint64_t dist = Sub(m_plus, w).f;
+    const int shift = -m_plus.e;
+    const uint64_t one = uint64_t(1) << shift;
+
+    uint32_t p1 = static_cast<uint32_t>(m_plus.f >> shift);   // integral part
+    uint64_t p2 = m_plus.f & (one - 1);                       // fraction
+
+    uint32_t pow10 = 1;
+    int n = 1;
+    while (n < 10 && p1 / pow10 >= 10) { pow10 *= 10; n++; }
+
+    int len = 0;
+    while (n > 0) {
+        buf[len++] = static_cast<char>('0' + p1 / pow10);
+        p1 %= pow10;
+        n--;
+        uint64_t rest = (static_cast<uint64_t>(p1) << shift) + p2;
+        if (rest <= delta) {
+            dec_exp += n;
+            Grisu2Round(buf, len, dist, delta, rest,
+                        static_cast<uint64_t>(pow10) << shift);
+            return len;
+        }
+        pow10 /= 10;
+    }
+
+    int m = 0;
+    for (;;) {
+        p2 *= 10;
+        buf[len++] = static_cast<char>('0' + (p2 >> shift));
+        p2 &= one - 1;
+        m++;
+        delta *= 10;
+        dist *= 10;
+        if (p2 <= delta) break;
+    }
+    dec_exp -= m;
+    Grisu2Round(buf, len, dist, delta, p2, one);
+    return len;
+}
+
+// Shortest digits of v > 0 (finite): v ~= digits * 10^dec_exp.
+static int Grisu2(double v, char *buf, int &dec_exp) {
+    uint64_t bits = BitsFromDouble(v);
+    uint64_t frac = bits & ((uint64_t(1) << 52) - 1);
+    int biased = static_cast<int>(bits >> 52);
+
+    DiyFp x = biased == 0 ? DiyFp{frac, 1 - 1075}
+                          : DiyFp{frac | (uint64_t(1) << 52), biased - 1075};
+    // Halfway points to the neighbouring doubles; the lower one is closer
+    // when v is a power of two.
+    bool lower_closer = frac == 0 && biased > 1;
+    DiyFp m_plus = Normalize(DiyFp{2 * x.f + 1, x.e - 1});
+    DiyFp m_minus = NormalizeTo(lower_closer ? DiyFp{4 * x.f - 1, x.e - 2}
+                                             : DiyFp{2 * x.f - 1, x.e - 1},
+                                m_plus.e);
+    DiyFp w = Normalize(x);
+
+    // A cached 10^-k that brings m_plus's exponent into [-60, -32]
+    const int alpha = -60;
+    int f = alpha - m_plus.e - 1;
+    int k = (f * 78913) / (1 << 18) + (f > 0);
+    int index = (-CACHED_POW10_MIN + k + (CACHED_POW10_STEP - 1)) / CACHED_POW10_STEP;
+    const CachedPow10 &cached = CACHED_POW10[index];
+    DiyFp c = {cached.f, cached.e};
+
+    DiyFp cw = Mul(w, c);
+    DiyFp cm = Mul(m_minus, c);
+    DiyFp cp = Mul(m_plus, c);
+    // Shrink the interval by one unit each side to absorb the rounding of Mul
+    dec_exp = -cached.k;
+    return Grisu2DigitGen(buf, dec_exp, DiyFp{cm.f + 1, cm.e}, cw,
+                          DiyFp{cp.f - 1, cp.e});
+}
+
+static char *WriteExponent(char *p, int e) {
+    *p++ = 'e';
+    if (e < 0) { *p++ = '-'; e = -e; }
+    if (e >= 100) *p++ = static_cast<char>('0' + e / 100);
+    if (e >= 10) *p++ = static_cast<char>('0' + e / 10 % 10);
+    *p++ = static_cast<char>('0' + e % 10);
+    return p;
+}
+
+size_t JsonFormatDouble(double v, char *buf, bool keep_type) {
+    // Plain notation while the decimal point is within these limits, as
+    // with %.17g
+    static const int MAX_FIXED = 17, MIN_FIXED = -4;
+
+    char *p = buf;
+    uint64_t bits = BitsFromDouble(v);
+    if ((bits & 0x7ff0000000000000ULL) == 0x7ff0000000000000ULL) {
+        std::memcpy(buf, "null", 5);
+        return 4;
+    }
+    if (bits >> 63) {
+        *p++ = '-';
+        v = -v;
+    }
+    if (v == 0) {
+        *p++ = '0';
+        if (keep_type) { *p++ = '.'; *p++ = '0'; }
+        *p = '\0';
+        return static_cast<size_t>(p - buf);
+    }
+
+    char digits[24];
+    int dec_exp = 0;
+    int n = Grisu2(v, digits, dec_exp);
+    int point = n + dec_exp;   // digits before the decimal point
+
+    if (dec_exp >= 0 && point <= MAX_FIXED) {
+        // 1234 or 1234000
+        std::memcpy(p, digits, n);
+        p += n;
+        for (int i = 0; i < dec_exp; i++) *p++ = '0';
+        if (keep_type) { *p++ = '.'; *p++ = '0'; }
+    } else if (point > 0 && point <= MAX_FIXED) {
+        // 12.34
+        std::memcpy(p, digits, point);
+        p += point;
+        *p++ = '.';
+        std::memcpy(p, digits + point, n - point);
+        p += n - point;
+    } else if (point > MIN_FIXED && point <= 0) {
+        // 0.001234
+        *p++ = '0';
+        *p++ = '.';
+        for (int i = point; i < 0; i++) *p++ = '0';
+        std::memcpy(p, digits, n);
+        p += n;
+    } else {
+        // 1.234e-7
+        *p++ = digits[0];
+        if (n > 1) {
+            *p++ = '.';
+            std::memcpy(p, digits + 1, n - 1);
+            p += n - 1;
+        }
+        p = WriteExponent(p, point - 1);
+    }
+    *p = '\0';
+    return static_cast<size_t>(p - buf);
+}
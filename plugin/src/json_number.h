@@ -0,0 +1,37 @@
+#ifndef _JSON_NUMBER_H_
+#define _JSON_NUMBER_H_
+
+// Number <-> text conversion for JSON — no wx dependencies.
+//
+// Both directions ignore the C locale (a decimal comma never leaks in or
+// out) and work on byte buffers, so a reader can convert a token where it
+// lies. Parsing is exact: most inputs take Clinger's fast path or the
+// Eisel-Lemire algorithm, and the rare ambiguous ones fall back to a
+// classic-locale stream. Formatting writes the shortest digits that read
+// back to the same double (Grisu2).
+
+#include <cstddef>
+#include <cstdint>
+
+// Enough for any JsonFormatDouble() output, with a terminating NUL.
+static const size_t JSON_DOUBLE_CHARS = 32;
+
+// Decimal integers with an optional '+' or '-' (only '+' for unsigned).
+// False on any other byte, an empty digit string or overflow.
+bool JsonParseInt64(const char *s, size_t len, int64_t *out);
+bool JsonParseUInt64(const char *s, size_t len, uint64_t *out);
+
+// [+-]digits[.digits][(e|E)[+-]digits], where either the integer or the
+// fraction digits may be empty (not both). False on a syntax error or a
+// magnitude beyond DBL_MAX; tiny magnitudes round to subnormals or zero.
+bool JsonParseDouble(const char *s, size_t len, double *out);
+
+// Writes v into buf (JSON_DOUBLE_CHARS bytes) and returns the length, NUL
+// not counted. Values with no fractional part and a short integer form are
+// written as integers ("200"), or with ".0" when keep_type is set so a
+// reader that types numbers by their spelling sees a double again. Large
+// and small magnitudes use an exponent ("1.5e-7"). NaN and infinities have
+// no JSON form and are written as null.
+size_t JsonFormatDouble(double v, char *buf, bool keep_type);
+
+#endif // _JSON_NUMBER_H_
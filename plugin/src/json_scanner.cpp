@@ -0,0 +1,328 @@
+#include "json_scanner.h"
+#include "json_number.h"
+#include "json_simd.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+bool JsonNumberIsInteger(const char *s, size_t len) {
+    bool neg = (len > 0 && s[0] == '-');
+    size_t i = neg ? 1 : 0;
+    for (size_t k = i; k < len; k++)
+        if (s[k] < '0' || s[k] > '9') return false;
+    size_t digits = len - i;
+    if (digits < 19) return true;
+    if (digits > 20) return false;
+    // Compare against the limits digit-by-digit, as wxJSONReader::Strtoll does.
+    const char *limit = neg ? "9223372036854775808" : "18446744073709551615";
+    size_t limit_len = std::strlen(limit);
+    if (digits != limit_len) return digits < limit_len;
+    return std::memcmp(s + i, limit, digits) <= 0;
+}
+
+double JsonNumberToDouble(const char *s, size_t len) {
+    double d = 0;
+    if (!JsonParseDouble(s, len, &d))   // the token is valid, so it overflowed
+        return s[0] == '-' ? -HUGE_VAL : HUGE_VAL;
+    return d;
+}
+
+JsonScanner::JsonScanner(JsonHandler *handler)
+    : m_handler(handler), m_expect(EXPECT_VALUE), m_offset(0) {}
+
+bool JsonScanner::Feed(const char *data, size_t len) {
+    if (!m_error.empty()) return false;
+    if (m_carry.empty()) {
+        size_t used = Scan(data, len, false);
+        if (m_error.empty() && used < len)
+            m_carry.assign(data + used, len - used);
+        m_offset += used;
+    } else {
+        // Only happens when a token straddles a chunk boundary, so the copy
+        // is bounded by the chunk size rather than the document size.
+        m_carry.append(data, len);
+        size_t used = Scan(m_carry.data(), m_carry.size(), false);
+        m_carry.erase(0, used);
+        m_offset += used;
+    }
+    return m_error.empty();
+}
+
+bool JsonScanner::Finish() {
+    if (m_error.empty() && !m_carry.empty()) {
+        size_t used = Scan(m_carry.data(), m_carry.size(), true);
+        if (m_error.empty() && used < m_carry.size())
+            Fail("unterminated string", used);
+        m_offset += used;
+        m_carry.clear();
+    }
+    if (m_error.empty() && m_expect != EXPECT_NOTHING)
+        Fail("unexpected end of input", 0);
+    return m_error.empty();
+}
+
+void JsonScanner::Fail(const char *what, size_t pos) {
+    if (!m_error.empty()) return;
+    char buf[96];
+    std::snprintf(buf, sizeof(buf), "%s at offset %lu", what,
+                  static_cast<unsigned long>(m_offset + pos));
+    m_error = buf;
+}
+
+void JsonScanner::ValueDone() {
+    m_expect = m_stack.empty() ? EXPECT_NOTHING : EXPECT_COMMA_OR_END;
+}
+
+// Strict RFC 8259 number grammar: -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+static bool IsJsonNumber(const char *s, size_t n) {
+    size_t i = 0;
+    if (i < n && s[i] == '-') i++;
+    if (i >= n) return false;
+    if (s[i] == '0') {
+        i++;
+    } else if (s[i] >= '1' && s[i] <= '9') {
+        while (i < n && s[i] >= '0' && s[i] <= '9') i++;
+    } else {
+        return false;
+    }
+    if (i < n && s[i] == '.') {
+        i++;
+        size_t start = i;
+        while (i < n && s[i] >= '0' && s[i] <= '9') i++;
+        if (i == start) return false;
+    }
+    if (i < n && (s[i] == 'e' || s[i] == 'E')) {
+        i++;
+        if (i < n && (s[i] == '+' || s[i] == '-')) i++;
+        size_t start = i;
+        while (i < n && s[i] >= '0' && s[i] <= '9') i++;
+        if (i == start) return false;
+    }
+    return i == n;
+}
+
+size_t JsonScanner::ScanBareToken(const char *p, size_t len, size_t base,
+                                  bool final) {
+    size_t n = JsonFindDelimiter(p, len);
+    if (n == len && !final) return 0;  // may continue in the next chunk
+
+    if (n == 4 && std::memcmp(p, "null", 4) == 0) {
+        m_handler->OnLiteral(JSON_NULL);
+    } else if (n == 4 && std::memcmp(p, "true", 4) == 0) {
+        m_handler->OnLiteral(JSON_TRUE);
+    } else if (n == 5 && std::memcmp(p, "false", 5) == 0) {
+        m_handler->OnLiteral(JSON_FALSE);
+    } else if (IsJsonNumber(p, n)) {
+        m_handler->OnNumber(p, n);
+    } else {
+        Fail("invalid literal", base);
+        return 0;
+    }
+    return n;
+}
+
+static int HexVal(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Parse 4 hex digits at p. Returns -1 on a malformed sequence.
+static long Hex4(const char *p) {
+    long v = 0;
+    for (int k = 0; k < 4; k++) {
+        int h = HexVal(p[k]);
+        if (h < 0) return -1;
+        v = (v << 4) | h;
+    }
+    return v;
+}
+
+static void AppendUTF8(std::string &out, unsigned long cp) {
+    if (cp < 0x80) {
+        out += static_cast<char>(cp);
+    } else if (cp < 0x800) {
+        out += static_cast<char>(0xC0 | (cp >> 6));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        out += static_cast<char>(0xE0 | (cp >> 12));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (cp >> 18));
+        out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+}
+
+size_t JsonScanner::ScanString(const char *p, size_t len, size_t base,
+                               bool is_key, bool final) {
+    // Fast path: no escapes, hand out a view straight into the input buffer.
+    size_t j = 1 + JsonFindQuoteOrEscape(p + 1, len - 1);
+    if (j == len) return 0;
+    if (p[j] == '"') {
+        if (is_key) m_handler->OnKey(p + 1, j - 1);
+        else        m_handler->OnString(p + 1, j - 1);
+        return j + 1;
+    }
+
+    // Slow path: unescape into scratch.
+    m_unescaped.assign(p + 1, j - 1);
+    while (j < len) {
+        char c = p[j];
+        if (c == '"') {
+            if (is_key) m_handler->OnKey(m_unescaped.data(), m_unescaped.size());
+            else        m_handler->OnString(m_unescaped.data(), m_unescaped.size());
+            return j + 1;
+        }
+        if (c != '\\') {
+            size_t run = JsonFindQuoteOrEscape(p + j, len - j);
+            m_unescaped.append(p + j, run);
+            j += run;
+            continue;
+        }
+        if (j + 1 >= len) return 0;
+        char e = p[j + 1];
+        switch (e) {
+            case '"':  m_unescaped += '"';  j += 2; break;
+            case '\\': m_unescaped += '\\'; j += 2; break;
+            case '/':  m_unescaped += '/';  j += 2; break;
+            case 'b':  m_unescaped += '\b'; j += 2; break;
+            case 'f':  m_unescaped += '\f'; j += 2; break;
+            case 'n':  m_unescaped += '\n'; j += 2; break;
+            case 'r':  m_unescaped += '\r'; j += 2; break;
+            case 't':  m_unescaped += '\t'; j += 2; break;
+            case 'u': {
+                if (j + 6 > len) return 0;
+                long cp = Hex4(p + j + 2);
+                if (cp < 0) { Fail("invalid \\u escape", base + j); return 0; }
+                j += 6;
+                if (cp >= 0xD800 && cp <= 0xDBFF) {
+                    // High surrogate: combine with a following low surrogate.
+                    // Wait for more input only while what follows could
+                    // still be a \u escape.
+                    bool escape = (j >= len || p[j] == '\\') &&
+                                  (j + 1 >= len || p[j + 1] == 'u');
+                    if (escape && j + 6 > len && !final) return 0;
+                    long lo = escape && j + 6 <= len ? Hex4(p + j + 2) : -1;
+                    if (lo >= 0xDC00 && lo <= 0xDFFF) {
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+                        j += 6;
+                    } else {
+                        cp = 0xFFFD;
+                    }
+                } else if (cp >= 0xDC00 && cp <= 0xDFFF) {
+                    cp = 0xFFFD;
+                }
+                AppendUTF8(m_unescaped, static_cast<unsigned long>(cp));
+                break;
+            }
+            default:
+                Fail("invalid escape sequence", base + j);
+                return 0;
+        }
+    }
+    return 0;
+}
+
+size_t JsonScanner::Scan(const char *p, size_t len, bool final) {
+    size_t i = 0;
+    while (i < len && m_error.empty()) {
+        char c = p[i];
+        switch (c) {
+            case ' ': case '\t': case '\n': case '\r':
+                i++;
+                break;
+
+            case '{':
+            case '[':
+                if (m_expect != EXPECT_VALUE && m_expect != EXPECT_VALUE_OR_END) {
+                    Fail("unexpected bracket", i);
+                    return i;
+                }
+                m_stack.push_back(c);
+                if (c == '{') {
+                    m_expect = EXPECT_KEY_OR_END;
+                    m_handler->OnBeginObject();
+                } else {
+                    m_expect = EXPECT_VALUE_OR_END;
+                    m_handler->OnBeginArray();
+                }
+                i++;
+                break;
+
+            case '}':
+                if ((m_expect != EXPECT_KEY_OR_END && m_expect != EXPECT_COMMA_OR_END) ||
+                    m_stack.empty() || m_stack.back() != '{') {
+                    Fail("unexpected '}'", i);
+                    return i;
+                }
+                m_stack.pop_back();
+                m_handler->OnEndObject();
+                ValueDone();
+                i++;
+                break;
+
+            case ']':
+                if ((m_expect != EXPECT_VALUE_OR_END && m_expect != EXPECT_COMMA_OR_END) ||
+                    m_stack.empty() || m_stack.back() != '[') {
+                    Fail("unexpected ']'", i);
+                    return i;
+                }
+                m_stack.pop_back();
+                m_handler->OnEndArray();
+                ValueDone();
+                i++;
+                break;
+
+            case ':':
+                if (m_expect != EXPECT_COLON) {
+                    Fail("unexpected ':'", i);
+                    return i;
+                }
+                m_expect = EXPECT_VALUE;
+                i++;
+                break;
+
+            case ',':
+                if (m_expect != EXPECT_COMMA_OR_END) {
+                    Fail("unexpected ','", i);
+                    return i;
+                }
+                m_expect = (m_stack.back() == '{') ? EXPECT_KEY : EXPECT_VALUE;
+                i++;
+                break;
+
+            case '"': {
+                bool is_key = (m_expect == EXPECT_KEY || m_expect == EXPECT_KEY_OR_END);
+                if (!is_key && m_expect != EXPECT_VALUE && m_expect != EXPECT_VALUE_OR_END) {
+                    Fail("unexpected string", i);
+                    return i;
+                }
+                size_t n = ScanString(p + i, len - i, i, is_key, final);
+                if (n == 0) return i;  // incomplete (or error)
+                if (is_key) m_expect = EXPECT_COLON;
+                else        ValueDone();
+                i += n;
+                break;
+            }
+
+            default: {
+                if (m_expect != EXPECT_VALUE && m_expect != EXPECT_VALUE_OR_END) {
+                    Fail(m_expect == EXPECT_NOTHING ? "trailing characters"
+                                                    : "unexpected character", i);
+                    return i;
+                }
+                size_t n = ScanBareToken(p + i, len - i, i, final);
+                if (n == 0) return i;  // incomplete (or error)
+                ValueDone();
+                i += n;
+                break;
+            }
+        }
+    }
+    return i;
+}
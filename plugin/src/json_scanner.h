@@ -0,0 +1,86 @@
+#ifndef _JSON_SCANNER_H_
+#define _JSON_SCANNER_H_
+
+// Incremental (push) JSON tokenizer — no wx dependencies.
+// Bytes are fed in arbitrary chunks; each complete token is reported to a
+// JsonHandler as soon as it is recognised, so callers can build their own
+// records without materialising a document tree.
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+enum JsonLiteral { JSON_NULL, JSON_TRUE, JSON_FALSE };
+
+// SAX-style callbacks. String and number views are only valid for the
+// duration of the call. Numbers are passed as their raw (validated) text so
+// the handler can decide how to interpret them.
+class JsonHandler {
+public:
+    virtual ~JsonHandler() {}
+    virtual void OnBeginObject() = 0;
+    virtual void OnEndObject() = 0;
+    virtual void OnBeginArray() = 0;
+    virtual void OnEndArray() = 0;
+    virtual void OnKey(const char *s, size_t len) = 0;
+    virtual void OnString(const char *s, size_t len) = 0;
+    virtual void OnNumber(const char *s, size_t len) = 0;
+    virtual void OnLiteral(JsonLiteral lit) = 0;
+};
+
+// True if a validated number token has no fraction or exponent and fits in a
+// 64-bit signed (or, when non-negative, unsigned) integer. wxJSONReader stores
+// such tokens as integers, so IsDouble() is false for them.
+bool JsonNumberIsInteger(const char *s, size_t len);
+
+// Locale-independent, correctly rounded conversion of a validated number
+// token (JsonParseDouble()); magnitudes beyond DBL_MAX give ±HUGE_VAL.
+double JsonNumberToDouble(const char *s, size_t len);
+
+class JsonScanner {
+public:
+    explicit JsonScanner(JsonHandler *handler);
+
+    // Scan the next chunk of a UTF-8 document. A token split across chunk
+    // boundaries is carried over to the next call. Returns false once a
+    // syntax error has been found; further input is ignored.
+    bool Feed(const char *data, size_t len);
+
+    // Signal end of input. Returns true only if exactly one complete JSON
+    // value (plus optional whitespace) was read.
+    bool Finish();
+
+    bool HasError() const { return !m_error.empty(); }
+    const std::string &GetError() const { return m_error; }
+    size_t GetBytesScanned() const { return m_offset; }
+
+private:
+    enum Expect {
+        EXPECT_VALUE,          // any value (document root, after ':' or ',' in array)
+        EXPECT_VALUE_OR_END,   // just after '['
+        EXPECT_KEY,            // after ',' in object
+        EXPECT_KEY_OR_END,     // just after '{'
+        EXPECT_COLON,
+        EXPECT_COMMA_OR_END,
+        EXPECT_NOTHING         // root value complete
+    };
+
+    size_t Scan(const char *p, size_t len, bool final);
+    void ValueDone();
+    void Fail(const char *what, size_t pos);
+    // Returns bytes consumed by a string starting at p[0]=='"', or 0 if the
+    // string is incomplete. Sets m_error on malformed escapes.
+    size_t ScanString(const char *p, size_t len, size_t base, bool is_key,
+                      bool final);
+    size_t ScanBareToken(const char *p, size_t len, size_t base, bool final);
+
+    JsonHandler *m_handler;
+    std::vector<char> m_stack;   // '{' or '['
+    Expect m_expect;
+    std::string m_carry;         // incomplete token from the previous chunk
+    std::string m_unescaped;     // scratch for strings containing escapes
+    std::string m_error;
+    size_t m_offset;             // absolute offset of the first unconsumed byte
+};
+
+#endif // _JSON_SCANNER_H_
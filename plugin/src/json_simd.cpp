@@ -0,0 +1,214 @@
+#include "json_simd.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define JSON_SIMD_X86 1   // SSE2 is part of x86-64
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// GCC and Clang only emit AVX2 instructions in functions marked for it;
+// MSVC emits them anywhere.
+#if defined(JSON_SIMD_X86) && (defined(__GNUC__) || defined(__clang__))
+#define JSON_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define JSON_TARGET_AVX2
+#endif
+
+// ---- scalar ----------------------------------------------------------------
+
+static bool IsDelimiter(unsigned char c) {
+    switch (c) {
+        case ' ': case '\t': case '\n': case '\r':
+        case ',': case ':': case ']': case '}': case '[': case '{': case '"':
+            return true;
+        default:
+            return false;
+    }
+}
+
+static size_t FindQuoteOrEscapeScalar(const char *p, size_t len) {
+    size_t i = 0;
+    while (i < len && p[i] != '"' && p[i] != '\\') i++;
+    return i;
+}
+
+static size_t FindDelimiterScalar(const char *p, size_t len) {
+    size_t i = 0;
+    while (i < len && !IsDelimiter(static_cast<unsigned char>(p[i]))) i++;
+    return i;
+}
+
+#ifdef JSON_SIMD_X86
+
+static inline unsigned LowestBit(unsigned mask) {
+#ifdef _MSC_VER
+    unsigned long i;
+    _BitScanForward(&i, mask);
+    return static_cast<unsigned>(i);
+#else
+    return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+}
+
+// ---- SSE2 ------------------------------------------------------------------
+
+static size_t FindQuoteOrEscapeSSE2(const char *p, size_t len) {
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i escape = _mm_set1_epi8('\\');
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i));
+        __m128i hit = _mm_or_si128(_mm_cmpeq_epi8(v, quote),
+                                   _mm_cmpeq_epi8(v, escape));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(hit));
+        if (mask) return i + LowestBit(mask);
+    }
+    return i + FindQuoteOrEscapeScalar(p + i, len - i);
+}
+
+// Brackets and braces are found with two compares: '[' | 0x20 == '{' and
+// ']' | 0x20 == '}', and no other byte ORs to either.
+static size_t FindDelimiterSSE2(const char *p, size_t len) {
+    const __m128i space = _mm_set1_epi8(' '), tab = _mm_set1_epi8('\t');
+    const __m128i lf = _mm_set1_epi8('\n'), cr = _mm_set1_epi8('\r');
+    const __m128i comma = _mm_set1_epi8(','), colon = _mm_set1_epi8(':');
+    const __m128i quote = _mm_set1_epi8('"'), lower = _mm_set1_epi8(0x20);
+    const __m128i open = _mm_set1_epi8('{'), close = _mm_set1_epi8('}');
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i));
+        __m128i folded = _mm_or_si128(v, lower);
+        __m128i hit = _mm_or_si128(
+            _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, space), _mm_cmpeq_epi8(v, tab)),
+                         _mm_or_si128(_mm_cmpeq_epi8(v, lf), _mm_cmpeq_epi8(v, cr))),
+            _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, comma), _mm_cmpeq_epi8(v, colon)),
+                         _mm_or_si128(_mm_cmpeq_epi8(v, quote),
+                                      _mm_or_si128(_mm_cmpeq_epi8(folded, open),
+                                                   _mm_cmpeq_epi8(folded, close)))));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(hit));
+        if (mask) return i + LowestBit(mask);
+    }
+    return i + FindDelimiterScalar(p + i, len - i);
+}
+
+// ---- AVX2 ------------------------------------------------------------------
+
+JSON_TARGET_AVX2
+static size_t FindQuoteOrEscapeAVX2(const char *p, size_t len) {
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i escape = _mm256_set1_epi8('\\');
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + i));
+        __m256i hit = _mm256_or_si256(_mm256_cmpeq_epi8(v, quote),
+                                      _mm256_cmpeq_epi8(v, escape));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(hit));
+        if (mask) return i + LowestBit(mask);
+    }
+    return i + FindQuoteOrEscapeSSE2(p + i, len - i);
+}
+
+JSON_TARGET_AVX2
+static size_t FindDelimiterAVX2(const char *p, size_t len) {
+    const __m256i space = _mm256_set1_epi8(' '), tab = _mm256_set1_epi8('\t');
+    const __m256i lf = _mm256_set1_epi8('\n'), cr = _mm256_set1_epi8('\r');
+    const __m256i comma = _mm256_set1_epi8(','), colon = _mm256_set1_epi8(':');
+    const __m256i quote = _mm256_set1_epi8('"'), lower = _mm256_set1_epi8(0x20);
+    const __m256i open = _mm256_set1_epi8('{'), close = _mm256_set1_epi8('}');
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + i));
+        __m256i folded = _mm256_or_si256(v, lower);
+        __m256i hit = _mm256_or_si256(
+            _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, space), _mm256_cmpeq_epi8(v, tab)),
+                            _mm256_or_si256(_mm256_cmpeq_epi8(v, lf), _mm256_cmpeq_epi8(v, cr))),
+            _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, comma), _mm256_cmpeq_epi8(v, colon)),
+                            _mm256_or_si256(_mm256_cmpeq_epi8(v, quote),
+                                            _mm256_or_si256(_mm256_cmpeq_epi8(folded, open),
+                                                            _mm256_cmpeq_epi8(folded, close)))));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(hit));
+        if (mask) return i + LowestBit(mask);
+    }
+    return i + FindDelimiterSSE2(p + i, len - i);
+}
+
+static bool CpuHasAVX2() {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    if (!osxsave || (_xgetbv(0) & 0x6) != 0x6) return false;   // YMM state saved
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    // Also checks that the OS saves the YMM registers.
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif // JSON_SIMD_X86
+
+// ---- dispatch --------------------------------------------------------------
+
+typedef size_t (*FindFn)(const char *, size_t);
+
+struct SimdFns {
+    JsonSimdLevel level;
+    FindFn find_quote_or_escape;
+    FindFn find_delimiter;
+};
+
+static SimdFns FnsFor(JsonSimdLevel level) {
+    switch (level) {
+#ifdef JSON_SIMD_X86
+    case JSON_SIMD_AVX2:
+        return {JSON_SIMD_AVX2, FindQuoteOrEscapeAVX2, FindDelimiterAVX2};
+    case JSON_SIMD_SSE2:
+        return {JSON_SIMD_SSE2, FindQuoteOrEscapeSSE2, FindDelimiterSSE2};
+#endif
+    default:
+        return {JSON_SIMD_SCALAR, FindQuoteOrEscapeScalar, FindDelimiterScalar};
+    }
+}
+
+static SimdFns &Active() {
+    static SimdFns fns = FnsFor(JsonSimdBest());
+    return fns;
+}
+
+JsonSimdLevel JsonSimdBest() {
+#ifdef JSON_SIMD_X86
+    static const JsonSimdLevel best =
+        CpuHasAVX2() ? JSON_SIMD_AVX2 : JSON_SIMD_SSE2;
+    return best;
+#else
+    return JSON_SIMD_SCALAR;
+#endif
+}
+
+JsonSimdLevel JsonSimdActive() { return Active().level; }
+
+void JsonSimdUse(JsonSimdLevel level) {
+    Active() = FnsFor(level < JsonSimdBest() ? level : JsonSimdBest());
+}
+
+const char *JsonSimdName(JsonSimdLevel level) {
+    switch (level) {
+    case JSON_SIMD_AVX2: return "avx2";
+    case JSON_SIMD_SSE2: return "sse2";
+    default:             return "scalar";
+    }
+}
+
+size_t JsonFindQuoteOrEscape(const char *p, size_t len) {
+    return Active().find_quote_or_escape(p, len);
+}
+
+size_t JsonFindDelimiter(const char *p, size_t len) {
+    return Active().find_delimiter(p, len);
+}
@@ -0,0 +1,33 @@
+#ifndef _JSON_SIMD_H_
+#define _JSON_SIMD_H_
+
+// Vectorised byte searches for the JSON scanner — no wx dependencies.
+//
+// Most of a /api/v1/observations payload is short keys, strings and numbers,
+// and JsonScanner spends its time looking for the byte that ends each of
+// them. These functions do that 16 (SSE2) or 32 (AVX2) bytes at a time. The
+// best version the CPU supports is picked on first use; other targets (and
+// 32-bit x86) use the plain byte loop.
+
+#include <cstddef>
+
+enum JsonSimdLevel { JSON_SIMD_SCALAR, JSON_SIMD_SSE2, JSON_SIMD_AVX2 };
+
+// The best level this CPU (and OS) supports.
+JsonSimdLevel JsonSimdBest();
+
+// The level in use. JsonSimdUse() switches it, capped at JsonSimdBest();
+// it is meant for tests and benchmarks and must not race with scanning.
+JsonSimdLevel JsonSimdActive();
+void JsonSimdUse(JsonSimdLevel level);
+
+const char *JsonSimdName(JsonSimdLevel level);   // "scalar", "sse2", "avx2"
+
+// Offset of the first '"' or '\\' in p[0, len), or len if there is none.
+size_t JsonFindQuoteOrEscape(const char *p, size_t len);
+
+// Offset of the first byte that ends a bare token (number or literal):
+// whitespace, ',', ':', brackets, braces or '"'. len if there is none.
+size_t JsonFindDelimiter(const char *p, size_t len);
+
+#endif // _JSON_SIMD_H_
@@ -0,0 +1,131 @@
+#include "marker_batch.h"
+
+#include <cmath>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+BatchColor BatchColor::FromFloat(float r, float g, float b, float a) {
+    BatchColor c;
+    c.r = static_cast<uint8_t>(r * 255 + 0.5f);
+    c.g = static_cast<uint8_t>(g * 255 + 0.5f);
+    c.b = static_cast<uint8_t>(b * 255 + 0.5f);
+    c.a = static_cast<uint8_t>(a * 255 + 0.5f);
+    return c;
+}
+
+MarkerBatch::MarkerBatch() {
+    for (int i = 0; i <= CIRCLE_SEGMENTS; i++) {
+        float a = 2.0f * M_PI * i / CIRCLE_SEGMENTS;
+        m_unit_x[i] = cosf(a);
+        m_unit_y[i] = sinf(a);
+    }
+}
+
+void MarkerBatch::Clear() {
+    m_fills.clear();
+    m_lines.clear();
+    m_pennants.clear();
+}
+
+void MarkerBatch::AddTriangle(float x0, float y0, float x1, float y1,
+                              float x2, float y2, BatchColor c) {
+    Push(m_fills, x0, y0, c);
+    Push(m_fills, x1, y1, c);
+    Push(m_fills, x2, y2, c);
+}
+
+void MarkerBatch::AddQuad(float x0, float y0, float x1, float y1,
+                          float x2, float y2, float x3, float y3,
+                          BatchColor c) {
+    AddTriangle(x0, y0, x1, y1, x2, y2, c);
+    AddTriangle(x0, y0, x2, y2, x3, y3, c);
+}
+
+// A triangle fan unrolled into triangles.
+void MarkerBatch::AddDisc(float cx, float cy, float radius, BatchColor c) {
+    for (int i = 0; i < CIRCLE_SEGMENTS; i++)
+        AddTriangle(cx, cy,
+                    cx + radius * m_unit_x[i],     cy + radius * m_unit_y[i],
+                    cx + radius * m_unit_x[i + 1], cy + radius * m_unit_y[i + 1],
+                    c);
+}
+
+void MarkerBatch::AddMarker(PlatformType kind, float px, float py,
+                            BatchColor c) {
+    if (kind == PLATFORM_BUOY) {
+        AddDisc(px, py, MARKER_SIZE, c);
+    } else if (kind == PLATFORM_SHIP) {
+        float size = MARKER_SIZE;
+        float h = size * 1.2f;
+        AddTriangle(px, py - h,                    // top
+                    px - size, py + h * 0.5f,      // bottom-left
+                    px + size, py + h * 0.5f, c);  // bottom-right
+    } else if (kind == PLATFORM_SHORE) {
+        float s = MARKER_SIZE * 0.8f;
+        AddQuad(px - s, py - s, px + s, py - s,
+                px + s, py + s, px - s, py + s, c);
+    } else if (kind == PLATFORM_DRIFTER) {
+        float s = MARKER_SIZE * 0.7f * 1.3f;
+        AddQuad(px, py - s, px + s, py,            // top, right
+                px, py + s, px - s, py, c);        // bottom, left
+    } else {
+        AddDisc(px, py, MARKER_SIZE * 0.6f, c);
+    }
+}
+
+void MarkerBatch::AddWindBarb(float px, float py, double dir_deg,
+                              double spd_kt, BatchColor c) {
+    if (std::isnan(dir_deg) || std::isnan(spd_kt)) return;
+    if (spd_kt < 0.5) return;  // calm
+
+    float dir_rad = static_cast<float>(dir_deg * M_PI / 180.0);
+    // Wind barb: shaft points from station in the direction the wind is coming FROM
+    float shaft_len = 25.0f;
+    float dx = sinf(dir_rad);
+    float dy = -cosf(dir_rad);  // screen Y inverted
+
+    Push(m_lines, px, py, c);
+    Push(m_lines, px + dx * shaft_len, py + dy * shaft_len, c);
+
+    // Barb ticks: pennants (50kt), long barbs (10kt), short barbs (5kt)
+    int remaining = static_cast<int>(spd_kt + 2.5);  // round
+    float tick_spacing = 5.0f;
+    float tick_pos = shaft_len;  // start from end of shaft
+
+    // Perpendicular direction for barb ticks (to the right of shaft direction)
+    float nx = -dy;
+    float ny = dx;
+    float barb_len = 10.0f;
+
+    // Pennants (50 kt)
+    while (remaining >= 50) {
+        float bx = px + dx * tick_pos;
+        float by = py + dy * tick_pos;
+        Push(m_pennants, bx, by, c);
+        Push(m_pennants, bx + nx * barb_len, by + ny * barb_len, c);
+        Push(m_pennants, px + dx * (tick_pos - tick_spacing),
+                         py + dy * (tick_pos - tick_spacing), c);
+        tick_pos -= tick_spacing;
+        remaining -= 50;
+    }
+
+    // Long barbs (10 kt)
+    while (remaining >= 10) {
+        float bx = px + dx * tick_pos;
+        float by = py + dy * tick_pos;
+        Push(m_lines, bx, by, c);
+        Push(m_lines, bx + nx * barb_len, by + ny * barb_len, c);
+        tick_pos -= tick_spacing;
+        remaining -= 10;
+    }
+
+    // Short barb (5 kt)
+    if (remaining >= 5) {
+        float bx = px + dx * tick_pos;
+        float by = py + dy * tick_pos;
+        Push(m_lines, bx, by, c);
+        Push(m_lines, bx + nx * barb_len * 0.5f, by + ny * barb_len * 0.5f, c);
+    }
+}
@@ -0,0 +1,75 @@
+#ifndef _MARKER_BATCH_H_
+#define _MARKER_BATCH_H_
+
+// Vertex arrays for the GL station overlay — no wx or GL dependencies.
+//
+// RenderStationsGL() used to issue a glBegin/glEnd pair per marker, barb
+// shaft, tick and pennant. Instead, each frame's geometry is appended here
+// into one interleaved array per primitive class and drawn with a single
+// glDrawArrays each:
+//   Fills()     GL_TRIANGLES  highlight halos and marker shapes
+//   Lines()     GL_LINES      wind barb shafts and ticks
+//   Pennants()  GL_TRIANGLES  50 kt wind barb pennants
+// Within a class, vertices keep station order, so a halo still sits under
+// its own marker.
+
+#include "station_store.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Marker size in pixels
+static const int MARKER_SIZE = 8;
+
+struct BatchColor {
+    uint8_t r, g, b, a;
+    static BatchColor FromFloat(float r, float g, float b, float a);
+};
+
+// Interleaved layout: glVertexPointer(2, GL_FLOAT, ...) at x,
+// glColorPointer(4, GL_UNSIGNED_BYTE, ...) at color.
+struct BatchVertex {
+    float x, y;
+    BatchColor color;
+};
+
+class MarkerBatch {
+public:
+    MarkerBatch();
+
+    // Drop all vertices but keep the allocations for the next frame.
+    void Clear();
+
+    void AddDisc(float cx, float cy, float radius, BatchColor color);
+    void AddMarker(PlatformType kind, float px, float py, BatchColor color);
+
+    // Wind barb at (px, py): dir_deg true, spd_kt in knots. Calm (< 0.5 kt)
+    // or missing values add nothing.
+    void AddWindBarb(float px, float py, double dir_deg, double spd_kt,
+                     BatchColor color);
+
+    const std::vector<BatchVertex> &Fills() const { return m_fills; }
+    const std::vector<BatchVertex> &Lines() const { return m_lines; }
+    const std::vector<BatchVertex> &Pennants() const { return m_pennants; }
+
+private:
+    static void Push(std::vector<BatchVertex> &v, float x, float y,
+                     BatchColor c) {
+        BatchVertex bv = {x, y, c};
+        v.push_back(bv);
+    }
+    void AddTriangle(float x0, float y0, float x1, float y1,
+                     float x2, float y2, BatchColor c);
+    void AddQuad(float x0, float y0, float x1, float y1,
+                 float x2, float y2, float x3, float y3, BatchColor c);
+
+    enum { CIRCLE_SEGMENTS = 16 };
+    float m_unit_x[CIRCLE_SEGMENTS + 1], m_unit_y[CIRCLE_SEGMENTS + 1];
+
+    std::vector<BatchVertex> m_fills;
+    std::vector<BatchVertex> m_lines;
+    std::vector<BatchVertex> m_pennants;
+};
+
+#endif // _MARKER_BATCH_H_
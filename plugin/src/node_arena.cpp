@@ -0,0 +1,135 @@
+#include "node_arena.h"
+
+#include <algorithm>
+#include <atomic>
+#include <new>
+
+// Every object is preceded by the arena it came from (null: the heap), so
+// Free() needs no lookup.
+union ObjectHeader {
+    NodeArena *arena;
+    double align_d;
+    long long align_ll;
+};
+static_assert(sizeof(ObjectHeader) % NodeArena::ALIGN == 0,
+              "objects must stay aligned after their header");
+
+struct NodeArena::Block {
+    Block *next;
+};
+
+static const size_t FIRST_BLOCK = 16 * 1024;
+static const size_t MAX_BLOCK = 1024 * 1024;
+
+static size_t RoundUp(size_t n) {
+    return (n + NodeArena::ALIGN - 1) & ~(NodeArena::ALIGN - 1);
+}
+
+static const size_t BLOCK_HEADER = RoundUp(sizeof(void *));
+
+static thread_local NodeArena *s_current = nullptr;
+static std::atomic<int> s_count(0);
+
+NodeArena::NodeArena()
+    : m_blocks(nullptr), m_next(nullptr), m_end(nullptr),
+      m_block_size(FIRST_BLOCK), m_reserved(0), m_refs(0), m_open(false) {
+    for (FreeList &f : m_free) {
+        f.bytes = 0;
+        f.head = nullptr;
+    }
+    s_count++;
+}
+
+NodeArena::~NodeArena() {
+    while (m_blocks) {
+        Block *next = m_blocks->next;
+        ::operator delete(m_blocks);
+        m_blocks = next;
+    }
+    s_count--;
+}
+
+int NodeArena::Count() { return s_count; }
+
+void *NodeArena::Take(size_t bytes) {
+    bytes = RoundUp(bytes);
+    for (FreeList &f : m_free) {
+        if (f.bytes == bytes && f.head) {
+            void *p = f.head;
+            f.head = *static_cast<void **>(p);
+            return p;
+        }
+    }
+    if (static_cast<size_t>(m_end - m_next) < bytes) {
+        // Start a new block; what is left of the old one is abandoned.
+        size_t size = std::max(m_block_size, BLOCK_HEADER + bytes);
+        Block *b = static_cast<Block *>(::operator new(size));
+        b->next = m_blocks;
+        m_blocks = b;
+        m_next = reinterpret_cast<char *>(b) + BLOCK_HEADER;
+        m_end = reinterpret_cast<char *>(b) + size;
+        m_reserved += size;
+        m_block_size = std::min(m_block_size * 2, MAX_BLOCK);
+    }
+    void *p = m_next;
+    m_next += bytes;
+    return p;
+}
+
+void NodeArena::Give(void *p, size_t bytes) {
+    bytes = RoundUp(bytes);
+    for (FreeList &f : m_free) {
+        if (f.bytes == 0) f.bytes = bytes;
+        if (f.bytes == bytes) {
+            *static_cast<void **>(p) = f.head;
+            f.head = p;
+            return;
+        }
+    }
+    // More sizes than lists: the memory waits for the arena to go.
+}
+
+void NodeArena::Release() {
+    if (--m_refs == 0) delete this;
+}
+
+void *NodeArena::Allocate(size_t size) {
+    size_t bytes = sizeof(ObjectHeader) + size;
+    NodeArena *arena = s_current;
+    ObjectHeader *h;
+    if (arena) {
+        h = static_cast<ObjectHeader *>(arena->Take(bytes));
+        arena->m_refs++;
+    } else {
+        h = static_cast<ObjectHeader *>(::operator new(bytes));
+    }
+    h->arena = arena;
+    return h + 1;
+}
+
+void NodeArena::Free(void *p, size_t size) {
+    if (!p) return;
+    ObjectHeader *h = static_cast<ObjectHeader *>(p) - 1;
+    NodeArena *arena = h->arena;
+    if (!arena) {
+        ::operator delete(h);
+        return;
+    }
+    arena->Give(h, sizeof(ObjectHeader) + size);
+    arena->Release();
+}
+
+NodeArena::Scope::Scope(bool enable)
+    : m_arena(enable ? new NodeArena : nullptr), m_prev(s_current) {
+    if (!m_arena) return;
+    m_arena->m_open = true;
+    m_arena->m_refs = 1;
+    s_current = m_arena;
+}
+
+NodeArena::Scope::~Scope() {
+    if (!m_arena) return;
+    s_current = m_prev;
+    m_arena->m_open = false;
+    m_arena->Release();
+}
@@ -0,0 +1,82 @@
+#ifndef _NODE_ARENA_H_
+#define _NODE_ARENA_H_
+
+// Monotonic arena for the nodes of a parsed document — no wx dependencies.
+//
+// A parser opens a NodeArena::Scope around the parse; every object whose
+// class operator new calls Allocate() while the scope is open on that
+// thread is carved out of a few large blocks instead of getting its own
+// heap allocation. Freeing such an object only drops a count (its memory is
+// reused for the next same-sized object while the arena lives), and the
+// blocks go back to the heap in one go when the last object is freed, so
+// the arena outlives the scope for as long as any copy of the document
+// does. Outside a scope Allocate() and Free() fall back to the heap, so
+// one class can mix both kinds of objects.
+//
+// The counts are not atomic: an arena's objects must be freed on one
+// thread at a time, as wxJSONValue's own reference counts already require.
+
+#include <cstddef>
+
+class NodeArena {
+public:
+    // Objects come out aligned to this; classes with stricter alignment
+    // must not use the arena.
+    static const size_t ALIGN = 8;
+
+    // Opens a new arena for the calling thread until the scope ends (a
+    // disabled scope changes nothing). Scopes nest.
+    class Scope {
+    public:
+        explicit Scope(bool enable = true);
+        ~Scope();
+
+        NodeArena *Get() const { return m_arena; }
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        NodeArena *m_arena;
+        NodeArena *m_prev;
+    };
+
+    // For class operator new / operator delete. Free() must get the size
+    // passed to Allocate() (a sized operator delete does this).
+    static void *Allocate(size_t size);
+    static void Free(void *p, size_t size);
+
+    // Arenas not yet returned to the heap, in every thread.
+    static int Count();
+
+    // Objects allocated and not yet freed; bytes taken from the heap.
+    size_t Live() const { return m_refs - (m_open ? 1 : 0); }
+    size_t Reserved() const { return m_reserved; }
+
+private:
+    struct Block;
+
+    NodeArena();
+    ~NodeArena();
+
+    void *Take(size_t bytes);
+    void Give(void *p, size_t bytes);
+    void Release();
+
+    Block *m_blocks;
+    char *m_next;
+    char *m_end;
+    size_t m_block_size;
+    size_t m_reserved;
+    size_t m_refs;    // live objects, plus one while a scope is open
+    bool m_open;
+
+    // Freed objects by size: a document has only a handful of node sizes.
+    static const int FREE_LISTS = 4;
+    struct FreeList {
+        size_t bytes;
+        void *head;
+    } m_free[FREE_LISTS];
+};
+
+#endif // _NODE_ARENA_H_
@@ -1,12 +1,26 @@
 #include "obs_parser.h"
+#include "station_view.h"
 
 #include <wx/intl.h>
 #include <wx/jsonreader.h>
 #include <wx/jsonval.h>
 #include <wx/log.h>
+#include <algorithm>
+#include <cstring>
 
-bool ParseObservations(const wxString &json, ObservationList &out,
-                       wxString &error_msg) {
+static const size_t EXCERPT_BYTES = 300;
+
+int64_t ParseObsTime(const char *utf8, size_t len) {
+    int64_t t = ParseIsoTime(utf8, len);
+    if (t != TIME_UNKNOWN) return t;
+    // Not the server's usual form: accept what wxDateTime does.
+    wxDateTime dt;
+    dt.ParseISOCombined(wxString::FromUTF8(utf8, len));
+    return EpochFromDateTime(dt);
+}
+
+bool ParseObservationsDOM(const wxString &json, ObservationList &out,
+                          wxString &error_msg) {
     wxJSONValue root;
     wxJSONReader reader;
     int errors = reader.Parse(json, &root);
@@ -48,9 +62,9 @@ bool ParseObservations(const wxString &json, ObservationList &out,
         if (lon < -180.0 || lon > 180.0) { skipped++; continue; }
 
         if (!obj.HasMember(wxT("time")) || !obj[wxT("time")].IsString()) { skipped++; continue; }
-        wxDateTime obs_time;
-        obs_time.ParseISOCombined(obj[wxT("time")].AsString());
-        if (!obs_time.IsValid()) { skipped++; continue; }
+        wxCharBuffer time_utf8 = obj[wxT("time")].AsString().ToUTF8();
+        int64_t obs_time = ParseObsTime(time_utf8.data(), time_utf8.length());
+        if (obs_time == TIME_UNKNOWN) { skipped++; continue; }
 
         // --- Build station ---
         ObservationStation st;
@@ -85,3 +99,257 @@ bool ParseObservations(const wxString &json, ObservationList &out,
 
     return true;
 }
+
+// ---------- Streaming parser ----------
+
+ObsStreamParser::ObsStreamParser()
+    : m_scanner(this),
+      m_skip_depth(0),
+      m_in_root(false),
+      m_key_is_stations(false),
+      m_stations_found(false),
+      m_in_stations(false),
+      m_in_station(false),
+      m_field(F_NONE),
+      m_fields(~0u),
+      m_has_id(false), m_has_lat(false), m_has_lon(false), m_has_time(false),
+      m_sink(nullptr), m_skipped(0) {}
+
+bool ObsStreamParser::Feed(const char *data, size_t len) {
+    if (m_head.size() < EXCERPT_BYTES)
+        m_head.append(data, std::min(len, EXCERPT_BYTES - m_head.size()));
+    return m_scanner.Feed(data, len);
+}
+
+// First EXCERPT_BYTES of the document as a wxString, dropping a UTF-8
+// sequence that was cut in half by the byte limit.
+static wxString HeadExcerpt(const std::string &head) {
+    size_t n = head.size();
+    size_t start = n;
+    while (start > 0 && n - start < 4 &&
+           (static_cast<unsigned char>(head[start - 1]) & 0xC0) == 0x80)
+        start--;
+    if (start > 0) {
+        unsigned char c = static_cast<unsigned char>(head[start - 1]);
+        size_t need = (c >= 0xF0) ? 4 : (c >= 0xE0) ? 3 : (c >= 0xC0) ? 2 : 1;
+        if (n - (start - 1) < need) n = start - 1;
+    }
+    return wxString::FromUTF8(head.data(), n);
+}
+
+bool ObsStreamParser::Finish(ObservationList &out, wxString &error_msg) {
+    if (!m_scanner.Finish()) {
+        error_msg = _("JSON parse error");
+        wxLogError("ShipObs: JSON parse error (%s), response: %s",
+                   m_scanner.GetError().c_str(), HeadExcerpt(m_head));
+        return false;
+    }
+    if (!m_stations_found) {
+        error_msg = _("Missing 'stations' array in response");
+        wxLogError("ShipObs: missing 'stations' array, response: %s",
+                   HeadExcerpt(m_head));
+        return false;
+    }
+
+    out.swap(m_out);
+    m_out.clear();
+
+    if (m_skipped > 0)
+        wxLogWarning("ShipObs: skipped %d station(s) with invalid/missing required fields", m_skipped);
+
+    return true;
+}
+
+ObsStreamParser::Field ObsStreamParser::LookupField(const char *s, size_t len) {
+#define MATCH(lit, f) \
+    if (len == sizeof(lit) - 1 && std::memcmp(s, lit, len) == 0) return f;
+    switch (len) {
+        case 2: MATCH("id", F_ID) break;
+        case 3: MATCH("lat", F_LAT) MATCH("lon", F_LON) MATCH("vis", F_VIS) break;
+        case 4: MATCH("type", F_TYPE) MATCH("time", F_TIME) MATCH("gust", F_GUST) break;
+        case 7: MATCH("country", F_COUNTRY) MATCH("wave_ht", F_WAVE_HT) break;
+        case 8: MATCH("wind_dir", F_WIND_DIR) MATCH("wind_spd", F_WIND_SPD)
+                MATCH("pressure", F_PRESSURE) MATCH("air_temp", F_AIR_TEMP)
+                MATCH("sea_temp", F_SEA_TEMP) break;
+        default: break;
+    }
+#undef MATCH
+    return F_NONE;
+}
+
+void ObsStreamParser::StartStation() {
+    m_st = ObservationStation();
+    m_has_id = m_has_lat = m_has_lon = m_has_time = false;
+    m_field = F_NONE;
+    m_in_station = true;
+}
+
+void ObsStreamParser::EndStation() {
+    m_in_station = false;
+
+    if (!m_has_id || m_st.id.IsEmpty()) { m_skipped++; return; }
+    if (!m_has_lat || m_st.lat < -90.0 || m_st.lat > 90.0) { m_skipped++; return; }
+    if (!m_has_lon || m_st.lon < -180.0 || m_st.lon > 180.0) { m_skipped++; return; }
+    if (!m_has_time || m_st.time == TIME_UNKNOWN) { m_skipped++; return; }
+
+    if (m_sink)
+        m_sink->OnStation(m_st);
+    else
+        m_out.push_back(std::move(m_st));
+}
+
+void ObsStreamParser::ClearField(Field f) {
+    switch (f) {
+        case F_ID:       m_has_id = false;   break;
+        case F_LAT:      m_has_lat = false;  break;
+        case F_LON:      m_has_lon = false;  break;
+        case F_TIME:     m_has_time = false; break;
+        case F_TYPE:     m_st.type.Clear();    break;
+        case F_COUNTRY:  m_st.country.Clear(); break;
+        case F_WIND_DIR: m_st.wind_dir = NAN; break;
+        case F_WIND_SPD: m_st.wind_spd = NAN; break;
+        case F_GUST:     m_st.gust     = NAN; break;
+        case F_PRESSURE: m_st.pressure = NAN; break;
+        case F_AIR_TEMP: m_st.air_temp = NAN; break;
+        case F_SEA_TEMP: m_st.sea_temp = NAN; break;
+        case F_WAVE_HT:  m_st.wave_ht  = NAN; break;
+        case F_VIS:      m_st.vis      = NAN; break;
+        case F_NONE:     break;
+    }
+}
+
+void ObsStreamParser::OnBeginObject() {
+    if (m_skip_depth > 0) { m_skip_depth++; return; }
+    if (m_in_station) {
+        ClearField(m_field);
+        m_skip_depth = 1;
+    } else if (m_in_stations) {
+        StartStation();
+    } else if (m_in_root) {
+        if (m_key_is_stations) m_stations_found = false;
+        m_skip_depth = 1;
+    } else {
+        m_in_root = true;
+    }
+}
+
+void ObsStreamParser::OnEndObject() {
+    if (m_skip_depth > 0) { m_skip_depth--; return; }
+    if (m_in_station) EndStation();
+    else              m_in_root = false;
+}
+
+void ObsStreamParser::OnBeginArray() {
+    if (m_skip_depth > 0) { m_skip_depth++; return; }
+    if (m_in_station) {
+        ClearField(m_field);
+        m_skip_depth = 1;
+    } else if (m_in_stations) {
+        m_skipped++;
+        m_skip_depth = 1;
+    } else if (m_in_root && m_key_is_stations) {
+        // A repeated "stations" key replaces the earlier one, as in wxJSON.
+        m_stations_found = true;
+        m_in_stations = true;
+        m_out.clear();
+        if (m_sink) m_sink->OnReset();
+        m_skipped = 0;
+    } else {
+        m_skip_depth = 1;
+    }
+}
+
+void ObsStreamParser::OnEndArray() {
+    if (m_skip_depth > 0) { m_skip_depth--; return; }
+    m_in_stations = false;
+}
+
+void ObsStreamParser::OnKey(const char *s, size_t len) {
+    if (m_skip_depth > 0) return;
+    if (m_in_station) {
+        m_field = LookupField(s, len);
+        if (m_field >= F_WIND_DIR && !((m_fields >> (m_field - F_WIND_DIR)) & 1))
+            m_field = F_NONE;  // projected away: treat as an unknown key
+    } else if (m_in_root && !m_in_stations) {
+        m_key_is_stations = (len == 8 && std::memcmp(s, "stations", 8) == 0);
+    }
+}
+
+void ObsStreamParser::OnString(const char *s, size_t len) {
+    if (m_skip_depth > 0) return;
+    if (m_in_station) {
+        switch (m_field) {
+            case F_ID:
+                m_st.id = wxString::FromUTF8(s, len);
+                m_has_id = true;
+                break;
+            case F_TYPE:    m_st.type    = wxString::FromUTF8(s, len); break;
+            case F_COUNTRY: m_st.country = wxString::FromUTF8(s, len); break;
+            case F_TIME:
+                m_st.time = ParseObsTime(s, len);
+                m_has_time = true;
+                break;
+            default:
+                ClearField(m_field);
+                break;
+        }
+    } else if (m_in_stations) {
+        m_skipped++;
+    } else if (m_in_root && m_key_is_stations) {
+        m_stations_found = false;
+    }
+}
+
+void ObsStreamParser::OnNumber(const char *s, size_t len) {
+    if (m_skip_depth > 0) return;
+    if (m_in_station) {
+        // wxJSON keeps integer literals as ints; IsDouble() rejects them.
+        if (JsonNumberIsInteger(s, len)) {
+            ClearField(m_field);
+            return;
+        }
+        double d = JsonNumberToDouble(s, len);
+        switch (m_field) {
+            case F_LAT:      m_st.lat = d; m_has_lat = true; break;
+            case F_LON:      m_st.lon = d; m_has_lon = true; break;
+            case F_WIND_DIR: m_st.wind_dir = d; break;
+            case F_WIND_SPD: m_st.wind_spd = d; break;
+            case F_GUST:     m_st.gust     = d; break;
+            case F_PRESSURE: m_st.pressure = d; break;
+            case F_AIR_TEMP: m_st.air_temp = d; break;
+            case F_SEA_TEMP: m_st.sea_temp = d; break;
+            case F_WAVE_HT:  m_st.wave_ht  = d; break;
+            case F_VIS:      m_st.vis      = d; break;
+            default:         ClearField(m_field); break;
+        }
+    } else if (m_in_stations) {
+        m_skipped++;
+    } else if (m_in_root && m_key_is_stations) {
+        m_stations_found = false;
+    }
+}
+
+void ObsStreamParser::OnLiteral(JsonLiteral /*lit*/) {
+    if (m_skip_depth > 0) return;
+    if (m_in_station)
+        ClearField(m_field);  // null / true / false: never a valid field value
+    else if (m_in_stations)
+        m_skipped++;
+    else if (m_in_root && m_key_is_stations)
+        m_stations_found = false;
+}
+
+// ---------- Entry points ----------
+
+bool ParseObservations(const char *utf8, size_t len, ObservationList &out,
+                       wxString &error_msg) {
+    ObsStreamParser parser;
+    parser.Feed(utf8, len);
+    return parser.Finish(out, error_msg);
+}
+
+bool ParseObservations(const wxString &json, ObservationList &out,
+                       wxString &error_msg) {
+    wxCharBuffer buf = json.ToUTF8();
+    return ParseObservations(buf.data(), buf.length(), out, error_msg);
+}
@@ -2,6 +2,7 @@
 #define _OBS_PARSER_H_
 
 #include "observation.h"
+#include "json_scanner.h"
 #include <wx/string.h>
 
 // Parse a JSON response string from the shipobs server into an ObservationList.
@@ -10,4 +11,103 @@
 bool ParseObservations(const wxString &json, ObservationList &out,
                        wxString &error_msg);
 
+// Same as above, for a raw UTF-8 buffer (e.g. an HTTP response body).
+// Streams the document through ObsStreamParser, so no wxString copy of the
+// payload and no wxJSONValue tree are built.
+bool ParseObservations(const char *utf8, size_t len, ObservationList &out,
+                       wxString &error_msg);
+
+// Observation time as epoch seconds (UTC). The server's fixed
+// "YYYY-MM-DDTHH:MM:SSZ" is decoded directly; any other form goes through
+// wxDateTime::ParseISOCombined(). TIME_UNKNOWN if neither accepts it.
+int64_t ParseObsTime(const char *utf8, size_t len);
+
+// Original wxJSONValue (DOM) implementation. Kept as the reference for the
+// differential tests and the parser benchmark.
+bool ParseObservationsDOM(const wxString &json, ObservationList &out,
+                          wxString &error_msg);
+
+// Receives the stations of an ObsStreamParser one at a time, as soon as
+// each station object closes.
+class StationSink {
+public:
+    virtual ~StationSink() {}
+    virtual void OnStation(const ObservationStation &st) = 0;
+    // A repeated "stations" key: the stations so far are void.
+    virtual void OnReset() = 0;
+};
+
+// Incremental parser for the /api/v1/observations response. Reads the
+// "stations" array one token at a time directly into ObservationStation,
+// applying the same drop rules as ParseObservationsDOM():
+//   - id must be a non-empty string
+//   - lat/lon must be non-integer numbers within range (wxJSON stores "31"
+//     as an int, which IsDouble() rejects, so integers are dropped too)
+//   - time must be a string accepted by ParseObsTime()
+// Bytes may be fed in chunks of any size.
+class ObsStreamParser : private JsonHandler {
+public:
+    ObsStreamParser();
+
+    // Returns false once a JSON syntax error has been detected.
+    bool Feed(const char *data, size_t len);
+
+    // Finish the document and move the parsed stations into out.
+    // On error, out is left untouched and error_msg is set.
+    bool Finish(ObservationList &out, wxString &error_msg);
+
+    // Hand each station to sink instead of collecting it, so Finish()
+    // returns none. Call before the first Feed().
+    void SetSink(StationSink *sink) { m_sink = sink; }
+
+    int GetSkipped() const { return m_skipped; }
+
+    // Read only the observation values in field_mask (bit m = StationMetric
+    // m, see FetchProfile); the others are left missing even if the server
+    // sends them. Defaults to all. Call before the first Feed().
+    void SetFields(unsigned field_mask) { m_fields = field_mask; }
+
+private:
+    // Station fields we recognise; anything else is ignored.
+    enum Field {
+        F_NONE, F_ID, F_TYPE, F_COUNTRY, F_LAT, F_LON, F_TIME,
+        F_WIND_DIR, F_WIND_SPD, F_GUST, F_PRESSURE,
+        F_AIR_TEMP, F_SEA_TEMP, F_WAVE_HT, F_VIS
+    };
+
+    void OnBeginObject();
+    void OnEndObject();
+    void OnBeginArray();
+    void OnEndArray();
+    void OnKey(const char *s, size_t len);
+    void OnString(const char *s, size_t len);
+    void OnNumber(const char *s, size_t len);
+    void OnLiteral(JsonLiteral lit);
+
+    static Field LookupField(const char *s, size_t len);
+    void ClearField(Field f);   // value of the wrong JSON type for f
+    void StartStation();
+    void EndStation();
+
+    JsonScanner m_scanner;
+    std::string m_head;       // first bytes of the document, for error logs
+    int m_skip_depth;         // >0 while skipping an uninteresting container
+    bool m_in_root;           // inside the root object
+    bool m_key_is_stations;   // last root-level key was "stations"
+    bool m_stations_found;    // root has a "stations" array
+    bool m_in_stations;       // inside that array
+    bool m_in_station;        // inside one station object
+    Field m_field;            // key of the station value about to be read
+    unsigned m_fields;        // observation values to read, F_WIND_DIR = bit 0
+
+    // Station being assembled, with "present and of the right type" flags
+    // for the required fields (a later duplicate key overrides, as in wxJSON).
+    ObservationStation m_st;
+    bool m_has_id, m_has_lat, m_has_lon, m_has_time;
+
+    ObservationList m_out;
+    StationSink *m_sink;
+    int m_skipped;
+};
+
 #endif // _OBS_PARSER_H_
@@ -1,7 +1,10 @@
 #ifndef _OBSERVATION_H_
 #define _OBSERVATION_H_
 
+#include "history_store.h"
+
 #include <cmath>
+#include <cstdint>
 #include <vector>
 #include <wx/datetime.h>
 #include <wx/string.h>
@@ -13,7 +16,7 @@ struct ObservationStation {
 
     double lat;
     double lon;
-    wxDateTime time;   // Observation time (UTC)
+    int64_t time;      // Observation time, epoch seconds UTC (TIME_UNKNOWN = none)
 
     // Meteorological / oceanographic values. NaN means missing.
     // Units match the server API (SI/metric). Convert to display units in the UI layer.
@@ -27,7 +30,7 @@ struct ObservationStation {
     double vis;        // metres
 
     ObservationStation()
-        : lat(NAN), lon(NAN),
+        : lat(NAN), lon(NAN), time(TIME_UNKNOWN),
           wind_dir(NAN), wind_spd(NAN), gust(NAN),
           pressure(NAN), air_temp(NAN), sea_temp(NAN),
           wave_ht(NAN), vis(NAN) {}
@@ -0,0 +1,59 @@
+#include "projection_cache.h"
+
+ProjectionCache::ProjectionCache()
+    : m_valid(false), m_serial(0), m_carry_ok(false) {}
+
+void ProjectionCache::Invalidate() {
+    m_valid = false;
+    m_x.clear();
+    m_y.clear();
+    m_lat.clear();
+    m_lon.clear();
+    m_visible.clear();
+    m_hits.Clear();
+    m_carry.clear();
+}
+
+void ProjectionCache::Invalidate(std::vector<uint32_t> &&carry) {
+    if (!m_valid) {  // no positions to carry over
+        Invalidate();
+        return;
+    }
+    m_old_key = m_key;
+    m_old_x.swap(m_x);
+    m_old_y.swap(m_y);
+    m_old_lat.swap(m_lat);
+    m_old_lon.swap(m_lon);
+    Invalidate();
+    m_carry.swap(carry);
+}
+
+void ProjectionCache::Begin(const ProjectionKey &key, size_t count) {
+    m_carry_ok = !m_carry.empty() && m_old_key == key;
+    m_key = key;
+    m_x.resize(count);
+    m_y.resize(count);
+    m_lat.resize(count);
+    m_lon.resize(count);
+    m_visible.clear();
+    m_hits.Begin(key.pix_width, key.pix_height, VIEW_MARGIN);
+}
+
+void ProjectionCache::Set(size_t i, float x, float y) {
+    m_x[i] = x;
+    m_y[i] = y;
+    // NaN fails every comparison, so unplaced stations are never visible
+    if (x >= -VIEW_MARGIN && x <= m_key.pix_width + VIEW_MARGIN &&
+        y >= -VIEW_MARGIN && y <= m_key.pix_height + VIEW_MARGIN) {
+        m_visible.push_back(static_cast<uint32_t>(i));
+        m_hits.Add(static_cast<uint32_t>(i), x, y);
+    }
+}
+
+void ProjectionCache::Finish() {
+    m_hits.Finish();
+    m_valid = true;
+    m_serial++;
+    m_carry.clear();
+    m_carry_ok = false;
+}
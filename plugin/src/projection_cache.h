@@ -0,0 +1,126 @@
+#ifndef _PROJECTION_CACHE_H_
+#define _PROJECTION_CACHE_H_
+
+// Screen positions of all stations for one viewport — no wx dependencies.
+//
+// Projecting a station (GetCanvasPixLL) is the one per-station cost every
+// consumer used to pay on its own: each renderer every frame, hit-testing
+// on every mouse move. The cache projects every station once per viewport
+// (keyed on the viewport parameters the projection depends on) and keeps
+// the visible subset plus a ScreenIndex over it. It is rebuilt only when
+// the key changes or Invalidate() is called after the station set changed.
+
+#include "station_store.h"
+#include "screen_index.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Stations this far outside the canvas (pixels) still count as visible,
+// so markers and barbs straddling the edge are not clipped away.
+static const int VIEW_MARGIN = 50;
+
+// Viewport parameters that determine where a lat/lon lands on screen.
+struct ProjectionKey {
+    double clat, clon, view_scale_ppm, skew, rotation;
+    int pix_width, pix_height, projection_type;
+
+    ProjectionKey()
+        : clat(0), clon(0), view_scale_ppm(0), skew(0), rotation(0),
+          pix_width(0), pix_height(0), projection_type(0) {}
+    bool operator==(const ProjectionKey &o) const {
+        return clat == o.clat && clon == o.clon &&
+               view_scale_ppm == o.view_scale_ppm && skew == o.skew &&
+               rotation == o.rotation && pix_width == o.pix_width &&
+               pix_height == o.pix_height && projection_type == o.projection_type;
+    }
+    bool operator!=(const ProjectionKey &o) const { return !(*this == o); }
+};
+
+class ProjectionCache {
+public:
+    ProjectionCache();
+
+    // True if the cached positions are valid for this viewport.
+    bool IsCurrent(const ProjectionKey &key) const {
+        return m_valid && m_key == key;
+    }
+
+    // Forget all positions (call when the station set changes).
+    void Invalidate();
+
+    // Same, for a new station set that largely repeats the old one:
+    // carry[i] is the old index of new station i (or NO_STATION). If the
+    // next Rebuild() is for the same viewport, stations still at their old
+    // coordinates keep their position instead of being projected again. A
+    // wrong hint only costs a projection, never a wrong position.
+    void Invalidate(std::vector<uint32_t> &&carry);
+
+    // Project every station with project(lat, lon, float &x, float &y).
+    template <typename Project>
+    void Rebuild(const ProjectionKey &key, const StationStore &stations,
+                 Project project) {
+        Begin(key, stations.Size());
+        for (size_t i = 0; i < stations.Size(); i++) {
+            double lat = stations.Lat(i), lon = stations.Lon(i);
+            float x = NAN, y = NAN;
+            if (!std::isnan(lat) && !std::isnan(lon) && !Carry(i, lat, lon, x, y))
+                project(lat, lon, x, y);
+            m_lat[i] = lat;
+            m_lon[i] = lon;
+            Set(i, x, y);
+        }
+        Finish();
+    }
+
+    // Changes on every Rebuild(), so anything derived from the positions
+    // can tell whether it is stale.
+    uint64_t Serial() const { return m_serial; }
+
+    // Position of station i (NaN if it has none); valid while IsCurrent().
+    float X(size_t i) const { return m_x[i]; }
+    float Y(size_t i) const { return m_y[i]; }
+
+    // Stations within VIEW_MARGIN of the canvas, in ascending order.
+    const std::vector<uint32_t> &Visible() const { return m_visible; }
+
+    const ProjectionKey &Key() const { return m_key; }
+
+    // Grid over the visible stations for hit-testing.
+    const ScreenIndex &Hits() const { return m_hits; }
+
+private:
+    void Begin(const ProjectionKey &key, size_t count);
+    void Set(size_t i, float x, float y);
+    void Finish();
+
+    // Old position of new station i, if the carry-over map allows it.
+    bool Carry(size_t i, double lat, double lon, float &x, float &y) const {
+        if (!m_carry_ok || i >= m_carry.size()) return false;
+        uint32_t k = m_carry[i];
+        if (k >= m_old_lat.size() || m_old_lat[k] != lat || m_old_lon[k] != lon)
+            return false;
+        x = m_old_x[k];
+        y = m_old_y[k];
+        return true;
+    }
+
+    ProjectionKey m_key;
+    bool m_valid;
+    uint64_t m_serial;
+    std::vector<float> m_x, m_y;
+    std::vector<double> m_lat, m_lon;   // coordinates the positions are for
+
+    // Positions of the previous station set, kept by Invalidate(carry)
+    ProjectionKey m_old_key;
+    std::vector<float> m_old_x, m_old_y;
+    std::vector<double> m_old_lat, m_old_lon;
+    std::vector<uint32_t> m_carry;
+    bool m_carry_ok;                    // set by Begin() for this rebuild
+    std::vector<uint32_t> m_visible;
+    ScreenIndex m_hits;
+};
+
+#endif // _PROJECTION_CACHE_H_
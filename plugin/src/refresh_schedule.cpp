@@ -0,0 +1,112 @@
+#include "refresh_schedule.h"
+
+#include <algorithm>
+
+// True if every part of inner lies within a part of outer, both split at
+// the antimeridian.
+static bool Contains(const BBox &outer, const BBox &inner) {
+    BBox out[2], in[2];
+    int n_out = SplitBbox(outer.lat_min, outer.lat_max,
+                          outer.lon_min, outer.lon_max, out);
+    int n_in = SplitBbox(inner.lat_min, inner.lat_max,
+                         inner.lon_min, inner.lon_max, in);
+    for (int i = 0; i < n_in; i++) {
+        bool inside = false;
+        for (int o = 0; o < n_out && !inside; o++)
+            inside = in[i].lat_min >= out[o].lat_min &&
+                     in[i].lat_max <= out[o].lat_max &&
+                     in[i].lon_min >= out[o].lon_min &&
+                     in[i].lon_max <= out[o].lon_max;
+        if (!inside) return false;
+    }
+    return true;
+}
+
+static bool SameArea(const BBox &a, const BBox &b) {
+    return a.lat_min == b.lat_min && a.lat_max == b.lat_max &&
+           a.lon_min == b.lon_min && a.lon_max == b.lon_max;
+}
+
+RefreshSchedule::RefreshSchedule(uint32_t seed)
+    : m_active(false), m_running(false), m_area(), m_requested(), m_fetched(),
+      m_fetched_at(REFRESH_NEVER), m_due(REFRESH_NEVER),
+      m_settle(REFRESH_NEVER), m_not_before(0), m_failures(0), m_rng(seed) {}
+
+void RefreshSchedule::Start(const RefreshOptions &opt, const BBox &area,
+                            int64_t now) {
+    m_opt        = opt;
+    m_active     = true;
+    m_running    = false;
+    m_area       = area;
+    m_fetched_at = REFRESH_NEVER;
+    m_due        = now;
+    m_settle     = REFRESH_NEVER;
+    m_not_before = 0;
+    m_failures   = 0;
+}
+
+void RefreshSchedule::Stop() {
+    m_active  = false;
+    m_running = false;
+}
+
+void RefreshSchedule::SetArea(const BBox &area, int64_t now) {
+    if (SameArea(area, m_area)) return;
+    m_area = area;
+    if (!m_active || m_running) return;   // Done() looks at it
+    m_settle = Covered(area, now)
+                   ? REFRESH_NEVER
+                   : std::max(now + m_opt.debounce_ms, m_not_before);
+}
+
+int64_t RefreshSchedule::NextWake() const {
+    if (!m_active || m_running) return REFRESH_NEVER;
+    return std::min(m_due, m_settle);
+}
+
+bool RefreshSchedule::Due(int64_t now, BBox &area) {
+    if (now < NextWake()) return false;
+    m_running   = true;
+    m_requested = m_area;
+    area        = m_area;
+    return true;
+}
+
+void RefreshSchedule::Done(bool ok, int64_t now) {
+    if (!m_running) return;
+    m_running = false;
+    m_settle  = REFRESH_NEVER;
+    if (ok) {
+        m_failures   = 0;
+        m_not_before = 0;
+        m_fetched    = m_requested;
+        m_fetched_at = now;
+        m_due        = now + Jitter(m_opt.interval_ms);
+        // The area moved on while the refresh ran.
+        if (!Covered(m_area, now)) m_settle = now + m_opt.debounce_ms;
+    } else {
+        int shift = std::min(m_failures, 20);
+        m_failures++;
+        int64_t delay = std::min(m_opt.retry_ms << shift, m_opt.retry_max_ms);
+        m_due        = now + Jitter(delay);
+        m_not_before = m_due;
+    }
+}
+
+void RefreshSchedule::Skipped(int64_t now) {
+    if (!m_running) return;
+    m_running = false;
+    m_settle  = REFRESH_NEVER;
+    m_due     = now + Jitter(m_opt.interval_ms);
+}
+
+bool RefreshSchedule::Covered(const BBox &area, int64_t now) const {
+    return m_fetched_at != REFRESH_NEVER && m_failures == 0 &&
+           now - m_fetched_at < m_opt.interval_ms && Contains(m_fetched, area);
+}
+
+int64_t RefreshSchedule::Jitter(int64_t delay) {
+    double u = static_cast<double>(m_rng() - m_rng.min()) /
+               (m_rng.max() - m_rng.min());   // 0..1
+    return static_cast<int64_t>(delay * (1.0 + m_opt.jitter * (2.0 * u - 1.0)));
+}
@@ -0,0 +1,82 @@
+#ifndef _REFRESH_SCHEDULE_H_
+#define _REFRESH_SCHEDULE_H_
+
+// When to refresh an area automatically — no wx dependencies.
+//
+// The area (the chart viewport, or a pinned area) is refreshed every
+// interval. A new area is refreshed once it has stopped changing for the
+// debounce time, so panning doesn't start a fetch per frame; a new area
+// lying inside the one refreshed last, while that is still fresh, needs no
+// refresh at all. After a failed refresh the next attempt waits retry,
+// doubling with each failure up to retry_max, and a new area doesn't cut
+// that wait short. Every delay is spread by +-jitter so that many clients
+// don't hit the server in step.
+//
+// Times are milliseconds on a monotonic clock. The caller keeps the
+// object locked if it's used from several threads.
+
+#include "url_builder.h"
+
+#include <cstdint>
+#include <random>
+
+struct RefreshOptions {
+    int64_t interval_ms;
+    int64_t debounce_ms;
+    int64_t retry_ms;       // first retry after a failure
+    int64_t retry_max_ms;
+    double jitter;          // fraction of each delay, 0..1
+    RefreshOptions()
+        : interval_ms(10 * 60 * 1000), debounce_ms(2000), retry_ms(30 * 1000),
+          retry_max_ms(30 * 60 * 1000), jitter(0.1) {}
+};
+
+static const int64_t REFRESH_NEVER = INT64_MAX;
+
+class RefreshSchedule {
+public:
+    explicit RefreshSchedule(uint32_t seed = 1);
+
+    // Refresh area from now on, the first time right away.
+    void Start(const RefreshOptions &opt, const BBox &area, int64_t now);
+    void Stop();
+    bool Active() const { return m_active; }
+
+    // The area to refresh changed. Areas crossing the antimeridian may be
+    // given either way SplitBbox() accepts.
+    void SetArea(const BBox &area, int64_t now);
+
+    // When Due() will next return true (REFRESH_NEVER while stopped or
+    // while a refresh is running).
+    int64_t NextWake() const;
+
+    // True if a refresh should start now; it refreshes area. The schedule
+    // then waits for Done() or Skipped().
+    bool Due(int64_t now, BBox &area);
+
+    // The refresh Due() started succeeded or failed.
+    void Done(bool ok, int64_t now);
+    // It didn't happen (cancelled): try again after the interval.
+    void Skipped(int64_t now);
+
+    int Failures() const { return m_failures; }
+
+private:
+    bool Covered(const BBox &area, int64_t now) const;
+    int64_t Jitter(int64_t delay);
+
+    RefreshOptions m_opt;
+    bool m_active;
+    bool m_running;
+    BBox m_area;          // what to refresh next
+    BBox m_requested;     // what the running refresh fetches
+    BBox m_fetched;       // what the last successful refresh fetched
+    int64_t m_fetched_at; // REFRESH_NEVER = nothing fetched yet
+    int64_t m_due;        // next regular refresh (interval or retry)
+    int64_t m_settle;     // refresh of a changed area, REFRESH_NEVER = none
+    int64_t m_not_before; // end of the wait after a failure
+    int m_failures;
+    std::minstd_rand m_rng;
+};
+
+#endif // _REFRESH_SCHEDULE_H_
@@ -1,9 +1,17 @@
 #include "render_overlay.h"
 #include "shipobs_pi.h"
 #include "observation.h"
-
+#include "station_view.h"
+#include "marker_batch.h"
+#include "glyph_atlas.h"
+#include "projection_cache.h"
+#include "station_clusters.h"
+#include "age_fade.h"
+
+#include <algorithm>
 #include <cmath>
-#include <map>
+#include <cstdio>
+#include <string>
 #include <vector>
 #ifdef __APPLE__
 #  include <OpenGL/gl.h>
@@ -17,31 +25,46 @@
 #include <wx/font.h>
 #include <wx/datetime.h>
 
-// Marker size in pixels
-static const int MARKER_SIZE = 8;
-
-// Compute opacity 0.0..1.0 based on observation age.
-// Fresh observations are fully opaque, observations older than 24h fade out.
-static float AgeOpacity(const wxDateTime &obs_time) {
-    if (!obs_time.IsValid()) return 0.5f;
-    wxTimeSpan age = wxDateTime::Now().ToUTC() - obs_time;
-    double hours = age.GetSeconds().ToDouble() / 3600.0;
-    if (hours < 0) hours = 0;
-    if (hours > 24) return 0.15f;
-    // Linear fade from 1.0 at 0h to 0.3 at 24h
-    return static_cast<float>(1.0 - 0.7 * (hours / 24.0));
+// Age bucket of every station (see age_fade.h), computed in one pass over
+// the time column when a frame is built; markers look their opacity up.
+static std::vector<uint16_t> s_age_buckets;
+
+static void UpdateAgeBuckets(const StationStore &stations, int64_t now) {
+    s_age_buckets.resize(stations.Size());
+    AgeBuckets(stations.Columns().time, stations.Size(), now,
+               s_age_buckets.data());
+}
+
+// Interned id indices of the highlighted stations, resolved once per frame
+// so the per-station test is an integer compare.
+static std::vector<uint32_t> HighlightedIds(shipobs_pi *plugin,
+                                            const StationStore &stations) {
+    std::vector<uint32_t> ids;
+    for (const std::string &id : plugin->GetHighlightedStationIds()) {
+        uint32_t idx = stations.FindString(id);
+        if (idx != STRING_NOT_FOUND) ids.push_back(idx);
+    }
+    return ids;
+}
+
+static bool IsHighlighted(const StationStore &stations, size_t i,
+                          const std::vector<uint32_t> &highlighted) {
+    uint32_t id = stations.IdIndex(i);
+    for (uint32_t h : highlighted)
+        if (h == id) return true;
+    return false;
 }
 
 // Get marker colour for a station type.
 // Returns r,g,b in 0..1 range.
-static void TypeColor(const wxString &type, float &r, float &g, float &b) {
-    if (type == wxT("buoy")) {
+static void TypeColor(PlatformType kind, float &r, float &g, float &b) {
+    if (kind == PLATFORM_BUOY) {
         r = 1.0f; g = 0.85f; b = 0.0f;   // Yellow
-    } else if (type == wxT("ship")) {
+    } else if (kind == PLATFORM_SHIP) {
         r = 0.2f; g = 0.4f; b = 1.0f;     // Blue
-    } else if (type == wxT("shore")) {
+    } else if (kind == PLATFORM_SHORE) {
         r = 0.0f; g = 0.8f; b = 0.2f;     // Green
-    } else if (type == wxT("drifter")) {
+    } else if (kind == PLATFORM_DRIFTER) {
         r = 0.0f; g = 0.9f; b = 0.9f;     // Cyan
     } else {
         r = 0.7f; g = 0.7f; b = 0.7f;     // Grey
@@ -49,306 +72,350 @@ static void TypeColor(const wxString &type, float &r, float &g, float &b) {
 }
 
 // Get marker colour as wxColour for DC rendering.
-static wxColour TypeWxColor(const wxString &type) {
+static wxColour TypeWxColor(PlatformType kind) {
     float r, g, b;
-    TypeColor(type, r, g, b);
+    TypeColor(kind, r, g, b);
     return wxColour(static_cast<unsigned char>(r * 255),
                     static_cast<unsigned char>(g * 255),
                     static_cast<unsigned char>(b * 255));
 }
 
-// ---------- GL drawing primitives ----------
+// ---------- Clusters ----------
 
-static void DrawCircleGL(float cx, float cy, float radius, int segments = 16) {
-    glBegin(GL_TRIANGLE_FAN);
-    glVertex2f(cx, cy);
-    for (int i = 0; i <= segments; i++) {
-        float a = 2.0f * M_PI * i / segments;
-        glVertex2f(cx + radius * cosf(a), cy + radius * sinf(a));
-    }
-    glEnd();
+// Aggregate marker radius: grows with the member count, capped at about
+// two plain markers.
+static float ClusterRadius(uint32_t count) {
+    float r = MARKER_SIZE + 2 + 2.0f * std::log2(static_cast<float>(count));
+    return std::min(r, MARKER_SIZE * 2.0f + 4);
 }
 
-static void DrawTriangleGL(float cx, float cy, float size) {
-    float h = size * 1.2f;
-    glBegin(GL_TRIANGLES);
-    glVertex2f(cx, cy - h);           // top
-    glVertex2f(cx - size, cy + h * 0.5f);  // bottom-left
-    glVertex2f(cx + size, cy + h * 0.5f);  // bottom-right
-    glEnd();
+// Members' type colour if they all share one type, slate otherwise.
+static void ClusterColor(uint8_t type_mask, float &r, float &g, float &b) {
+    for (int t = 0; t < PLATFORM_COUNT; t++) {
+        if (type_mask == (1u << t)) {
+            TypeColor(static_cast<PlatformType>(t), r, g, b);
+            return;
+        }
+    }
+    r = 0.45f; g = 0.5f; b = 0.6f;
 }
 
-static void DrawSquareGL(float cx, float cy, float size) {
-    glBegin(GL_QUADS);
-    glVertex2f(cx - size, cy - size);
-    glVertex2f(cx + size, cy - size);
-    glVertex2f(cx + size, cy + size);
-    glVertex2f(cx - size, cy + size);
-    glEnd();
+static bool ClusterHighlighted(const StationStore &stations,
+                               const StationClusters &clusters, size_t c,
+                               const std::vector<uint32_t> &highlighted) {
+    if (highlighted.empty()) return false;
+    const uint32_t *members = clusters.Members(c);
+    for (uint32_t k = 0; k < clusters.Clusters()[c].count; k++)
+        if (IsHighlighted(stations, members[k], highlighted)) return true;
+    return false;
 }
 
-static void DrawDiamondGL(float cx, float cy, float size) {
-    float s = size * 1.3f;
-    glBegin(GL_QUADS);
-    glVertex2f(cx, cy - s);     // top
-    glVertex2f(cx + s, cy);     // right
-    glVertex2f(cx, cy + s);     // bottom
-    glVertex2f(cx - s, cy);     // left
-    glEnd();
-}
+// ---------- GL label glyph atlas ----------
 
-static void DrawMarkerGL(const wxString &type, float px, float py) {
-    if (type == wxT("buoy")) {
-        DrawCircleGL(px, py, MARKER_SIZE);
-    } else if (type == wxT("ship")) {
-        DrawTriangleGL(px, py, MARKER_SIZE);
-    } else if (type == wxT("shore")) {
-        DrawSquareGL(px, py, MARKER_SIZE * 0.8f);
-    } else if (type == wxT("drifter")) {
-        DrawDiamondGL(px, py, MARKER_SIZE * 0.7f);
-    } else {
-        DrawCircleGL(px, py, MARKER_SIZE * 0.6f);
-    }
-}
+static const int ATLAS_SIZE = 512;
+static GlyphAtlas s_atlas(ATLAS_SIZE, ATLAS_SIZE);
+static GLuint s_atlas_tex = 0;
+static int s_line_height = 0;  // label font height in pixels
+static std::vector<LabelVertex> s_label_verts;
 
-// Draw a wind barb at (px, py) for given direction (deg true) and speed (knots).
-static void DrawWindBarbGL(float px, float py, double dir_deg, double spd_kt) {
-    if (std::isnan(dir_deg) || std::isnan(spd_kt)) return;
-    if (spd_kt < 0.5) return;  // calm
-
-    float dir_rad = static_cast<float>(dir_deg * M_PI / 180.0);
-    // Wind barb: shaft points from station in the direction the wind is coming FROM
-    float shaft_len = 25.0f;
-    float dx = sinf(dir_rad);
-    float dy = -cosf(dir_rad);  // screen Y inverted
-
-    float ex = px + dx * shaft_len;
-    float ey = py + dy * shaft_len;
-
-    glBegin(GL_LINES);
-    glVertex2f(px, py);
-    glVertex2f(ex, ey);
-    glEnd();
-
-    // Barb ticks: pennants (50kt), long barbs (10kt), short barbs (5kt)
-    int remaining = static_cast<int>(spd_kt + 2.5);  // round
-    float tick_spacing = 5.0f;
-    float tick_pos = shaft_len;  // start from end of shaft
-
-    // Perpendicular direction for barb ticks (to the right of shaft direction)
-    float nx = -dy;
-    float ny = dx;
-    float barb_len = 10.0f;
-
-    // Pennants (50 kt)
-    while (remaining >= 50) {
-        float bx = px + dx * tick_pos;
-        float by = py + dy * tick_pos;
-        float bx2 = bx + nx * barb_len;
-        float by2 = by + ny * barb_len;
-        float bx3 = px + dx * (tick_pos - tick_spacing);
-        float by3 = py + dy * (tick_pos - tick_spacing);
-        glBegin(GL_TRIANGLES);
-        glVertex2f(bx, by);
-        glVertex2f(bx2, by2);
-        glVertex2f(bx3, by3);
-        glEnd();
-        tick_pos -= tick_spacing;
-        remaining -= 50;
-    }
+// Rasterise code points into the atlas, white on black through a
+// wxMemoryDC with the red channel kept as coverage. Each glyph is drawn
+// once per atlas lifetime; a full atlas starts over.
+static void RasterizeGlyphs(std::vector<uint32_t> &cps) {
+    std::sort(cps.begin(), cps.end());
+    cps.erase(std::unique(cps.begin(), cps.end()), cps.end());
 
-    // Long barbs (10 kt)
-    while (remaining >= 10) {
-        float bx = px + dx * tick_pos;
-        float by = py + dy * tick_pos;
-        glBegin(GL_LINES);
-        glVertex2f(bx, by);
-        glVertex2f(bx + nx * barb_len, by + ny * barb_len);
-        glEnd();
-        tick_pos -= tick_spacing;
-        remaining -= 10;
+    wxFont font(8, wxFONTFAMILY_SWISS, wxFONTSTYLE_NORMAL, wxFONTWEIGHT_NORMAL);
+    wxBitmap tmp(1, 1);
+    wxMemoryDC measure(tmp);
+    measure.SetFont(font);
+    if (s_line_height == 0) {
+        wxCoord h = 0;
+        measure.GetTextExtent(wxT("Ag"), nullptr, &h);
+        s_line_height = h;
     }
 
-    // Short barb (5 kt)
-    if (remaining >= 5) {
-        float bx = px + dx * tick_pos;
-        float by = py + dy * tick_pos;
-        glBegin(GL_LINES);
-        glVertex2f(bx, by);
-        glVertex2f(bx + nx * barb_len * 0.5f, by + ny * barb_len * 0.5f);
-        glEnd();
+    for (uint32_t cp : cps) {
+        if (s_atlas.Find(cp)) continue;
+        wxString text(wxUniChar(cp));
+        wxCoord w = 0, h = 0;
+        measure.GetTextExtent(text, &w, &h);
+
+        GlyphCell *cell = s_atlas.Add(cp, w, h);
+        if (!cell) {
+            s_atlas.Reset();
+            cell = s_atlas.Add(cp, w, h);
+            if (!cell) continue;
+        }
+        if (w <= 0 || h <= 0) continue;
+
+        wxBitmap bmp(w, h);
+        {
+            wxMemoryDC mdc(bmp);
+            mdc.SetFont(font);
+            mdc.SetBackground(*wxBLACK_BRUSH);
+            mdc.Clear();
+            mdc.SetTextForeground(*wxWHITE);
+            mdc.DrawText(text, 0, 0);
+        }
+        wxImage img = bmp.ConvertToImage();
+        for (int y = 0; y < h; y++) {
+            uint8_t *row = s_atlas.Row(cell->y + y) + cell->x;
+            for (int x = 0; x < w; x++)
+                row[x] = img.GetRed(x, y);  // black bg -> 0, white text -> 255
+        }
     }
 }
 
-// ---------- GL label texture cache ----------
-
-struct LabelTex { GLuint id; int w, h; };
-static std::map<wxString, LabelTex> s_label_cache;
-static bool s_cache_dirty = false;
-
-void InvalidateLabelCache() { s_cache_dirty = true; }
-
-static void ClearLabelCache() {
-    for (auto &kv : s_label_cache)
-        glDeleteTextures(1, &kv.second.id);
-    s_label_cache.clear();
-    s_cache_dirty = false;
-}
-
-// Returns a cached GL texture for the given text, creating it if needed.
-static const LabelTex *GetOrCreateLabelTex(const wxString &text) {
-    auto it = s_label_cache.find(text);
-    if (it != s_label_cache.end())
-        return &it->second;
-
-    wxFont font(8, wxFONTFAMILY_SWISS, wxFONTSTYLE_NORMAL, wxFONTWEIGHT_NORMAL);
-
-    // Measure
-    wxCoord tw = 1, th = 1;
-    {
-        wxBitmap tmp(1, 1);
-        wxMemoryDC mdc(tmp);
-        mdc.SetFont(font);
-        mdc.GetTextExtent(text, &tw, &th);
-        tw += 2; th += 2;
+// Create the atlas texture, or re-upload it after new glyphs were added.
+static void UploadAtlas() {
+    if (s_atlas_tex && !s_atlas.IsDirty()) return;
+
+    glPushClientAttrib(GL_CLIENT_PIXEL_STORE_BIT);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    if (!s_atlas_tex) {
+        glGenTextures(1, &s_atlas_tex);
+        glBindTexture(GL_TEXTURE_2D, s_atlas_tex);
+        // Quads are pixel aligned and glyph-sized: no filtering needed
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, s_atlas.Width(),
+                     s_atlas.Height(), 0, GL_ALPHA, GL_UNSIGNED_BYTE,
+                     s_atlas.Pixels().data());
+    } else {
+        glBindTexture(GL_TEXTURE_2D, s_atlas_tex);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, s_atlas.Width(),
+                        s_atlas.Height(), GL_ALPHA, GL_UNSIGNED_BYTE,
+                        s_atlas.Pixels().data());
     }
+    glPopClientAttrib();
+    s_atlas.ClearDirty();
+}
 
-    // Render white text on black background
-    wxBitmap bmp(tw, th);
-    {
-        wxMemoryDC mdc(bmp);
-        mdc.SetFont(font);
-        mdc.SetBackground(*wxBLACK_BRUSH);
-        mdc.Clear();
-        mdc.SetTextForeground(*wxWHITE);
-        mdc.DrawText(text, 1, 1);
-    }
+// ---------- GL Rendering ----------
 
-    // Convert to RGBA: use luminance as alpha, colour set at draw time via glColor
-    wxImage img = bmp.ConvertToImage();
-    std::vector<unsigned char> px(tw * th * 4);
-    for (int y = 0; y < th; y++) {
-        for (int x = 0; x < tw; x++) {
-            unsigned char a = img.GetRed(x, y);  // black bg → 0, white text → 255
-            px[4 * (y * tw + x) + 0] = 255;  // colour applied by glColor
-            px[4 * (y * tw + x) + 1] = 255;
-            px[4 * (y * tw + x) + 2] = 255;
-            px[4 * (y * tw + x) + 3] = a;
+// Geometry of the current frame, kept between frames for its allocations.
+static MarkerBatch s_batch;
+
+// A station id, or (count > 0) a cluster's member count.
+struct PendingLabel { uint32_t id; float px, py, alpha; uint32_t count; };
+static std::vector<PendingLabel> s_labels;
+
+// Lay out all pending labels into s_label_verts. Station ids are dark
+// gray (alpha from the station's age), right of the marker; cluster
+// counts are white, centred on the aggregate marker.
+static void LayoutLabels(const StationStore &stations,
+                         std::vector<uint32_t> *missing) {
+    s_label_verts.clear();
+    for (const PendingLabel &pl : s_labels) {
+        float y = std::floor(pl.py - s_line_height / 2);
+        if (pl.count > 0) {
+            char text[16];
+            int n = snprintf(text, sizeof(text), "%u", pl.count);
+            size_t first = s_label_verts.size();
+            float w = s_atlas.AppendLabel(text, n, pl.px, y,
+                                          BatchColor::FromFloat(1, 1, 1, pl.alpha),
+                                          s_label_verts, missing);
+            float shift = std::floor(w / 2);
+            for (size_t k = first; k < s_label_verts.size(); k++)
+                s_label_verts[k].x -= shift;
+            continue;
         }
+        float x = pl.px + MARKER_SIZE + 3;
+        s_atlas.AppendLabel(stations.StringData(pl.id),
+                            stations.StringLength(pl.id), x, y,
+                            BatchColor::FromFloat(0.3f, 0.3f, 0.3f, pl.alpha),
+                            s_label_verts, missing);
     }
-
-    GLuint tex;
-    glGenTextures(1, &tex);
-    glBindTexture(GL_TEXTURE_2D, tex);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, tw, th, 0,
-                 GL_RGBA, GL_UNSIGNED_BYTE, px.data());
-    glBindTexture(GL_TEXTURE_2D, 0);
-
-    LabelTex lt{tex, (int)tw, (int)th};
-    s_label_cache[text] = lt;
-    return &s_label_cache[text];
 }
 
-static void DrawLabelGL(const wxString &text, float px, float py, float alpha) {
-    const LabelTex *lt = GetOrCreateLabelTex(text);
-    if (!lt) return;
-
-    float x = px + MARKER_SIZE + 3;
-    float y = py - lt->h / 2.0f;
+// All labels: one texture bind, one draw call.
+static void DrawLabelsGL() {
+    if (s_label_verts.empty()) return;
+    UploadAtlas();
 
+    const std::vector<LabelVertex> &v = s_label_verts;
     glEnable(GL_TEXTURE_2D);
-    glBindTexture(GL_TEXTURE_2D, lt->id);
-    glColor4f(0.3f, 0.3f, 0.3f, alpha);
-    glBegin(GL_QUADS);
-    glTexCoord2f(0, 0); glVertex2f(x,           y);
-    glTexCoord2f(1, 0); glVertex2f(x + lt->w,   y);
-    glTexCoord2f(1, 1); glVertex2f(x + lt->w,   y + lt->h);
-    glTexCoord2f(0, 1); glVertex2f(x,            y + lt->h);
-    glEnd();
+    glBindTexture(GL_TEXTURE_2D, s_atlas_tex);
+    glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+    glVertexPointer(2, GL_FLOAT, sizeof(LabelVertex), &v[0].x);
+    glTexCoordPointer(2, GL_FLOAT, sizeof(LabelVertex), &v[0].u);
+    glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(LabelVertex), &v[0].color);
+    glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(v.size()));
+    glPopClientAttrib();
+    glBindTexture(GL_TEXTURE_2D, 0);
     glDisable(GL_TEXTURE_2D);
 }
 
-// ---------- GL Rendering ----------
+static void DrawVerticesGL(GLenum mode, const std::vector<BatchVertex> &v) {
+    if (v.empty()) return;
+    glVertexPointer(2, GL_FLOAT, sizeof(BatchVertex), &v[0].x);
+    glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(BatchVertex), &v[0].color);
+    glDrawArrays(mode, 0, static_cast<GLsizei>(v.size()));
+}
 
-void RenderStationsGL(shipobs_pi *plugin, PlugIn_ViewPort *vp) {
-    const ObservationList &stations = plugin->GetStations();
-    if (stations.empty()) return;
+// Inputs the cached frame geometry (s_batch, s_label_verts) was built
+// from. While none change — the usual case between viewport moves — a
+// frame only re-issues the draw calls.
+struct FrameKey {
+    uint64_t projection;                // ProjectionCache::Serial()
+    std::vector<uint32_t> highlighted;
+    bool show_barbs, show_labels, clustered;
+    int64_t minute;                     // opacity follows observation age
+    bool operator==(const FrameKey &o) const {
+        return projection == o.projection && highlighted == o.highlighted &&
+               show_barbs == o.show_barbs && show_labels == o.show_labels &&
+               clustered == o.clustered && minute == o.minute;
+    }
+};
+static FrameKey s_frame_key;
+static bool s_frame_valid = false;
 
-    if (s_cache_dirty) ClearLabelCache();
+// Yellow halo behind stations whose info frame is active/hovered
+static const BatchColor HALO_COLOR = BatchColor::FromFloat(
+    243/255.0f, 229/255.0f, 47/255.0f, 0.75f);
 
-    bool show_barbs = plugin->GetShowWindBarbs();
-    bool show_labels = plugin->GetShowLabels();
+static void AddStationGL(const StationStore &stations,
+                         const ProjectionCache &proj, uint32_t i,
+                         const FrameKey &key) {
+    float px = proj.X(i), py = proj.Y(i);
 
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    glLineWidth(1.5f);
+    float opacity = AgeBucketOpacity(s_age_buckets[i]);
+    PlatformType kind = stations.Type(i);
+    float r, g, b;
+    TypeColor(kind, r, g, b);
 
-    for (size_t i = 0; i < stations.size(); i++) {
-        const ObservationStation &st = stations[i];
-        if (std::isnan(st.lat) || std::isnan(st.lon)) continue;
+    if (!key.highlighted.empty() && IsHighlighted(stations, i, key.highlighted))
+        s_batch.AddDisc(px, py, MARKER_SIZE + 7, HALO_COLOR);
 
-        wxPoint pt;
-        GetCanvasPixLL(vp, &pt, st.lat, st.lon);
-        float px = static_cast<float>(pt.x);
-        float py = static_cast<float>(pt.y);
+    s_batch.AddMarker(kind, px, py, BatchColor::FromFloat(r, g, b, opacity));
 
-        // Skip stations outside the viewport (with some margin)
-        if (pt.x < -50 || pt.x > vp->pix_width + 50 ||
-            pt.y < -50 || pt.y > vp->pix_height + 50)
-            continue;
+    if (key.show_barbs)
+        s_batch.AddWindBarb(px, py, stations.Metric(METRIC_WIND_DIR, i),
+                            stations.Metric(METRIC_WIND_SPD, i),
+                            BatchColor::FromFloat(0, 0, 0, opacity));
 
-        float opacity = AgeOpacity(st.time);
-        float r, g, b;
-        TypeColor(st.type, r, g, b);
+    uint32_t id = stations.IdIndex(i);
+    if (key.show_labels && stations.StringLength(id) > 0) {
+        PendingLabel pl = {id, px, py, opacity, 0};
+        s_labels.push_back(pl);
+    }
+}
 
-        // Yellow halo if a sticky info frame for this station is active/hovered
-        if (plugin->IsStationHighlighted(st.id)) {
-            glColor4f(243/255.0f, 229/255.0f, 47/255.0f, 0.75f);
-            DrawCircleGL(px, py, MARKER_SIZE + 7);
-        }
+// Aggregate marker: outlined disc with the member count. Opacity follows
+// the newest member.
+static void AddClusterGL(const StationStore &stations,
+                         const StationClusters &clusters, size_t c,
+                         const FrameKey &key, int64_t now) {
+    const StationCluster &cl = clusters.Clusters()[c];
+    float radius = ClusterRadius(cl.count);
+    float opacity = AgeOpacity(cl.newest, now);
+    float r, g, b;
+    ClusterColor(cl.type_mask, r, g, b);
 
-        // Draw marker fill
-        glColor4f(r, g, b, opacity);
-        DrawMarkerGL(st.type, px, py);
+    if (ClusterHighlighted(stations, clusters, c, key.highlighted))
+        s_batch.AddDisc(cl.x, cl.y, radius + 7, HALO_COLOR);
+    s_batch.AddDisc(cl.x, cl.y, radius + 1.5f,
+                    BatchColor::FromFloat(0.15f, 0.15f, 0.15f, opacity));
+    s_batch.AddDisc(cl.x, cl.y, radius, BatchColor::FromFloat(r, g, b, opacity));
 
-        // Draw marker outline
-        glColor4f(0, 0, 0, opacity);
-        // Just draw a thin border by re-drawing in line mode
-        glLineWidth(1.0f);
+    PendingLabel pl = {0, cl.x, cl.y, std::max(opacity, 0.6f), cl.count};
+    s_labels.push_back(pl);
+}
 
-        // Wind barb
-        if (show_barbs) {
-            glColor4f(0, 0, 0, opacity);
-            glLineWidth(1.5f);
-            DrawWindBarbGL(px, py, st.wind_dir, st.wind_spd);
+// Returns false if the labels lack glyphs, so the next frame builds again.
+static bool BuildFrameGL(const StationStore &stations,
+                         const ProjectionCache &proj,
+                         const StationClusters &clusters, const FrameKey &key,
+                         int64_t now) {
+    s_batch.Clear();
+    s_labels.clear();
+    UpdateAgeBuckets(stations, now);
+
+    if (key.clustered) {
+        const std::vector<StationCluster> &cl = clusters.Clusters();
+        for (size_t c = 0; c < cl.size(); c++) {
+            if (cl[c].count == 1)
+                AddStationGL(stations, proj, cl[c].seed, key);
+            else
+                AddClusterGL(stations, clusters, c, key, now);
         }
+    } else {
+        for (uint32_t i : proj.Visible())
+            AddStationGL(stations, proj, i, key);
+    }
 
-        if (show_labels && !st.id.IsEmpty()) {
-            DrawLabelGL(st.id, px, py, opacity);
-        }
+    // A full atlas starts over while rasterising and drops glyphs the first
+    // layout found: collect what the frame needs again and add it to the
+    // new atlas.
+    std::vector<uint32_t> missing;
+    LayoutLabels(stations, &missing);
+    for (int pass = 0; pass < 2 && !missing.empty(); pass++) {
+        unsigned generation = s_atlas.Generation();
+        RasterizeGlyphs(missing);
+        missing.clear();
+        LayoutLabels(stations,
+                     s_atlas.Generation() != generation ? &missing : nullptr);
+    }
+    return missing.empty();
+}
+
+void RenderStationsGL(shipobs_pi *plugin, PlugIn_ViewPort * /*vp*/) {
+    const StationStore &stations = plugin->GetStations();
+    if (stations.Empty()) return;
+    const ProjectionCache &proj = plugin->GetProjection();
+
+    int64_t now = EpochFromDateTime(wxDateTime::Now().ToUTC());
+    FrameKey key;
+    key.projection  = proj.Serial();
+    key.highlighted = HighlightedIds(plugin, stations);
+    key.show_barbs  = plugin->GetShowWindBarbs();
+    key.show_labels = plugin->GetShowLabels();
+    key.clustered   = plugin->GetClusterStations();
+    key.minute      = now / 60;
+    if (!s_frame_valid || !(key == s_frame_key)) {
+        s_frame_valid = BuildFrameGL(stations, proj, plugin->GetClusters(),
+                                     key, now);
+        s_frame_key = key;
     }
 
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    // One draw call per primitive class
+    glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+    DrawVerticesGL(GL_TRIANGLES, s_batch.Fills());
+    glLineWidth(1.5f);
+    DrawVerticesGL(GL_LINES, s_batch.Lines());
+    DrawVerticesGL(GL_TRIANGLES, s_batch.Pennants());
+    glPopClientAttrib();
+
+    DrawLabelsGL();
+
     glDisable(GL_BLEND);
 }
 
 // ---------- DC drawing primitives ----------
 
-static void DrawMarkerDC(wxDC &dc, const wxString &type, int px, int py) {
-    if (type == wxT("buoy")) {
+static void DrawMarkerDC(wxDC &dc, PlatformType kind, int px, int py) {
+    if (kind == PLATFORM_BUOY) {
         dc.DrawCircle(px, py, MARKER_SIZE);
-    } else if (type == wxT("ship")) {
+    } else if (kind == PLATFORM_SHIP) {
         wxPoint pts[3];
         int h = MARKER_SIZE + 2;
         pts[0] = wxPoint(px, py - h);
         pts[1] = wxPoint(px - MARKER_SIZE, py + h / 2);
         pts[2] = wxPoint(px + MARKER_SIZE, py + h / 2);
         dc.DrawPolygon(3, pts);
-    } else if (type == wxT("shore")) {
+    } else if (kind == PLATFORM_SHORE) {
         int s = MARKER_SIZE;
         dc.DrawRectangle(px - s, py - s, s * 2, s * 2);
-    } else if (type == wxT("drifter")) {
+    } else if (kind == PLATFORM_DRIFTER) {
         wxPoint pts[4];
         int s = MARKER_SIZE;
         pts[0] = wxPoint(px, py - s);
@@ -363,50 +430,102 @@ static void DrawMarkerDC(wxDC &dc, const wxString &type, int px, int py) {
 
 // ---------- DC Rendering ----------
 
-void RenderStationsDC(shipobs_pi *plugin, wxDC &dc, PlugIn_ViewPort *vp) {
-    const ObservationList &stations = plugin->GetStations();
-    if (stations.empty()) return;
+// Approximate opacity via alpha-blended colour on white background
+static wxColour BlendOnWhite(const wxColour &col, float opacity) {
+    unsigned char alpha = static_cast<unsigned char>(opacity * 255);
+    return wxColour(
+        (col.Red() * alpha + 255 * (255 - alpha)) / 255,
+        (col.Green() * alpha + 255 * (255 - alpha)) / 255,
+        (col.Blue() * alpha + 255 * (255 - alpha)) / 255);
+}
 
-    bool show_labels = plugin->GetShowLabels();
+static void DrawStationDC(wxDC &dc, const StationStore &stations,
+                          const ProjectionCache &proj, uint32_t i,
+                          const std::vector<uint32_t> &highlighted,
+                          bool show_labels) {
+    wxPoint pt(static_cast<int>(proj.X(i)), static_cast<int>(proj.Y(i)));
+
+    float opacity = AgeBucketOpacity(s_age_buckets[i]);
+    PlatformType kind = stations.Type(i);
+    wxColour blended = BlendOnWhite(TypeWxColor(kind), opacity);
+
+    // Yellow halo
+    if (!highlighted.empty() && IsHighlighted(stations, i, highlighted)) {
+        dc.SetBrush(wxBrush(wxColour(243, 229, 47)));
+        dc.SetPen(wxPen(wxColour(243, 229, 47), 1));
+        dc.DrawCircle(pt.x, pt.y, MARKER_SIZE + 7);
+    }
 
-    dc.SetTextForeground(wxColour(77, 77, 77));  // dark gray
-    wxFont font(8, wxFONTFAMILY_SWISS, wxFONTSTYLE_NORMAL, wxFONTWEIGHT_NORMAL);
-    dc.SetFont(font);
+    dc.SetBrush(wxBrush(blended));
+    dc.SetPen(wxPen(*wxBLACK, 1));
 
-    for (size_t i = 0; i < stations.size(); i++) {
-        const ObservationStation &st = stations[i];
-        if (std::isnan(st.lat) || std::isnan(st.lon)) continue;
+    DrawMarkerDC(dc, kind, pt.x, pt.y);
 
-        wxPoint pt;
-        GetCanvasPixLL(vp, &pt, st.lat, st.lon);
+    uint32_t id = stations.IdIndex(i);
+    if (show_labels && stations.StringLength(id) > 0) {
+        dc.DrawText(StationString(stations, id), pt.x + MARKER_SIZE + 3, pt.y - 5);
+    }
+}
 
-        if (pt.x < -50 || pt.x > vp->pix_width + 50 ||
-            pt.y < -50 || pt.y > vp->pix_height + 50)
-            continue;
+static void DrawClusterDC(wxDC &dc, const StationStore &stations,
+                          const StationClusters &clusters, size_t c,
+                          const std::vector<uint32_t> &highlighted,
+                          int64_t now) {
+    const StationCluster &cl = clusters.Clusters()[c];
+    wxPoint pt(static_cast<int>(cl.x), static_cast<int>(cl.y));
+    int radius = static_cast<int>(ClusterRadius(cl.count));
+
+    if (ClusterHighlighted(stations, clusters, c, highlighted)) {
+        dc.SetBrush(wxBrush(wxColour(243, 229, 47)));
+        dc.SetPen(wxPen(wxColour(243, 229, 47), 1));
+        dc.DrawCircle(pt.x, pt.y, radius + 7);
+    }
 
-        float opacity = AgeOpacity(st.time);
-        wxColour col = TypeWxColor(st.type);
-        // Approximate opacity via alpha-blended colour on white background
-        unsigned char alpha = static_cast<unsigned char>(opacity * 255);
-        wxColour blended(
-            (col.Red() * alpha + 255 * (255 - alpha)) / 255,
-            (col.Green() * alpha + 255 * (255 - alpha)) / 255,
-            (col.Blue() * alpha + 255 * (255 - alpha)) / 255);
-
-        // Yellow halo
-        if (plugin->IsStationHighlighted(st.id)) {
-            dc.SetBrush(wxBrush(wxColour(243, 229, 47)));
-            dc.SetPen(wxPen(wxColour(243, 229, 47), 1));
-            dc.DrawCircle(pt.x, pt.y, MARKER_SIZE + 7);
-        }
+    float r, g, b;
+    ClusterColor(cl.type_mask, r, g, b);
+    wxColour col(static_cast<unsigned char>(r * 255),
+                 static_cast<unsigned char>(g * 255),
+                 static_cast<unsigned char>(b * 255));
+    dc.SetBrush(wxBrush(BlendOnWhite(col, AgeOpacity(cl.newest, now))));
+    dc.SetPen(wxPen(wxColour(38, 38, 38), 2));
+    dc.DrawCircle(pt.x, pt.y, radius);
+
+    wxString count = wxString::Format(wxT("%u"), cl.count);
+    wxCoord w = 0, h = 0;
+    dc.GetTextExtent(count, &w, &h);
+    dc.DrawText(count, pt.x - w / 2, pt.y - h / 2);
+}
+
+void RenderStationsDC(shipobs_pi *plugin, wxDC &dc, PlugIn_ViewPort * /*vp*/) {
+    const StationStore &stations = plugin->GetStations();
+    if (stations.Empty()) return;
 
-        dc.SetBrush(wxBrush(blended));
-        dc.SetPen(wxPen(*wxBLACK, 1));
+    bool show_labels = plugin->GetShowLabels();
+    int64_t now = EpochFromDateTime(wxDateTime::Now().ToUTC());
+    std::vector<uint32_t> highlighted = HighlightedIds(plugin, stations);
+    UpdateAgeBuckets(stations, now);
 
-        DrawMarkerDC(dc, st.type, pt.x, pt.y);
+    wxFont font(8, wxFONTFAMILY_SWISS, wxFONTSTYLE_NORMAL, wxFONTWEIGHT_NORMAL);
+    dc.SetFont(font);
 
-        if (show_labels && !st.id.IsEmpty()) {
-            dc.DrawText(st.id, pt.x + MARKER_SIZE + 3, pt.y - 5);
-        }
+    const ProjectionCache &proj = plugin->GetProjection();
+    if (!plugin->GetClusterStations()) {
+        dc.SetTextForeground(wxColour(77, 77, 77));  // dark gray
+        for (uint32_t i : proj.Visible())
+            DrawStationDC(dc, stations, proj, i, highlighted, show_labels);
+        return;
     }
+
+    // Plain stations first, then aggregate markers with white counts
+    const StationClusters &clusters = plugin->GetClusters();
+    const std::vector<StationCluster> &cl = clusters.Clusters();
+    dc.SetTextForeground(wxColour(77, 77, 77));
+    for (size_t c = 0; c < cl.size(); c++)
+        if (cl[c].count == 1)
+            DrawStationDC(dc, stations, proj, cl[c].seed, highlighted,
+                          show_labels);
+    dc.SetTextForeground(*wxWHITE);
+    for (size_t c = 0; c < cl.size(); c++)
+        if (cl[c].count > 1)
+            DrawClusterDC(dc, stations, clusters, c, highlighted, now);
 }
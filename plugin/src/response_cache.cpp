@@ -0,0 +1,80 @@
+#include "response_cache.h"
+
+static const char CACHE_MAGIC[4] = {'S', 'O', 'B', 'C'};
+static const uint32_t CACHE_VERSION = 2;
+static const size_t CACHE_HEADER_SIZE = 32;
+
+// 32-bit FNV-1a; only used to pick a slot, so collisions just share it.
+static uint32_t HashUrl(const std::string &s) {
+    uint32_t h = 2166136261u;
+    for (unsigned char c : s) {
+        h ^= c;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static size_t Align8(size_t n) { return (n + 7) & ~static_cast<size_t>(7); }
+
+static void PutU32(std::string &buf, uint32_t v) {
+    buf.append(reinterpret_cast<const char *>(&v), sizeof(v));
+}
+
+static uint32_t GetU32(const std::string &buf, size_t at) {
+    uint32_t v;
+    std::memcpy(&v, buf.data() + at, sizeof(v));
+    return v;
+}
+
+std::string ResponseCache::PathFor(const std::string &url) const {
+    return m_base_path + "." + std::to_string(HashUrl(url) % m_slots) +
+           ".resp";
+}
+
+bool ResponseCache::Load(const std::string &url, CachedResponse &out) const {
+    if (!IsOpen()) return false;
+    std::string buf;
+    if (!ReadFileBytes(PathFor(url), buf)) return false;
+    if (buf.size() < CACHE_HEADER_SIZE ||
+        buf.compare(0, 4, CACHE_MAGIC, 4) != 0 ||
+        GetU32(buf, 4) != CACHE_VERSION)
+        return false;
+
+    uint64_t url_len  = GetU32(buf, 8);
+    uint64_t etag_len = GetU32(buf, 12);
+    uint64_t lm_len   = GetU32(buf, 16);
+    std::memcpy(&out.stored_at, buf.data() + 24, sizeof(int64_t));
+    uint64_t strings  = url_len + etag_len + lm_len;
+    if (CACHE_HEADER_SIZE + strings > buf.size()) return false;
+    size_t pos = CACHE_HEADER_SIZE;
+    if (url_len != url.size() || buf.compare(pos, url_len, url) != 0)
+        return false;  // slot holds another URL
+    pos += url_len;
+    out.etag.assign(buf, pos, etag_len);
+    pos += etag_len;
+    out.last_modified.assign(buf, pos, lm_len);
+    pos = Align8(pos + lm_len);
+    if (pos > buf.size()) return false;
+
+    return DecodeBlock(buf.data() + pos, buf.size() - pos, out.stations);
+}
+
+bool ResponseCache::Store(const std::string &url, const std::string &etag,
+                          const std::string &last_modified,
+                          const StationColumns &cols, int64_t stored_at) {
+    if (!IsOpen()) return false;
+
+    std::string buf(CACHE_MAGIC, 4);
+    PutU32(buf, CACHE_VERSION);
+    PutU32(buf, static_cast<uint32_t>(url.size()));
+    PutU32(buf, static_cast<uint32_t>(etag.size()));
+    PutU32(buf, static_cast<uint32_t>(last_modified.size()));
+    PutU32(buf, 0);  // reserved
+    buf.append(reinterpret_cast<const char *>(&stored_at), sizeof(stored_at));
+    buf += url;
+    buf += etag;
+    buf += last_modified;
+    buf.resize(Align8(buf.size()), '\0');
+    buf += EncodeBlock(cols);
+    return WriteFileAtomic(PathFor(url), buf);
+}
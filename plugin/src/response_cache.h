@@ -0,0 +1,52 @@
+#ifndef _RESPONSE_CACHE_H_
+#define _RESPONSE_CACHE_H_
+
+// Disk cache of observation responses for conditional requests — no wx
+// dependencies.
+//
+// One file per slot, <base>.<slot>.resp, the slot being a hash of the
+// request URL; with CACHE_SLOTS slots the cache never holds more files than
+// that, and a slot wanted by another URL is simply overwritten. Each file
+// keeps the URL it was stored for, the response's ETag / Last-Modified
+// validators, when it was stored, and the parsed stations as a history
+// block (EncodeBlock), so a 304 Not Modified reply is answered without
+// parsing anything. TileCache keeps its tiles in one too, keyed by tile.
+
+#include "history_store.h"
+
+#include <string>
+
+static const unsigned CACHE_SLOTS = 64;
+
+struct CachedResponse {
+    std::string etag;            // as sent by the server, quotes included
+    std::string last_modified;   // HTTP-date
+    int64_t stored_at;           // epoch seconds, TIME_UNKNOWN if unset
+    StationColumns stations;
+    CachedResponse() : stored_at(TIME_UNKNOWN) {}
+};
+
+class ResponseCache {
+public:
+    explicit ResponseCache(unsigned slots = CACHE_SLOTS) : m_slots(slots) {}
+
+    // Use files <base_path>.<slot>.resp (UTF-8, without extension).
+    void Open(const std::string &base_path) { m_base_path = base_path; }
+    bool IsOpen() const { return !m_base_path.empty(); }
+
+    // The cached response for url, if there is one and it is readable.
+    bool Load(const std::string &url, CachedResponse &out) const;
+
+    // Remember a response, replacing any earlier one for url.
+    bool Store(const std::string &url, const std::string &etag,
+               const std::string &last_modified, const StationColumns &cols,
+               int64_t stored_at);
+
+    std::string PathFor(const std::string &url) const;
+
+private:
+    std::string m_base_path;
+    unsigned m_slots;
+};
+
+#endif // _RESPONSE_CACHE_H_
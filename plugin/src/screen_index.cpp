@@ -0,0 +1,81 @@
+#include "screen_index.h"
+
+#include <algorithm>
+#include <cmath>
+
+ScreenIndex::ScreenIndex(int cell_size)
+    : m_cell_size(cell_size > 0 ? cell_size : 32), m_origin(0),
+      m_cols(0), m_rows(0) {}
+
+void ScreenIndex::Clear() {
+    m_points.clear();
+    m_cell_start.clear();
+    m_cols = m_rows = 0;
+}
+
+void ScreenIndex::Begin(int width, int height, int margin) {
+    Clear();
+    m_origin = -margin;
+    m_cols = std::max(1, (width + 2 * margin) / m_cell_size + 1);
+    m_rows = std::max(1, (height + 2 * margin) / m_cell_size + 1);
+}
+
+void ScreenIndex::Add(uint32_t station, float x, float y) {
+    Point p = {x, y, station};
+    m_points.push_back(p);
+}
+
+int ScreenIndex::CellCol(float x) const {
+    int c = static_cast<int>(std::floor((x - m_origin) / m_cell_size));
+    return std::min(std::max(c, 0), m_cols - 1);
+}
+
+int ScreenIndex::CellRow(float y) const {
+    int r = static_cast<int>(std::floor((y - m_origin) / m_cell_size));
+    return std::min(std::max(r, 0), m_rows - 1);
+}
+
+// Counting sort by cell: two passes over the points, no per-cell vectors.
+void ScreenIndex::Finish() {
+    size_t cells = static_cast<size_t>(m_cols) * m_rows;
+    m_cell_start.assign(cells + 1, 0);
+    for (const Point &p : m_points)
+        m_cell_start[CellRow(p.y) * m_cols + CellCol(p.x) + 1]++;
+    for (size_t c = 0; c < cells; c++)
+        m_cell_start[c + 1] += m_cell_start[c];
+
+    m_scratch.resize(m_points.size());
+    std::vector<uint32_t> fill(m_cell_start.begin(), m_cell_start.end() - 1);
+    for (const Point &p : m_points)
+        m_scratch[fill[CellRow(p.y) * m_cols + CellCol(p.x)]++] = p;
+    m_points.swap(m_scratch);
+}
+
+int ScreenIndex::Nearest(float x, float y, float radius,
+                         float *out_x, float *out_y) const {
+    if (m_cell_start.empty()) return -1;
+
+    int c0 = CellCol(x - radius), c1 = CellCol(x + radius);
+    int r0 = CellRow(y - radius), r1 = CellRow(y + radius);
+    double best_dist_sq = static_cast<double>(radius) * radius;
+    const Point *best = nullptr;
+    for (int r = r0; r <= r1; r++) {
+        for (int c = c0; c <= c1; c++) {
+            size_t cell = static_cast<size_t>(r) * m_cols + c;
+            for (uint32_t k = m_cell_start[cell]; k < m_cell_start[cell + 1]; k++) {
+                const Point &p = m_points[k];
+                double dx = x - p.x, dy = y - p.y;
+                double dist_sq = dx * dx + dy * dy;
+                if (dist_sq < best_dist_sq ||
+                    (best && dist_sq == best_dist_sq && p.station < best->station)) {
+                    best_dist_sq = dist_sq;
+                    best = &p;
+                }
+            }
+        }
+    }
+    if (!best) return -1;
+    if (out_x) *out_x = best->x;
+    if (out_y) *out_y = best->y;
+    return static_cast<int>(best->station);
+}
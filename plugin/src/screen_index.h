@@ -0,0 +1,56 @@
+#ifndef _SCREEN_INDEX_H_
+#define _SCREEN_INDEX_H_
+
+// Uniform grid over projected station positions, for hit-testing — no wx
+// dependencies.
+//
+// The render pass already projects every visible station; it records the
+// screen positions here (Begin / Add / Finish) so that mouse handling can
+// find the station under the cursor by looking at a few grid cells
+// instead of re-projecting every station on every mouse move.
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class ScreenIndex {
+public:
+    // cell_size should be at least the largest query radius, so a query
+    // touches at most 3 x 3 cells.
+    explicit ScreenIndex(int cell_size = 32);
+
+    // Start a rebuild for a canvas of width x height pixels. Points may
+    // lie up to `margin` pixels outside it.
+    void Begin(int width, int height, int margin);
+    void Add(uint32_t station, float x, float y);
+    void Finish();
+
+    // Drop all points (e.g. when the station set changes).
+    void Clear();
+
+    size_t Size() const { return m_points.size(); }
+
+    // Station nearest to (x, y) strictly within radius, or -1. Ties go to
+    // the lower station index. If found, its position is stored in
+    // out_x / out_y when those are non-null.
+    int Nearest(float x, float y, float radius,
+                float *out_x = nullptr, float *out_y = nullptr) const;
+
+private:
+    struct Point {
+        float x, y;
+        uint32_t station;
+    };
+
+    int CellCol(float x) const;
+    int CellRow(float y) const;
+
+    int m_cell_size;
+    int m_origin;                 // -margin: grid starts left/above the canvas
+    int m_cols, m_rows;
+    std::vector<Point> m_points;  // Add() order until Finish(), then by cell
+    std::vector<uint32_t> m_cell_start;  // m_cols * m_rows + 1 offsets
+    std::vector<Point> m_scratch;
+};
+
+#endif // _SCREEN_INDEX_H_
@@ -1,86 +1,412 @@
 #include "server_client.h"
+#include "history_store.h"
+#include "http_client.h"
 #include "obs_parser.h"
+#include "response_cache.h"
+#include "station_merge.h"
+#include "station_view.h"
 #include "url_builder.h"
+#include "wire_format.h"
 
 #include <curl/curl.h>
 #include <wx/intl.h>
 #include <wx/log.h>
+#include <wx/time.h>
+#include <algorithm>
+#include <cmath>
+#include <cctype>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+// Bytes of a non-200 response body kept for the error log.
+static const size_t ERROR_EXCERPT = 300;
+
+// What the plugin accepts: the compact columnar encoding (see
+// wire_format.h) from servers that have it, JSON from the others.
+static const char ACCEPT_HEADER[] =
+    "Accept: application/x-shipobs-columns, application/json;q=0.5";
+
+// Receives the (already decompressed) response body from curl. A JSON body
+// is fed straight into the parser, which packs each station into columns
+// as soon as its object closes: neither the body nor a list of parsed
+// stations is ever held in memory as a whole, parsing overlaps the
+// download, and the stations so far can be shown before it ends. A
+// columnar body is collected and decoded once complete.
+struct ResponseSink : StationSink {
+    CURL *curl;
+    ObsStreamParser parser;
+    StationColumns stations;    // parsed from a JSON body so far
+    FetchProgress *progress;    // told about new stations, or null
+    size_t reported;            // stations progress has seen
+    bool columns;           // Content-Type is WIRE_CONTENT_TYPE
+    std::string body;       // columnar body
+    long http_code;         // read once the first body bytes arrive
+    size_t received;        // decompressed body bytes
+    bool parse_failed;
+    std::string excerpt;    // start of a non-200 body
+    std::string etag;           // validators of the final response
+    std::string last_modified;
+    ResponseSink(CURL *c) : curl(c), progress(nullptr), reported(0),
+                            columns(false), http_code(0), received(0),
+                            parse_failed(false) {
+        parser.SetSink(this);
+    }
+
+    void OnStation(const ObservationStation &st) { AppendObservation(st, stations); }
+    void OnReset() {
+        stations.Clear();
+        reported = 0;
+    }
+};
 
 static size_t CurlWriteCallback(char *ptr, size_t size, size_t nmemb,
                                  void *userdata) {
-    std::string *buf = static_cast<std::string *>(userdata);
-    buf->append(ptr, size * nmemb);
-    return size * nmemb;
+    ResponseSink *sink = static_cast<ResponseSink *>(userdata);
+    size_t n = size * nmemb;
+    if (sink->received == 0)
+        curl_easy_getinfo(sink->curl, CURLINFO_RESPONSE_CODE, &sink->http_code);
+    sink->received += n;
+
+    if (sink->http_code != 200) {
+        size_t keep = std::min(n, ERROR_EXCERPT - std::min(ERROR_EXCERPT,
+                                                           sink->excerpt.size()));
+        sink->excerpt.append(ptr, keep);
+        return n;
+    }
+    if (sink->columns) {
+        sink->body.append(ptr, n);
+        return n;
+    }
+    if (!sink->parser.Feed(ptr, n)) {
+        sink->parse_failed = true;
+        return 0;  // abort the transfer; Finish() reports the error
+    }
+    if (sink->progress && sink->stations.Size() > sink->reported) {
+        sink->progress->OnStations(sink->stations.View(), sink->reported);
+        sink->reported = sink->stations.Size();
+    }
+    return n;
 }
 
-bool FetchObservations(const wxString &server_url,
-                       double lat_min, double lat_max,
-                       double lon_min, double lon_max,
-                       const wxString &max_age,
-                       const wxString &types,
-                       ObservationList &out,
-                       wxString &error_msg) {
-    BBox bb = ClampBbox(lat_min, lat_max, lon_min, lon_max);
+// If line is the header `name: value` (name in lower case), set value.
+static bool HeaderValue(const char *line, size_t n, const char *name,
+                        std::string &value) {
+    size_t len = std::strlen(name);
+    if (n <= len || line[len] != ':') return false;
+    for (size_t i = 0; i < len; i++)
+        if (std::tolower(static_cast<unsigned char>(line[i])) != name[i])
+            return false;
+    size_t b = len + 1, e = n;
+    while (b < e && (line[b] == ' ' || line[b] == '\t')) b++;
+    while (e > b && std::isspace(static_cast<unsigned char>(line[e - 1]))) e--;
+    value.assign(line + b, e - b);
+    return true;
+}
 
-    std::string s_max_age = std::string(max_age.mb_str(wxConvUTF8));
-    std::string s_types   = std::string(types.mb_str(wxConvUTF8));
+// Picks up the cache validators and the body's encoding. curl also reports
+// the headers of redirects and interim replies, so each status line starts
+// over.
+static size_t CurlHeaderCallback(char *ptr, size_t size, size_t nitems,
+                                 void *userdata) {
+    ResponseSink *sink = static_cast<ResponseSink *>(userdata);
+    size_t n = size * nitems;
+    if (n >= 5 && std::memcmp(ptr, "HTTP/", 5) == 0) {
+        sink->etag.clear();
+        sink->last_modified.clear();
+        sink->columns = false;
+    } else if (!HeaderValue(ptr, n, "etag", sink->etag) &&
+               !HeaderValue(ptr, n, "last-modified", sink->last_modified)) {
+        std::string type;
+        if (HeaderValue(ptr, n, "content-type", type))
+            sink->columns = type.compare(0, sizeof(WIRE_CONTENT_TYPE) - 1,
+                                         WIRE_CONTENT_TYPE) == 0;
+    }
+    return n;
+}
 
+// Progress of all transfers of one fetch, reported as one sum.
+struct ProgressSum {
+    FetchProgress *progress;
+    std::vector<size_t> received;   // per transfer, bytes on the wire
+    std::vector<size_t> total;
+};
+
+// One request of a fetch and everything its callbacks write to.
+struct Transfer {
+    ProgressSum *sum;
+    size_t index;
+    std::string url;
+    unsigned fields;           // FetchProfile::fields
+    ResponseSink sink;
+    CachedResponse cached;     // conditional request: what we have
+    bool have_cached;
+    struct curl_slist *headers;
+    Transfer(CURL *c) : sum(nullptr), index(0), fields(ALL_FIELDS), sink(c),
+                        have_cached(false), headers(nullptr) {}
+    ~Transfer() { curl_slist_free_all(headers); }
+};
+
+static int CurlProgressCallback(void *clientp, curl_off_t dltotal,
+                                curl_off_t dlnow, curl_off_t /*ultotal*/,
+                                curl_off_t /*ulnow*/) {
+    Transfer *t = static_cast<Transfer *>(clientp);
+    ProgressSum *sum = t->sum;
+    sum->received[t->index] = static_cast<size_t>(dlnow);
+    sum->total[t->index]    = static_cast<size_t>(dltotal);
+    size_t received = 0, total = 0;
+    bool known = true;   // the total is only known once every size is
+    for (size_t i = 0; i < sum->received.size(); i++) {
+        received += sum->received[i];
+        total    += sum->total[i];
+        if (!sum->total[i]) known = false;
+    }
+    bool go_on = sum->progress->OnDownload(received, known ? total : 0);
+    return go_on ? 0 : 1;  // non-zero aborts the transfer
+}
+
+static std::string ObservationsUrl(const wxString &server_url, const BBox &bb,
+                                   const std::string &max_age,
+                                   const std::string &types,
+                                   const FetchProfile &profile, int64_t since) {
     std::string url =
         std::string(server_url.mb_str(wxConvUTF8)) +
         "/api/v1/observations?lat_min=" + FmtDbl(bb.lat_min) +
         "&lat_max=" + FmtDbl(bb.lat_max) +
         "&lon_min=" + FmtDbl(bb.lon_min) +
         "&lon_max=" + FmtDbl(bb.lon_max) +
-        "&max_age=" + s_max_age +
-        "&types="   + s_types;
-
-    wxLogMessage("ShipObs: fetch  lat=[%.4f, %.4f]  lon=[%.4f, %.4f]  age=%s  types=%s",
-                 bb.lat_min, bb.lat_max, bb.lon_min, bb.lon_max,
-                 s_max_age.c_str(), s_types.c_str());
-    wxLogMessage("ShipObs: URL: %s", url.c_str());
-
-    CURL *curl = curl_easy_init();
-    if (!curl) {
-        error_msg = _("Failed to initialize HTTP client");
-        wxLogError("ShipObs: failed to initialize curl");
-        return false;
-    }
+        "&max_age=" + max_age +
+        "&types="   + types +
+        profile.Query();
+    if (since != TIME_UNKNOWN)
+        url += "&since=" + FormatIsoTime(since);
+    return url;
+}
 
-    std::string response;
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+// Set the request options of t on its (prepared) handle. Full fetches are
+// sent as conditional requests when the URL has a cached response.
+static void SetUpTransfer(CURL *curl, Transfer &t, ResponseCache *cache,
+                          ProgressSum *sum) {
+    // Let curl offer every encoding it was built with (gzip, deflate and,
+    // where available, br/zstd) and decompress on the fly.
+    curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "");
     curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, CurlWriteCallback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 15L);
-    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 5L);
-    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &t.sink);
+    curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, CurlHeaderCallback);
+    curl_easy_setopt(curl, CURLOPT_HEADERDATA, &t.sink);
+
+    t.headers = curl_slist_append(t.headers, ACCEPT_HEADER);
+    t.have_cached = cache && cache->Load(t.url, t.cached);
+    if (t.have_cached) {
+        if (!t.cached.etag.empty())
+            t.headers = curl_slist_append(
+                t.headers, ("If-None-Match: " + t.cached.etag).c_str());
+        if (!t.cached.last_modified.empty())
+            t.headers = curl_slist_append(
+                t.headers, ("If-Modified-Since: " + t.cached.last_modified).c_str());
+    }
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, t.headers);
+    if (sum) {
+        t.sum = sum;
+        curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
+        curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, CurlProgressCallback);
+        curl_easy_setopt(curl, CURLOPT_XFERINFODATA, &t);
+    }
+}
+
+// Turn the outcome of a finished transfer into stations (or an error).
+static bool FinishTransfer(HttpClient &http, CURL *curl, Transfer &t,
+                           CURLcode res, const HttpStats &st,
+                           const wxString &server_url, ResponseCache *cache,
+                           StationColumns &out, wxString &error_msg) {
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, nullptr);
+    long http_code = st.http_code;
+    ResponseSink &sink = t.sink;
 
-    CURLcode res = curl_easy_perform(curl);
-    long http_code = 0;
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
-    curl_easy_cleanup(curl);
+    if (res == CURLE_ABORTED_BY_CALLBACK) {
+        error_msg = _("Fetch cancelled");
+        wxLogMessage("ShipObs: fetch cancelled");
+        return false;
+    }
 
-    if (res != CURLE_OK) {
+    if (res != CURLE_OK && !sink.parse_failed) {
         error_msg = wxString::Format(
             _("Failed to connect to server: %s"), server_url);
         wxLogError("ShipObs: fetch failed: %s", curl_easy_strerror(res));
         return false;
     }
 
-    if (response.empty()) {
+    wxLogMessage("ShipObs: timing  dns=%.0f ms  connect=%.0f ms  tls=%.0f ms  "
+                 "first byte=%.0f ms  total=%.0f ms  (%s; %lu of %lu requests reused)",
+                 st.name_lookup_ms, st.connect_ms, st.tls_ms,
+                 st.first_byte_ms, st.total_ms,
+                 st.reused ? "reused connection" : "new connection",
+                 http.GetReusedCount(), http.GetRequestCount());
+
+    if (http_code == 304 && t.have_cached) {
+        wxLogMessage("ShipObs: HTTP 304, not modified (%lld bytes transferred); "
+                     "reusing %zu cached stations",
+                     static_cast<long long>(st.bytes), t.cached.stations.Size());
+        out = std::move(t.cached.stations);
+        return true;
+    }
+
+    if (sink.received == 0) {
         error_msg = _("Empty response from server");
         wxLogError("ShipObs: HTTP %ld, empty response", http_code);
         return false;
     }
 
-    wxLogMessage("ShipObs: HTTP %ld, %zu bytes", http_code, response.size());
+    wxLogMessage("ShipObs: HTTP %ld, %zu bytes %s (%lld transferred)",
+                 http_code, sink.received, sink.columns ? "columnar" : "JSON",
+                 static_cast<long long>(st.bytes));
 
     if (http_code != 200) {
-        std::string excerpt = response.substr(0, 300);
-        wxLogError("ShipObs: server error body: %s", excerpt.c_str());
+        wxLogError("ShipObs: server error body: %s", sink.excerpt.c_str());
         error_msg = wxString::Format(_("Server returned HTTP %ld"), http_code);
         return false;
     }
 
-    wxString json = wxString::FromUTF8(response.c_str(), response.size());
-    return ParseObservations(json, out, error_msg);
+    if (sink.columns) {
+        if (!DecodeWire(sink.body.data(), sink.body.size(), out)) {
+            error_msg = _("Malformed response from server");
+            wxLogError("ShipObs: could not decode %zu byte columnar response",
+                       sink.body.size());
+            return false;
+        }
+        // Fields not asked for are missing, even if the server sent them.
+        for (int m = 0; m < METRIC_COUNT; m++)
+            if (!((t.fields >> m) & 1))
+                std::fill(out.metric[m].begin(), out.metric[m].end(), NAN);
+    } else {
+        ObservationList none;   // the stations went to sink.stations
+        if (!sink.parser.Finish(none, error_msg)) return false;
+        out = std::move(sink.stations);
+    }
+
+    if (cache && (!sink.etag.empty() || !sink.last_modified.empty()) &&
+        !cache->Store(t.url, sink.etag, sink.last_modified, out,
+                      EpochFromDateTime(wxDateTime::Now().ToUTC())))
+        wxLogWarning("ShipObs: could not write response cache %s",
+                     cache->PathFor(t.url).c_str());
+    return true;
+}
+
+bool FetchAreas(HttpClient &http,
+                const wxString &server_url,
+                const wxString &max_age,
+                const wxString &types,
+                const FetchProfile &profile,
+                std::vector<AreaRequest> &areas,
+                ResponseCache *cache,
+                int max_parallel,
+                wxString &error_msg,
+                FetchProgress *progress) {
+    if (areas.empty()) return true;
+    std::string s_max_age = std::string(max_age.mb_str(wxConvUTF8));
+    std::string s_types   = NormalizeTypes(std::string(types.mb_str(wxConvUTF8)));
+
+    ProgressSum sum;
+    sum.progress = progress;
+    sum.received.assign(areas.size(), 0);
+    sum.total.assign(areas.size(), 0);
+
+    std::vector<std::unique_ptr<Transfer>> transfers;
+    std::vector<CURL *> handles;
+    for (size_t i = 0; i < areas.size(); i++) {
+        const AreaRequest &a = areas[i];
+        BBox bb = ClampBbox(a.lat_min, a.lat_max, a.lon_min, a.lon_max);
+        std::string url = ObservationsUrl(server_url, bb, s_max_age, s_types,
+                                          profile, a.since);
+        wxLogMessage("ShipObs: fetch  lat=[%.4f, %.4f]  lon=[%.4f, %.4f]  age=%s  types=%s",
+                     bb.lat_min, bb.lat_max, bb.lon_min, bb.lon_max,
+                     s_max_age.c_str(), s_types.c_str());
+        wxLogMessage("ShipObs: URL: %s", url.c_str());
+
+        CURL *curl = http.Prepare(url, i);
+        if (!curl) {
+            error_msg = _("Failed to initialize HTTP client");
+            wxLogError("ShipObs: failed to initialize curl");
+            return false;
+        }
+        transfers.emplace_back(new Transfer(curl));
+        Transfer &t = *transfers.back();
+        t.index  = i;
+        t.url    = url;
+        t.fields = profile.fields;
+        t.sink.parser.SetFields(profile.fields);
+        if (a.since == TIME_UNKNOWN) t.sink.progress = progress;
+        // Deltas vary with `since` and are small anyway: no caching.
+        SetUpTransfer(curl, t, a.since == TIME_UNKNOWN ? cache : nullptr,
+                      progress ? &sum : nullptr);
+        handles.push_back(curl);
+    }
+
+    std::vector<CURLcode> results;
+    std::vector<HttpStats> stats;
+    if (areas.size() == 1) {
+        results.assign(1, http.Perform());
+        stats.assign(1, http.LastStats());
+    } else {
+        wxLongLong start = wxGetLocalTimeMillis();
+        http.PerformMany(areas.size(), max_parallel, results, stats);
+        double slowest = 0;
+        for (const HttpStats &st : stats) slowest = std::max(slowest, st.total_ms);
+        wxLogMessage("ShipObs: %zu requests, up to %d at a time, in %lld ms "
+                     "(slowest %.0f ms)", areas.size(), max_parallel,
+                     (wxGetLocalTimeMillis() - start).GetValue(), slowest);
+    }
+
+    bool ok = true;
+    for (size_t i = 0; i < areas.size(); i++) {
+        wxString err;
+        bool cache_it = areas[i].since == TIME_UNKNOWN;
+        if (!FinishTransfer(http, handles[i], *transfers[i], results[i],
+                            stats[i], server_url, cache_it ? cache : nullptr,
+                            areas[i].stations, err) && ok) {
+            ok = false;
+            error_msg = err;  // report the first failure
+        }
+    }
+    return ok;
+}
+
+bool FetchObservations(HttpClient &http,
+                       const wxString &server_url,
+                       double lat_min, double lat_max,
+                       double lon_min, double lon_max,
+                       const wxString &max_age,
+                       const wxString &types,
+                       const FetchProfile &profile,
+                       int64_t since,
+                       ResponseCache *cache,
+                       StationColumns &out,
+                       wxString &error_msg,
+                       FetchProgress *progress) {
+    BBox parts[2];
+    int n = SplitBbox(lat_min, lat_max, lon_min, lon_max, parts);
+    std::vector<AreaRequest> areas(n);
+    for (int i = 0; i < n; i++) {
+        areas[i].lat_min = parts[i].lat_min;
+        areas[i].lat_max = parts[i].lat_max;
+        areas[i].lon_min = parts[i].lon_min;
+        areas[i].lon_max = parts[i].lon_max;
+        areas[i].since   = since;
+    }
+    if (!FetchAreas(http, server_url, max_age, types, profile, areas, cache,
+                    n, error_msg, progress))
+        return false;
+
+    if (n == 1) {
+        out = std::move(areas[0].stations);
+        return true;
+    }
+    // Stations on the antimeridian itself come back from both halves.
+    StationColumns both;
+    for (const AreaRequest &a : areas) {
+        StationView v = a.stations.View();
+        for (size_t i = 0; i < v.count; i++) AppendStation(v, i, both);
+    }
+    MergeStations(StationView(), both.View(), TIME_UNKNOWN, out, nullptr);
+    return true;
 }
@@ -1,23 +1,87 @@
 #ifndef _SERVER_CLIENT_H_
 #define _SERVER_CLIENT_H_
 
-#include "observation.h"
+#include "history_store.h"
+#include "url_builder.h"
+#include <cstdint>
+#include <vector>
 #include <wx/string.h>
 
+class HttpClient;
+class ResponseCache;
+
+// Progress hook for a fetch running off the GUI thread. Called on the
+// fetching thread; returning false cancels the fetch. The body is parsed
+// as it arrives, so there is no separate parse stage to report.
+class FetchProgress {
+public:
+    virtual ~FetchProgress() {}
+    // received/total in bytes on the wire (compressed, if the server
+    // compressed the response); total is 0 while the size is unknown.
+    virtual bool OnDownload(size_t received, size_t total) = 0;
+    // Stations of a full (not delta) JSON response parsed so far, while it
+    // is still downloading; those from index first on are new since the
+    // last call for this response. Each area of a fetch reports its own.
+    virtual void OnStations(const StationView & /*stations*/, size_t /*first*/) {}
+};
+
+// One area of a multi-area fetch (see FetchAreas()).
+struct AreaRequest {
+    double lat_min, lat_max, lon_min, lon_max;  // within ±90 / ±180
+    int64_t since;              // delta fetch, or TIME_UNKNOWN
+    StationColumns stations;    // filled on success
+    AreaRequest() : lat_min(0), lat_max(0), lon_min(0), lon_max(0),
+                    since(TIME_UNKNOWN) {}
+};
+
+// Fetch several areas concurrently, at most max_parallel requests at a
+// time over the client's shared connections, so the whole fetch takes
+// about as long as its slowest request. Each area's stations are returned
+// separately. Fails (with the first error) if any request fails; progress
+// reports the bytes received by all requests together.
+bool FetchAreas(HttpClient &http,
+                const wxString &server_url,
+                const wxString &max_age,
+                const wxString &types,
+                const FetchProfile &profile,
+                std::vector<AreaRequest> &areas,
+                ResponseCache *cache,
+                int max_parallel,
+                wxString &error_msg,
+                FetchProgress *progress = nullptr);
+
 // Fetch observations from the server within the given bounding box.
 // Parameters:
+//   http        - Long-lived client; its open connection is reused
 //   server_url  - Base URL, e.g. "http://localhost:8080"
-//   lat_min/max, lon_min/max - Bounding box
+//   lat_min/max, lon_min/max - Bounding box. A box crossing the
+//                 antimeridian (lon_max > 180 as OpenCPN reports it, or
+//                 lon_min > lon_max, e.g. 170..-170) is fetched as two
+//                 concurrent requests whose results are merged
 //   max_age     - e.g. "6h", "12h", "24h"
 //   types       - Comma-separated, e.g. "ship,buoy,shore"
-//   out         - Filled with parsed observations on success
-// Returns true on success, false on HTTP or parse error.
-bool FetchObservations(const wxString &server_url,
+//   profile     - Fields and precision to ask for; fields left out are
+//                 missing (NaN) in the result
+//   since       - Epoch seconds: only stations observed after this (a
+//                 delta fetch); TIME_UNKNOWN fetches everything
+//   cache       - Optional response cache (may be null). A full fetch is
+//                 sent as a conditional request when the URL has a cached
+//                 response, and a 304 reply returns the cached stations
+//                 without downloading or parsing them again
+//   out         - Filled with the stations on success
+//   progress    - Optional progress/cancel hooks (may be null)
+// Returns true on success, false on HTTP or parse error or cancellation.
+bool FetchObservations(HttpClient &http,
+                       const wxString &server_url,
                        double lat_min, double lat_max,
                        double lon_min, double lon_max,
                        const wxString &max_age,
                        const wxString &types,
-                       ObservationList &out,
-                       wxString &error_msg);
+                       const FetchProfile &profile,
+                       int64_t since,
+                       ResponseCache *cache,
+                       StationColumns &out,
+                       wxString &error_msg,
+                       FetchProgress *progress = nullptr);
 
 #endif // _SERVER_CLIENT_H_
@@ -1,5 +1,6 @@
 #include "settings_dialog.h"
 #include "shipobs_pi.h"
+#include "url_builder.h"
 
 #include <wx/intl.h>
 #include <wx/sizer.h>
@@ -7,6 +8,11 @@
 #include <wx/stattext.h>
 #include <wx/button.h>
 
+// Labels for the field checklist, in FIELD_NAMES order (url_builder.h).
+static const char *const FIELD_LABELS[FIELD_COUNT] = {
+    "Wind direction", "Wind speed", "Gust", "Pressure",
+    "Air temperature", "Sea temperature", "Wave height", "Visibility"};
+
 enum {
     ID_SETTINGS_OK = 20001
 };
@@ -31,8 +37,67 @@ SettingsDialog::SettingsDialog(wxWindow *parent, shipobs_pi *plugin)
     m_server_url = new wxTextCtrl(this, wxID_ANY, plugin->GetServerURL(),
                                   wxDefaultPosition, wxSize(300, -1));
     serverSizer->Add(m_server_url, 0, wxALL | wxEXPAND, 4);
+    m_delta = new wxCheckBox(this, wxID_ANY,
+        _("Download only new reports when fetching an area again"));
+    m_delta->SetValue(plugin->GetDeltaFetch());
+    serverSizer->Add(m_delta, 0, wxALL, 4);
+    m_tiled = new wxCheckBox(this, wxID_ANY,
+        _("Reuse areas fetched in the last 5 minutes"));
+    m_tiled->SetValue(plugin->GetTiledFetch());
+    serverSizer->Add(m_tiled, 0, wxALL, 4);
+    m_warm_up = new wxCheckBox(this, wxID_ANY,
+        _("Connect to the server when OpenCPN starts"));
+    m_warm_up->SetValue(plugin->GetWarmUpConnection());
+    serverSizer->Add(m_warm_up, 0, wxALL, 4);
     topSizer->Add(serverSizer, 0, wxALL | wxEXPAND, 4);
 
+    // Bandwidth
+    wxStaticBoxSizer *bwSizer =
+        new wxStaticBoxSizer(wxVERTICAL, this, _("Bandwidth"));
+    m_low_bandwidth = new wxCheckBox(this, wxID_ANY,
+        _("Low bandwidth: download only these fields, rounded"));
+    m_low_bandwidth->SetValue(plugin->GetLowBandwidth());
+    bwSizer->Add(m_low_bandwidth, 0, wxALL, 4);
+    wxArrayString fieldLabels;
+    for (int m = 0; m < FIELD_COUNT; m++)
+        fieldLabels.Add(wxGetTranslation(FIELD_LABELS[m]));
+    m_fields = new wxCheckListBox(this, wxID_ANY, wxDefaultPosition,
+                                  wxDefaultSize, fieldLabels);
+    for (int m = 0; m < FIELD_COUNT; m++)
+        m_fields->Check(m, (plugin->GetFetchFields() >> m) & 1);
+    bwSizer->Add(m_fields, 0, wxALL | wxEXPAND, 4);
+    wxBoxSizer *budgetRow = new wxBoxSizer(wxHORIZONTAL);
+    budgetRow->Add(new wxStaticText(this, wxID_ANY, _("Daily limit (KB, 0 = none):")),
+                   0, wxALL | wxALIGN_CENTER_VERTICAL, 4);
+    m_budget = new wxSpinCtrl(this, wxID_ANY, wxEmptyString, wxDefaultPosition,
+                              wxDefaultSize, wxSP_ARROW_KEYS, 0, 1000000,
+                              plugin->GetDailyBudgetKB());
+    budgetRow->Add(m_budget, 0, wxALL, 4);
+    bwSizer->Add(budgetRow, 0, wxEXPAND);
+    topSizer->Add(bwSizer, 0, wxALL | wxEXPAND, 4);
+
+    // Auto-refresh
+    wxStaticBoxSizer *refreshSizer =
+        new wxStaticBoxSizer(wxHORIZONTAL, this, _("Auto-refresh"));
+    wxArrayString refreshModes;
+    refreshModes.Add(_("Off"));
+    refreshModes.Add(_("Chart view"));
+    refreshModes.Add(_("Area in Fetch new"));
+    m_auto_refresh = new wxChoice(this, wxID_ANY, wxDefaultPosition,
+                                  wxDefaultSize, refreshModes);
+    m_auto_refresh->SetSelection(plugin->GetAutoRefresh());
+    refreshSizer->Add(m_auto_refresh, 0, wxALL, 4);
+    refreshSizer->Add(new wxStaticText(this, wxID_ANY, _("every")),
+                      0, wxALL | wxALIGN_CENTER_VERTICAL, 4);
+    m_refresh_minutes = new wxSpinCtrl(this, wxID_ANY, wxEmptyString,
+                                       wxDefaultPosition, wxDefaultSize,
+                                       wxSP_ARROW_KEYS, 1, 1440,
+                                       plugin->GetRefreshMinutes());
+    refreshSizer->Add(m_refresh_minutes, 0, wxALL, 4);
+    refreshSizer->Add(new wxStaticText(this, wxID_ANY, _("minutes")),
+                      0, wxALL | wxALIGN_CENTER_VERTICAL, 4);
+    topSizer->Add(refreshSizer, 0, wxALL | wxEXPAND, 4);
+
     // Display options
     wxStaticBoxSizer *dispSizer =
         new wxStaticBoxSizer(wxVERTICAL, this, _("Display"));
@@ -40,8 +105,11 @@ SettingsDialog::SettingsDialog(wxWindow *parent, shipobs_pi *plugin)
     m_wind_barbs->SetValue(plugin->GetShowWindBarbs());
     m_labels = new wxCheckBox(this, wxID_ANY, _("Show station labels"));
     m_labels->SetValue(plugin->GetShowLabels());
+    m_clusters = new wxCheckBox(this, wxID_ANY, _("Group nearby stations"));
+    m_clusters->SetValue(plugin->GetClusterStations());
     dispSizer->Add(m_wind_barbs, 0, wxALL, 4);
     dispSizer->Add(m_labels, 0, wxALL, 4);
+    dispSizer->Add(m_clusters, 0, wxALL, 4);
     topSizer->Add(dispSizer, 0, wxALL | wxEXPAND, 4);
 
     // Info trigger
@@ -71,7 +139,19 @@ void SettingsDialog::OnOK(wxCommandEvent &event) {
     m_plugin->SetServerURL(m_server_url->GetValue());
     m_plugin->SetShowWindBarbs(m_wind_barbs->GetValue());
     m_plugin->SetShowLabels(m_labels->GetValue());
+    m_plugin->SetClusterStations(m_clusters->GetValue());
+    m_plugin->SetDeltaFetch(m_delta->GetValue());
+    m_plugin->SetTiledFetch(m_tiled->GetValue());
+    m_plugin->SetWarmUpConnection(m_warm_up->GetValue());
     m_plugin->SetInfoMode(m_info_trigger->GetSelection());
+    m_plugin->SetLowBandwidth(m_low_bandwidth->GetValue());
+    unsigned fields = 0;
+    for (int m = 0; m < FIELD_COUNT; m++)
+        if (m_fields->IsChecked(m)) fields |= 1u << m;
+    m_plugin->SetFetchFields(fields);
+    m_plugin->SetDailyBudgetKB(m_budget->GetValue());
+    m_plugin->SetAutoRefresh(m_auto_refresh->GetSelection());
+    m_plugin->SetRefreshMinutes(m_refresh_minutes->GetValue());
 
     EndModal(wxID_OK);
 }
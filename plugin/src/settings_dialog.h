@@ -4,7 +4,10 @@
 #include <wx/dialog.h>
 #include <wx/textctrl.h>
 #include <wx/checkbox.h>
+#include <wx/choice.h>
+#include <wx/checklst.h>
 #include <wx/radiobox.h>
+#include <wx/spinctrl.h>
 
 class shipobs_pi;
 
@@ -21,7 +24,16 @@ private:
     wxTextCtrl *m_server_url;
     wxCheckBox *m_wind_barbs;
     wxCheckBox *m_labels;
+    wxCheckBox *m_clusters;
+    wxCheckBox *m_delta;
+    wxCheckBox *m_tiled;
+    wxCheckBox *m_warm_up;
     wxRadioBox *m_info_trigger;
+    wxCheckBox     *m_low_bandwidth;
+    wxCheckListBox *m_fields;
+    wxSpinCtrl     *m_budget;
+    wxChoice       *m_auto_refresh;
+    wxSpinCtrl     *m_refresh_minutes;
 
     DECLARE_EVENT_TABLE()
 };
@@ -1,7 +1,9 @@
 #include "ship_reports_plugin_dialog.h"
 #include "shipobs_pi.h"
-#include "server_client.h"
+#include "fetch_worker.h"
 #include "gpx_builder.h"
+#include "station_view.h"
+#include "url_builder.h"
 
 #include <wx/sizer.h>
 #include <wx/arrstr.h>
@@ -16,9 +18,16 @@
 #include <sstream>
 #include <iomanip>
 #include <cmath>
+#include <utility>
+
+// Labels for the field checklist, in FIELD_NAMES order (url_builder.h).
+static const char *const FIELD_LABELS[FIELD_COUNT] = {
+    "Wind direction", "Wind speed", "Gust", "Pressure",
+    "Air temperature", "Sea temperature", "Wave height", "Visibility"};
 
 enum {
     ID_FETCH = 10001,
+    ID_CANCEL_FETCH,
     ID_CLOSE_BTN,
     ID_HISTORY_LIST,
     ID_EXPORT_GPX,
@@ -32,6 +41,7 @@ enum {
 
 BEGIN_EVENT_TABLE(ShipReportsPluginDialog, wxDialog)
     EVT_BUTTON(ID_FETCH,        ShipReportsPluginDialog::OnFetch)
+    EVT_BUTTON(ID_CANCEL_FETCH, ShipReportsPluginDialog::OnCancelFetch)
     EVT_BUTTON(ID_CLOSE_BTN,    ShipReportsPluginDialog::OnClose)
     EVT_CLOSE(                  ShipReportsPluginDialog::OnWindowClose)
     EVT_LIST_ITEM_SELECTED(ID_HISTORY_LIST, ShipReportsPluginDialog::OnHistorySelected)
@@ -48,7 +58,8 @@ ShipReportsPluginDialog::ShipReportsPluginDialog(wxWindow *parent, shipobs_pi *p
                wxDEFAULT_DIALOG_STYLE | wxRESIZE_BORDER),
       m_plugin(plugin),
       m_lat_min(-90), m_lat_max(90),
-      m_lon_min(-180), m_lon_max(180) {
+      m_lon_min(-180), m_lon_max(180),
+      m_partial_job(0) {
 
     wxBoxSizer *topSizer = new wxBoxSizer(wxVERTICAL);
 
@@ -154,7 +165,12 @@ ShipReportsPluginDialog::ShipReportsPluginDialog(wxWindow *parent, shipobs_pi *p
     p2Sizer->Add(0, 12, 1);
 
     m_fetch_btn = new wxButton(p2, ID_FETCH, _("Fetch"));
-    p2Sizer->Add(m_fetch_btn, 0, wxLEFT | wxRIGHT | wxEXPAND, 8);
+    m_cancel_fetch_btn = new wxButton(p2, ID_CANCEL_FETCH, _("Cancel"));
+    m_cancel_fetch_btn->Enable(false);
+    wxBoxSizer *fetchHbox = new wxBoxSizer(wxHORIZONTAL);
+    fetchHbox->Add(m_fetch_btn, 1, wxEXPAND);
+    fetchHbox->Add(m_cancel_fetch_btn, 0, wxEXPAND | wxLEFT, 6);
+    p2Sizer->Add(fetchHbox, 0, wxLEFT | wxRIGHT | wxEXPAND, 8);
 
     // Flexible space below Fetch button (min 12px)
     p2Sizer->Add(0, 12, 1);
@@ -177,14 +193,67 @@ ShipReportsPluginDialog::ShipReportsPluginDialog(wxWindow *parent, shipobs_pi *p
     m_settings_url = new wxTextCtrl(p3, wxID_ANY, wxEmptyString,
                                     wxDefaultPosition, wxSize(300, -1));
     serverBox->Add(m_settings_url, 0, wxALL | wxEXPAND, 4);
+    m_settings_delta = new wxCheckBox(p3, wxID_ANY,
+        _("Download only new reports when fetching an area again"));
+    serverBox->Add(m_settings_delta, 0, wxALL, 4);
+    m_settings_tiled = new wxCheckBox(p3, wxID_ANY,
+        _("Reuse areas fetched in the last 5 minutes"));
+    serverBox->Add(m_settings_tiled, 0, wxALL, 4);
+    m_settings_warm_up = new wxCheckBox(p3, wxID_ANY,
+        _("Connect to the server when OpenCPN starts"));
+    serverBox->Add(m_settings_warm_up, 0, wxALL, 4);
     p3Sizer->Add(serverBox, 0, wxALL | wxEXPAND, 6);
 
+    wxStaticBoxSizer *bwBox =
+        new wxStaticBoxSizer(wxVERTICAL, p3, _("Bandwidth"));
+    m_settings_low_bandwidth = new wxCheckBox(p3, wxID_ANY,
+        _("Low bandwidth: download only these fields, rounded"));
+    bwBox->Add(m_settings_low_bandwidth, 0, wxALL, 4);
+    wxArrayString fieldLabels;
+    for (int m = 0; m < FIELD_COUNT; m++)
+        fieldLabels.Add(wxGetTranslation(FIELD_LABELS[m]));
+    m_settings_fields = new wxCheckListBox(p3, wxID_ANY, wxDefaultPosition,
+                                           wxDefaultSize, fieldLabels);
+    bwBox->Add(m_settings_fields, 0, wxALL | wxEXPAND, 4);
+    wxBoxSizer *budgetRow = new wxBoxSizer(wxHORIZONTAL);
+    budgetRow->Add(new wxStaticText(p3, wxID_ANY, _("Daily limit (KB, 0 = none):")),
+                   0, wxALL | wxALIGN_CENTER_VERTICAL, 4);
+    m_settings_budget = new wxSpinCtrl(p3, wxID_ANY, wxEmptyString,
+                                       wxDefaultPosition, wxDefaultSize,
+                                       wxSP_ARROW_KEYS, 0, 1000000, 0);
+    budgetRow->Add(m_settings_budget, 0, wxALL, 4);
+    bwBox->Add(budgetRow, 0, wxEXPAND);
+    m_settings_traffic = new wxStaticText(p3, wxID_ANY, wxEmptyString);
+    bwBox->Add(m_settings_traffic, 0, wxALL, 4);
+    p3Sizer->Add(bwBox, 0, wxALL | wxEXPAND, 6);
+
+    wxStaticBoxSizer *refreshBox =
+        new wxStaticBoxSizer(wxHORIZONTAL, p3, _("Auto-refresh"));
+    wxArrayString refreshModes;
+    refreshModes.Add(_("Off"));
+    refreshModes.Add(_("Chart view"));
+    refreshModes.Add(_("Area in Fetch new"));
+    m_settings_auto_refresh = new wxChoice(p3, wxID_ANY, wxDefaultPosition,
+                                           wxDefaultSize, refreshModes);
+    refreshBox->Add(m_settings_auto_refresh, 0, wxALL, 4);
+    refreshBox->Add(new wxStaticText(p3, wxID_ANY, _("every")),
+                    0, wxALL | wxALIGN_CENTER_VERTICAL, 4);
+    m_settings_refresh_minutes = new wxSpinCtrl(p3, wxID_ANY, wxEmptyString,
+                                                wxDefaultPosition, wxDefaultSize,
+                                                wxSP_ARROW_KEYS, 1, 1440, 10);
+    refreshBox->Add(m_settings_refresh_minutes, 0, wxALL, 4);
+    refreshBox->Add(new wxStaticText(p3, wxID_ANY, _("minutes")),
+                    0, wxALL | wxALIGN_CENTER_VERTICAL, 4);
+    p3Sizer->Add(refreshBox, 0, wxALL | wxEXPAND, 6);
+
     wxStaticBoxSizer *dispBox =
         new wxStaticBoxSizer(wxVERTICAL, p3, _("Display"));
     m_settings_wind_barbs = new wxCheckBox(p3, wxID_ANY, _("Show wind barbs"));
     m_settings_labels     = new wxCheckBox(p3, wxID_ANY, _("Show station labels"));
+    m_settings_clusters   = new wxCheckBox(p3, wxID_ANY, _("Group nearby stations"));
     dispBox->Add(m_settings_wind_barbs, 0, wxALL, 4);
     dispBox->Add(m_settings_labels,     0, wxALL, 4);
+    dispBox->Add(m_settings_clusters,   0, wxALL, 4);
     p3Sizer->Add(dispBox, 0, wxALL | wxEXPAND, 6);
 
     wxArrayString infoModes;
@@ -230,13 +299,35 @@ ShipReportsPluginDialog::ShipReportsPluginDialog(wxWindow *parent, shipobs_pi *p
     m_lon_min_ctrl->Bind(wxEVT_KILL_FOCUS, &ShipReportsPluginDialog::OnCoordBlur, this);
     m_lon_max_ctrl->Bind(wxEVT_KILL_FOCUS, &ShipReportsPluginDialog::OnCoordBlur, this);
 
+    Bind(EVT_SHIPOBS_FETCH_PROGRESS, &ShipReportsPluginDialog::OnFetchProgress, this);
+    Bind(EVT_SHIPOBS_FETCH_DONE,     &ShipReportsPluginDialog::OnFetchDone, this);
+    Bind(EVT_SHIPOBS_FETCH_STATIONS, &ShipReportsPluginDialog::OnFetchStations, this);
+
     m_settings_url->Bind(wxEVT_KILL_FOCUS, &ShipReportsPluginDialog::OnSettingsUrlBlur, this);
     m_settings_wind_barbs->Bind(wxEVT_CHECKBOX,
         [this](wxCommandEvent&) { ApplySettings(); });
     m_settings_labels->Bind(wxEVT_CHECKBOX,
         [this](wxCommandEvent&) { ApplySettings(); });
+    m_settings_clusters->Bind(wxEVT_CHECKBOX,
+        [this](wxCommandEvent&) { ApplySettings(); });
+    m_settings_delta->Bind(wxEVT_CHECKBOX,
+        [this](wxCommandEvent&) { ApplySettings(); });
+    m_settings_tiled->Bind(wxEVT_CHECKBOX,
+        [this](wxCommandEvent&) { ApplySettings(); });
+    m_settings_warm_up->Bind(wxEVT_CHECKBOX,
+        [this](wxCommandEvent&) { ApplySettings(); });
     m_settings_info_mode->Bind(wxEVT_RADIOBOX,
         [this](wxCommandEvent&) { ApplySettings(); });
+    m_settings_low_bandwidth->Bind(wxEVT_CHECKBOX,
+        [this](wxCommandEvent&) { ApplySettings(); });
+    m_settings_fields->Bind(wxEVT_CHECKLISTBOX,
+        [this](wxCommandEvent&) { ApplySettings(); });
+    m_settings_budget->Bind(wxEVT_SPINCTRL,
+        [this](wxSpinEvent&) { ApplySettings(); });
+    m_settings_auto_refresh->Bind(wxEVT_CHOICE,
+        [this](wxCommandEvent&) { ApplySettings(); UpdateAutoRefresh(); });
+    m_settings_refresh_minutes->Bind(wxEVT_SPINCTRL,
+        [this](wxSpinEvent&) { ApplySettings(); UpdateAutoRefresh(); });
 
     PopulateAreaControls();
     ValidateCoords();
@@ -257,35 +348,66 @@ void ShipReportsPluginDialog::PopulateSettingsControls() {
     m_settings_url->SetValue(m_plugin->GetServerURL());
     m_settings_wind_barbs->SetValue(m_plugin->GetShowWindBarbs());
     m_settings_labels->SetValue(m_plugin->GetShowLabels());
+    m_settings_clusters->SetValue(m_plugin->GetClusterStations());
+    m_settings_delta->SetValue(m_plugin->GetDeltaFetch());
+    m_settings_tiled->SetValue(m_plugin->GetTiledFetch());
+    m_settings_warm_up->SetValue(m_plugin->GetWarmUpConnection());
     m_settings_info_mode->SetSelection(m_plugin->GetInfoMode());
+    m_settings_low_bandwidth->SetValue(m_plugin->GetLowBandwidth());
+    for (int m = 0; m < FIELD_COUNT; m++)
+        m_settings_fields->Check(m, (m_plugin->GetFetchFields() >> m) & 1);
+    m_settings_fields->Enable(m_plugin->GetLowBandwidth());
+    m_settings_budget->SetValue(m_plugin->GetDailyBudgetKB());
+    m_settings_auto_refresh->SetSelection(m_plugin->GetAutoRefresh());
+    m_settings_refresh_minutes->SetValue(m_plugin->GetRefreshMinutes());
+    UpdateTrafficLabel();
 }
 
 void ShipReportsPluginDialog::ApplySettings() {
     m_plugin->SetServerURL(m_settings_url->GetValue());
     m_plugin->SetShowWindBarbs(m_settings_wind_barbs->GetValue());
     m_plugin->SetShowLabels(m_settings_labels->GetValue());
+    m_plugin->SetClusterStations(m_settings_clusters->GetValue());
+    m_plugin->SetDeltaFetch(m_settings_delta->GetValue());
+    m_plugin->SetTiledFetch(m_settings_tiled->GetValue());
+    m_plugin->SetWarmUpConnection(m_settings_warm_up->GetValue());
     m_plugin->SetInfoMode(m_settings_info_mode->GetSelection());
+    m_plugin->SetLowBandwidth(m_settings_low_bandwidth->GetValue());
+    unsigned fields = 0;
+    for (int m = 0; m < FIELD_COUNT; m++)
+        if (m_settings_fields->IsChecked(m)) fields |= 1u << m;
+    m_plugin->SetFetchFields(fields);
+    m_settings_fields->Enable(m_plugin->GetLowBandwidth());
+    m_plugin->SetDailyBudgetKB(m_settings_budget->GetValue());
+    m_plugin->SetAutoRefresh(m_settings_auto_refresh->GetSelection());
+    m_plugin->SetRefreshMinutes(m_settings_refresh_minutes->GetValue());
     m_plugin->SaveConfig();
     RequestRefresh(m_plugin->GetParentWindow());
 }
 
+void ShipReportsPluginDialog::UpdateTrafficLabel() {
+    const TrafficMeter &meter = m_plugin->GetTraffic();
+    int64_t now = EpochFromDateTime(wxDateTime::Now().ToUTC());
+    m_settings_traffic->SetLabel(wxString::Format(
+        _("Downloaded: %.1f KB this session, %.1f KB today"),
+        meter.SessionBytes() / 1024.0, meter.DayBytes(now) / 1024.0));
+}
+
 void ShipReportsPluginDialog::OnSettingsUrlBlur(wxFocusEvent &event) {
     ApplySettings();
     event.Skip();
 }
 
-// Normalize viewport longitudes to [-180, 180], matching the clamping in
-// server_client.cpp. OpenCPN can return lon_min < -180 when panned past the
-// antimeridian (e.g. lon_min=-259, lon_max=100).
+// Normalize viewport longitudes to [-180, 180], matching SplitBbox() in
+// url_builder.h. OpenCPN can return lon_min < -180 or lon_max > 180 when
+// panned past the antimeridian (e.g. lon_min=-259, lon_max=100); a view
+// still crossing it is kept as lon_min > lon_max (e.g. 160..-140) and
+// fetched as two areas.
 static void ClampViewportLon(double &lon_min, double &lon_max) {
-    if (lon_max - lon_min >= 360.0) {
-        lon_min = -180.0; lon_max = 180.0;
-    } else {
-        while (lon_min < -180.0) { lon_min += 360.0; lon_max += 360.0; }
-        while (lon_min >  180.0) { lon_min -= 360.0; lon_max -= 360.0; }
-        lon_min = std::max(-180.0, lon_min);
-        lon_max = std::min( 180.0, lon_max);
-    }
+    BBox parts[2];
+    int n = SplitBbox(0.0, 0.0, lon_min, lon_max, parts);
+    lon_min = parts[0].lon_min;
+    lon_max = parts[n - 1].lon_max;
 }
 
 void ShipReportsPluginDialog::PopulateAreaControls() {
@@ -329,9 +451,7 @@ void ShipReportsPluginDialog::RefreshHistory() {
                                      wxLIST_STATE_SELECTED);
         m_history_list->EnsureVisible(last);
         m_export_gpx_btn->Enable(true);
-        ObservationList stations;
-        if (m_plugin->LoadStationsForEntry((size_t)last, stations))
-            m_plugin->SetStations(stations);
+        m_plugin->ShowHistoryEntry((size_t)last);
         m_notebook->SetSelection(0);  // show Ship Reports tab
     } else {
         m_notebook->SetSelection(1);  // show Fetch new tab
@@ -388,7 +508,10 @@ bool ShipReportsPluginDialog::ValidateCoords() {
         return true;
     }
 
-    m_coord_error->SetLabel(_("Latitude: \u221290.0 to 90.0  \u00b7  Longitude: \u2212180.0 to 180.0"));
+    if (lon_min > lon_max)
+        m_coord_error->SetLabel(_("Area crosses the 180\u00b0 meridian: Longitude min to 180.0 and \u2212180.0 to Longitude max"));
+    else
+        m_coord_error->SetLabel(_("Latitude: \u221290.0 to 90.0  \u00b7  Longitude: \u2212180.0 to 180.0"));
     m_coord_error->SetForegroundColour(
         wxSystemSettings::GetColour(wxSYS_COLOUR_GRAYTEXT));
     m_coord_error->GetParent()->Layout();
@@ -410,7 +533,9 @@ void ShipReportsPluginDialog::OnSize(wxSizeEvent &event) {
     CallAfter([this]() { AdjustColumns(); });
 }
 
-void ShipReportsPluginDialog::OnFetch(wxCommandEvent & /*event*/) {
+// Fill job from the Fetch new tab and the settings; with_area, also the
+// area. Returns false, with the reason in the status line, if it can't.
+bool ShipReportsPluginDialog::BuildJob(FetchJob &job, bool with_area) {
     // Build types string
     wxString types;
     if (m_chk_ship->GetValue())    { if (!types.IsEmpty()) types += wxT(","); types += wxT("ship"); }
@@ -421,61 +546,222 @@ void ShipReportsPluginDialog::OnFetch(wxCommandEvent & /*event*/) {
 
     if (types.IsEmpty()) {
         m_status_label->SetLabel(_("Select at least one platform type"));
-        return;
+        return false;
     }
 
-    // Coords are pre-validated (Fetch button is disabled when invalid)
-    double lat_min, lat_max, lon_min, lon_max;
-    auto parseCoord = [](wxTextCtrl *ctrl, double &val) -> bool {
-        wxString s = ctrl->GetValue().Trim();
-        s.Replace(wxT(","), wxT("."));
-        return s.ToDouble(&val);
-    };
-    if (!parseCoord(m_lat_min_ctrl, lat_min) ||
-        !parseCoord(m_lat_max_ctrl, lat_max) ||
-        !parseCoord(m_lon_min_ctrl, lon_min) ||
-        !parseCoord(m_lon_max_ctrl, lon_max)) {
-        return;  // should not happen — button is disabled when invalid
+    if (with_area) {
+        // Coords are pre-validated (Fetch button is disabled when invalid)
+        auto parseCoord = [](wxTextCtrl *ctrl, double &val) -> bool {
+            wxString s = ctrl->GetValue().Trim();
+            s.Replace(wxT(","), wxT("."));
+            return s.ToDouble(&val);
+        };
+        if (!parseCoord(m_lat_min_ctrl, job.lat_min) ||
+            !parseCoord(m_lat_max_ctrl, job.lat_max) ||
+            !parseCoord(m_lon_min_ctrl, job.lon_min) ||
+            !parseCoord(m_lon_max_ctrl, job.lon_max)) {
+            return false;  // should not happen — button is disabled when invalid
+        }
     }
 
-    wxString max_age = m_max_age->GetString(m_max_age->GetSelection());
+    job.server_url = m_plugin->GetServerURL();
+    job.max_age    = m_max_age->GetString(m_max_age->GetSelection());
+    job.types      = types;
+    job.tiled      = m_plugin->GetTiledFetch();
+    job.delta      = m_plugin->GetDeltaFetch();
+    job.max_parallel = m_plugin->GetMaxParallelRequests();
+    job.profile    = m_plugin->GetFetchProfile();
+    return true;
+}
+
+void ShipReportsPluginDialog::OnFetch(wxCommandEvent & /*event*/) {
+    FetchJob job;
+    if (!BuildJob(job, true)) return;
 
+    FetchWorker *worker = m_plugin->GetFetchWorker();
+    if (!worker) {
+        m_status_label->SetLabel(_("Error: background fetch is unavailable"));
+        return;
+    }
+    if (m_plugin->OverDailyBudget()) {
+        m_status_label->SetLabel(wxString::Format(
+            _("Daily download limit of %d KB reached"),
+            m_plugin->GetDailyBudgetKB()));
+        return;
+    }
+
+    if (job.delta && !job.tiled)
+        job.base = m_plugin->GetDeltaBase(job, job.since);
+
+    // Runs on the fetch thread; the canvas stays interactive meanwhile.
+    worker->Enqueue(job, this);
     m_status_label->SetLabel(_("Fetching..."));
-    Update();
+    m_cancel_fetch_btn->Enable(true);
+}
+
+void ShipReportsPluginDialog::UpdateAutoRefresh() {
+    FetchWorker *worker = m_plugin->GetFetchWorker();
+    if (!worker) return;
+    int mode = m_plugin->GetAutoRefresh();
+    FetchJob job;
+    if (mode == 0 || !IsShown() || m_plugin->OverDailyBudget() ||
+        !BuildJob(job, mode == 2)) {
+        worker->StopAutoRefresh();
+        return;
+    }
+    if (mode == 1) {
+        if (!m_plugin->HasViewPort()) {
+            worker->StopAutoRefresh();
+            return;
+        }
+        PlugIn_ViewPort vp = m_plugin->GetCurrentViewPort();
+        job.lat_min = vp.lat_min;
+        job.lat_max = vp.lat_max;
+        job.lon_min = vp.lon_min;
+        job.lon_max = vp.lon_max;
+    }
+    RefreshOptions opt;
+    opt.interval_ms = m_plugin->GetRefreshMinutes() * 60000LL;
+    worker->StartAutoRefresh(job, opt, mode == 1, this);
+}
 
-    ObservationList stations;
-    wxString error;
-    bool ok = FetchObservations(
-        m_plugin->GetServerURL(),
-        lat_min, lat_max, lon_min, lon_max,
-        max_age, types, stations, error);
+void ShipReportsPluginDialog::OnCancelFetch(wxCommandEvent & /*event*/) {
+    if (m_plugin->GetFetchWorker())
+        m_plugin->GetFetchWorker()->CancelAll();
+    m_status_label->SetLabel(_("Cancelling..."));
+}
 
-    if (ok) {
+void ShipReportsPluginDialog::OnFetchProgress(wxThreadEvent &event) {
+    if (event.GetInt() == FETCH_STAGE_DOWNLOAD)
+        m_status_label->SetLabel(wxString::Format(
+            _("Fetching... %.1f KB received"), event.GetExtraLong() / 1024.0));
+}
+
+// Stations of a fetch still downloading: the first set replaces what is
+// shown, later ones are added to it.
+void ShipReportsPluginDialog::OnFetchStations(wxThreadEvent &event) {
+    FetchPartialPtr part = event.GetPayload<FetchPartialPtr>();
+    FetchWorker *worker = m_plugin->GetFetchWorker();
+    if (!worker || !IsShown() || worker->IsCancelled(part->job_id)) return;
+    if (part->job_id != m_partial_job) {
+        m_partial_job = part->job_id;
+        m_plugin->SetStations(std::move(part->stations));
+    } else {
+        m_plugin->AppendStations(part->stations);
+    }
+    m_status_label->SetLabel(wxString::Format(
+        _("Fetching... %zu stations so far"), m_plugin->GetStations().Size()));
+}
+
+// After a fetch that showed partial stations failed: back to the history
+// entry selected, if any.
+void ShipReportsPluginDialog::RestoreShownStations() {
+    long sel = m_history_list->GetNextItem(-1, wxLIST_NEXT_ALL,
+                                           wxLIST_STATE_SELECTED);
+    if (sel >= 0)
+        m_plugin->ShowHistoryEntry(static_cast<size_t>(sel));
+    else
+        m_plugin->ClearStations();
+}
+
+// Results are applied here, on the GUI thread, never on the fetch thread.
+void ShipReportsPluginDialog::OnFetchDone(wxThreadEvent &event) {
+    FetchResultPtr res = event.GetPayload<FetchResultPtr>();
+    FetchWorker *worker = m_plugin->GetFetchWorker();
+    bool more_pending = worker && worker->GetPendingCount() > 0;
+    m_cancel_fetch_btn->Enable(more_pending);
+    bool showed_partial = res->job_id == m_partial_job;
+    if (showed_partial) m_partial_job = 0;
+
+    // Failed and cancelled fetches count too: the bytes came in regardless.
+    if (res->bytes) {
+        m_plugin->AddTraffic(res->bytes);
+        UpdateTrafficLabel();
+        if (worker && m_plugin->OverDailyBudget()) worker->StopAutoRefresh();
+    }
+
+    // A job can finish just before the dialog cancels it on close: its
+    // stations must not come back on a chart the dialog has cleared.
+    bool dropped = !IsShown() || (worker && worker->IsCancelled(res->job_id));
+
+    // Refreshes only replace what is shown; they don't add history entries.
+    if (res->job.automatic) {
+        if (dropped) return;
+        if (res->ok) {
+            size_t count = res->stations.Size();
+            m_plugin->SetStations(std::move(res->stations));
+            if (!more_pending)
+                m_status_label->SetLabel(wxString::Format(
+                    _("Refreshed at %s UTC (%zu stations)"),
+                    wxDateTime::Now().ToUTC().Format(wxT("%H:%M")), count));
+        } else if (!res->cancelled) {
+            m_status_label->SetLabel(wxString::Format(
+                _("Auto-refresh failed: %s"), res->error));
+        }
+        return;
+    }
+
+    if (res->ok) {
         FetchRecord rec;
         rec.fetched_at    = wxDateTime::Now().ToUTC();
         rec.label         = rec.fetched_at.Format(wxT("%Y-%m-%d %H:%M"));
-        rec.lat_min       = lat_min;
-        rec.lat_max       = lat_max;
-        rec.lon_min       = lon_min;
-        rec.lon_max       = lon_max;
-        rec.station_count = stations.size();
-
-        m_plugin->AppendFetch(rec, stations);
-        m_plugin->SetStations(stations);
-        m_status_label->SetLabel(_("Ready"));
-        RefreshHistory();  // also switches to Tab 1
+        rec.lat_min       = res->job.lat_min;
+        rec.lat_max       = res->job.lat_max;
+        rec.lon_min       = res->job.lon_min;
+        rec.lon_max       = res->job.lon_max;
+        rec.station_count = res->stations.Size();
+
+        if (!res->job.tiled)
+            m_plugin->RememberFetch(res->job, res->stations);
+        if (res->job.base)
+            m_plugin->SetStationOrderHint(std::move(res->carry));
+
+        bool saved = m_plugin->AppendFetch(rec, res->stations);
+        if (dropped) {
+            // Kept in the history, but not shown.
+            if (showed_partial && IsShown()) RestoreShownStations();
+            if (!more_pending) m_status_label->SetLabel(_("Cancelled"));
+            return;
+        }
+        if (more_pending)
+            m_status_label->SetLabel(_("Fetching..."));
+        else if (res->job.tiled)
+            m_status_label->SetLabel(wxString::Format(
+                _("Ready (%zu areas reused, %zu updated, %zu downloaded)"),
+                res->tiles.cached, res->tiles.refreshed, res->tiles.downloaded));
+        else if (res->job.base)
+            m_status_label->SetLabel(wxString::Format(
+                _("Ready (%zu updated, %zu new, %zu expired)"),
+                res->merge.updated, res->merge.added, res->merge.expired));
+        else
+            m_status_label->SetLabel(_("Ready"));
+        RefreshHistory();  // also switches to Tab 1 and shows the new entry
+        if (!saved) m_plugin->SetStations(std::move(res->stations));  // not on disk
+    } else if (res->cancelled || dropped) {
+        // A hidden dialog has cleared the chart already.
+        if (showed_partial && IsShown()) RestoreShownStations();
+        if (!more_pending) m_status_label->SetLabel(_("Cancelled"));
     } else {
-        m_status_label->SetLabel(wxString::Format(_("Error: %s"), error));
+        if (showed_partial) RestoreShownStations();
+        m_status_label->SetLabel(wxString::Format(_("Error: %s"), res->error));
     }
 }
 
 void ShipReportsPluginDialog::OnClose(wxCommandEvent & /*event*/) {
-    m_plugin->SetStations(ObservationList());
+    if (m_plugin->GetFetchWorker()) {
+        m_plugin->GetFetchWorker()->StopAutoRefresh();
+        m_plugin->GetFetchWorker()->CancelAll();
+    }
+    m_plugin->ClearStations();
     Hide();
 }
 
 void ShipReportsPluginDialog::OnWindowClose(wxCloseEvent & /*event*/) {
-    m_plugin->SetStations(ObservationList());
+    if (m_plugin->GetFetchWorker()) {
+        m_plugin->GetFetchWorker()->StopAutoRefresh();
+        m_plugin->GetFetchWorker()->CancelAll();
+    }
+    m_plugin->ClearStations();
     Hide();
 }
 
@@ -483,9 +769,7 @@ void ShipReportsPluginDialog::OnHistorySelected(wxListEvent &event) {
     long idx = event.GetIndex();
     const FetchHistory &hist = m_plugin->GetFetchHistory();
     if (idx >= 0 && idx < (long)hist.size()) {
-        ObservationList stations;
-        if (m_plugin->LoadStationsForEntry((size_t)idx, stations))
-            m_plugin->SetStations(stations);
+        m_plugin->ShowHistoryEntry((size_t)idx);
         m_export_gpx_btn->Enable(true);
         m_delete_entry_btn->Enable(true);
     }
@@ -497,7 +781,7 @@ void ShipReportsPluginDialog::OnDeleteEntry(wxCommandEvent & /*event*/) {
     if (sel == -1) return;
 
     m_plugin->RemoveFetch((size_t)sel);
-    m_plugin->SetStations(ObservationList());
+    m_plugin->ClearStations();
 
     RefreshHistory();
 
@@ -509,7 +793,7 @@ void ShipReportsPluginDialog::OnDeleteEntry(wxCommandEvent & /*event*/) {
 
 // Write stations as GPX waypoints to a file.
 static bool WriteGPXFile(const wxString &filepath, const wxDateTime &fetched_at,
-                         const ObservationList &stations) {
+                         const StationStore &stations) {
     wxFile f;
     if (!f.Open(filepath, wxFile::write)) return false;
     wxString gpx = BuildGPXString(fetched_at, stations);
@@ -527,8 +811,8 @@ void ShipReportsPluginDialog::OnExportGPX(wxCommandEvent & /*event*/) {
     if (sel >= (long)hist.size()) return;
     const FetchRecord &rec = hist[sel];
 
-    ObservationList stations;
-    if (!m_plugin->LoadStationsForEntry((size_t)sel, stations)) {
+    StationStore stations;
+    if (!m_plugin->MapHistoryEntry((size_t)sel, stations)) {
         wxMessageBox(_("Failed to load station data from disk"),
                      _("Error"), wxOK | wxICON_ERROR, this);
         return;
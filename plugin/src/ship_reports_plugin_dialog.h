@@ -8,15 +8,19 @@
 #include <wx/panel.h>
 #include <wx/choice.h>
 #include <wx/checkbox.h>
+#include <wx/checklst.h>
 #include <wx/radiobox.h>
+#include <wx/spinctrl.h>
 #include <wx/stattext.h>
 #include <wx/textctrl.h>
 #include <wx/button.h>
 #include <wx/listctrl.h>
 #include <wx/statline.h>
 #include <wx/statbox.h>
+#include <wx/event.h>
 
 class shipobs_pi;
+struct FetchJob;
 
 class ShipReportsPluginDialog : public wxDialog {
 public:
@@ -25,9 +29,18 @@ public:
 
     void UpdateViewportBounds(const PlugIn_ViewPort &vp);
     void RefreshHistory();
+    // Start, restart or stop the auto-refresh as the settings say. It only
+    // runs while the dialog is shown: its stations are on the chart only then.
+    void UpdateAutoRefresh();
 
 private:
     void OnFetch(wxCommandEvent &event);
+    bool BuildJob(FetchJob &job, bool with_area);
+    void OnCancelFetch(wxCommandEvent &event);
+    void OnFetchProgress(wxThreadEvent &event);
+    void OnFetchDone(wxThreadEvent &event);
+    void OnFetchStations(wxThreadEvent &event);
+    void RestoreShownStations();
     void OnClose(wxCommandEvent &event);
     void OnWindowClose(wxCloseEvent &event);
     void OnHistorySelected(wxListEvent &event);
@@ -44,6 +57,7 @@ private:
     void PopulateSettingsControls();
     void ApplySettings();
     void OnSettingsUrlBlur(wxFocusEvent &event);
+    void UpdateTrafficLabel();
 
     shipobs_pi *m_plugin;
 
@@ -67,6 +81,7 @@ private:
     wxTextCtrl   *m_lon_max_ctrl;
     wxStaticText *m_coord_error;
     wxButton     *m_fetch_btn;
+    wxButton     *m_cancel_fetch_btn;
     wxStaticText *m_status_label;
 
     double m_lat_min, m_lat_max, m_lon_min, m_lon_max;
@@ -75,7 +90,19 @@ private:
     wxTextCtrl *m_settings_url;
     wxCheckBox *m_settings_wind_barbs;
     wxCheckBox *m_settings_labels;
+    wxCheckBox *m_settings_clusters;
+    wxCheckBox *m_settings_delta;
+    wxCheckBox *m_settings_tiled;
+    wxCheckBox *m_settings_warm_up;
     wxRadioBox *m_settings_info_mode;
+    wxCheckBox     *m_settings_low_bandwidth;
+    wxCheckListBox *m_settings_fields;
+    wxSpinCtrl     *m_settings_budget;
+    wxStaticText   *m_settings_traffic;
+    wxChoice       *m_settings_auto_refresh;
+    wxSpinCtrl     *m_settings_refresh_minutes;
+
+    unsigned m_partial_job;   // job whose stations are shown while it runs
 
     DECLARE_EVENT_TABLE()
 };
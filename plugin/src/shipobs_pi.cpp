@@ -4,17 +4,23 @@
 #include "station_popup.h"
 #include "station_info_frame.h"
 #include "settings_dialog.h"
+#include "fetch_worker.h"
+#include "obs_parser.h"
+#include "station_view.h"
+#include "station_merge.h"
+#include "url_builder.h"
 
 #include <wx/app.h>
 #include <wx/intl.h>
 #include <wx/fileconf.h>
 #include <wx/file.h>
+#include <wx/filefn.h>
 #include <wx/log.h>
 #include <wx/jsonreader.h>
-#include <wx/jsonwriter.h>
 #include <wx/jsonval.h>
 #include <algorithm>
 #include <cmath>
+#include <utility>
 
 
 // Factory functions required by OpenCPN plugin loader
@@ -24,6 +30,17 @@ extern "C" DECL_EXP opencpn_plugin *create_pi(void *ppimgr) {
 
 extern "C" DECL_EXP void destroy_pi(opencpn_plugin *p) { delete p; }
 
+// Where the history store and the response cache live.
+static wxString HistoryDir() {
+    wxString *pdir = GetpPrivateApplicationDataLocation();
+    if (!pdir || pdir->IsEmpty()) return wxT("");
+    return *pdir + wxFILE_SEP_PATH;
+}
+
+// Low-bandwidth mode fetches wind and pressure unless told otherwise.
+static const unsigned DEFAULT_FETCH_FIELDS =
+    (1u << METRIC_WIND_DIR) | (1u << METRIC_WIND_SPD) | (1u << METRIC_PRESSURE);
+
 // ---------- Construction / Destruction ----------
 
 shipobs_pi::shipobs_pi(void *ppimgr)
@@ -33,10 +50,21 @@ shipobs_pi::shipobs_pi(void *ppimgr)
       m_request_dialog(nullptr),
       m_settings_dialog(nullptr),
       m_station_popup(nullptr),
+      m_fetch_worker(nullptr),
       m_cursor_lat(0), m_cursor_lon(0),
       m_server_url(wxT("http://localhost:8080")),
       m_show_wind_barbs(true),
       m_show_labels(false),
+      m_cluster_stations(true),
+      m_warm_up_connection(false),
+      m_delta_fetch(true),
+      m_tiled_fetch(true),
+      m_max_parallel(4),
+      m_low_bandwidth(false),
+      m_fetch_fields(DEFAULT_FETCH_FIELDS),
+      m_daily_budget_kb(0),
+      m_auto_refresh(0),
+      m_refresh_minutes(10),
       m_info_mode(2),
       m_erase_history_after(0),
       m_vp_valid(false) {}
@@ -75,6 +103,22 @@ int shipobs_pi::Init(void) {
     LoadConfig();
     LoadHistory();
 
+    wxString cache_dir = HistoryDir();
+    if (!cache_dir.IsEmpty()) {
+        m_response_cache.Open(ToUTF8String(cache_dir + wxT("shipobs_cache")));
+        m_tiles.Open(ToUTF8String(cache_dir + wxT("shipobs_tiles")));
+    }
+
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    m_fetch_worker = new FetchWorker(&m_http, &m_response_cache, &m_tiles);
+    if (m_fetch_worker->Run() != wxTHREAD_NO_ERROR) {
+        wxLogError("ShipObs: failed to start fetch thread");
+        delete m_fetch_worker;
+        m_fetch_worker = nullptr;
+    } else if (m_warm_up_connection && !OverDailyBudget()) {
+        m_fetch_worker->WarmUp(m_server_url);
+    }
+
     return WANTS_OVERLAY_CALLBACK | WANTS_OPENGL_OVERLAY_CALLBACK |
            WANTS_CURSOR_LATLON | WANTS_CONFIG | WANTS_MOUSE_EVENTS |
            INSTALLS_TOOLBAR_TOOL;
@@ -83,6 +127,15 @@ int shipobs_pi::Init(void) {
 bool shipobs_pi::DeInit(void) {
     SaveConfig();  // history is always on disk already
 
+    // Join the fetch thread before destroying the dialog it posts events to.
+    if (m_fetch_worker) {
+        m_fetch_worker->Stop();
+        delete m_fetch_worker;
+        m_fetch_worker = nullptr;
+    }
+    m_http.Close();
+    curl_global_cleanup();
+
     if (m_request_dialog) {
         m_request_dialog->Destroy();
         m_request_dialog = nullptr;
@@ -141,12 +194,14 @@ void shipobs_pi::OnToolbarToolCallback(int id) {
     if (will_show) {
         m_request_dialog->RefreshHistory();
     }
+    m_request_dialog->UpdateAutoRefresh();
 }
 
 void shipobs_pi::ShowPreferencesDialog(wxWindow *parent) {
     SettingsDialog dlg(parent, this);
     if (dlg.ShowModal() == wxID_OK) {
         SaveConfig();
+        if (m_request_dialog) m_request_dialog->UpdateAutoRefresh();
         RequestRefresh(m_parent_window);
     }
 }
@@ -164,13 +219,68 @@ void shipobs_pi::OnParentActivate(wxActivateEvent &event) {
 
 bool shipobs_pi::MouseEventHook(wxMouseEvent &event) {
     return HandleStationPopup(this, event, m_cursor_lat, m_cursor_lon,
-                              m_vp, m_station_popup, m_parent_window);
+                              m_station_popup, m_parent_window);
+}
+
+// Re-project the stations if the viewport changed (or the station set did,
+// see Invalidate()) since the last render. Returns true if it did.
+bool shipobs_pi::UpdateProjection(PlugIn_ViewPort *vp) {
+    ProjectionKey key;
+    key.clat            = vp->clat;
+    key.clon            = vp->clon;
+    key.view_scale_ppm  = vp->view_scale_ppm;
+    key.skew            = vp->skew;
+    key.rotation        = vp->rotation;
+    key.pix_width       = vp->pix_width;
+    key.pix_height      = vp->pix_height;
+    key.projection_type = vp->m_projection_type;
+    if (m_projection.IsCurrent(key)) return false;
+
+    PlugIn_ViewPort vp_copy = *vp;
+    m_projection.Rebuild(key, m_stations,
+                         [&vp_copy](double lat, double lon, float &x, float &y) {
+        wxPoint pt;
+        GetCanvasPixLL(&vp_copy, &pt, lat, lon);
+        x = static_cast<float>(pt.x);
+        y = static_cast<float>(pt.y);
+    });
+    if (m_cluster_stations)
+        m_clusters.Build(m_stations, m_projection);
+    else
+        m_clusters.Clear();
+    return true;
+}
+
+// Drop everything derived from the station set; the next render
+// re-projects and re-clusters.
+void shipobs_pi::StationsChanged() {
+    if (m_order_hint.empty()) {
+        m_projection.Invalidate();
+    } else {
+        m_projection.Invalidate(std::move(m_order_hint));
+        m_order_hint.clear();
+    }
+    m_clusters.Clear();
+    RequestRefresh(m_parent_window);
 }
 
+void shipobs_pi::SetClusterStations(bool b) {
+    if (b == m_cluster_stations) return;
+    m_cluster_stations = b;
+    StationsChanged();
+}
+
+// Frames follow their station on screen, which only moves when the chart
+// was re-projected or the canvas itself moved.
 static void RepositionInfoFrames(std::vector<StationInfoFrame*> &frames,
                                   PlugIn_ViewPort *vp,
-                                  wxWindow *parent) {
+                                  wxWindow *parent,
+                                  bool reprojected,
+                                  wxPoint &last_origin) {
     if (frames.empty()) return;
+    wxPoint origin = parent->ClientToScreen(wxPoint(0, 0));
+    if (!reprojected && origin == last_origin) return;
+    last_origin = origin;
     PlugIn_ViewPort vp_copy = *vp;
     for (StationInfoFrame *f : frames) {
         wxPoint st_px;
@@ -185,8 +295,13 @@ bool shipobs_pi::RenderGLOverlayMultiCanvas(wxGLContext *pcontext,
     if (!vp) return false;
     m_vp = *vp;
     m_vp_valid = true;
+    bool moved = UpdateProjection(vp);
+    if (moved && m_fetch_worker)
+        m_fetch_worker->SetViewport({vp->lat_min, vp->lat_max,
+                                     vp->lon_min, vp->lon_max});
     RenderStationsGL(this, vp);
-    RepositionInfoFrames(m_info_frames, vp, m_parent_window);
+    RepositionInfoFrames(m_info_frames, vp, m_parent_window, moved,
+                         m_frames_origin);
     return true;
 }
 
@@ -195,8 +310,13 @@ bool shipobs_pi::RenderOverlayMultiCanvas(wxDC &dc, PlugIn_ViewPort *vp,
     if (!vp) return false;
     m_vp = *vp;
     m_vp_valid = true;
+    bool moved = UpdateProjection(vp);
+    if (moved && m_fetch_worker)
+        m_fetch_worker->SetViewport({vp->lat_min, vp->lat_max,
+                                     vp->lon_min, vp->lon_max});
     RenderStationsDC(this, dc, vp);
-    RepositionInfoFrames(m_info_frames, vp, m_parent_window);
+    RepositionInfoFrames(m_info_frames, vp, m_parent_window, moved,
+                         m_frames_origin);
     return true;
 }
 
@@ -213,11 +333,12 @@ void shipobs_pi::OpenOrFocusInfoFrame(const ObservationStation &st,
     m_info_frames.push_back(frame);
 }
 
-bool shipobs_pi::IsStationHighlighted(const wxString &id) const {
+std::vector<std::string> shipobs_pi::GetHighlightedStationIds() const {
+    std::vector<std::string> ids;
     for (StationInfoFrame *f : m_info_frames)
-        if (f->IsHighlighted() && f->GetStationId() == id)
-            return true;
-    return false;
+        if (f->IsHighlighted())
+            ids.push_back(ToUTF8String(f->GetStationId()));
+    return ids;
 }
 
 void shipobs_pi::RemoveInfoFrame(StationInfoFrame *frame) {
@@ -226,10 +347,29 @@ void shipobs_pi::RemoveInfoFrame(StationInfoFrame *frame) {
         m_info_frames.erase(it);
 }
 
-void shipobs_pi::SetStations(const ObservationList &stations) {
-    m_stations = stations;
-    InvalidateLabelCache();
-    RequestRefresh(m_parent_window);
+// m_stations is what the renderer and hit-testing read: either the mapped
+// history entry (zero-copy) or columns held in memory.
+void shipobs_pi::SetStations(StationColumns &&stations) {
+    m_stations.SetColumns(std::move(stations));
+    StationsChanged();
+}
+
+void shipobs_pi::AppendStations(const StationColumns &more) {
+    m_stations.Append(more.View());
+    StationsChanged();
+}
+
+bool shipobs_pi::ShowHistoryEntry(size_t index) {
+    bool ok = m_stations.MapRecord(m_history_store, index);
+    if (!ok)
+        wxLogError("ShipObs: failed to map history entry %zu", index);
+    StationsChanged();
+    return ok;
+}
+
+void shipobs_pi::ClearStations() {
+    m_stations.Clear();
+    StationsChanged();
 }
 
 
@@ -243,6 +383,28 @@ void shipobs_pi::LoadConfig() {
     conf->Read(wxT("ServerURL"), &m_server_url, wxT("http://localhost:8080"));
     conf->Read(wxT("ShowWindBarbs"), &m_show_wind_barbs, true);
     conf->Read(wxT("ShowLabels"), &m_show_labels, false);
+    conf->Read(wxT("ClusterStations"), &m_cluster_stations, true);
+    conf->Read(wxT("WarmUpConnection"), &m_warm_up_connection, false);
+    conf->Read(wxT("DeltaFetch"), &m_delta_fetch, true);
+    conf->Read(wxT("TiledFetch"), &m_tiled_fetch, true);
+    conf->Read(wxT("MaxParallelRequests"), &m_max_parallel, 4);
+    m_max_parallel = std::max(1, std::min(8, m_max_parallel));
+    conf->Read(wxT("LowBandwidth"), &m_low_bandwidth, false);
+    long fields = DEFAULT_FETCH_FIELDS;
+    conf->Read(wxT("FetchFields"), &fields, DEFAULT_FETCH_FIELDS);
+    SetFetchFields(static_cast<unsigned>(fields));
+    conf->Read(wxT("DailyBudgetKB"), &m_daily_budget_kb, 0);
+    conf->Read(wxT("AutoRefresh"), &m_auto_refresh, 0);
+    conf->Read(wxT("RefreshMinutes"), &m_refresh_minutes, 10);
+    m_auto_refresh = std::max(0, std::min(2, m_auto_refresh));
+    m_refresh_minutes = std::max(1, m_refresh_minutes);
+    long traffic_day = 0;
+    wxString traffic_bytes;
+    unsigned long long day_bytes = 0;
+    conf->Read(wxT("TrafficDay"), &traffic_day, 0);
+    conf->Read(wxT("TrafficDayBytes"), &traffic_bytes, wxT("0"));
+    if (traffic_bytes.ToULongLong(&day_bytes))
+        m_traffic.Restore(traffic_day, day_bytes);
     conf->Read(wxT("InfoMode"), &m_info_mode, 2);
     conf->Read(wxT("EraseHistoryAfter"), &m_erase_history_after, 0);
 }
@@ -255,18 +417,49 @@ void shipobs_pi::SaveConfig() {
     conf->Write(wxT("ServerURL"), m_server_url);
     conf->Write(wxT("ShowWindBarbs"), m_show_wind_barbs);
     conf->Write(wxT("ShowLabels"), m_show_labels);
+    conf->Write(wxT("ClusterStations"), m_cluster_stations);
+    conf->Write(wxT("WarmUpConnection"), m_warm_up_connection);
+    conf->Write(wxT("DeltaFetch"), m_delta_fetch);
+    conf->Write(wxT("TiledFetch"), m_tiled_fetch);
+    conf->Write(wxT("MaxParallelRequests"), m_max_parallel);
+    conf->Write(wxT("LowBandwidth"), m_low_bandwidth);
+    conf->Write(wxT("FetchFields"), static_cast<long>(m_fetch_fields));
+    conf->Write(wxT("DailyBudgetKB"), m_daily_budget_kb);
+    conf->Write(wxT("AutoRefresh"), m_auto_refresh);
+    conf->Write(wxT("RefreshMinutes"), m_refresh_minutes);
+    conf->Write(wxT("TrafficDay"), static_cast<long>(m_traffic.Day()));
+    conf->Write(wxT("TrafficDayBytes"),
+                wxString::Format(wxT("%llu"), static_cast<unsigned long long>(
+                                                  m_traffic.StoredDayBytes())));
     conf->Write(wxT("InfoMode"), m_info_mode);
     conf->Write(wxT("EraseHistoryAfter"), m_erase_history_after);
 }
 
 // ---------- History persistence ----------
 // Disk is the source of truth. m_fetch_history holds metadata only (no station
-// data). Stations are written on fetch and read back on demand.
+// data) and mirrors the HistoryStore index. Stations are written on fetch and
+// read back on demand, one record at a time.
+
+static HistoryRecordInfo RecordInfoFromFetch(const FetchRecord &rec) {
+    HistoryRecordInfo info;
+    info.label      = ToUTF8String(rec.label);
+    info.fetched_at = EpochFromDateTime(rec.fetched_at);
+    info.lat_min    = rec.lat_min;
+    info.lat_max    = rec.lat_max;
+    info.lon_min    = rec.lon_min;
+    info.lon_max    = rec.lon_max;
+    return info;
+}
+
+// ---- One-time migration from the JSON history file ----
+// Earlier versions kept everything in shipobs_history.json and rewrote it on
+// every change.
 
-// wxJSONWriter uses %.10g which strips trailing zeros: 200.0 → "200".
-// wxJSONReader then stores "200" as wxJSONTYPE_INT, and AsDouble() on that
-// reads the wrong union slot (m_valDouble instead of m_valLong) → ~0.
-// This only affects OUR OWN history JSON (written by wxJSONWriter).
+// Those files were written by wxJSONWriter with %.10g, which strips trailing
+// zeros: 200.0 → "200". wxJSONReader then stores "200" as wxJSONTYPE_INT, and
+// AsDouble() on that reads the wrong union slot (m_valDouble instead of
+// m_valLong) → ~0. The writer now keeps the type only with
+// wxJSONWRITER_RECOGNIZE_DOUBLE, and the old files stay as they are.
 // Server responses use Python's json module which always writes 200.0 as
 // "200.0", so AsDouble() works directly there.  See ParseObservations().
 static double SafeDouble(const wxJSONValue &v) {
@@ -278,33 +471,6 @@ static double SafeDouble(const wxJSONValue &v) {
     return NAN;
 }
 
-static wxString HistoryFilePath() {
-    wxString *pdir = GetpPrivateApplicationDataLocation();
-    if (!pdir || pdir->IsEmpty()) return wxT("");
-    return *pdir + wxFILE_SEP_PATH + wxT("shipobs_history.json");
-}
-
-// Serialise one station to a JSON object.
-static wxJSONValue SerializeStation(const ObservationStation &st) {
-    wxJSONValue s;
-    s[wxT("id")]      = st.id;
-    s[wxT("type")]    = st.type;
-    s[wxT("country")] = st.country;
-    s[wxT("lat")]     = st.lat;
-    s[wxT("lon")]     = st.lon;
-    if (st.time.IsValid())
-        s[wxT("time")] = st.time.Format(wxT("%Y-%m-%dT%H:%M:%SZ"));
-    if (!std::isnan(st.wind_dir)) s[wxT("wind_dir")] = st.wind_dir;
-    if (!std::isnan(st.wind_spd)) s[wxT("wind_spd")] = st.wind_spd;
-    if (!std::isnan(st.gust))     s[wxT("gust")]     = st.gust;
-    if (!std::isnan(st.pressure)) s[wxT("pressure")] = st.pressure;
-    if (!std::isnan(st.air_temp)) s[wxT("air_temp")] = st.air_temp;
-    if (!std::isnan(st.sea_temp)) s[wxT("sea_temp")] = st.sea_temp;
-    if (!std::isnan(st.wave_ht))  s[wxT("wave_ht")]  = st.wave_ht;
-    if (!std::isnan(st.vis))      s[wxT("vis")]      = st.vis;
-    return s;
-}
-
 // Deserialise one station from a JSON object.
 static ObservationStation ParseStation(const wxJSONValue &s) {
     ObservationStation st;
@@ -314,9 +480,8 @@ static ObservationStation ParseStation(const wxJSONValue &s) {
     if (s.HasMember(wxT("lat")))     st.lat     = SafeDouble(s.ItemAt(wxT("lat")));
     if (s.HasMember(wxT("lon")))     st.lon     = SafeDouble(s.ItemAt(wxT("lon")));
     if (s.HasMember(wxT("time"))) {
-        wxDateTime dt;
-        dt.ParseISOCombined(s.ItemAt(wxT("time")).AsString());
-        if (dt.IsValid()) st.time = dt;
+        std::string t = ToUTF8String(s.ItemAt(wxT("time")).AsString());
+        st.time = ParseObsTime(t.data(), t.size());
     }
     if (s.HasMember(wxT("wind_dir"))) st.wind_dir = SafeDouble(s.ItemAt(wxT("wind_dir")));
     if (s.HasMember(wxT("wind_spd"))) st.wind_spd = SafeDouble(s.ItemAt(wxT("wind_spd")));
@@ -329,18 +494,8 @@ static ObservationStation ParseStation(const wxJSONValue &s) {
     return st;
 }
 
-// Read and parse the history JSON file.  If the file is missing, root is
-// initialised to an empty but valid document (version=1, records=[]).
-static bool ReadHistoryFile(wxJSONValue &root) {
-    wxString path = HistoryFilePath();
-
-    if (path.IsEmpty() || !wxFileExists(path)) {
-        root = wxJSONValue(wxJSONTYPE_OBJECT);
-        root[wxT("version")] = 1;
-        root[wxT("records")] = wxJSONValue(wxJSONTYPE_ARRAY);
-        return true;
-    }
-
+// Read and parse a history JSON file.
+static bool ReadHistoryFile(const wxString &path, wxJSONValue &root) {
     wxFile f;
     if (!f.Open(path, wxFile::read)) return false;
     wxFileOffset len = f.Length();
@@ -351,138 +506,203 @@ static bool ReadHistoryFile(wxJSONValue &root) {
     f.Read(buf.GetData(), len);
     buf.SetDataLen(len);
 
-    wxString json = wxString::FromUTF8(
-        static_cast<const char *>(buf.GetData()), buf.GetDataLen());
-
-    wxJSONReader reader;
-    if (reader.Parse(json, &root) > 0) return false;
-    if (!root.HasMember(wxT("records")))
-        root[wxT("records")] = wxJSONValue(wxJSONTYPE_ARRAY);
-    return true;
+    // The whole document is converted and dropped: build it in one arena.
+    wxJSONReader reader(wxJSONREADER_TOLERANT | wxJSONREADER_ARENA);
+    if (reader.Parse(static_cast<const char *>(buf.GetData()),
+                     buf.GetDataLen(), &root) > 0)
+        return false;
+    return root.HasMember(wxT("records")) && root[wxT("records")].IsArray();
 }
 
-// Serialise root and write it to the history file.
-static bool WriteHistoryFile(const wxJSONValue &root) {
-    wxString path = HistoryFilePath();
-    if (path.IsEmpty()) return false;
-
-    wxJSONWriter writer(wxJSONWRITER_NONE);
-    wxString json;
-    writer.Write(root, json);
-
-    wxFile f;
-    if (!f.Open(path, wxFile::write)) return false;
-    wxCharBuffer buf = json.ToUTF8();
-    f.Write(buf.data(), buf.length());
-    return true;
-}
+// Copy every record of shipobs_history.json into the (new, empty) store,
+// then rename the JSON file so it is not imported again. The renamed file
+// is left in place as a backup.
+void shipobs_pi::MigrateJsonHistory(const wxString &base) {
+    wxString path = HistoryDir() + wxT("shipobs_history.json");
+    if (!wxFileExists(path)) return;
 
-// Populate m_fetch_history with metadata only (no station data in memory).
-void shipobs_pi::LoadHistory() {
     wxJSONValue root;
-    if (!ReadHistoryFile(root)) return;
+    if (!ReadHistoryFile(path, root)) {
+        wxLogWarning("ShipObs: could not read %s, history not migrated", path);
+        return;
+    }
 
-    wxJSONValue records = root[wxT("records")];
-    m_fetch_history.clear();
+    // Records go into a store of their own, moved into place once all are
+    // in: a failure leaves no index behind, so the next start tries again.
+    std::string target = ToUTF8String(base);
+    std::string temp = target + ".migrating";
+    FileRemove(temp + ".idx");   // left by an interrupted migration
+    HistoryStore migrated;
+    if (!migrated.Open(temp)) {
+        wxLogError("ShipObs: failed to open history index %s.idx",
+                   wxString::FromUTF8(temp.c_str()));
+        return;
+    }
 
+    wxJSONValue records = root[wxT("records")];
+    StationColumns cols;
+    ObservationList stations;
     for (int i = 0; i < records.Size(); i++) {
         wxJSONValue r = records[i];
         FetchRecord rec;
         if (r.HasMember(wxT("label")))
             rec.label = r[wxT("label")].AsString();
         if (r.HasMember(wxT("fetched_at"))) {
-            wxDateTime dt;
-            dt.ParseISOCombined(r[wxT("fetched_at")].AsString());
-            if (dt.IsValid()) rec.fetched_at = dt;
+            std::string t = ToUTF8String(r[wxT("fetched_at")].AsString());
+            rec.fetched_at = DateTimeFromEpoch(ParseObsTime(t.data(), t.size()));
         }
         if (r.HasMember(wxT("lat_min"))) rec.lat_min = SafeDouble(r[wxT("lat_min")]);
         if (r.HasMember(wxT("lat_max"))) rec.lat_max = SafeDouble(r[wxT("lat_max")]);
         if (r.HasMember(wxT("lon_min"))) rec.lon_min = SafeDouble(r[wxT("lon_min")]);
         if (r.HasMember(wxT("lon_max"))) rec.lon_max = SafeDouble(r[wxT("lon_max")]);
-        // station_count from the array size — no station data loaded into RAM
-        if (r.HasMember(wxT("stations")) && r[wxT("stations")].IsArray())
-            rec.station_count = static_cast<size_t>(r[wxT("stations")].Size());
-        m_fetch_history.push_back(rec);
+
+        stations.clear();
+        if (r.HasMember(wxT("stations")) && r[wxT("stations")].IsArray()) {
+            wxJSONValue starray = r[wxT("stations")];
+            stations.reserve(static_cast<size_t>(starray.Size()));
+            for (int j = 0; j < starray.Size(); j++)
+                stations.push_back(ParseStation(starray[j]));
+        }
+        StationsToColumns(stations, cols);
+        if (!migrated.Append(RecordInfoFromFetch(rec), cols)) {
+            wxLogError("ShipObs: failed to migrate history record %d of %s",
+                       i + 1, path);
+            migrated.Clear();
+            return;
+        }
     }
+    if (!migrated.MoveTo(target)) {
+        wxLogError("ShipObs: could not move the migrated history to %s.idx",
+                   base);
+        migrated.Clear();
+        return;
+    }
+    if (!m_history_store.Open(target)) {
+        wxLogError("ShipObs: failed to open history index %s.idx", base);
+        return;
+    }
+
+    if (!wxRenameFile(path, path + wxT(".migrated")))
+        wxLogWarning("ShipObs: could not rename %s after migration", path);
+    wxLogMessage("ShipObs: migrated %d history record(s) from %s",
+                 records.Size(), path);
 }
 
-// Write a new fetch record (with its stations) to disk, then reload metadata.
-void shipobs_pi::AppendFetch(const FetchRecord &rec,
-                             const ObservationList &stations) {
-    wxJSONValue root;
-    ReadHistoryFile(root);  // creates empty root if file missing
-
-    // Build record JSON
-    wxJSONValue r;
-    r[wxT("label")]      = rec.label;
-    r[wxT("fetched_at")] = rec.fetched_at.IsValid()
-        ? rec.fetched_at.Format(wxT("%Y-%m-%dT%H:%M:%SZ"))
-        : wxString(wxT(""));
-    r[wxT("lat_min")] = rec.lat_min;
-    r[wxT("lat_max")] = rec.lat_max;
-    r[wxT("lon_min")] = rec.lon_min;
-    r[wxT("lon_max")] = rec.lon_max;
-
-    wxJSONValue starray(wxJSONTYPE_ARRAY);
-    for (size_t i = 0; i < stations.size(); i++)
-        starray.Append(SerializeStation(stations[i]));
-    r[wxT("stations")] = starray;
-
-    // Append, then trim oldest if eraseHistoryAfter > 0
-    wxJSONValue old_records = root[wxT("records")];
-    wxJSONValue new_records(wxJSONTYPE_ARRAY);
-    int start = 0;
-    if (m_erase_history_after > 0) {
-        // keep at most (m_erase_history_after - 1) existing entries so that
-        // after appending the new one the total equals m_erase_history_after
-        start = old_records.Size() - (m_erase_history_after - 1);
-        if (start < 0) start = 0;
+// Populate m_fetch_history with metadata only (no station data in memory).
+// The store is opened (and an old JSON history imported) on first use.
+void shipobs_pi::LoadHistory() {
+    if (!m_history_store.IsOpen()) {
+        wxString dir = HistoryDir();
+        if (dir.IsEmpty()) return;
+        wxString base = dir + wxT("shipobs_history");
+        if (!m_history_store.Open(ToUTF8String(base))) {
+            wxLogError("ShipObs: failed to open history index %s.idx", base);
+            return;
+        }
+        if (m_history_store.IsNew()) MigrateJsonHistory(base);
     }
-    for (int i = start; i < old_records.Size(); i++)
-        new_records.Append(old_records[i]);
-    new_records.Append(r);
-    root[wxT("records")] = new_records;
 
-    if (!WriteHistoryFile(root))
+    m_fetch_history.clear();
+    for (const HistoryRecordInfo &info : m_history_store.Records()) {
+        FetchRecord rec;
+        rec.label         = wxString::FromUTF8(info.label.data(), info.label.size());
+        rec.fetched_at    = DateTimeFromEpoch(info.fetched_at);
+        rec.lat_min       = info.lat_min;
+        rec.lat_max       = info.lat_max;
+        rec.lon_min       = info.lon_min;
+        rec.lon_max       = info.lon_max;
+        rec.station_count = info.station_count;
+        m_fetch_history.push_back(rec);
+    }
+}
+
+// Append a new fetch record (with its stations) to disk, then reload metadata.
+// On success the new record is the last history entry.
+bool shipobs_pi::AppendFetch(const FetchRecord &rec,
+                             const StationColumns &stations) {
+    bool ok = m_history_store.Append(RecordInfoFromFetch(rec), stations);
+    if (!ok) {
         wxLogError("ShipObs: failed to write history file");
-    else
-        wxLogMessage("ShipObs: saved fetch record (%zu station(s))", stations.size());
+    } else {
+        wxLogMessage("ShipObs: saved fetch record (%zu station(s))", stations.Size());
+        // Trim oldest so the total equals m_erase_history_after (0 = never)
+        if (m_erase_history_after > 0 &&
+            !m_history_store.TrimTo(static_cast<size_t>(m_erase_history_after)))
+            wxLogError("ShipObs: failed to trim history");
+    }
     LoadHistory();
+    return ok;
 }
 
 // Remove entry at index from disk, then reload metadata.
 void shipobs_pi::RemoveFetch(size_t index) {
-    wxJSONValue root;
-    if (!ReadHistoryFile(root)) return;
+    if (!m_history_store.Remove(index))
+        wxLogError("ShipObs: failed to remove history entry %zu", index);
+    LoadHistory();
+}
+
+// ---------- Delta fetch ----------
+
+// Areas whose last fetch is kept for delta fetching.
+static const size_t MAX_DELTA_AREAS = 4;
 
-    wxJSONValue old_records = root[wxT("records")];
-    wxJSONValue new_records(wxJSONTYPE_ARRAY);
-    for (int i = 0; i < old_records.Size(); i++) {
-        if (i != static_cast<int>(index))
-            new_records.Append(old_records[i]);
+static std::string DeltaAreaKey(const FetchJob &job) {
+    return ToUTF8String(job.server_url) + "|" + FmtDbl(job.lat_min) + "|" +
+           FmtDbl(job.lat_max) + "|" + FmtDbl(job.lon_min) + "|" +
+           FmtDbl(job.lon_max) + "|" + ToUTF8String(job.max_age) + "|" +
+           ToUTF8String(job.types) + job.profile.Query();
+}
+
+std::shared_ptr<const StationColumns>
+shipobs_pi::GetDeltaBase(const FetchJob &job, int64_t &since) const {
+    std::string key = DeltaAreaKey(job);
+    for (const DeltaArea &a : m_delta_areas) {
+        if (a.key != key || a.newest == TIME_UNKNOWN) continue;
+        since = a.newest;
+        return a.stations;
     }
-    root[wxT("records")] = new_records;
+    return nullptr;
+}
 
-    WriteHistoryFile(root);
-    LoadHistory();
+void shipobs_pi::RememberFetch(const FetchJob &job,
+                               const StationColumns &stations) {
+    std::string key = DeltaAreaKey(job);
+    m_delta_areas.erase(
+        std::remove_if(m_delta_areas.begin(), m_delta_areas.end(),
+                       [&key](const DeltaArea &a) { return a.key == key; }),
+        m_delta_areas.end());
+    if (m_delta_areas.size() >= MAX_DELTA_AREAS)
+        m_delta_areas.erase(m_delta_areas.begin());
+
+    DeltaArea area;
+    area.key      = key;
+    area.stations = std::make_shared<const StationColumns>(stations);
+    area.newest   = NewestTime(area.stations->View());
+    m_delta_areas.push_back(area);
 }
 
-// Read stations for one history entry from disk.
-bool shipobs_pi::LoadStationsForEntry(size_t index, ObservationList &out) {
-    wxJSONValue root;
-    if (!ReadHistoryFile(root)) return false;
+// ---------- Bandwidth ----------
 
-    wxJSONValue records = root[wxT("records")];
-    if (static_cast<int>(index) >= records.Size()) return false;
+FetchProfile shipobs_pi::GetFetchProfile() const {
+    return m_low_bandwidth ? FetchProfile(m_fetch_fields, 1) : FetchProfile();
+}
 
-    wxJSONValue r = records[static_cast<int>(index)];
-    if (!r.HasMember(wxT("stations")) || !r[wxT("stations")].IsArray())
-        return false;
+void shipobs_pi::AddTraffic(uint64_t bytes) {
+    m_traffic.Add(bytes, EpochFromDateTime(wxDateTime::Now().ToUTC()));
+    SaveConfig();
+}
 
-    wxJSONValue starray = r[wxT("stations")];
-    out.clear();
-    out.reserve(static_cast<size_t>(starray.Size()));
-    for (int i = 0; i < starray.Size(); i++)
-        out.push_back(ParseStation(starray[i]));
-    return true;
+bool shipobs_pi::OverDailyBudget() const {
+    uint64_t budget = static_cast<uint64_t>(std::max(0, m_daily_budget_kb)) * 1024;
+    return m_traffic.OverBudget(budget,
+                                EpochFromDateTime(wxDateTime::Now().ToUTC()));
+}
+
+void shipobs_pi::SetStationOrderHint(std::vector<uint32_t> &&carry) {
+    m_order_hint = std::move(carry);
+}
+
+// Map one history entry's stations from disk; nothing is copied.
+bool shipobs_pi::MapHistoryEntry(size_t index, StationStore &out) const {
+    return out.MapRecord(m_history_store, index);
 }
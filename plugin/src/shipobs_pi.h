@@ -3,6 +3,20 @@
 
 #include "ocpn_plugin.h"
 #include "observation.h"
+#include "history_store.h"
+#include "station_store.h"
+#include "projection_cache.h"
+#include "station_clusters.h"
+#include "http_client.h"
+#include "response_cache.h"
+#include "tile_cache.h"
+#include "traffic_meter.h"
+#include "url_builder.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
 
 #define PLUGIN_VERSION_MAJOR 0
 #define PLUGIN_VERSION_MINOR 1
@@ -14,6 +28,8 @@ class ShipReportsPluginDialog;
 class SettingsDialog;
 class StationPopup;
 class StationInfoFrame;
+class FetchWorker;
+struct FetchJob;
 
 class shipobs_pi : public opencpn_plugin_116 {
 public:
@@ -46,24 +62,59 @@ public:
     void OpenOrFocusInfoFrame(const ObservationStation &st,
                               const wxPoint &station_screen);
     void RemoveInfoFrame(StationInfoFrame *frame);
-    bool IsStationHighlighted(const wxString &id) const;
+    // UTF-8 ids of stations whose sticky frame is active/hovered.
+    std::vector<std::string> GetHighlightedStationIds() const;
 
     bool RenderGLOverlayMultiCanvas(wxGLContext *pcontext,
                                     PlugIn_ViewPort *vp, int canvasIndex);
     bool RenderOverlayMultiCanvas(wxDC &dc, PlugIn_ViewPort *vp,
                                   int canvasIndex);
 
-    // Data access
-    ObservationList &GetStations() { return m_stations; }
-    const ObservationList &GetStations() const { return m_stations; }
-    void SetStations(const ObservationList &stations);
+    // Stations on the chart, read in place (no ObservationStation objects).
+    const StationStore &GetStations() const { return m_stations; }
+    void SetStations(StationColumns &&stations);  // held in memory
+    void AppendStations(const StationColumns &more);  // a fetch in progress
+    bool ShowHistoryEntry(size_t index);          // mapped from disk
+    void ClearStations();
 
-    // History — disk is the source of truth; these do read-modify-write
-    void AppendFetch(const FetchRecord &rec, const ObservationList &stations);
+    // Screen positions of the stations for the last rendered viewport;
+    // read by the renderers and by hover / double-click handling.
+    const ProjectionCache &GetProjection() const { return m_projection; }
+
+    // Nearby stations grouped for drawing, rebuilt with the projection;
+    // empty while clustering is off.
+    const StationClusters &GetClusters() const { return m_clusters; }
+
+    // History — disk is the source of truth (binary HistoryStore); appending
+    // or removing an entry touches only that entry, never the whole file
+    bool AppendFetch(const FetchRecord &rec, const StationColumns &stations);
     void RemoveFetch(size_t index);
-    bool LoadStationsForEntry(size_t index, ObservationList &out);
+    bool MapHistoryEntry(size_t index, StationStore &out) const;
     const FetchHistory &GetFetchHistory() const { return m_fetch_history; }
 
+    // Delta fetch — the stations last fetched for an area (server, bbox,
+    // max age and types) are kept in memory, so fetching the area again
+    // only downloads newer reports. Null (since untouched) if the area
+    // wasn't fetched this session.
+    std::shared_ptr<const StationColumns> GetDeltaBase(const FetchJob &job,
+                                                       int64_t &since) const;
+    void RememberFetch(const FetchJob &job, const StationColumns &stations);
+
+    // How the next station set relates to the one shown: carry[i] is the
+    // shown index of new station i (or NO_STATION). Lets the next
+    // re-projection skip stations that did not move.
+    void SetStationOrderHint(std::vector<uint32_t> &&carry);
+
+    // Background fetch thread (null if it failed to start)
+    FetchWorker *GetFetchWorker() { return m_fetch_worker; }
+
+    // Bandwidth used by fetches, for this session and today (UTC); today's
+    // count is kept with the settings. Fetches stop once it reaches the
+    // daily budget.
+    void AddTraffic(uint64_t bytes);
+    const TrafficMeter &GetTraffic() const { return m_traffic; }
+    bool OverDailyBudget() const;
+
     // Settings accessors
     wxString GetServerURL() const { return m_server_url; }
     void SetServerURL(const wxString &url) { m_server_url = url; }
@@ -71,6 +122,31 @@ public:
     void SetShowWindBarbs(bool b) { m_show_wind_barbs = b; }
     bool GetShowLabels() const { return m_show_labels; }
     void SetShowLabels(bool b) { m_show_labels = b; }
+    bool GetClusterStations() const { return m_cluster_stations; }
+    void SetClusterStations(bool b);
+    // Open the server connection when OpenCPN starts (takes effect then).
+    bool GetWarmUpConnection() const { return m_warm_up_connection; }
+    void SetWarmUpConnection(bool b) { m_warm_up_connection = b; }
+    bool GetDeltaFetch() const { return m_delta_fetch; }
+    void SetDeltaFetch(bool b) { m_delta_fetch = b; }
+    bool GetTiledFetch() const { return m_tiled_fetch; }
+    void SetTiledFetch(bool b) { m_tiled_fetch = b; }
+    int GetMaxParallelRequests() const { return m_max_parallel; }
+    // Low-bandwidth fetch: only the fields in GetFetchFields() (bit m =
+    // StationMetric m), rounded to one decimal.
+    bool GetLowBandwidth() const { return m_low_bandwidth; }
+    void SetLowBandwidth(bool b) { m_low_bandwidth = b; }
+    unsigned GetFetchFields() const { return m_fetch_fields; }
+    void SetFetchFields(unsigned mask) { m_fetch_fields = mask & ALL_FIELDS; }
+    FetchProfile GetFetchProfile() const;
+    // Daily download budget in KB, 0 = none
+    int GetDailyBudgetKB() const { return m_daily_budget_kb; }
+    void SetDailyBudgetKB(int kb) { m_daily_budget_kb = kb; }
+    // Auto-refresh: 0=off, 1=chart viewport, 2=area of the Fetch new tab
+    int  GetAutoRefresh() const { return m_auto_refresh; }
+    void SetAutoRefresh(int mode) { m_auto_refresh = mode; }
+    int  GetRefreshMinutes() const { return m_refresh_minutes; }
+    void SetRefreshMinutes(int m) { m_refresh_minutes = std::max(1, m); }
     // Info display mode: 0=hover popup, 1=double-click sticky frame, 2=both
     int  GetInfoMode() const { return m_info_mode; }
     void SetInfoMode(int m)  { m_info_mode = m; }
@@ -78,12 +154,17 @@ public:
     void SetEraseHistoryAfter(int n) { m_erase_history_after = n; }
 
     PlugIn_ViewPort GetCurrentViewPort() const { return m_vp; }
+    bool HasViewPort() const { return m_vp_valid; }
     wxWindow *GetParentWindow() const { return m_parent_window; }
     void SaveConfig();
 
 private:
     void LoadConfig();
+    bool UpdateProjection(PlugIn_ViewPort *vp);
+    void StationsChanged();
     void LoadHistory();        // reads metadata from disk into m_fetch_history
+    // One-time import of shipobs_history.json into the store at base.
+    void MigrateJsonHistory(const wxString &base);
 
     wxWindow *m_parent_window;
     int m_toolbar_id;
@@ -94,10 +175,26 @@ private:
     SettingsDialog *m_settings_dialog;
     StationPopup *m_station_popup;
     std::vector<StationInfoFrame*> m_info_frames;
+    wxPoint m_frames_origin;    // canvas screen origin at last reposition
+    FetchWorker *m_fetch_worker;
+    HttpClient m_http;          // used on the fetch thread only
+    ResponseCache m_response_cache;  // likewise, once the thread runs
+    TileCache m_tiles;               // likewise
 
     // Data
-    ObservationList m_stations;
+    StationStore m_stations;    // mapped history entry or in-memory fetch
+    ProjectionCache m_projection;
+    StationClusters m_clusters;
     FetchHistory m_fetch_history;
+    HistoryStore m_history_store;
+    std::vector<uint32_t> m_order_hint;  // consumed by StationsChanged()
+
+    struct DeltaArea {
+        std::string key;
+        std::shared_ptr<const StationColumns> stations;
+        int64_t newest;
+    };
+    std::vector<DeltaArea> m_delta_areas;  // least recently fetched first
 
     // Current state
     double m_cursor_lat;
@@ -108,6 +205,17 @@ private:
     wxString m_server_url;
     bool m_show_wind_barbs;
     bool m_show_labels;
+    bool m_cluster_stations;
+    bool m_warm_up_connection;  // connect to the server at Init (opt-in)
+    bool m_delta_fetch;
+    bool m_tiled_fetch;
+    int  m_max_parallel;   // concurrent requests of one fetch, 1..8
+    bool m_low_bandwidth;
+    unsigned m_fetch_fields;
+    int  m_daily_budget_kb;
+    int  m_auto_refresh;
+    int  m_refresh_minutes;
+    TrafficMeter m_traffic;
     int  m_info_mode;   // 0=hover popup, 1=double-click sticky frame, 2=both
     // 0 = never erase; N = drop oldest entries once count exceeds N
     int  m_erase_history_after;
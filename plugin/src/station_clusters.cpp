@@ -0,0 +1,101 @@
+#include "station_clusters.h"
+
+#include <algorithm>
+#include <cmath>
+
+StationClusters::StationClusters(float radius)
+    : m_radius(radius > 1 ? radius : 1), m_hits(static_cast<int>(std::ceil(radius))) {}
+
+void StationClusters::Clear() {
+    m_clusters.clear();
+    m_member_start.assign(1, 0);
+    m_members.clear();
+    m_hits.Clear();
+}
+
+void StationClusters::Build(const StationStore &stations,
+                            const ProjectionCache &proj) {
+    Clear();
+    const std::vector<uint32_t> &visible = proj.Visible();
+    if (visible.empty()) return;
+
+    // Grid of cluster seeds: cells are one radius wide, so any seed within
+    // the radius of a point is in the point's cell or one of its neighbours.
+    float x0 = proj.X(visible[0]), y0 = proj.Y(visible[0]);
+    float x1 = x0, y1 = y0;
+    for (uint32_t i : visible) {
+        x0 = std::min(x0, proj.X(i)); x1 = std::max(x1, proj.X(i));
+        y0 = std::min(y0, proj.Y(i)); y1 = std::max(y1, proj.Y(i));
+    }
+    int cols = static_cast<int>((x1 - x0) / m_radius) + 1;
+    int rows = static_cast<int>((y1 - y0) / m_radius) + 1;
+    m_cell_head.assign(static_cast<size_t>(cols) * rows, -1);
+    m_next.clear();
+    m_assigned.resize(visible.size());
+    m_sum_x.clear();
+    m_sum_y.clear();
+
+    const float r2 = m_radius * m_radius;
+    for (size_t k = 0; k < visible.size(); k++) {
+        uint32_t i = visible[k];
+        float x = proj.X(i), y = proj.Y(i);
+        int cx = static_cast<int>((x - x0) / m_radius);
+        int cy = static_cast<int>((y - y0) / m_radius);
+
+        // Nearest seed within the radius, if any
+        int best = -1;
+        float best_d2 = r2;
+        for (int gy = std::max(cy - 1, 0); gy <= std::min(cy + 1, rows - 1); gy++) {
+            for (int gx = std::max(cx - 1, 0); gx <= std::min(cx + 1, cols - 1); gx++) {
+                for (int c = m_cell_head[gy * cols + gx]; c >= 0; c = m_next[c]) {
+                    const StationCluster &cl = m_clusters[c];
+                    float dx = x - proj.X(cl.seed), dy = y - proj.Y(cl.seed);
+                    float d2 = dx * dx + dy * dy;
+                    if (d2 < best_d2) { best_d2 = d2; best = c; }
+                }
+            }
+        }
+
+        PlatformType type = stations.Type(i);
+        int64_t t = stations.Time(i);
+        if (best < 0) {
+            StationCluster cl = {0, 0, i, 0, 0, TIME_UNKNOWN};
+            best = static_cast<int>(m_clusters.size());
+            m_clusters.push_back(cl);
+            m_sum_x.push_back(0);
+            m_sum_y.push_back(0);
+            int cell = cy * cols + cx;
+            m_next.push_back(m_cell_head[cell]);
+            m_cell_head[cell] = best;
+        }
+        StationCluster &cl = m_clusters[best];
+        cl.count++;
+        cl.type_mask |= static_cast<uint8_t>(1u << type);
+        if (t != TIME_UNKNOWN && (cl.newest == TIME_UNKNOWN || t > cl.newest))
+            cl.newest = t;
+        m_sum_x[best] += x;
+        m_sum_y[best] += y;
+        m_assigned[k] = static_cast<uint32_t>(best);
+    }
+
+    // Members grouped by cluster (counting sort keeps station order, so
+    // each seed comes first), positions averaged, hit grid built.
+    size_t n = m_clusters.size();
+    m_member_start.assign(n + 1, 0);
+    for (size_t c = 0; c < n; c++)
+        m_member_start[c + 1] = m_member_start[c] + m_clusters[c].count;
+    m_members.resize(visible.size());
+    std::vector<uint32_t> fill(m_member_start.begin(), m_member_start.end() - 1);
+    for (size_t k = 0; k < visible.size(); k++)
+        m_members[fill[m_assigned[k]]++] = visible[k];
+
+    const ProjectionKey &key = proj.Key();
+    m_hits.Begin(key.pix_width, key.pix_height, VIEW_MARGIN);
+    for (size_t c = 0; c < n; c++) {
+        StationCluster &cl = m_clusters[c];
+        cl.x = static_cast<float>(m_sum_x[c] / cl.count);
+        cl.y = static_cast<float>(m_sum_y[c] / cl.count);
+        m_hits.Add(static_cast<uint32_t>(c), cl.x, cl.y);
+    }
+    m_hits.Finish();
+}
@@ -0,0 +1,65 @@
+#ifndef _STATION_CLUSTERS_H_
+#define _STATION_CLUSTERS_H_
+
+// Screen-space clustering of visible stations — no wx dependencies.
+//
+// At small scales thousands of stations land within a few pixels of each
+// other. Between the projection and the renderers, stations closer than
+// CLUSTER_RADIUS pixels on screen are grouped (greedy, in station order,
+// through a grid of cluster seeds), and each group of two or more is drawn
+// as one aggregate marker with a count. The number of drawn markers is
+// then bounded by the canvas area rather than the station count. Zooming
+// in spreads stations apart, so clusters dissolve on their own; the
+// clusters are rebuilt with the projection, i.e. once per viewport change.
+
+#include "projection_cache.h"
+#include "screen_index.h"
+#include "station_store.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+static const float CLUSTER_RADIUS = 20.0f;
+
+struct StationCluster {
+    float x, y;          // mean screen position of the members
+    uint32_t seed;       // first member; the station itself when count == 1
+    uint32_t count;
+    uint8_t type_mask;   // bit (1 << PlatformType) per member type
+    int64_t newest;      // latest member observation time, or TIME_UNKNOWN
+};
+
+class StationClusters {
+public:
+    explicit StationClusters(float radius = CLUSTER_RADIUS);
+
+    // Group the stations visible in proj.
+    void Build(const StationStore &stations, const ProjectionCache &proj);
+    void Clear();
+
+    const std::vector<StationCluster> &Clusters() const { return m_clusters; }
+
+    // Station indices of cluster c, seed first.
+    const uint32_t *Members(size_t c) const {
+        return m_members.data() + m_member_start[c];
+    }
+
+    // Grid over cluster positions; ids are cluster indices.
+    const ScreenIndex &Hits() const { return m_hits; }
+
+private:
+    float m_radius;
+    std::vector<StationCluster> m_clusters;
+    std::vector<uint32_t> m_member_start;  // m_clusters.size() + 1 offsets
+    std::vector<uint32_t> m_members;
+    ScreenIndex m_hits;
+
+    // Scratch, kept for its allocations
+    std::vector<int> m_cell_head;          // first cluster seeded in a cell
+    std::vector<int> m_next;               // next cluster in the same cell
+    std::vector<uint32_t> m_assigned;      // cluster of each visible station
+    std::vector<double> m_sum_x, m_sum_y;
+};
+
+#endif // _STATION_CLUSTERS_H_
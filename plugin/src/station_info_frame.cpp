@@ -1,5 +1,6 @@
 #include "station_info_frame.h"
 #include "shipobs_pi.h"
+#include "station_view.h"
 
 #include <cmath>
 #include <wx/intl.h>
@@ -38,9 +39,9 @@ StationInfoFrame::StationInfoFrame(wxWindow *parent, shipobs_pi *plugin,
 
     // Build content
     wxString info;
-    if (st.time.IsValid())
+    if (st.time != TIME_UNKNOWN)
         info += wxString::Format(wxT("%s UTC\n"),
-                                 st.time.Format(wxT("%Y-%m-%d %H:%M")));
+                                 DateTimeFromEpoch(st.time).Format(wxT("%Y-%m-%d %H:%M")));
     info += wxString::Format(_("Station: %s  [%s]\n"), st.id, st.type);
     if (!st.country.IsEmpty())
         info += wxString::Format(_("Country: %s\n"), st.country);
@@ -0,0 +1,105 @@
+#include "station_merge.h"
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+// Id of ships that report without a call sign; such reports never merge.
+static const char PLACEHOLDER_ID[] = "SHIP";
+
+static std::string String(const StationView &v, uint32_t idx) {
+    return std::string(v.StringData(idx), v.StringLength(idx));
+}
+
+static bool IsPlaceholder(const StationView &v, size_t i) {
+    return v.StringEquals(v.id[i], PLACEHOLDER_ID, sizeof(PLACEHOLDER_ID) - 1);
+}
+
+static bool Expired(int64_t t, int64_t cutoff) {
+    return cutoff != TIME_UNKNOWN && t != TIME_UNKNOWN && t < cutoff;
+}
+
+// A placeholder-id report is identified by its time and position.
+static std::string ReportKey(const StationView &v, size_t i) {
+    std::string key(reinterpret_cast<const char *>(&v.time[i]), sizeof(int64_t));
+    key.append(reinterpret_cast<const char *>(&v.lat[i]), sizeof(double));
+    key.append(reinterpret_cast<const char *>(&v.lon[i]), sizeof(double));
+    return key;
+}
+
+void AppendStation(const StationView &v, size_t i, StationColumns &out) {
+    out.lat.push_back(v.lat[i]);
+    out.lon.push_back(v.lon[i]);
+    out.time.push_back(v.time[i]);
+    for (int m = 0; m < METRIC_COUNT; m++)
+        out.metric[m].push_back(v.metric[m][i]);
+    out.id.push_back(out.Intern(String(v, v.id[i])));
+    out.type.push_back(out.Intern(String(v, v.type[i])));
+    out.country.push_back(out.Intern(String(v, v.country[i])));
+}
+
+int64_t NewestTime(const StationView &v) {
+    int64_t newest = TIME_UNKNOWN;
+    for (size_t i = 0; i < v.count; i++)
+        if (v.time[i] != TIME_UNKNOWN && (newest == TIME_UNKNOWN || v.time[i] > newest))
+            newest = v.time[i];
+    return newest;
+}
+
+MergeStats MergeStations(const StationView &base, const StationView &delta,
+                         int64_t cutoff, StationColumns &out,
+                         std::vector<uint32_t> *carry) {
+    MergeStats stats;
+    out.Clear();
+    out.Reserve(base.count + delta.count);
+    if (carry) carry->clear();
+
+    // Newest delta report per id; placeholder reports stand alone.
+    std::unordered_map<std::string, size_t> by_id;
+    for (size_t j = 0; j < delta.count; j++) {
+        if (IsPlaceholder(delta, j)) continue;
+        auto ins = by_id.emplace(String(delta, delta.id[j]), j);
+        if (!ins.second && delta.time[j] > delta.time[ins.first->second])
+            ins.first->second = j;
+    }
+    std::vector<bool> used(delta.count, false);
+    std::unordered_set<std::string> placeholder_reports;
+
+    for (size_t i = 0; i < base.count; i++) {
+        if (Expired(base.time[i], cutoff)) {
+            stats.expired++;
+            continue;
+        }
+        const StationView *src = &base;
+        size_t k = i;
+        if (IsPlaceholder(base, i)) {
+            placeholder_reports.insert(ReportKey(base, i));
+        } else {
+            auto it = by_id.find(String(base, base.id[i]));
+            if (it != by_id.end()) {
+                size_t j = it->second;
+                used[j] = true;
+                if (delta.time[j] > base.time[i] && !Expired(delta.time[j], cutoff)) {
+                    src = &delta;
+                    k = j;
+                }
+            }
+        }
+        AppendStation(*src, k, out);
+        if (src == &delta) stats.updated++; else stats.kept++;
+        if (carry) carry->push_back(static_cast<uint32_t>(i));
+    }
+
+    for (size_t j = 0; j < delta.count; j++) {
+        if (used[j] || Expired(delta.time[j], cutoff)) continue;
+        if (IsPlaceholder(delta, j)) {
+            if (!placeholder_reports.insert(ReportKey(delta, j)).second) continue;
+        } else if (by_id[String(delta, delta.id[j])] != j) {
+            continue;  // an older duplicate within the delta
+        }
+        AppendStation(delta, j, out);
+        stats.added++;
+        if (carry) carry->push_back(NO_STATION);
+    }
+    return stats;
+}
@@ -0,0 +1,46 @@
+#ifndef _STATION_MERGE_H_
+#define _STATION_MERGE_H_
+
+// Merging an incremental fetch into earlier results — no wx dependencies.
+//
+// A delta fetch ("since=" the newest observation already held) returns only
+// stations that reported since. MergeStations() folds such a response into
+// the previous stations keyed by station id, newer report wins — the same
+// rule the server applies when it deduplicates its sources. Ships without
+// a call sign all carry the placeholder id "SHIP" and are never merged;
+// only an identical report (same time and position) is dropped. Stations
+// that have aged out of the max-age window are removed, so the result is
+// what a full fetch would have returned.
+//
+// Previous stations keep their order and new ones are appended, so caches
+// indexed by station can be carried over (see ProjectionCache).
+
+#include "station_store.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct MergeStats {
+    size_t kept;       // previous report still current
+    size_t updated;    // replaced by a newer report
+    size_t added;      // not seen before
+    size_t expired;    // older than the cutoff, dropped
+    MergeStats() : kept(0), updated(0), added(0), expired(0) {}
+};
+
+// Append station i of v to out.
+void AppendStation(const StationView &v, size_t i, StationColumns &out);
+
+// Newest observation time in v, or TIME_UNKNOWN.
+int64_t NewestTime(const StationView &v);
+
+// Merge delta over base into out (cleared first). Stations observed before
+// cutoff (epoch seconds; TIME_UNKNOWN keeps all) are dropped. If carry is
+// given, carry[i] is the base index merged station i replaces or keeps, or
+// NO_STATION for added stations.
+MergeStats MergeStations(const StationView &base, const StationView &delta,
+                         int64_t cutoff, StationColumns &out,
+                         std::vector<uint32_t> *carry);
+
+#endif // _STATION_MERGE_H_
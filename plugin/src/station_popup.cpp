@@ -2,6 +2,7 @@
 #include "shipobs_pi.h"
 #include "station_info_frame.h"
 #include "observation.h"
+#include "station_view.h"
 
 #include <cmath>
 #include <wx/intl.h>
@@ -27,9 +28,9 @@ StationPopup::~StationPopup() {}
 void StationPopup::ShowStation(const ObservationStation &st,
                                const wxPoint &screen_pos) {
     wxString info;
-    if (st.time.IsValid())
+    if (st.time != TIME_UNKNOWN)
         info += wxString::Format(wxT("%s UTC\n"),
-                                 st.time.Format(wxT("%b %d, %Y %H:%M")));
+                                 DateTimeFromEpoch(st.time).Format(wxT("%b %d, %Y %H:%M")));
     info += wxString::Format(_("Station: %s  [%s]\n"), st.id, st.type);
     if (!st.country.IsEmpty())
         info += wxString::Format(_("Country: %s\n"), st.country);
@@ -59,6 +60,58 @@ void StationPopup::ShowStation(const ObservationStation &st,
     if (!std::isnan(st.vis))
         info += wxString::Format(_("Visibility: %.1f nm\n"), st.vis);
 
+    ShowText(info, screen_pos);
+}
+
+void StationPopup::ShowCluster(const StationStore &stations,
+                               const uint32_t *members, size_t count,
+                               const wxPoint &screen_pos) {
+    static const char *const TYPE_NAMES[PLATFORM_COUNT] = {
+        "ship", "buoy", "shore", "drifter", "other"};
+
+    size_t per_type[PLATFORM_COUNT] = {};
+    int64_t newest = TIME_UNKNOWN;
+    float max_wind = NAN, max_wave = NAN;
+    float min_pres = NAN, max_pres = NAN;
+    for (size_t k = 0; k < count; k++) {
+        uint32_t i = members[k];
+        per_type[stations.Type(i)]++;
+        int64_t t = stations.Time(i);
+        if (t != TIME_UNKNOWN && (newest == TIME_UNKNOWN || t > newest))
+            newest = t;
+        // fmax/fmin ignore a NaN operand
+        max_wind = std::fmax(max_wind, stations.Metric(METRIC_WIND_SPD, i));
+        max_wave = std::fmax(max_wave, stations.Metric(METRIC_WAVE_HT, i));
+        min_pres = std::fmin(min_pres, stations.Metric(METRIC_PRESSURE, i));
+        max_pres = std::fmax(max_pres, stations.Metric(METRIC_PRESSURE, i));
+    }
+
+    wxString info = wxString::Format(_("%zu stations"), count);
+    wxString types;
+    for (int t = 0; t < PLATFORM_COUNT; t++) {
+        if (!per_type[t]) continue;
+        if (!types.IsEmpty()) types += wxT(", ");
+        types += wxString::Format(wxT("%zu %s"), per_type[t], TYPE_NAMES[t]);
+    }
+    info += wxT("  [") + types + wxT("]\n");
+    if (newest != TIME_UNKNOWN)
+        info += wxString::Format(_("Newest: %s UTC\n"),
+            DateTimeFromEpoch(newest).Format(wxT("%b %d, %Y %H:%M")));
+    info += wxT("\n");
+
+    if (!std::isnan(max_wind))
+        info += wxString::Format(_("Max wind: %.1f kts\n"), max_wind * 1.94384);
+    if (!std::isnan(min_pres))
+        info += wxString::Format(_("Pressure: %.1f - %.1f hPa\n"),
+                                 min_pres, max_pres);
+    if (!std::isnan(max_wave))
+        info += wxString::Format(_("Max wave ht: %.1f m\n"), max_wave);
+    info += _("Zoom in to see individual stations");
+
+    ShowText(info, screen_pos);
+}
+
+void StationPopup::ShowText(const wxString &info, const wxPoint &screen_pos) {
     m_text->SetLabel(info);
     GetSizer()->Fit(this);
 
@@ -70,47 +123,30 @@ void StationPopup::ShowStation(const ObservationStation &st,
 
 // Returns the index of the nearest station within HIT_RADIUS of cursor_px,
 // or -1 if none found. If found and st_screen_out is non-null, sets it to
-// the station's screen-coordinate position.
-static int FindNearestStation(const ObservationList &stations,
-                              const PlugIn_ViewPort &vp,
+// the station's screen-coordinate position. Looks up the positions the last
+// render pass recorded instead of projecting every station.
+static int FindNearestStation(const StationStore &stations,
+                              const ScreenIndex &hits,
                               const wxPoint &cursor_px,
                               wxWindow *parent,
                               wxPoint *st_screen_out) {
-    int best_idx = -1;
-    double best_dist_sq = HIT_RADIUS * HIT_RADIUS;
-    wxPoint best_st_px;
-
-    PlugIn_ViewPort vp_copy = vp;
-    for (size_t i = 0; i < stations.size(); i++) {
-        const ObservationStation &st = stations[i];
-        if (std::isnan(st.lat) || std::isnan(st.lon)) continue;
-
-        wxPoint st_px;
-        GetCanvasPixLL(&vp_copy, &st_px, st.lat, st.lon);
-
-        double dx = cursor_px.x - st_px.x;
-        double dy = cursor_px.y - st_px.y;
-        double dist_sq = dx * dx + dy * dy;
-
-        if (dist_sq < best_dist_sq) {
-            best_dist_sq = dist_sq;
-            best_idx = static_cast<int>(i);
-            best_st_px = st_px;
-        }
-    }
+    float sx, sy;
+    int best_idx = hits.Nearest(cursor_px.x, cursor_px.y, HIT_RADIUS, &sx, &sy);
+    if (best_idx < 0 || static_cast<size_t>(best_idx) >= stations.Size())
+        return -1;
 
-    if (best_idx >= 0 && st_screen_out)
-        *st_screen_out = parent->ClientToScreen(best_st_px);
+    if (st_screen_out)
+        *st_screen_out = parent->ClientToScreen(
+            wxPoint(static_cast<int>(sx), static_cast<int>(sy)));
 
     return best_idx;
 }
 
 bool HandleStationPopup(shipobs_pi *plugin, wxMouseEvent &event,
                         double cursor_lat, double cursor_lon,
-                        const PlugIn_ViewPort &vp,
                         StationPopup *&popup,
                         wxWindow *parent) {
-    const ObservationList &stations = plugin->GetStations();
+    const StationStore &stations = plugin->GetStations();
     int info_mode = plugin->GetInfoMode();  // 0=hover, 1=dblclick, 2=both
     wxPoint cursor_px = event.GetPosition();
 
@@ -119,30 +155,44 @@ bool HandleStationPopup(shipobs_pi *plugin, wxMouseEvent &event,
 
     // Double-click → open (or raise) a sticky info frame
     if (want_dblclick && event.LeftDClick()) {
-        if (!stations.empty()) {
+        if (!stations.Empty()) {
             wxPoint st_screen;
-            int idx = FindNearestStation(stations, vp, cursor_px, parent,
-                                         &st_screen);
+            int idx = FindNearestStation(stations, plugin->GetProjection().Hits(),
+                                         cursor_px, parent, &st_screen);
             if (idx >= 0) {
-                plugin->OpenOrFocusInfoFrame(stations[idx], st_screen);
+                plugin->OpenOrFocusInfoFrame(StationAt(stations, idx), st_screen);
                 return true;  // consume event
             }
         }
         return false;
     }
 
-    // Hover popup
+    // Hover popup — over an aggregate marker, summarise its members
     if (want_hover && event.Moving()) {
-        if (stations.empty()) return false;
+        if (stations.Empty()) return false;
+
+        const StationClusters &clusters = plugin->GetClusters();
+        int cluster = clusters.Hits().Nearest(cursor_px.x, cursor_px.y,
+                                              HIT_RADIUS);
+        if (cluster >= 0 &&
+            clusters.Clusters()[cluster].count > 1 &&
+            clusters.Clusters()[cluster].seed < stations.Size()) {
+            if (!popup)
+                popup = new StationPopup(parent);
+            popup->ShowCluster(stations, clusters.Members(cluster),
+                               clusters.Clusters()[cluster].count,
+                               parent->ClientToScreen(cursor_px));
+            return false;
+        }
 
         wxPoint st_screen;
-        int best_idx = FindNearestStation(stations, vp, cursor_px, parent,
-                                          &st_screen);
+        int best_idx = FindNearestStation(stations, plugin->GetProjection().Hits(),
+                                          cursor_px, parent, &st_screen);
         if (best_idx >= 0) {
             if (!popup)
                 popup = new StationPopup(parent);
             wxPoint screen_pos = parent->ClientToScreen(cursor_px);
-            popup->ShowStation(stations[best_idx], screen_pos);
+            popup->ShowStation(StationAt(stations, best_idx), screen_pos);
         } else {
             if (popup && popup->IsShown())
                 popup->Hide();
@@ -4,8 +4,11 @@
 #include "ocpn_plugin.h"
 #include <wx/popupwin.h>
 #include <wx/stattext.h>
+#include <cstddef>
+#include <cstdint>
 
 class shipobs_pi;
+class StationStore;
 struct ObservationStation;
 
 class StationPopup : public wxPopupWindow {
@@ -15,15 +18,21 @@ public:
 
     void ShowStation(const ObservationStation &st, const wxPoint &pos);
 
+    // Summary of a group of stations drawn as one aggregate marker.
+    void ShowCluster(const StationStore &stations, const uint32_t *members,
+                     size_t count, const wxPoint &pos);
+
 private:
+    void ShowText(const wxString &info, const wxPoint &screen_pos);
+
     wxStaticText *m_text;
 };
 
-// Called from MouseEventHook. Finds nearest station within 15px and shows popup.
+// Called from MouseEventHook. Finds nearest station (or station cluster)
+// within 15px and shows popup.
 // Returns true if the event was consumed.
 bool HandleStationPopup(shipobs_pi *plugin, wxMouseEvent &event,
                         double cursor_lat, double cursor_lon,
-                        const PlugIn_ViewPort &vp,
                         StationPopup *&popup,
                         wxWindow *parent);
 
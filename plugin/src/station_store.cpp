@@ -0,0 +1,79 @@
+#include "station_store.h"
+#include "station_merge.h"
+
+#include <utility>
+
+PlatformType PlatformTypeFromString(const char *s, size_t n) {
+    switch (n) {
+    case 4:
+        if (std::memcmp(s, "ship", 4) == 0) return PLATFORM_SHIP;
+        if (std::memcmp(s, "buoy", 4) == 0) return PLATFORM_BUOY;
+        break;
+    case 5:
+        if (std::memcmp(s, "shore", 5) == 0) return PLATFORM_SHORE;
+        break;
+    case 7:
+        if (std::memcmp(s, "drifter", 7) == 0) return PLATFORM_DRIFTER;
+        break;
+    }
+    return PLATFORM_OTHER;
+}
+
+StationStore::StationStore() {}
+
+void StationStore::SetColumns(StationColumns &&cols) {
+    m_mapped.Reset();
+    m_columns = std::move(cols);
+    m_view = m_columns.View();
+    BuildTypeColumn();
+}
+
+void StationStore::Append(const StationView &more) {
+    if (m_view.count > 0 && m_columns.Size() != m_view.count) {
+        StationColumns copy;
+        for (size_t i = 0; i < m_view.count; i++) AppendStation(m_view, i, copy);
+        m_columns = std::move(copy);
+    }
+    m_mapped.Reset();
+    for (size_t i = 0; i < more.count; i++) AppendStation(more, i, m_columns);
+    m_view = m_columns.View();
+    BuildTypeColumn();
+}
+
+bool StationStore::MapRecord(const HistoryStore &history, size_t index) {
+    m_columns = StationColumns();
+    bool ok = history.Map(index, m_mapped);
+    m_view = m_mapped.View();
+    BuildTypeColumn();
+    return ok;
+}
+
+void StationStore::Clear() {
+    m_mapped.Reset();
+    m_columns = StationColumns();
+    m_view = StationView();
+    std::vector<uint8_t>().swap(m_type);
+}
+
+// Types repeat across thousands of stations but the table holds each once:
+// classify the table, then fill the column by index.
+void StationStore::BuildTypeColumn() {
+    std::vector<uint8_t> by_string(m_view.string_count, PLATFORM_OTHER);
+    std::vector<bool> seen(m_view.string_count, false);
+    m_type.resize(m_view.count);
+    for (size_t i = 0; i < m_view.count; i++) {
+        uint32_t t = m_view.type[i];
+        if (!seen[t]) {
+            by_string[t] = PlatformTypeFromString(m_view.StringData(t),
+                                                  m_view.StringLength(t));
+            seen[t] = true;
+        }
+        m_type[i] = by_string[t];
+    }
+}
+
+uint32_t StationStore::FindString(const std::string &s) const {
+    for (uint32_t idx = 0; idx < m_view.string_count; idx++)
+        if (m_view.StringEquals(idx, s)) return idx;
+    return STRING_NOT_FOUND;
+}
@@ -0,0 +1,94 @@
+#ifndef _STATION_STORE_H_
+#define _STATION_STORE_H_
+
+// The stations shown on the chart, as structure-of-arrays columns — no wx
+// dependencies.
+//
+// Everything that walks the station set (renderer, hit-testing, GPX export,
+// history) reads these columns instead of a list of ObservationStation
+// records: positions, times and metrics are contiguous per column, ids and
+// countries are indices into one interned string table, and the platform
+// type is a one-byte enum resolved once when the store is filled, so the
+// per-frame loops neither touch strings nor chase pointers.
+//
+// The columns come either from memory (SetColumns) or straight from a
+// history record mapped from disk (MapRecord); only the one-byte type
+// column is built in both cases.
+
+#include "history_store.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Platform types drawn differently; any other type string is PLATFORM_OTHER.
+enum PlatformType : uint8_t {
+    PLATFORM_SHIP, PLATFORM_BUOY, PLATFORM_SHORE, PLATFORM_DRIFTER,
+    PLATFORM_OTHER, PLATFORM_COUNT
+};
+
+PlatformType PlatformTypeFromString(const char *s, size_t n);
+
+// Returned by StationStore::FindString() for strings not in the table.
+static const uint32_t STRING_NOT_FOUND = UINT32_MAX;
+
+// "No station" in station index columns (e.g. a carry-over map).
+static const uint32_t NO_STATION = UINT32_MAX;
+
+class StationStore {
+public:
+    StationStore();
+
+    // Take over in-memory columns.
+    void SetColumns(StationColumns &&cols);
+
+    // Add stations at the end, e.g. those of a fetch still downloading. A
+    // mapped history record is copied into memory first.
+    void Append(const StationView &more);
+
+    // Show a history record in place (see HistoryStore::Map). On failure
+    // the store is left empty.
+    bool MapRecord(const HistoryStore &history, size_t index);
+
+    void Clear();
+
+    size_t Size() const { return m_view.count; }
+    bool Empty() const { return m_view.count == 0; }
+
+    double Lat(size_t i) const { return m_view.lat[i]; }
+    double Lon(size_t i) const { return m_view.lon[i]; }
+    int64_t Time(size_t i) const { return m_view.time[i]; }  // epoch s, UTC
+    float Metric(StationMetric m, size_t i) const { return m_view.metric[m][i]; }
+    PlatformType Type(size_t i) const {
+        return static_cast<PlatformType>(m_type[i]);
+    }
+
+    // Interned strings: equal ids share an index, so stations can be
+    // matched by comparing IdIndex() values.
+    uint32_t IdIndex(size_t i) const { return m_view.id[i]; }
+    uint32_t TypeIndex(size_t i) const { return m_view.type[i]; }
+    uint32_t CountryIndex(size_t i) const { return m_view.country[i]; }
+    const char *StringData(uint32_t idx) const { return m_view.StringData(idx); }
+    size_t StringLength(uint32_t idx) const { return m_view.StringLength(idx); }
+
+    // Index of s in the string table, or STRING_NOT_FOUND. Linear in the
+    // number of distinct strings; resolve once, then compare indices.
+    uint32_t FindString(const std::string &s) const;
+
+    // Raw columns, e.g. for HistoryStore::Append().
+    const StationView &Columns() const { return m_view; }
+
+private:
+    StationStore(const StationStore &);
+    StationStore &operator=(const StationStore &);
+
+    void BuildTypeColumn();
+
+    StationColumns m_columns;       // when filled from memory
+    MappedRecord m_mapped;          // when showing a history record
+    StationView m_view;             // whichever of the two is current
+    std::vector<uint8_t> m_type;    // PlatformType per station
+};
+
+#endif // _STATION_STORE_H_
@@ -0,0 +1,69 @@
+#include "station_view.h"
+
+std::string ToUTF8String(const wxString &s) {
+    wxCharBuffer buf = s.ToUTF8();
+    return std::string(buf.data(), buf.length());
+}
+
+int64_t EpochFromDateTime(const wxDateTime &dt) {
+    if (!dt.IsValid()) return TIME_UNKNOWN;
+    wxDateTime::Tm tm = dt.GetTm();
+    return DaysFromCivil(tm.year, tm.mon + 1, tm.mday) * 86400 +
+           tm.hour * 3600 + tm.min * 60 + tm.sec;
+}
+
+wxDateTime DateTimeFromEpoch(int64_t t) {
+    if (t == TIME_UNKNOWN) return wxDateTime();
+    int64_t days = (t >= 0 ? t : t - 86399) / 86400;
+    int64_t secs = t - days * 86400;
+    int y, m, d;
+    CivilFromDays(days, y, m, d);
+    return wxDateTime(static_cast<wxDateTime::wxDateTime_t>(d),
+                      static_cast<wxDateTime::Month>(m - 1), y,
+                      static_cast<wxDateTime::wxDateTime_t>(secs / 3600),
+                      static_cast<wxDateTime::wxDateTime_t>(secs / 60 % 60),
+                      static_cast<wxDateTime::wxDateTime_t>(secs % 60));
+}
+
+wxString StationString(const StationStore &s, uint32_t idx) {
+    return wxString::FromUTF8(s.StringData(idx), s.StringLength(idx));
+}
+
+void StationsToColumns(const ObservationList &stations, StationColumns &cols) {
+    cols.Clear();
+    cols.Reserve(stations.size());
+    for (const ObservationStation &st : stations) AppendObservation(st, cols);
+}
+
+void AppendObservation(const ObservationStation &st, StationColumns &cols) {
+    const double values[METRIC_COUNT] = {
+        st.wind_dir, st.wind_spd, st.gust, st.pressure,
+        st.air_temp, st.sea_temp, st.wave_ht, st.vis};
+    cols.lat.push_back(st.lat);
+    cols.lon.push_back(st.lon);
+    cols.time.push_back(st.time);
+    for (int m = 0; m < METRIC_COUNT; m++)
+        cols.metric[m].push_back(static_cast<float>(values[m]));
+    cols.id.push_back(cols.Intern(ToUTF8String(st.id)));
+    cols.type.push_back(cols.Intern(ToUTF8String(st.type)));
+    cols.country.push_back(cols.Intern(ToUTF8String(st.country)));
+}
+
+ObservationStation StationAt(const StationStore &s, size_t i) {
+    ObservationStation st;
+    st.id       = StationString(s, s.IdIndex(i));
+    st.type     = StationString(s, s.TypeIndex(i));
+    st.country  = StationString(s, s.CountryIndex(i));
+    st.lat      = s.Lat(i);
+    st.lon      = s.Lon(i);
+    st.time     = s.Time(i);
+    st.wind_dir = s.Metric(METRIC_WIND_DIR, i);
+    st.wind_spd = s.Metric(METRIC_WIND_SPD, i);
+    st.gust     = s.Metric(METRIC_GUST, i);
+    st.pressure = s.Metric(METRIC_PRESSURE, i);
+    st.air_temp = s.Metric(METRIC_AIR_TEMP, i);
+    st.sea_temp = s.Metric(METRIC_SEA_TEMP, i);
+    st.wave_ht  = s.Metric(METRIC_WAVE_HT, i);
+    st.vis      = s.Metric(METRIC_VIS, i);
+    return st;
+}
@@ -0,0 +1,35 @@
+#ifndef _STATION_VIEW_H_
+#define _STATION_VIEW_H_
+
+// Bridges the column storage (history_store.h, station_store.h) and the wx
+// types used by the UI (ObservationStation, wxString, wxDateTime).
+
+#include "station_store.h"
+#include "observation.h"
+
+#include <string>
+#include <wx/datetime.h>
+#include <wx/string.h>
+
+std::string ToUTF8String(const wxString &s);
+
+// wxDateTime values in this plugin carry UTC wall-clock fields (observation
+// times are parsed from "...Z" strings, fetch times come from Now().ToUTC()),
+// so these convert through the broken-down fields rather than GetTicks().
+int64_t EpochFromDateTime(const wxDateTime &dt);
+wxDateTime DateTimeFromEpoch(int64_t t);
+
+// Interned string idx of a store as wxString.
+wxString StationString(const StationStore &s, uint32_t idx);
+
+// Pack an ObservationList into columns.
+void StationsToColumns(const ObservationList &stations, StationColumns &cols);
+
+// Add one station to the end of cols.
+void AppendObservation(const ObservationStation &st, StationColumns &cols);
+
+// Materialise a single station (popup / info frame); bulk consumers should
+// read the store's columns directly instead.
+ObservationStation StationAt(const StationStore &s, size_t i);
+
+#endif // _STATION_VIEW_H_
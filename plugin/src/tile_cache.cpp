@@ -0,0 +1,232 @@
+#include "tile_cache.h"
+#include "station_merge.h"
+
+#include <algorithm>
+#include <cmath>
+
+// ---------- Grid ----------
+
+int TileRow(double lat) {
+    int r = static_cast<int>(std::floor((lat + 90.0) / TILE_DEG));
+    return std::max(0, std::min(TILE_ROWS - 1, r));
+}
+
+int TileCol(double lon) {
+    int c = static_cast<int>(std::floor((lon + 180.0) / TILE_DEG));
+    return std::max(0, std::min(TILE_COLS - 1, c));
+}
+
+TileRect TilesCovering(const BBox &bb) {
+    TileRect r;
+    r.row0 = TileRow(bb.lat_min);
+    r.col0 = TileCol(bb.lon_min);
+    // An upper edge on a tile boundary does not reach into the next tile.
+    r.row1 = static_cast<int>(std::ceil((bb.lat_max + 90.0) / TILE_DEG)) - 1;
+    r.col1 = static_cast<int>(std::ceil((bb.lon_max + 180.0) / TILE_DEG)) - 1;
+    r.row1 = std::max(r.row0, std::min(TILE_ROWS - 1, r.row1));
+    r.col1 = std::max(r.col0, std::min(TILE_COLS - 1, r.col1));
+    return r;
+}
+
+BBox TileBounds(const TileRect &rect) {
+    return {-90.0 + rect.row0 * TILE_DEG, -90.0 + (rect.row1 + 1) * TILE_DEG,
+            -180.0 + rect.col0 * TILE_DEG, -180.0 + (rect.col1 + 1) * TILE_DEG};
+}
+
+static std::string TileKey(const std::string &query, int row, int col) {
+    return query + "|" + std::to_string(row) + "|" + std::to_string(col);
+}
+
+// Cover the cells of grid (one char per tile of cover, row-major) equal
+// to want with rectangles: runs along each row, stacked while the run
+// below has the same columns.
+static void Coalesce(const std::vector<char> &grid, const TileRect &cover,
+                     char want, std::vector<TileRect> &out) {
+    std::vector<TileRect> open;   // rects reaching the previous row
+    for (int r = cover.row0; r <= cover.row1; r++) {
+        const char *row = &grid[static_cast<size_t>(r - cover.row0) * cover.Cols()];
+        std::vector<TileRect> next;
+        for (int c = cover.col0; c <= cover.col1; c++) {
+            if (row[c - cover.col0] != want) continue;
+            int c1 = c;
+            while (c1 < cover.col1 && row[c1 + 1 - cover.col0] == want) c1++;
+            auto it = std::find_if(open.begin(), open.end(),
+                [c, c1](const TileRect &o) { return o.col0 == c && o.col1 == c1; });
+            if (it != open.end()) {
+                TileRect grown = *it;
+                grown.row1 = r;
+                next.push_back(grown);
+                open.erase(it);
+            } else {
+                next.push_back({r, r, c, c1});
+            }
+            c = c1;
+        }
+        out.insert(out.end(), open.begin(), open.end());
+        open.swap(next);
+    }
+    out.insert(out.end(), open.begin(), open.end());
+}
+
+// ---------- TileCache ----------
+
+TileCache::TileCache() : m_disk(TILE_DISK_SLOTS) {}
+
+void TileCache::Remember(const std::string &key, const TileEntry &entry) {
+    auto it = m_tiles.find(key);
+    if (it != m_tiles.end()) {
+        it->second.entry = entry;
+        m_lru.splice(m_lru.begin(), m_lru, it->second.lru);
+        return;
+    }
+    m_lru.push_front(key);
+    Slot slot;
+    slot.entry = entry;
+    slot.lru = m_lru.begin();
+    m_tiles.emplace(key, slot);
+    while (m_tiles.size() > TILE_MEMORY_MAX) {
+        m_tiles.erase(m_lru.back());
+        m_lru.pop_back();
+    }
+}
+
+bool TileCache::Get(const std::string &query, int row, int col,
+                    TileEntry &out) {
+    std::string key = TileKey(query, row, col);
+    auto it = m_tiles.find(key);
+    if (it != m_tiles.end()) {
+        m_lru.splice(m_lru.begin(), m_lru, it->second.lru);
+        out = it->second.entry;
+        return true;
+    }
+    CachedResponse cached;
+    if (!m_disk.Load(key, cached)) return false;
+    out.fetched_at = cached.stored_at;
+    out.newest     = NewestTime(cached.stations.View());
+    out.stations   = std::make_shared<const StationColumns>(std::move(cached.stations));
+    Remember(key, out);
+    return true;
+}
+
+void TileCache::Put(const std::string &query, int row, int col,
+                    StationColumns &&stations, int64_t fetched_at) {
+    std::string key = TileKey(query, row, col);
+    TileEntry entry;
+    entry.fetched_at = fetched_at;
+    entry.newest     = NewestTime(stations.View());
+    entry.stations   = std::make_shared<const StationColumns>(std::move(stations));
+    m_disk.Store(key, "", "", *entry.stations, fetched_at);
+    Remember(key, entry);
+}
+
+TilePlan TileCache::Plan(const std::string &query, const BBox &bb,
+                         int64_t now, bool delta) {
+    enum : char { FRESH, STALE, MISSING };
+    TilePlan plan;
+    plan.cover = TilesCovering(bb);
+    const TileRect &cover = plan.cover;
+
+    std::vector<char> grid(cover.Count(), MISSING);
+    std::vector<int64_t> newest(cover.Count(), TIME_UNKNOWN);
+    for (int r = cover.row0; r <= cover.row1; r++) {
+        for (int c = cover.col0; c <= cover.col1; c++) {
+            size_t k = static_cast<size_t>(r - cover.row0) * cover.Cols() +
+                       (c - cover.col0);
+            TileEntry e;
+            if (!Get(query, r, c, e) || e.fetched_at == TIME_UNKNOWN) continue;
+            if (e.fetched_at <= now && now - e.fetched_at < TILE_TTL) {
+                grid[k] = FRESH;
+                plan.stats.cached++;
+            } else if (delta && e.newest != TIME_UNKNOWN) {
+                grid[k] = STALE;
+                newest[k] = e.newest;
+                plan.stats.refreshed++;
+            }
+        }
+    }
+    plan.stats.downloaded = cover.Count() - plan.stats.cached -
+                            plan.stats.refreshed;
+
+    std::vector<TileRect> rects;
+    Coalesce(grid, cover, MISSING, rects);
+    for (const TileRect &rect : rects)
+        plan.requests.push_back({rect, TIME_UNKNOWN});
+
+    rects.clear();
+    Coalesce(grid, cover, STALE, rects);
+    for (const TileRect &rect : rects) {
+        // Newer than the oldest tile's newest report; the others merge
+        // reports they already hold as unchanged.
+        int64_t since = TIME_UNKNOWN;
+        for (int r = rect.row0; r <= rect.row1; r++)
+            for (int c = rect.col0; c <= rect.col1; c++) {
+                int64_t t = newest[static_cast<size_t>(r - cover.row0) * cover.Cols() +
+                                   (c - cover.col0)];
+                if (since == TIME_UNKNOWN || t < since) since = t;
+            }
+        plan.requests.push_back({rect, since});
+    }
+    plan.stats.requests = plan.requests.size();
+    return plan;
+}
+
+void TileCache::Apply(const std::string &query, const TileRequest &req,
+                      const StationView &response, int64_t now,
+                      int64_t cutoff) {
+    const TileRect &rect = req.rect;
+    std::vector<StationColumns> parts(rect.Count());
+    for (size_t i = 0; i < response.count; i++) {
+        int r = TileRow(response.lat[i]);
+        int c = TileCol(response.lon[i]);
+        if (r < rect.row0 || r > rect.row1 || c < rect.col0 || c > rect.col1)
+            continue;
+        AppendStation(response, i,
+                      parts[static_cast<size_t>(r - rect.row0) * rect.Cols() +
+                            (c - rect.col0)]);
+    }
+
+    for (int r = rect.row0; r <= rect.row1; r++) {
+        for (int c = rect.col0; c <= rect.col1; c++) {
+            StationColumns &part = parts[static_cast<size_t>(r - rect.row0) *
+                                         rect.Cols() + (c - rect.col0)];
+            if (req.since == TIME_UNKNOWN) {
+                Put(query, r, c, std::move(part), now);
+                continue;
+            }
+            TileEntry base;
+            if (!Get(query, r, c, base)) {
+                // Evicted meanwhile: keep what arrived, refetch it next time.
+                Put(query, r, c, std::move(part), TIME_UNKNOWN);
+                continue;
+            }
+            StationColumns merged;
+            MergeStations(base.stations->View(), part.View(), cutoff, merged,
+                          nullptr);
+            Put(query, r, c, std::move(merged), now);
+        }
+    }
+}
+
+bool TileCache::Assemble(const std::string &query, const BBox &bb,
+                         int64_t cutoff, StationColumns &out) {
+    TileRect cover = TilesCovering(bb);
+    StationColumns all;
+    bool complete = true;
+    for (int r = cover.row0; r <= cover.row1; r++) {
+        for (int c = cover.col0; c <= cover.col1; c++) {
+            TileEntry e;
+            if (!Get(query, r, c, e)) {
+                complete = false;
+                continue;
+            }
+            StationView v = e.stations->View();
+            for (size_t i = 0; i < v.count; i++)
+                if (v.lat[i] >= bb.lat_min && v.lat[i] <= bb.lat_max &&
+                    v.lon[i] >= bb.lon_min && v.lon[i] <= bb.lon_max)
+                    AppendStation(v, i, all);
+        }
+    }
+    // A ship that moved between tiles shows up in each; keep its newest.
+    MergeStations(StationView(), all.View(), cutoff, out, nullptr);
+    return complete;
+}
@@ -0,0 +1,128 @@
+#ifndef _TILE_CACHE_H_
+#define _TILE_CACHE_H_
+
+// Fixed-grid tile cache for observation fetches — no wx dependencies.
+//
+// The globe is cut into TILE_DEG x TILE_DEG tiles. A fetch of any bbox is
+// served from the tiles covering it: tiles fetched less than TILE_TTL ago
+// are used as they are, the others are downloaded again — neighbouring
+// ones together, one request per rectangle of tiles — and each response is
+// split back into its tiles. Panning or zooming within an area covered
+// recently therefore needs no network traffic at all.
+//
+// A stale tile that still holds stations can be refreshed with a delta
+// request ("since" its newest report) merged into them, as MergeStations()
+// does for whole fetches.
+//
+// Tiles are kept per query (server, max age, types): in memory, least
+// recently used dropped first, and on disk in a ResponseCache keyed by
+// tile, so they survive a restart.
+
+#include "response_cache.h"
+#include "url_builder.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+static const double TILE_DEG = 10.0;
+static const int TILE_ROWS = 18;                 // 180 / TILE_DEG
+static const int TILE_COLS = 36;                 // 360 / TILE_DEG
+static const int64_t TILE_TTL = 300;             // s; NDBC updates every 5 min
+static const size_t TILE_MEMORY_MAX = 1024;      // > TILE_ROWS * TILE_COLS
+static const unsigned TILE_DISK_SLOTS = 1024;
+
+// Inclusive range of tile rows (south to north) and columns (west to east).
+struct TileRect {
+    int row0, row1, col0, col1;
+    int Rows() const { return row1 - row0 + 1; }
+    int Cols() const { return col1 - col0 + 1; }
+    size_t Count() const { return static_cast<size_t>(Rows()) * Cols(); }
+};
+
+int TileRow(double lat);
+int TileCol(double lon);
+
+// Tiles covering bb (a clamped bbox, lon_min <= lon_max).
+TileRect TilesCovering(const BBox &bb);
+
+// Geographic extent of a rectangle of tiles.
+BBox TileBounds(const TileRect &rect);
+
+struct TileEntry {
+    std::shared_ptr<const StationColumns> stations;
+    int64_t fetched_at;   // epoch seconds, TIME_UNKNOWN = must refetch
+    int64_t newest;       // NewestTime(stations)
+    TileEntry() : fetched_at(TIME_UNKNOWN), newest(TIME_UNKNOWN) {}
+};
+
+// One request of a plan: a rectangle of tiles to download in full or, if
+// since is set, only reports newer than since.
+struct TileRequest {
+    TileRect rect;
+    int64_t since;
+};
+
+struct TileStats {
+    size_t cached;       // tiles used without a request
+    size_t refreshed;    // stale tiles updated by a delta request
+    size_t downloaded;   // tiles fetched in full
+    size_t requests;
+    TileStats() : cached(0), refreshed(0), downloaded(0), requests(0) {}
+};
+
+struct TilePlan {
+    TileRect cover;
+    std::vector<TileRequest> requests;
+    TileStats stats;
+};
+
+class TileCache {
+public:
+    TileCache();
+
+    // Also keep tiles in files <base_path>.<slot>.resp (UTF-8).
+    void Open(const std::string &base_path) { m_disk.Open(base_path); }
+
+    bool Get(const std::string &query, int row, int col, TileEntry &out);
+    void Put(const std::string &query, int row, int col,
+             StationColumns &&stations, int64_t fetched_at);
+
+    // The requests needed to bring every tile covering bb up to date at
+    // time now. Without delta, stale tiles are downloaded in full.
+    TilePlan Plan(const std::string &query, const BBox &bb, int64_t now,
+                  bool delta);
+
+    // Store the response to req in its tiles. Stations outside the rect
+    // (the server's bbox includes its edges) belong to a neighbour and are
+    // skipped; for a delta request, each tile's stations are merged with
+    // reports older than cutoff dropped.
+    void Apply(const std::string &query, const TileRequest &req,
+               const StationView &response, int64_t now, int64_t cutoff);
+
+    // Stations of the tiles covering bb that lie inside it, one per
+    // station id (the newest report), none older than cutoff. False if a
+    // tile is missing.
+    bool Assemble(const std::string &query, const BBox &bb, int64_t cutoff,
+                  StationColumns &out);
+
+    size_t MemoryTiles() const { return m_tiles.size(); }
+
+private:
+    struct Slot {
+        TileEntry entry;
+        std::list<std::string>::iterator lru;
+    };
+
+    void Remember(const std::string &key, const TileEntry &entry);
+
+    std::unordered_map<std::string, Slot> m_tiles;
+    std::list<std::string> m_lru;   // most recently used first
+    ResponseCache m_disk;
+};
+
+#endif // _TILE_CACHE_H_
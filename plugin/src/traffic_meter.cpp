@@ -0,0 +1,31 @@
+#include "traffic_meter.h"
+
+TrafficMeter::TrafficMeter() : m_session(0), m_day(0), m_day_bytes(0) {}
+
+int64_t TrafficMeter::DayOf(int64_t t) {
+    // Floor division, so times before 1970 fall on the right day too.
+    return t >= 0 ? t / 86400 : -((-t + 86399) / 86400);
+}
+
+void TrafficMeter::Restore(int64_t day, uint64_t bytes) {
+    m_day = day;
+    m_day_bytes = bytes;
+}
+
+void TrafficMeter::Add(uint64_t bytes, int64_t now) {
+    int64_t day = DayOf(now);
+    if (day != m_day) {
+        m_day = day;
+        m_day_bytes = 0;
+    }
+    m_day_bytes += bytes;
+    m_session += bytes;
+}
+
+uint64_t TrafficMeter::DayBytes(int64_t now) const {
+    return DayOf(now) == m_day ? m_day_bytes : 0;
+}
+
+bool TrafficMeter::OverBudget(uint64_t budget, int64_t now) const {
+    return budget > 0 && DayBytes(now) >= budget;
+}
@@ -0,0 +1,41 @@
+#ifndef _TRAFFIC_METER_H_
+#define _TRAFFIC_METER_H_
+
+// Download accounting against a daily budget — no wx dependencies.
+//
+// Counts the bytes received by fetches, for this session and for the
+// current day (UTC). The caller saves the day's count with the settings and
+// restores it at start-up, so it survives a restart; it starts over at
+// midnight UTC.
+
+#include <cstdint>
+
+class TrafficMeter {
+public:
+    TrafficMeter();
+
+    // Bytes counted on day (days since 1970-01-01, see DayOf()).
+    void Restore(int64_t day, uint64_t bytes);
+
+    // Count bytes received at time now (epoch seconds).
+    void Add(uint64_t bytes, int64_t now);
+
+    uint64_t SessionBytes() const { return m_session; }
+    uint64_t DayBytes(int64_t now) const;
+
+    // True once today's downloads reach budget bytes (0 = no budget).
+    bool OverBudget(uint64_t budget, int64_t now) const;
+
+    // What to save: the day counted last and its bytes.
+    int64_t Day() const { return m_day; }
+    uint64_t StoredDayBytes() const { return m_day_bytes; }
+
+    static int64_t DayOf(int64_t t);
+
+private:
+    uint64_t m_session;
+    int64_t m_day;
+    uint64_t m_day_bytes;
+};
+
+#endif // _TRAFFIC_METER_H_
@@ -9,6 +9,7 @@
 #include <locale>
 #include <sstream>
 #include <string>
+#include <vector>
 
 // Format a double with period decimal separator regardless of system locale.
 inline std::string FmtDbl(double d) {
@@ -41,4 +42,113 @@ inline BBox ClampBbox(double lat_min, double lat_max,
     return {lat_min, lat_max, lon_min, lon_max};
 }
 
+// Split a bounding box into the one or two boxes within [-180,180] that
+// cover it, returning how many. Unlike ClampBbox(), which cuts a viewport
+// crossing the antimeridian off at ±180, the part beyond it is kept as a
+// second box on the other side. The crossing can be given either way
+// OpenCPN reports it: lon_max past 180 (170..190) or lon_min > lon_max
+// (170..-170).
+inline int SplitBbox(double lat_min, double lat_max,
+                     double lon_min, double lon_max, BBox out[2]) {
+    lat_min = std::max(-90.0, std::min(90.0, lat_min));
+    lat_max = std::max(-90.0, std::min(90.0, lat_max));
+
+    if (lon_min > lon_max) lon_max += 360.0;
+    if (lon_max - lon_min >= 360.0) {
+        out[0] = {lat_min, lat_max, -180.0, 180.0};
+        return 1;
+    }
+    while (lon_min < -180.0) { lon_min += 360.0; lon_max += 360.0; }
+    while (lon_min >= 180.0) { lon_min -= 360.0; lon_max -= 360.0; }
+    if (lon_max <= 180.0) {
+        out[0] = {lat_min, lat_max, lon_min, lon_max};
+        return 1;
+    }
+    out[0] = {lat_min, lat_max, lon_min, 180.0};
+    out[1] = {lat_min, lat_max, -180.0, lon_max - 360.0};
+    return 2;
+}
+
+// Seconds in a max_age parameter ("6h", "2d", "90m"; a bare number is
+// hours). Returns 0 if the string is not understood.
+inline long long MaxAgeSeconds(const std::string &max_age) {
+    if (max_age.empty()) return 0;
+    size_t digits = 0;
+    long long n = 0;
+    while (digits < max_age.size() && max_age[digits] >= '0' &&
+           max_age[digits] <= '9' && digits < 9)
+        n = n * 10 + (max_age[digits++] - '0');
+    if (digits == 0) return 0;
+    std::string unit = max_age.substr(digits);
+    if (unit.empty() || unit == "h") return n * 3600;
+    if (unit == "m") return n * 60;
+    if (unit == "d") return n * 86400;
+    return 0;
+}
+
+// Canonical form of a types parameter: lower case, sorted, duplicates and
+// empty entries dropped. "Buoy, ship,buoy" and "ship,buoy" request the
+// same thing, so they must produce the same URL (and response cache key).
+inline std::string NormalizeTypes(const std::string &types) {
+    std::vector<std::string> parts;
+    std::string cur;
+    for (size_t i = 0; i <= types.size(); i++) {
+        char c = i < types.size() ? types[i] : ',';
+        if (c == ',') {
+            if (!cur.empty()) parts.push_back(cur);
+            cur.clear();
+        } else if (c != ' ') {
+            cur += (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+        }
+    }
+    std::sort(parts.begin(), parts.end());
+    parts.erase(std::unique(parts.begin(), parts.end()), parts.end());
+    std::string out;
+    for (const std::string &p : parts) {
+        if (!out.empty()) out += ',';
+        out += p;
+    }
+    return out;
+}
+
+// Observation fields a fetch can be limited to, in StationMetric order
+// (history_store.h): bit m of a field mask selects FIELD_NAMES[m].
+static const char *const FIELD_NAMES[] = {
+    "wind_dir", "wind_spd", "gust", "pressure",
+    "air_temp", "sea_temp", "wave_ht", "vis"};
+static const int FIELD_COUNT = 8;
+static const unsigned ALL_FIELDS = (1u << FIELD_COUNT) - 1;
+
+// What a fetch asks the server for beyond area, age and types: only some
+// observation fields, and values rounded to fewer decimals, to save
+// bandwidth. Fields left out arrive as missing values.
+struct FetchProfile {
+    unsigned fields;   // field mask; ALL_FIELDS = no "fields" parameter
+    int decimals;      // < 0 = full precision, no "precision" parameter
+    FetchProfile() : fields(ALL_FIELDS), decimals(-1) {}
+    FetchProfile(unsigned f, int d) : fields(f & ALL_FIELDS), decimals(d) {}
+
+    bool IsFull() const { return fields == ALL_FIELDS && decimals < 0; }
+
+    // Query parameters to append to the observations URL ("" if full).
+    // Decimals are at least 1: the parser treats integer literals as
+    // missing values.
+    std::string Query() const {
+        std::string q;
+        if (fields != ALL_FIELDS) {
+            q += "&fields=";
+            bool first = true;
+            for (int m = 0; m < FIELD_COUNT; m++) {
+                if (!(fields & (1u << m))) continue;
+                if (!first) q += ',';
+                q += FIELD_NAMES[m];
+                first = false;
+            }
+        }
+        if (decimals >= 0)
+            q += "&precision=" + std::to_string(std::max(1, decimals));
+        return q;
+    }
+};
+
 #endif // _URL_BUILDER_H_
@@ -0,0 +1,232 @@
+#include "wire_format.h"
+
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+static const char WIRE_MAGIC[4] = {'S', 'O', 'W', 'F'};
+static const uint16_t WIRE_VERSION = 1;
+static const size_t WIRE_HEADER_SIZE = 24;
+static const int32_t WIRE_MISSING_POS = INT32_MIN;
+
+// ---------- Encoding ----------
+
+template <typename T>
+static void Put(std::string &buf, const T &v) {
+    buf.append(reinterpret_cast<const char *>(&v), sizeof(v));
+}
+
+static void PutVarint(std::string &buf, uint64_t v) {
+    while (v >= 0x80) {
+        buf += static_cast<char>((v & 0x7f) | 0x80);
+        v >>= 7;
+    }
+    buf += static_cast<char>(v);
+}
+
+static int32_t QuantizeDeg(double deg) {
+    if (std::isnan(deg)) return WIRE_MISSING_POS;
+    double q = std::round(deg * WIRE_DEG_SCALE);
+    if (q <= INT32_MIN) return INT32_MIN + 1;
+    if (q > INT32_MAX) return INT32_MAX;
+    return static_cast<int32_t>(q);
+}
+
+std::string EncodeWire(const StationColumns &cols) {
+    uint32_t count = static_cast<uint32_t>(cols.Size());
+    uint32_t string_count = cols.StringCount();
+    int64_t time_base = TIME_UNKNOWN;
+    for (int64_t t : cols.time)
+        if (t != TIME_UNKNOWN && (time_base == TIME_UNKNOWN || t < time_base))
+            time_base = t;
+    if (time_base == TIME_UNKNOWN) time_base = 0;
+
+    std::string buf;
+    buf.reserve(WIRE_HEADER_SIZE + cols.string_bytes.size() + 2 * string_count +
+                count * (3 + 8 + 4 + 1 + METRIC_COUNT * 4));
+    buf.append(WIRE_MAGIC, 4);
+    Put(buf, WIRE_VERSION);
+    Put(buf, static_cast<uint16_t>(0));
+    Put(buf, count);
+    Put(buf, string_count);
+    Put(buf, time_base);
+
+    for (uint32_t s = 0; s < string_count; s++) {
+        uint32_t b = cols.string_offsets[s], e = cols.string_offsets[s + 1];
+        PutVarint(buf, e - b);
+        buf.append(cols.string_bytes, b, e - b);
+    }
+    for (uint32_t v : cols.id) PutVarint(buf, v);
+    for (uint32_t v : cols.type) PutVarint(buf, v);
+    for (uint32_t v : cols.country) PutVarint(buf, v);
+    for (double v : cols.lat) Put(buf, QuantizeDeg(v));
+    for (double v : cols.lon) Put(buf, QuantizeDeg(v));
+    for (int64_t t : cols.time)
+        PutVarint(buf, t == TIME_UNKNOWN
+                           ? 0 : static_cast<uint64_t>(t - time_base) + 1);
+    for (uint32_t i = 0; i < count; i++) {
+        uint8_t present = 0;
+        for (int m = 0; m < METRIC_COUNT; m++)
+            if (!std::isnan(cols.metric[m][i])) present |= 1u << m;
+        Put(buf, present);
+    }
+    for (int m = 0; m < METRIC_COUNT; m++)
+        for (float v : cols.metric[m])
+            if (!std::isnan(v)) Put(buf, v);
+    return buf;
+}
+
+// ---------- Decoding ----------
+
+// Bounds-checked cursor over the body. Every read fails once the body is
+// exhausted, so a truncated body is caught at the end of any column.
+struct WireReader {
+    const unsigned char *p, *end;
+
+    size_t Left() const { return static_cast<size_t>(end - p); }
+
+    template <typename T>
+    bool Get(T &v) {
+        if (Left() < sizeof(T)) return false;
+        std::memcpy(&v, p, sizeof(T));
+        p += sizeof(T);
+        return true;
+    }
+
+    bool Varint(uint64_t &v) {
+        v = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (p == end) return false;
+            unsigned char c = *p++;
+            v |= static_cast<uint64_t>(c & 0x7f) << shift;
+            if (!(c & 0x80)) return true;
+        }
+        return false;
+    }
+};
+
+static bool GetIndices(WireReader &in, uint32_t count,
+                       const std::vector<uint32_t> &remap,
+                       std::vector<uint32_t> &col) {
+    col.resize(count);
+    for (uint32_t i = 0; i < count; i++) {
+        uint64_t v;
+        if (!in.Varint(v) || v >= remap.size()) return false;
+        col[i] = remap[static_cast<size_t>(v)];
+    }
+    return true;
+}
+
+static bool GetPositions(WireReader &in, uint32_t count,
+                         std::vector<double> &col) {
+    if (in.Left() < 4ull * count) return false;
+    col.resize(count);
+    for (uint32_t i = 0; i < count; i++) {
+        int32_t q = 0;
+        in.Get(q);
+        col[i] = q == WIRE_MISSING_POS ? NAN : q / WIRE_DEG_SCALE;
+    }
+    return true;
+}
+
+static bool Decode(const char *data, size_t len, StationColumns &out) {
+    WireReader in = {reinterpret_cast<const unsigned char *>(data),
+                     reinterpret_cast<const unsigned char *>(data) + len};
+    char magic[4] = {};
+    uint16_t version = 0, reserved = 0;
+    uint32_t count = 0, string_count = 0;
+    int64_t time_base = 0;
+    if (!in.Get(magic) || !in.Get(version) || !in.Get(reserved) ||
+        !in.Get(count) || !in.Get(string_count) || !in.Get(time_base))
+        return false;
+    if (std::memcmp(magic, WIRE_MAGIC, 4) != 0 || version != WIRE_VERSION)
+        return false;
+    // Each station takes at least 3 + 8 + 1 + 1 bytes and each string one,
+    // so neither count can exceed the body: reject before allocating.
+    if (count > in.Left() / 13 || string_count > in.Left()) return false;
+
+    out.Reserve(count);
+    std::vector<uint32_t> remap(string_count);
+    for (uint32_t s = 0; s < string_count; s++) {
+        uint64_t n;
+        if (!in.Varint(n) || n > in.Left()) return false;
+        remap[s] = out.Intern(std::string(reinterpret_cast<const char *>(in.p),
+                                          static_cast<size_t>(n)));
+        in.p += n;
+    }
+    if (!GetIndices(in, count, remap, out.id) ||
+        !GetIndices(in, count, remap, out.type) ||
+        !GetIndices(in, count, remap, out.country) ||
+        !GetPositions(in, count, out.lat) ||
+        !GetPositions(in, count, out.lon))
+        return false;
+
+    // Offsets past the largest representable time mean a damaged body.
+    uint64_t max_offset = static_cast<uint64_t>(
+        time_base >= 0 ? INT64_MAX - time_base : INT64_MAX);
+    out.time.resize(count);
+    for (uint32_t i = 0; i < count; i++) {
+        uint64_t v;
+        if (!in.Varint(v)) return false;
+        if (v == 0) {
+            out.time[i] = TIME_UNKNOWN;
+            continue;
+        }
+        if (v - 1 > max_offset) return false;
+        out.time[i] = time_base + static_cast<int64_t>(v - 1);
+    }
+
+    if (in.Left() < count) return false;
+    const unsigned char *present = in.p;
+    in.p += count;
+    for (int m = 0; m < METRIC_COUNT; m++) {
+        std::vector<float> &col = out.metric[m];
+        col.assign(count, NAN);
+        for (uint32_t i = 0; i < count; i++)
+            if ((present[i] >> m) & 1)
+                if (!in.Get(col[i])) return false;
+    }
+    return in.p == in.end;
+}
+
+// Drop the stations ObsStreamParser::EndStation() drops from a JSON body:
+// no id, no position or one out of range, or no time.
+static void DropInvalid(StationColumns &out) {
+    size_t kept = 0;
+    for (size_t i = 0; i < out.Size(); i++) {
+        uint32_t id = out.id[i];
+        if (out.string_offsets[id + 1] == out.string_offsets[id]) continue;
+        if (!(out.lat[i] >= -90.0 && out.lat[i] <= 90.0)) continue;    // NaN too
+        if (!(out.lon[i] >= -180.0 && out.lon[i] <= 180.0)) continue;
+        if (out.time[i] == TIME_UNKNOWN) continue;
+        if (kept != i) {
+            out.lat[kept] = out.lat[i];
+            out.lon[kept] = out.lon[i];
+            out.time[kept] = out.time[i];
+            for (int m = 0; m < METRIC_COUNT; m++)
+                out.metric[m][kept] = out.metric[m][i];
+            out.id[kept] = out.id[i];
+            out.type[kept] = out.type[i];
+            out.country[kept] = out.country[i];
+        }
+        kept++;
+    }
+    out.lat.resize(kept);
+    out.lon.resize(kept);
+    out.time.resize(kept);
+    for (int m = 0; m < METRIC_COUNT; m++) out.metric[m].resize(kept);
+    out.id.resize(kept);
+    out.type.resize(kept);
+    out.country.resize(kept);
+}
+
+bool DecodeWire(const char *data, size_t len, StationColumns &out) {
+    out.Clear();
+    if (Decode(data, len, out)) {
+        DropInvalid(out);
+        return true;
+    }
+    out.Clear();
+    return false;
+}
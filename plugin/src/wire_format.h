@@ -0,0 +1,50 @@
+#ifndef _WIRE_FORMAT_H_
+#define _WIRE_FORMAT_H_
+
+// Compact columnar encoding of an observations response — no wx
+// dependencies.
+//
+// The plugin asks for it with
+//   Accept: application/x-shipobs-columns, application/json;q=0.5
+// and a server that supports it replies with that Content-Type; anything
+// else is parsed as JSON. The body carries the same stations as the JSON
+// "stations" array, at a fraction of the size: keys are not repeated,
+// strings are sent once, positions and times are integers and missing
+// values take one bit.
+//
+// Layout (little-endian; "varint" is unsigned LEB128):
+//   header, 24 bytes:
+//     char[4] "SOWF", u16 version (1), u16 reserved (0),
+//     u32 station count, u32 string count, i64 time base (epoch seconds)
+//   string table: string count x (varint byte length, UTF-8 bytes)
+//   id, type, country: count varint string indices each
+//   lat, lon:          count i32 each, in WIRE_DEG_SCALE units
+//                      (INT32_MIN = missing)
+//   time:              count varints, seconds after time base plus one
+//                      (0 = unknown)
+//   present:           count bytes, bit m set if metric m is present
+//   metric 0..7:       one f32 per station whose bit m is set, in
+//                      station order (wind_dir, wind_spd, gust, pressure,
+//                      air_temp, sea_temp, wave_ht, vis; see StationMetric)
+
+#include "history_store.h"
+
+#include <cstddef>
+#include <string>
+
+static const char WIRE_CONTENT_TYPE[] = "application/x-shipobs-columns";
+
+// Positions are sent in 1e-5 degree units (about 1 m).
+static const double WIRE_DEG_SCALE = 1e5;
+
+// Encode stations as a response body (the server side; used by tests and
+// benchmarks).
+std::string EncodeWire(const StationColumns &cols);
+
+// Decode a response body into columns. Stations the JSON parser would skip
+// (no id, position or time, or a position out of range) are dropped.
+// Returns false, with out cleared, if the body is malformed or of an
+// unknown version.
+bool DecodeWire(const char *data, size_t len, StationColumns &out);
+
+#endif // _WIRE_FORMAT_H_
@@ -16,6 +16,11 @@
 
 #include <wx/jsonreader.h>
 
+#include "../json_number.h"
+#include "../node_arena.h"
+
+#include <climits>
+
 #include <wx/mstream.h>
 #include <wx/sstream.h>
 #include <wx/debug.h>
@@ -214,6 +219,12 @@ static const wxChar* storeTraceMask = _T("StoreComment");
          string value from a stream: the reader assumes that the input stream
          is encoded in ANSI format and not in UTF-8; only meaningfull in ANSI
          builds, this flag is simply ignored in Unicode builds.
+ \li wxJSONREADER_ARENA: the values of the document are allocated from one
+     NodeArena (a few large memory blocks) instead of one by one from the
+     heap, and all members with the same name share one copy of the name.
+     The blocks are freed together when the last value of the document is
+     deleted, so this suits documents that are parsed, read and dropped as
+     a whole; a small value kept from a large document keeps all of it.
 
  You can also use the following shortcuts to specify some predefined
  flag's combinations:
@@ -242,6 +253,9 @@ wxJSONReader::wxJSONReader( int flags, int maxErrors )
     m_flags     = flags;
     m_maxErrors = maxErrors;
     m_noUtf8    = false;
+    m_buf       = 0;
+    m_bufEnd    = 0;
+    m_bufEof    = false;
 #if !defined( wxJSON_USE_UNICODE )
     // in ANSI builds we can suppress UTF-8 conversion for both the writer and the reader
     if ( m_flags & wxJSONREADER_NOUTF8_STREAM )    {
@@ -291,11 +305,14 @@ wxJSONReader::~wxJSONReader()
 
  \par Different input types
 
- The real parsing process in done using UTF-8 streams. If the input is
+ The real parsing process in done on UTF-8 text. If the input is
  from a \b wxString object, the Parse function first converts the input string
- in a temporary \b wxMemoryInputStream which contains the UTF-8 conversion
- of the string itself.
- Next, the overloaded Parse function is called.
+ in a temporary UTF-8 buffer and then calls the overloaded Parse function
+ that reads a memory buffer.
+ Text that is already in memory (a file's content, an HTTP response) should
+ be passed to that overload directly: it reads the bytes with a plain pointer
+ instead of calling the stream's functions for every byte, and gives the same
+ values, errors and warnings as reading the same bytes from a stream.
 
  @param doc    the JSON text that has to be parsed
  @param val    the wxJSONValue object that contains the parsed text; if NULL the
@@ -326,11 +343,10 @@ wxJSONReader:: Parse( const wxString& doc, wxJSONValue* val )
         readBuff = utf8CB.data();
 #endif
 
-    // now construct the temporary memory input stream
+    // now parse the temporary buffer
     size_t len = strlen( readBuff );
-    wxMemoryInputStream is( readBuff, len );
 
-    int numErr = Parse( is, val );
+    int numErr = Parse( readBuff, len, val );
 #if !defined( wxJSON_USE_UNICODE )
     m_noUtf8 = noUtf8_bak;
 #endif
@@ -341,6 +357,41 @@ wxJSONReader:: Parse( const wxString& doc, wxJSONValue* val )
 int
 wxJSONReader::Parse( wxInputStream& is, wxJSONValue* val )
 {
+    m_buf    = 0;
+    m_bufEnd = 0;
+    return DoParse( is, val );
+}
+
+//! \overload Parse( const wxString&, wxJSONValue* )
+/*!
+ Reads \c len bytes of UTF-8 text from \c doc (ANSI text in ANSI builds
+ when the reader was constructed with wxJSONREADER_NOUTF8_STREAM).
+ The text does not need to be NUL terminated and it may contain NUL bytes.
+*/
+int
+wxJSONReader::Parse( const char* doc, size_t len, wxJSONValue* val )
+{
+    // ReadChar() and PeekChar() read the buffer through m_buf; the stream
+    // is only passed along to them and is never read
+    wxMemoryInputStream is( doc, len );
+    m_buf    = doc;
+    m_bufEnd = doc + len;
+    m_bufEof = false;
+    int numErr = DoParse( is, val );
+    m_buf    = 0;
+    m_bufEnd = 0;
+    return numErr;
+}
+
+//! Parses the document read by ReadChar() (internal use)
+int
+wxJSONReader::DoParse( wxInputStream& is, wxJSONValue* val )
+{
+    // with wxJSONREADER_ARENA the values created until the function
+    // returns come from a new arena
+    NodeArena::Scope arena(( m_flags & wxJSONREADER_ARENA ) != 0 );
+    m_keys.clear();
+
     // if val == 0 the 'temp' JSON value will be passed to DoRead()
     wxJSONValue temp;
     m_level    = 0;
@@ -490,14 +541,24 @@ wxJSONReader::GetWarningCount() const
 int
 wxJSONReader::ReadChar( wxInputStream& is )
 {
-    if ( is.Eof())    {
-        return -1;
+    unsigned char ch;
+    if ( m_buf )    {
+        if ( m_buf == m_bufEnd )    {
+            m_bufEof = true;
+            return -1;
+        }
+        ch = (unsigned char) *m_buf++;
     }
+    else    {
+        if ( is.Eof())    {
+            return -1;
+        }
 
-    unsigned char ch = is.GetC();
-    size_t last = is.LastRead();    // returns ZERO if EOF
-    if ( last == 0 )    {
-        return -1;
+        ch = is.GetC();
+        size_t last = is.LastRead();    // returns ZERO if EOF
+        if ( last == 0 )    {
+            return -1;
+        }
     }
 
     // the function also converts CR in LF. only LF is returned
@@ -511,7 +572,7 @@ wxJSONReader::ReadChar( wxInputStream& is )
             return -1;
         }
         else if ( nextChar == '\n' )    {
-            ch = is.GetC();
+            ch = m_buf ? (unsigned char) *m_buf++ : is.GetC();
         }
     }
     if ( ch == '\n' )  {
@@ -529,6 +590,8 @@ wxJSONReader::ReadChar( wxInputStream& is )
 /*!
  This function just calls the \b Peek() function on the stream
  and returns it.
+ When reading a memory buffer, it returns what a memory stream would: ZERO
+ the first time it peeks past the end of the buffer and -1 from then on.
 
  @param is    the input stream that contains the JSON text
  @return the next char (one single byte) in the input stream or -1 on error or EOF
@@ -537,7 +600,16 @@ int
 wxJSONReader::PeekChar( wxInputStream& is )
 {
     int ch = -1; unsigned char c;
-    if ( !is.Eof())    {
+    if ( m_buf )    {
+        if ( m_buf < m_bufEnd )    {
+            ch = (unsigned char) *m_buf;
+        }
+        else if ( !m_bufEof )    {
+            m_bufEof = true;
+            ch = 0;
+        }
+    }
+    else if ( !is.Eof())    {
         c = is.Peek();
         ch = c;
     }
@@ -719,7 +791,12 @@ wxJSONReader::DoRead( wxInputStream& is, wxJSONValue& parent )
                 }
                 else  {
                     // the string in 'value' is set as the 'key'
-                    key = value.AsString();
+                    if ( m_flags & wxJSONREADER_ARENA )  {
+                        key = *m_keys.insert( value.AsString() ).first;
+                    }
+                    else  {
+                        key = value.AsString();
+                    }
                     value.SetType( wxJSONTYPE_INVALID );
                 }
                 ch = ReadChar( is );
@@ -810,8 +887,7 @@ wxJSONReader::StoreValue( int ch, const wxString& key, wxJSONValue& value, wxJSO
                 // OK, adding the value to parent key/value map
                 wxLogTrace( traceMask, _T("(%s) adding value to key:%s"),
                      __PRETTY_FUNCTION__, key.c_str());
-                parent[key] = value;
-                m_lastStored = &(parent[key]);
+                MoveValue( value, parent[key] );
                 m_lastStored->SetLineNo( m_lineNo );
             }
         }
@@ -824,10 +900,7 @@ wxJSONReader::StoreValue( int ch, const wxString& key, wxJSONValue& value, wxJSO
             }
             wxLogTrace( traceMask, _T("(%s) appending value to parent array"),
                                  __PRETTY_FUNCTION__ );
-            parent.Append( value );
-            const wxJSONInternalArray* arr = parent.AsArray();
-            wxJSON_ASSERT( arr );
-            m_lastStored = &(arr->Last());
+            MoveValue( value, parent.Append( wxJSONValue( wxJSONTYPE_INVALID )));
             m_lastStored->SetLineNo( m_lineNo );
         }
         else  {
@@ -838,6 +911,23 @@ wxJSONReader::StoreValue( int ch, const wxString& key, wxJSONValue& value, wxJSO
     value.ClearComments();
 }
 
+//! Move the value read by DoRead() into its place in the parent (internal use)
+/*!
+ The data of \c value is handed over to \c dest, which becomes the last
+ stored value, and \c value takes the data \c dest had (the empty data of
+ a new member or element) to be reset by StoreValue().
+ Assigning \c value would share the data and the following SetLineNo()
+ would then copy it, objects and arrays included, once per level.
+*/
+void
+wxJSONReader::MoveValue( wxJSONValue& value, wxJSONValue& dest )
+{
+    wxJSONRefData* data = dest.m_refData;
+    dest.m_refData  = value.m_refData;
+    value.m_refData = data;
+    m_lastStored = &dest;
+}
+
 //! Add a error message to the error's array
 /*!
  The overloaded versions of this function add an error message to the
@@ -1139,6 +1229,19 @@ wxJSONReader::ReadString( wxInputStream& is, wxJSONValue& val )
 
     int ch = 0;
     while ( ch >= 0 ) {
+        if ( m_buf )    {
+            // copy the plain bytes up to the next quote, escape or line end
+            // in one go: ReadChar() would only count their columns
+            const char* run = m_buf;
+            while ( m_buf < m_bufEnd && *m_buf != '\"' && *m_buf != '\\'
+                    && *m_buf != '\n' && *m_buf != '\r' )    {
+                ++m_buf;
+            }
+            if ( m_buf > run )    {
+                utf8Buff.AppendData( run, m_buf - run );
+                m_colNo += m_buf - run;
+            }
+        }
         ch = ReadChar( is );
         unsigned char c = (unsigned char) ch;
         if ( ch == '\\' )  {    // an escape sequence
@@ -1267,6 +1370,23 @@ wxJSONReader::ReadString( wxInputStream& is, wxJSONValue& val )
     return ch;
 }
 
+// Case-insensitive comparison of a token with a lowercase literal
+static bool
+TokenIsNoCase( const std::string& token, const char* literal )
+{
+    size_t i = 0;
+    for ( ; i < token.size(); i++ )  {
+        char c = token[i];
+        if ( c >= 'A' && c <= 'Z' )  {
+            c += 'a' - 'A';
+        }
+        if ( literal[i] == 0 || c != literal[i] )  {
+            return false;
+        }
+    }
+    return literal[i] == 0;
+}
+
 //! Reads a token string
 /*!
  This function is called by the ReadValue() when the
@@ -1276,7 +1396,8 @@ wxJSONReader::ReadString( wxInputStream& is, wxJSONValue& val )
  all lies in the US-ASCII charset so their UTF-8 encodeing
  is the same as US-ASCII.
  The function simply reads one byte at a time from the stream
- and appends them to a \b wxString object.
+ and appends them to a \b std::string object (the reader's \c m_token,
+ so that its storage is reused from one value to the next).
  Returns the next character read.
 
  A token cannot include \e unicode \e escaped \e sequences
@@ -1288,7 +1409,7 @@ wxJSONReader::ReadString( wxInputStream& is, wxJSONValue& val )
  @return -1 in case of errors or EOF
 */
 int
-wxJSONReader::ReadToken( wxInputStream& is, int ch, wxString& s )
+wxJSONReader::ReadToken( wxInputStream& is, int ch, std::string& s )
 {
     int nextCh = ch;
     while ( nextCh >= 0 ) {
@@ -1311,7 +1432,7 @@ wxJSONReader::ReadToken( wxInputStream& is, int ch, wxString& s )
                 return nextCh;
                 break;
             default :
-                s.Append( (unsigned char) nextCh, 1 );
+                s += (char) nextCh;
                 break;
         }
         // read the next character
@@ -1346,59 +1467,64 @@ wxJSONReader::ReadToken( wxInputStream& is, int ch, wxString& s )
  \li if the literal starts with plus sign: unsigned integer
         then double conversion is tried
 
+ The conversions (see json_number.h) work on the bytes of the token and
+ do not depend on the C locale: a decimal comma is never accepted and a
+ double is correctly rounded. Integers that overflow their type fall
+ through to the next conversion; hexadecimal, \c inf and \c nan literals
+ are not numbers.
+
  Returns the next character or -1 on EOF.
 */
 int
 wxJSONReader::ReadValue( wxInputStream& is, int ch, wxJSONValue& val )
 {
-    wxString s;
+    std::string& s = m_token;
+    s.clear();
     int nextCh = ReadToken( is, ch, s );
     wxLogTrace( traceMask, _T("(%s) value=%s"),
              __PRETTY_FUNCTION__, val.AsString().c_str() );
 
     if ( val.IsValid() )  {
-        AddError( _T( "Value \'%s\' cannot follow a value: \',\' or \':\' missing?"), s );
+        AddError( _T( "Value \'%s\' cannot follow a value: \',\' or \':\' missing?"),
+                  wxString::From8BitData( s.data(), s.size() ));
         return nextCh;
     }
 
-    // variables used for converting numeric values
+    // variables used for converting numeric values; the token is converted
+    // where it lies, without a wxString and independently of the C locale
     bool r;  double d;
-#if defined( wxJSON_64BIT_INT )
-    wxInt64  i64;
-    wxUint64 ui64;
-#else
-    unsigned long int ul; long int l;
-#endif
+    int64_t  i64;
+    uint64_t ui64;
 
     // first try the literal strings lowercase and nocase
-    if ( s == _T("null") ) {
+    if ( s == "null" ) {
         val.SetType( wxJSONTYPE_NULL );
         wxLogTrace( traceMask, _T("(%s) value = NULL"),  __PRETTY_FUNCTION__ );
         return nextCh;
     }
-    else if ( s.CmpNoCase( _T( "null" )) == 0 ) {
+    else if ( TokenIsNoCase( s, "null" )) {
         wxLogTrace( traceMask, _T("(%s) value = NULL"),  __PRETTY_FUNCTION__ );
         AddWarning( wxJSONREADER_CASE, _T( "the \'null\' literal must be lowercase" ));
         val.SetType( wxJSONTYPE_NULL );
         return nextCh;
     }
-    else if ( s == _T("true") ) {
+    else if ( s == "true" ) {
         wxLogTrace( traceMask, _T("(%s) value = TRUE"),  __PRETTY_FUNCTION__ );
         val = true;
         return nextCh;
     }
-    else if ( s.CmpNoCase( _T( "true" )) == 0 ) {
+    else if ( TokenIsNoCase( s, "true" )) {
         wxLogTrace( traceMask, _T("(%s) value = TRUE"),  __PRETTY_FUNCTION__ );
         AddWarning( wxJSONREADER_CASE, _T( "the \'true\' literal must be lowercase" ));
         val = true;
         return nextCh;
     }
-    else if ( s == _T("false") ) {
+    else if ( s == "false" ) {
         wxLogTrace( traceMask, _T("(%s) value = FALSE"),  __PRETTY_FUNCTION__ );
         val = false;
         return nextCh;
     }
-    else if ( s.CmpNoCase( _T( "false" )) == 0 ) {
+    else if ( TokenIsNoCase( s, "false" )) {
         wxLogTrace( traceMask, _T("(%s) value = FALSE"),  __PRETTY_FUNCTION__ );
         AddWarning( wxJSONREADER_CASE, _T( "the \'false\' literal must be lowercase" ));
         val = false;
@@ -1436,56 +1562,57 @@ wxJSONReader::ReadValue( wxInputStream& is, int ch, wxJSONValue& val )
             tUnsigned = false;
             break;
         default :
-            AddError( _T( "Literal \'%s\' is incorrect (did you forget quotes?)"), s );
+            AddError( _T( "Literal \'%s\' is incorrect (did you forget quotes?)"),
+                      wxString::From8BitData( s.data(), s.size() ));
             return nextCh;
     }
 
     if ( tSigned )    {
+        r = JsonParseInt64( s.data(), s.size(), &i64 );
     #if defined( wxJSON_64BIT_INT)
-        r = Strtoll( s, &i64 );
         wxLogTrace( traceMask, _T("(%s) convert to wxInt64 result=%d"),
                   __PRETTY_FUNCTION__, r );
         if ( r )  {
             // store the value
-            val = i64;
+            val = (wxInt64) i64;
             return nextCh;
         }
     #else
-        r = s.ToLong( &l );
+        r = r && i64 >= LONG_MIN && i64 <= LONG_MAX;
         wxLogTrace( traceMask, _T("(%s) convert to int result=%d"),
                  __PRETTY_FUNCTION__, r );
         if ( r )  {
             // store the value
-            val = (int) l;
+            val = (int) i64;
             return nextCh;
         }
     #endif
     }
 
     if ( tUnsigned )    {
+        r = JsonParseUInt64( s.data(), s.size(), &ui64 );
     #if defined( wxJSON_64BIT_INT)
-        r = Strtoull( s, &ui64 );
         wxLogTrace( traceMask, _T("(%s) convert to wxUint64 result=%d"),
                               __PRETTY_FUNCTION__, r );
         if ( r )  {
             // store the value
-            val = ui64;
+            val = (wxUint64) ui64;
             return nextCh;
         }
     #else
-        r = s.ToULong( &ul );
+        r = r && ui64 <= ULONG_MAX;
         wxLogTrace( traceMask, _T("(%s) convert to int result=%d"),
                          __PRETTY_FUNCTION__, r );
         if ( r )  {
             // store the value
-            val = (unsigned int) ul;
+            val = (unsigned int) ui64;
             return nextCh;
         }
     #endif
     }
 
     if ( tDouble )    {
-        r = s.ToDouble( &d );
+        r = JsonParseDouble( s.data(), s.size(), &d );
         wxLogTrace( traceMask, _T("(%s) convert to double result=%d"),
                  __PRETTY_FUNCTION__, r );
         if ( r )  {
@@ -1497,9 +1624,9 @@ wxJSONReader::ReadValue( wxInputStream& is, int ch, wxJSONValue& val )
 
 
     // the value is not syntactically correct
-    AddError( _T( "Literal \'%s\' is incorrect (did you forget quotes?)"), s );
+    AddError( _T( "Literal \'%s\' is incorrect (did you forget quotes?)"),
+              wxString::From8BitData( s.data(), s.size() ));
     return nextCh;
-  return nextCh;
 }
 
 
@@ -27,6 +27,12 @@
 
 #include <wx/jsonval.h>
 
+#include "../node_arena.h"
+
+static_assert( alignof( wxJSONRefData ) <= NodeArena::ALIGN &&
+               alignof( wxJSONValue ) <= NodeArena::ALIGN,
+               "wxJSON values must fit the NodeArena's alignment" );
+
 
 WX_DEFINE_OBJARRAY( wxJSONInternalArray );
 
@@ -99,6 +105,27 @@ wxJSONRefData::GetRefCount() const
     return m_refCount;
 }
 
+//! Allocate the data from the current NodeArena, if any.
+/*!
+ A wxJSONReader constructed with the \c wxJSONREADER_ARENA flag opens a
+ NodeArena while it parses: the data of every value it creates is then
+ carved out of a few large memory blocks which are returned to the heap
+ in one go when the last value of the document is deleted.
+ Outside such a parse the data comes from the heap.
+*/
+void*
+wxJSONRefData::operator new( size_t size )
+{
+    return NodeArena::Allocate( size );
+}
+
+// Free data allocated by operator new
+void
+wxJSONRefData::operator delete( void* p, size_t size )
+{
+    NodeArena::Free( p, size );
+}
+
 
 /*******************************************************************
 
@@ -436,6 +463,25 @@ wxJSONValue::~wxJSONValue()
     UnRef();
 }
 
+//! Allocate the value from the current NodeArena, if any.
+/*!
+ The elements of a JSON array are allocated one by one by the array;
+ like wxJSONRefData, they come from the reader's arena during a parse
+ with the \c wxJSONREADER_ARENA flag.
+*/
+void*
+wxJSONValue::operator new( size_t size )
+{
+    return NodeArena::Allocate( size );
+}
+
+// Free a value allocated by operator new
+void
+wxJSONValue::operator delete( void* p, size_t size )
+{
+    NodeArena::Free( p, size );
+}
+
 
 // functions for retreiving the value type: they are all 'const'
 
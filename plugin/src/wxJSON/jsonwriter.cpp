@@ -16,6 +16,8 @@
 
 #include <wx/jsonwriter.h>
 
+#include "../json_number.h"
+
 #include <wx/sstream.h>
 #include <wx/mstream.h>
 #include <wx/debug.h>
@@ -186,6 +188,11 @@ static const wxChar* writerTraceMask = _T("traceWriter");
         values to the stream thus producing ANSI text output; only meaningfull in
         ANSI builds, this flag is simply ignored in Unicode builds.
     \li wxJSONWRITER_MEMORYBUFF:
+    \li wxJSONWRITER_RECOGNIZE_DOUBLE: this flag cause the JSON writer to append
+        \b .0 to double values that have no fractional part (200.0 instead of
+        200), so that the wxJSON reader stores them in a \b double again and
+        not in an integer. The output is strict JSON. It has no effect when a
+        format string was set by SetDoubleFmtString().
 
 
  Note that for the style wxJSONWRITER_NONE the JSON text output is a bit
@@ -204,9 +211,9 @@ wxJSONWriter::wxJSONWriter( int style, int indent, int step )
         m_indent = 0;
         m_step   = 0;
     }
-    // set the default format string for doubles as
-    // 10 significant digits and suppress trailing ZEROes
-    SetDoubleFmtString( "%.10g") ;
+    // doubles are written with the shortest digits that read back
+    // to the same value (see SetDoubleFmtString)
+    m_fmt = NULL;
 
 #if !defined( wxJSON_USE_UNICODE )
     // in ANSI builds we can suppress UTF-8 conversion for both the writer and the reader
@@ -301,13 +308,21 @@ wxJSONWriter::Write( const wxJSONValue& value, wxOutputStream& os )
 //! Set the format string for double values.
 /*!
  This function sets the format string used for printing double values.
- Double values are outputted to JSON text using the \b snprintf function
- with a default format string of:
+ By default (and after passing NULL) no format string is used: double
+ values are outputted with the shortest decimal digits that read back to
+ exactly the same value, in a form that does not depend on the C locale
+ (see json_number.h). For example 0.1 is written as \c 0.1, 1014.7 as
+ \c 1014.7 and 1.5e-7 as \c 1.5e-7. NaN and infinities, which JSON cannot
+ represent, are written as \c null.
+
+ When a format string is set, double values are outputted to JSON text using
+ the \b snprintf function, for example:
  \code
      %.10g
  \endcode
- which prints doubles with a precision of 10 decimal digits and suppressing
- trailing ZEROes.
+ prints doubles with a precision of 10 decimal digits and suppresses
+ trailing ZEROes (the default of older versions). Note that \b snprintf
+ honours the C locale's decimal separator and may not round-trip.
 
  Note that the parameter is a pointer to \b char and not to \b wxChar. This
  is because the JSON writer always procudes UTF-8 encoded text and decimal
@@ -1005,25 +1020,31 @@ wxJSONWriter::WriteUIntValue( wxOutputStream& os, const wxJSONValue& value )
 //! Writes a value of type DOUBLE.
 /*!
  This function is called for every value objects of DOUBLE type.
- This function uses the \n snprintf function to get the US-ASCII
- representation of the integer and simply copy it to the output stream.
+ This function uses JsonFormatDouble (or the \n snprintf function if a
+ format string was set) to get the US-ASCII representation of the double
+ and simply copy it to the output stream.
  Returns -1 on stream errors or ZERO if no errors.
 
- Note that writing a double to a decimal ASCII representation could
- lay to unexpected results depending on the format string used in the
- conversion.
- See SetDoubleFmtString for details.
+ See SetDoubleFmtString and the wxJSONWRITER_RECOGNIZE_DOUBLE style for
+ details.
 */
 int
 wxJSONWriter::WriteDoubleValue( wxOutputStream& os, const wxJSONValue& value )
 {
     int r = 0;
 
-    char buffer[32];
+    char buffer[JSON_DOUBLE_CHARS];
     wxJSONRefData* data = value.GetRefData();
     wxASSERT( data );
-    snprintf( buffer, 32, m_fmt, data->m_value.m_valDouble );
-    size_t len = strlen( buffer );
+    size_t len;
+    if ( m_fmt )  {
+        snprintf( buffer, JSON_DOUBLE_CHARS, m_fmt, data->m_value.m_valDouble );
+        len = strlen( buffer );
+    }
+    else  {
+        len = JsonFormatDouble( data->m_value.m_valDouble, buffer,
+                        ( m_style & wxJSONWRITER_RECOGNIZE_DOUBLE ) != 0 );
+    }
     os.Write( buffer, len );
     if ( os.GetLastError() != wxSTREAM_NO_ERROR )    {
         r = -1;
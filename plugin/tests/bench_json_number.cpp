@@ -0,0 +1,134 @@
+// Benchmark: JSON number conversion.
+// Usage: bench_json_number [count]   (default: 200000)
+//
+// Parses count observation-style numbers ("-80.87", "1014.7") and count
+// full-precision ones ("%.17g" of random doubles) with JsonParseDouble(),
+// strtod() and a classic-locale istringstream (the fallback the scanner
+// and wxString::ToDouble() paths used), then formats count doubles with
+// JsonFormatDouble() and with snprintf("%.17g") and ("%.10g", the old
+// wxJSONWriter default, which does not round-trip).
+
+#include "../src/json_number.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <locale>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+static const int RUNS = 5;
+
+// Best of RUNS, in ns per item.
+template <typename F>
+static double NsPerItem(size_t n, F f) {
+    double best_s = 1e9;
+    for (int r = 0; r < RUNS; r++) {
+        auto t0 = std::chrono::steady_clock::now();
+        f();
+        auto t1 = std::chrono::steady_clock::now();
+        best_s = std::min(best_s, std::chrono::duration<double>(t1 - t0).count());
+    }
+    return best_s * 1e9 / n;
+}
+
+static bool BenchParse(const char *label, const std::vector<std::string> &in) {
+    size_t n = in.size();
+    double sum_fast = 0, sum_strtod = 0, sum_stream = 0;
+    double fast_ns = NsPerItem(n, [&] {
+        sum_fast = 0;
+        for (const std::string &s : in) {
+            double d = 0;
+            JsonParseDouble(s.data(), s.size(), &d);
+            sum_fast += d;
+        }
+    });
+    double strtod_ns = NsPerItem(n, [&] {
+        sum_strtod = 0;
+        for (const std::string &s : in) sum_strtod += std::strtod(s.c_str(), nullptr);
+    });
+    double stream_ns = NsPerItem(n, [&] {
+        sum_stream = 0;
+        for (const std::string &s : in) {
+            std::istringstream iss(s);
+            iss.imbue(std::locale::classic());
+            double d = 0;
+            iss >> d;
+            sum_stream += d;
+        }
+    });
+    if (sum_fast != sum_strtod) {
+        std::fprintf(stderr, "MISMATCH: %s parsed values differ\n", label);
+        return false;
+    }
+    std::printf("parse %zu %s numbers:\n", n, label);
+    std::printf("  JsonParseDouble           %8.1f ns each\n", fast_ns);
+    std::printf("  strtod                    %8.1f ns each  (%.1fx)\n",
+                strtod_ns, strtod_ns / fast_ns);
+    std::printf("  istringstream (classic)   %8.1f ns each  (%.1fx)\n",
+                stream_ns, stream_ns / fast_ns);
+    (void)sum_stream;
+    return true;
+}
+
+int main(int argc, char **argv) {
+    size_t n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200000;
+    std::mt19937_64 rng(1771599600);
+    char buf[64];
+
+    // What the observation server sends: 2-decimal positions, 1-decimal
+    // pressures and temperatures.
+    std::vector<std::string> readings(n);
+    for (size_t i = 0; i < n; i++) {
+        switch (i % 3) {
+        case 0: std::snprintf(buf, sizeof buf, "%.2f", (rng() % 36000) / 100.0 - 180); break;
+        case 1: std::snprintf(buf, sizeof buf, "%.1f", 950 + (rng() % 1000) / 10.0); break;
+        default: std::snprintf(buf, sizeof buf, "%.1f", (rng() % 600) / 10.0 - 20); break;
+        }
+        readings[i] = buf;
+    }
+
+    std::vector<double> values(n);
+    std::vector<std::string> full(n);
+    for (size_t i = 0; i < n; i++) {
+        uint64_t bits;
+        do {
+            bits = rng();
+            std::memcpy(&values[i], &bits, sizeof bits);
+        } while (!std::isfinite(values[i]));
+        std::snprintf(buf, sizeof buf, "%.17g", values[i]);
+        full[i] = buf;
+    }
+
+    if (!BenchParse("observation", readings) || !BenchParse("%.17g", full))
+        return 1;
+
+    size_t len_fast = 0, len_17g = 0, len_10g = 0;
+    double fmt_ns = NsPerItem(n, [&] {
+        len_fast = 0;
+        for (double d : values) len_fast += JsonFormatDouble(d, buf, false);
+    });
+    double fmt17_ns = NsPerItem(n, [&] {
+        len_17g = 0;
+        for (double d : values)
+            len_17g += static_cast<size_t>(std::snprintf(buf, sizeof buf, "%.17g", d));
+    });
+    double fmt10_ns = NsPerItem(n, [&] {
+        len_10g = 0;
+        for (double d : values)
+            len_10g += static_cast<size_t>(std::snprintf(buf, sizeof buf, "%.10g", d));
+    });
+    std::printf("format %zu doubles (average length):\n", n);
+    std::printf("  JsonFormatDouble          %8.1f ns each  %5.1f chars, round-trips\n",
+                fmt_ns, double(len_fast) / n);
+    std::printf("  snprintf %%.17g            %8.1f ns each  %5.1f chars  (%.1fx)\n",
+                fmt17_ns, double(len_17g) / n, fmt17_ns / fmt_ns);
+    std::printf("  snprintf %%.10g            %8.1f ns each  %5.1f chars  (%.1fx), lossy\n",
+                fmt10_ns, double(len_10g) / n, fmt10_ns / fmt_ns);
+    return 0;
+}
@@ -0,0 +1,91 @@
+// Benchmark: JsonScanner throughput at each SIMD level.
+// Usage: bench_json_scanner [station_count ...]   (default: 1000 10000 100000)
+//
+// Scans a synthetic /api/v1/observations payload in 16 KiB chunks, the size
+// libcurl hands to the write callback, with a handler that only counts
+// tokens. Prints MB/s per level the CPU supports; once that is well above
+// the download rate, tokenizing is no longer what a fetch waits for.
+
+#include "../src/json_scanner.h"
+#include "../src/json_simd.h"
+#include "bench_payload.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+static const size_t CHUNK_BYTES = 16 * 1024;
+
+struct CountingHandler : public JsonHandler {
+    size_t tokens = 0;
+    size_t bytes = 0;
+    void OnBeginObject() { tokens++; }
+    void OnEndObject()   { tokens++; }
+    void OnBeginArray()  { tokens++; }
+    void OnEndArray()    { tokens++; }
+    void OnKey(const char *, size_t n)    { tokens++; bytes += n; }
+    void OnString(const char *, size_t n) { tokens++; bytes += n; }
+    void OnNumber(const char *, size_t n) { tokens++; bytes += n; }
+    void OnLiteral(JsonLiteral)           { tokens++; }
+};
+
+static size_t ScanPayload(const std::string &payload) {
+    CountingHandler h;
+    JsonScanner sc(&h);
+    for (size_t i = 0; i < payload.size(); i += CHUNK_BYTES)
+        sc.Feed(payload.data() + i, std::min(CHUNK_BYTES, payload.size() - i));
+    if (!sc.Finish()) {
+        std::fprintf(stderr, "scan error: %s\n", sc.GetError().c_str());
+        std::exit(1);
+    }
+    return h.tokens + h.bytes;
+}
+
+// Best of a few runs, in MB/s.
+static double MBPerSec(const std::string &payload, size_t &check) {
+    int iterations = std::max(3, static_cast<int>(50000000 / payload.size()));
+    double best_s = 1e9;
+    for (int i = 0; i < iterations; i++) {
+        auto t0 = std::chrono::steady_clock::now();
+        check = ScanPayload(payload);
+        auto t1 = std::chrono::steady_clock::now();
+        best_s = std::min(best_s, std::chrono::duration<double>(t1 - t0).count());
+    }
+    return payload.size() / best_s / 1e6;
+}
+
+int main(int argc, char **argv) {
+    std::vector<int> sizes;
+    for (int i = 1; i < argc; i++) sizes.push_back(std::atoi(argv[i]));
+    if (sizes.empty()) sizes = {1000, 10000, 100000};
+
+    JsonSimdLevel best = JsonSimdBest();
+    std::printf("%8s %10s", "stations", "bytes");
+    for (int level = JSON_SIMD_SCALAR; level <= best; level++)
+        std::printf(" %8s MB/s", JsonSimdName(static_cast<JsonSimdLevel>(level)));
+    std::printf("\n");
+
+    for (int n : sizes) {
+        std::string payload = MakePayload(n);
+        std::printf("%8d %10zu", n, payload.size());
+        size_t expected = 0;
+        for (int level = JSON_SIMD_SCALAR; level <= best; level++) {
+            JsonSimdUse(static_cast<JsonSimdLevel>(level));
+            size_t check = 0;
+            double mbps = MBPerSec(payload, check);
+            if (level == JSON_SIMD_SCALAR) expected = check;
+            if (check != expected) {
+                std::fprintf(stderr, "\nMISMATCH at %s\n",
+                             JsonSimdName(static_cast<JsonSimdLevel>(level)));
+                return 1;
+            }
+            std::printf(" %13.0f", mbps);
+        }
+        std::printf("\n");
+    }
+    JsonSimdUse(best);
+    return 0;
+}
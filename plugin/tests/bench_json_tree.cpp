@@ -0,0 +1,79 @@
+// Benchmark: wxJSONValue trees, heap-allocated vs. wxJSONREADER_ARENA.
+// Usage: bench_json_tree [station_count ...]   (default: 1000 5000 20000)
+//
+// Parses a synthetic /api/v1/observations response from memory with a
+// plain wxJSONReader and with one constructed with wxJSONREADER_ARENA, and
+// times building the tree and destroying it separately. Build it against
+// an older jsonreader.cpp / jsonval.cpp for the numbers before the reader
+// moved values into place (without the arena flag).
+
+#include <wx/jsonreader.h>
+#include <wx/jsonval.h>
+#include <wx/log.h>
+
+#include "bench_payload.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct Times {
+    double parse_ms;
+    double free_ms;
+};
+
+// Best of iterations, parse and teardown timed apart.
+static Times ParseAndFree(const std::string &payload, int flags, int iterations,
+                          int *stations) {
+    Times best = {1e9, 1e9};
+    for (int i = 0; i < iterations; i++) {
+        std::unique_ptr<wxJSONValue> root(new wxJSONValue);
+        wxJSONReader reader(flags);
+        auto t0 = std::chrono::steady_clock::now();
+        int errors = reader.Parse(payload.data(), payload.size(), root.get());
+        auto t1 = std::chrono::steady_clock::now();
+        *stations = errors ? -1 : (*root)[wxT("stations")].Size();
+        root.reset();
+        auto t2 = std::chrono::steady_clock::now();
+        best.parse_ms = std::min(best.parse_ms,
+            std::chrono::duration<double, std::milli>(t1 - t0).count());
+        best.free_ms = std::min(best.free_ms,
+            std::chrono::duration<double, std::milli>(t2 - t1).count());
+    }
+    return best;
+}
+
+int main(int argc, char **argv) {
+    wxLogNull null_log;
+
+    std::vector<int> sizes;
+    for (int i = 1; i < argc; i++) sizes.push_back(std::atoi(argv[i]));
+    if (sizes.empty()) sizes = {1000, 5000, 20000};
+
+    std::printf("%8s %10s %11s %11s %11s %11s\n", "stations", "bytes",
+                "parse ms", "arena", "free ms", "arena");
+    for (int n : sizes) {
+        std::string payload = MakePayload(n);
+        int iterations = n >= 20000 ? 3 : 10;
+
+        int heap_count = 0, arena_count = 0;
+        Times heap = ParseAndFree(payload, wxJSONREADER_TOLERANT, iterations,
+                                  &heap_count);
+        Times arena = ParseAndFree(payload,
+                                   wxJSONREADER_TOLERANT | wxJSONREADER_ARENA,
+                                   iterations, &arena_count);
+        if (heap_count != n || arena_count != n) {
+            std::fprintf(stderr, "MISMATCH: %d stations, read %d / %d\n",
+                         n, heap_count, arena_count);
+            return 1;
+        }
+        std::printf("%8d %10zu %11.2f %11.2f %11.2f %11.2f\n", n,
+                    payload.size(), heap.parse_ms, arena.parse_ms,
+                    heap.free_ms, arena.free_ms);
+    }
+    return 0;
+}
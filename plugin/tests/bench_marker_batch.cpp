@@ -0,0 +1,94 @@
+// Benchmark: per-frame cost of the GL station overlay geometry.
+// Usage: bench_marker_batch [station_count ...]   (default: 1000 5000 20000)
+//
+// No GL context is needed. For each station count this prints the time to
+// build one frame's MarkerBatch, its vertex bytes, and the driver calls per
+// frame: the batched path's three glDrawArrays, against the glBegin /
+// glVertex / glEnd calls the immediate-mode renderer issued for the same
+// geometry. Immediate-mode driver overhead scales with that call count.
+
+#include "../src/marker_batch.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+struct SyntheticStation {
+    float px, py;
+    PlatformType kind;
+    double wind_dir, wind_spd;
+};
+
+// Screen-space stations spread over a 1920x1080 canvas; wind up to 70 kt.
+static std::vector<SyntheticStation> MakeStations(int n) {
+    std::vector<SyntheticStation> v;
+    for (int i = 0; i < n; i++) {
+        SyntheticStation s;
+        s.px = static_cast<float>(i * 7919 % 1920);
+        s.py = static_cast<float>(i * 104729 % 1080);
+        s.kind = static_cast<PlatformType>(i % PLATFORM_COUNT);
+        s.wind_dir = (i * 37) % 360;
+        s.wind_spd = (i % 140) / 2.0;
+        v.push_back(s);
+    }
+    return v;
+}
+
+static void BuildFrame(MarkerBatch &b, const std::vector<SyntheticStation> &st) {
+    b.Clear();
+    for (const SyntheticStation &s : st) {
+        b.AddMarker(s.kind, s.px, s.py, BatchColor::FromFloat(0.2f, 0.4f, 1, 0.8f));
+        b.AddWindBarb(s.px, s.py, s.wind_dir, s.wind_spd,
+                      BatchColor::FromFloat(0, 0, 0, 0.8f));
+    }
+}
+
+// Calls the immediate-mode renderer made for the same frame: glBegin,
+// one glVertex2f per vertex and glEnd for every marker, shaft, tick and
+// pennant, plus three glColor4f and two glLineWidth per station.
+static size_t ImmediateCalls(const MarkerBatch &b,
+                             const std::vector<SyntheticStation> &st) {
+    size_t calls = 0;
+    for (const SyntheticStation &s : st) {
+        switch (s.kind) {
+        case PLATFORM_SHIP:    calls += 2 + 3; break;
+        case PLATFORM_SHORE:
+        case PLATFORM_DRIFTER: calls += 2 + 4; break;
+        default:               calls += 2 + 18; break;  // 16-segment fan
+        }
+        calls += 5;
+    }
+    calls += b.Lines().size() / 2 * 4;     // shafts and ticks
+    calls += b.Pennants().size() / 3 * 5;
+    return calls;
+}
+
+template <typename F>
+static double TimeMs(int iterations, F fn) {
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) fn();
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(t1 - t0).count() / iterations;
+}
+
+int main(int argc, char **argv) {
+    std::vector<int> sizes;
+    for (int i = 1; i < argc; i++) sizes.push_back(std::atoi(argv[i]));
+    if (sizes.empty()) sizes = {1000, 5000, 20000};
+
+    std::printf("%8s %12s %12s %14s %12s\n",
+                "stations", "build ms", "vertex KB", "immediate", "batched");
+    MarkerBatch batch;
+    for (int n : sizes) {
+        std::vector<SyntheticStation> st = MakeStations(n);
+        BuildFrame(batch, st);  // warm up: grow the arrays once
+        double ms = TimeMs(50, [&]() { BuildFrame(batch, st); });
+        size_t verts = batch.Fills().size() + batch.Lines().size() +
+                       batch.Pennants().size();
+        std::printf("%8d %12.3f %12.1f %14zu %12d\n", n, ms,
+                    verts * sizeof(BatchVertex) / 1024.0,
+                    ImmediateCalls(batch, st), 3);
+    }
+    return 0;
+}
@@ -0,0 +1,99 @@
+// Benchmark: node trees shaped like a parsed observations document, with the
+// nodes from the heap and from a NodeArena.
+// Usage: bench_node_arena [station_count ...]   (default: 1000 5000 20000)
+//
+// Every station is an object node with 14 member nodes; three members own
+// a string and the container nodes own their child lists, as wxJSONRefData
+// owns wxString and map storage that the arena does not cover. Build and
+// teardown are timed apart. bench_json_tree measures the real wxJSONReader.
+
+#include "../src/node_arena.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+struct DocNode {
+    virtual ~DocNode() {
+        for (DocNode *k : kids) delete k;
+    }
+
+    static void *operator new(size_t size) { return NodeArena::Allocate(size); }
+    static void operator delete(void *p, size_t size) { NodeArena::Free(p, size); }
+
+    double number = 0;
+    std::string text;
+    std::vector<DocNode *> kids;
+    char rest[120];   // the other wxJSONRefData members
+};
+
+static const int MEMBERS = 14;
+
+static DocNode *Build(int stations) {
+    DocNode *root = new DocNode;
+    DocNode *arr = new DocNode;
+    root->kids.push_back(arr);
+    arr->kids.reserve(stations);
+    for (int i = 0; i < stations; i++) {
+        DocNode *st = new DocNode;
+        st->kids.reserve(MEMBERS);
+        for (int m = 0; m < MEMBERS; m++) {
+            DocNode *v = new DocNode;
+            if (m < 3) v->text = "2026-02-20T15:00:00Z-" + std::to_string(i);
+            else v->number = i * 0.1 + m;
+            st->kids.push_back(v);
+        }
+        arr->kids.push_back(st);
+    }
+    return root;
+}
+
+struct Times {
+    double build_ms;
+    double free_ms;
+};
+
+static Times Run(int stations, bool arena, int iterations) {
+    Times best = {1e9, 1e9};
+    for (int i = 0; i < iterations; i++) {
+        auto t0 = std::chrono::steady_clock::now();
+        DocNode *root;
+        {
+            NodeArena::Scope scope(arena);
+            root = Build(stations);
+        }
+        auto t1 = std::chrono::steady_clock::now();
+        delete root;
+        auto t2 = std::chrono::steady_clock::now();
+        best.build_ms = std::min(best.build_ms,
+            std::chrono::duration<double, std::milli>(t1 - t0).count());
+        best.free_ms = std::min(best.free_ms,
+            std::chrono::duration<double, std::milli>(t2 - t1).count());
+    }
+    return best;
+}
+
+int main(int argc, char **argv) {
+    std::vector<int> sizes;
+    for (int i = 1; i < argc; i++) sizes.push_back(std::atoi(argv[i]));
+    if (sizes.empty()) sizes = {1000, 5000, 20000};
+
+    std::printf("%8s %8s %11s %11s %11s %11s\n", "stations", "nodes",
+                "build ms", "arena", "free ms", "arena");
+    for (int n : sizes) {
+        int iterations = n >= 20000 ? 5 : 20;
+        Times heap = Run(n, false, iterations);
+        Times arena = Run(n, true, iterations);
+        if (NodeArena::Count() != 0) {
+            std::fprintf(stderr, "LEAK: %d arenas left\n", NodeArena::Count());
+            return 1;
+        }
+        std::printf("%8d %8d %11.2f %11.2f %11.2f %11.2f\n", n,
+                    2 + n * (MEMBERS + 1), heap.build_ms, arena.build_ms,
+                    heap.free_ms, arena.free_ms);
+    }
+    return 0;
+}
@@ -0,0 +1,56 @@
+// Benchmark: streaming ParseObservations() vs. the wxJSONValue DOM path.
+// Usage: bench_obs_parser [station_count ...]   (default: 1000 5000 20000)
+
+#include "../src/obs_parser.h"
+#include "bench_payload.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <wx/log.h>
+
+template <typename F>
+static double TimeMs(int iterations, F fn) {
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) fn();
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(t1 - t0).count() / iterations;
+}
+
+int main(int argc, char **argv) {
+    wxLogNull null_log;
+
+    std::vector<int> sizes;
+    for (int i = 1; i < argc; i++) sizes.push_back(std::atoi(argv[i]));
+    if (sizes.empty()) sizes = {1000, 5000, 20000};
+
+    std::printf("%8s %10s %12s %12s %9s\n",
+                "stations", "bytes", "dom ms", "stream ms", "speedup");
+    for (int n : sizes) {
+        std::string payload = MakePayload(n);
+        int iterations = n >= 20000 ? 3 : 10;
+
+        ObservationList dom_out, stream_out;
+        wxString err;
+        double dom_ms = TimeMs(iterations, [&]() {
+            // The DOM path also pays the UTF-8 -> wxString conversion that
+            // FetchObservations used to do.
+            wxString json = wxString::FromUTF8(payload.data(), payload.size());
+            ParseObservationsDOM(json, dom_out, err);
+        });
+        double stream_ms = TimeMs(iterations, [&]() {
+            ParseObservations(payload.data(), payload.size(), stream_out, err);
+        });
+
+        if (dom_out.size() != stream_out.size()) {
+            std::fprintf(stderr, "MISMATCH: dom=%zu stream=%zu stations\n",
+                         dom_out.size(), stream_out.size());
+            return 1;
+        }
+        std::printf("%8d %10zu %12.2f %12.2f %8.1fx\n", n, payload.size(),
+                    dom_ms, stream_ms, dom_ms / stream_ms);
+    }
+    return 0;
+}
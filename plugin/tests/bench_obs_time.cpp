@@ -0,0 +1,101 @@
+// Benchmark: observation time decoding and per-frame marker ageing.
+// Usage: bench_obs_time [count]   (default: 100000)
+//
+// Decodes count "YYYY-MM-DDTHH:MM:SSZ" strings with ParseIsoTime() and with
+// wxDateTime::ParseISOCombined() + EpochFromDateTime() (what the parsers did
+// before), then turns count times into marker opacities with one
+// AgeBuckets() pass plus table lookups and with the old per-station
+// floating-point formula.
+
+#include "../src/age_fade.h"
+#include "../src/history_store.h"
+#include "../src/station_view.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <wx/datetime.h>
+#include <wx/string.h>
+
+static const int RUNS = 5;
+
+// Best of RUNS, in ns per item.
+template <typename F>
+static double NsPerItem(size_t n, F f) {
+    double best_s = 1e9;
+    for (int r = 0; r < RUNS; r++) {
+        auto t0 = std::chrono::steady_clock::now();
+        f();
+        auto t1 = std::chrono::steady_clock::now();
+        best_s = std::min(best_s, std::chrono::duration<double>(t1 - t0).count());
+    }
+    return best_s * 1e9 / n;
+}
+
+// The overlay's opacity formula before age buckets.
+static float OpacityPerStation(int64_t obs_time, int64_t now) {
+    if (obs_time == TIME_UNKNOWN) return 0.5f;
+    double hours = (now - obs_time) / 3600.0;
+    if (hours < 0) hours = 0;
+    if (hours > 24) return 0.15f;
+    return static_cast<float>(1.0 - 0.7 * (hours / 24.0));
+}
+
+int main(int argc, char **argv) {
+    size_t n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+    const int64_t now = 1771599600;   // 2026-02-20T15:00:00Z
+
+    // Observation times spread over the last 36 hours, a few unknown.
+    std::vector<int64_t> times(n);
+    std::vector<std::string> strings(n);
+    for (size_t i = 0; i < n; i++) {
+        times[i] = i % 97 == 0 ? TIME_UNKNOWN
+                               : now - static_cast<int64_t>(i * 7919 % 129600);
+        strings[i] = FormatIsoTime(now - static_cast<int64_t>(i * 7919 % 129600));
+    }
+    std::vector<wxString> wx_strings(strings.begin(), strings.end());
+
+    int64_t sum_fast = 0, sum_wx = 0;
+    double fast_ns = NsPerItem(n, [&] {
+        sum_fast = 0;
+        for (const std::string &s : strings)
+            sum_fast += ParseIsoTime(s.data(), s.size());
+    });
+    double wx_ns = NsPerItem(n, [&] {
+        sum_wx = 0;
+        for (const wxString &s : wx_strings) {
+            wxDateTime dt;
+            dt.ParseISOCombined(s);
+            sum_wx += EpochFromDateTime(dt);
+        }
+    });
+    if (sum_fast != sum_wx) {
+        std::fprintf(stderr, "MISMATCH: decoded times differ\n");
+        return 1;
+    }
+    std::printf("decode %zu timestamps:\n", n);
+    std::printf("  ParseIsoTime              %8.1f ns each\n", fast_ns);
+    std::printf("  wxDateTime::ParseISO...   %8.1f ns each  (%.1fx)\n",
+                wx_ns, wx_ns / fast_ns);
+
+    std::vector<uint16_t> buckets(n);
+    float sum_buckets = 0, sum_each = 0;
+    double bucket_ns = NsPerItem(n, [&] {
+        AgeBuckets(times.data(), n, now, buckets.data());
+        sum_buckets = 0;
+        for (size_t i = 0; i < n; i++) sum_buckets += AgeBucketOpacity(buckets[i]);
+    });
+    double each_ns = NsPerItem(n, [&] {
+        sum_each = 0;
+        for (size_t i = 0; i < n; i++) sum_each += OpacityPerStation(times[i], now);
+    });
+    std::printf("marker opacity for %zu stations (sums %.1f / %.1f):\n",
+                n, sum_buckets, sum_each);
+    std::printf("  AgeBuckets + lookup       %8.2f ns each\n", bucket_ns);
+    std::printf("  per-station formula       %8.2f ns each  (%.1fx)\n",
+                each_ns, each_ns / bucket_ns);
+    return 0;
+}
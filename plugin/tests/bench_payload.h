@@ -0,0 +1,46 @@
+#ifndef _BENCH_PAYLOAD_H_
+#define _BENCH_PAYLOAD_H_
+
+// Synthetic server response shaped like /api/v1/observations output, shared
+// by the benchmarks — no wx dependencies.
+//
+// n stations with every field set, or with missing_values, gust and wave
+// height null on most stations as in real data.
+
+#include <cstdio>
+#include <string>
+
+inline std::string MakePayload(int n, bool missing_values = false) {
+    static const char *types[] = {"ship", "buoy", "shore", "drifter", "other"};
+    std::string s = "{\"generated\": \"2026-02-20T15:00:00Z\", \"count\": " +
+                    std::to_string(n) + ", \"stations\": [";
+    char buf[512], gust[16], wave_ht[16];
+    for (int i = 0; i < n; i++) {
+        if (missing_values) {
+            std::snprintf(gust, sizeof(gust), "%s", i % 3 ? "null" : "12.5");
+            std::snprintf(wave_ht, sizeof(wave_ht), "%s",
+                          i % 5 == 1 ? "1.5" : "null");
+        } else {
+            std::snprintf(gust, sizeof(gust), "%.1f", (i % 350) / 10.0);
+            std::snprintf(wave_ht, sizeof(wave_ht), "%.1f", (i % 80) / 10.0);
+        }
+        std::snprintf(buf, sizeof(buf),
+            "%s{\"id\": \"ST%05d\", \"type\": \"%s\", \"country\": \"US\", "
+            "\"lat\": %.4f, \"lon\": %.4f, \"time\": \"2026-02-20T%02d:%02d:00Z\", "
+            "\"wind_dir\": %d.0, \"wind_spd\": %.1f, \"gust\": %s, "
+            "\"pressure\": %.1f, \"air_temp\": %.1f, \"sea_temp\": %.1f, "
+            "\"wave_ht\": %s, \"vis\": null}",
+            i ? ", " : "", i, types[i % 5],
+            -80.0 + (i * 7919 % 16000) / 100.0,
+            -180.0 + (i * 104729 % 36000) / 100.0,
+            i % 24, i % 60, (i * 37) % 360,
+            (i % 300) / 10.0, gust,
+            980.0 + (i % 500) / 10.0, (i % 400) / 10.0 - 10.0,
+            (i % 300) / 10.0, wave_ht);
+        s += buf;
+    }
+    s += "]}";
+    return s;
+}
+
+#endif // _BENCH_PAYLOAD_H_
@@ -0,0 +1,87 @@
+// Benchmark: columnar wire format (DecodeWire) vs. JSON (ParseObservations)
+// for the same stations — body size and decode time.
+// Usage: bench_wire_format [station_count ...]   (default: 1000 5000 20000)
+//
+// The JSON time stops at an ObservationList; packing it into columns, which
+// FetchObservations also does, comes on top. Sizes are uncompressed.
+
+#include "../src/obs_parser.h"
+#include "../src/wire_format.h"
+#include "bench_payload.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <wx/log.h>
+
+// What the server would encode: the parsed stations as columns.
+static StationColumns ToColumns(const ObservationList &stations) {
+    StationColumns cols;
+    for (const ObservationStation &st : stations) {
+        const double values[METRIC_COUNT] = {
+            st.wind_dir, st.wind_spd, st.gust, st.pressure,
+            st.air_temp, st.sea_temp, st.wave_ht, st.vis};
+        cols.lat.push_back(st.lat);
+        cols.lon.push_back(st.lon);
+        cols.time.push_back(st.time);
+        for (int m = 0; m < METRIC_COUNT; m++)
+            cols.metric[m].push_back(static_cast<float>(values[m]));
+        cols.id.push_back(cols.Intern(std::string(st.id.mb_str(wxConvUTF8))));
+        cols.type.push_back(cols.Intern(std::string(st.type.mb_str(wxConvUTF8))));
+        cols.country.push_back(cols.Intern(std::string(st.country.mb_str(wxConvUTF8))));
+    }
+    return cols;
+}
+
+template <typename F>
+static double TimeMs(int iterations, F fn) {
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) fn();
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(t1 - t0).count() / iterations;
+}
+
+int main(int argc, char **argv) {
+    wxLogNull null_log;
+
+    std::vector<int> sizes;
+    for (int i = 1; i < argc; i++) sizes.push_back(std::atoi(argv[i]));
+    if (sizes.empty()) sizes = {1000, 5000, 20000};
+
+    std::printf("%8s %10s %10s %7s %10s %10s %9s\n", "stations", "json B",
+                "wire B", "ratio", "json ms", "wire ms", "speedup");
+    for (int n : sizes) {
+        std::string json = MakePayload(n, true);
+        ObservationList parsed;
+        wxString err;
+        if (!ParseObservations(json.data(), json.size(), parsed, err)) {
+            std::fprintf(stderr, "JSON parse failed\n");
+            return 1;
+        }
+        std::string wire = EncodeWire(ToColumns(parsed));
+        int iterations = n >= 20000 ? 5 : 20;
+
+        ObservationList json_out;
+        StationColumns wire_out;
+        double json_ms = TimeMs(iterations, [&]() {
+            ParseObservations(json.data(), json.size(), json_out, err);
+        });
+        double wire_ms = TimeMs(iterations, [&]() {
+            DecodeWire(wire.data(), wire.size(), wire_out);
+        });
+
+        if (json_out.size() != wire_out.Size()) {
+            std::fprintf(stderr, "MISMATCH: json=%zu wire=%zu stations\n",
+                         json_out.size(), wire_out.Size());
+            return 1;
+        }
+        std::printf("%8d %10zu %10zu %6.1fx %10.2f %10.2f %8.1fx\n", n,
+                    json.size(), wire.size(),
+                    static_cast<double>(json.size()) / wire.size(),
+                    json_ms, wire_ms, json_ms / wire_ms);
+    }
+    return 0;
+}
@@ -0,0 +1,79 @@
+#include "test_runner.h"
+#include "../src/age_fade.h"
+
+#include <cstdint>
+#include <vector>
+
+static const int64_t NOW = 1771599600;   // 2026-02-20T15:00:00Z
+
+// AgeBuckets() must agree with AgeBucket() for every time, whatever lane
+// of a group of four it lands in.
+static void RequireSameBuckets(const std::vector<int64_t> &times, int64_t now) {
+    for (size_t shift = 0; shift < 4; shift++) {
+        std::vector<int64_t> t(shift, now);
+        t.insert(t.end(), times.begin(), times.end());
+        std::vector<uint16_t> out(t.size(), 0xffff);
+        AgeBuckets(t.data(), t.size(), now, out.data());
+        for (size_t i = 0; i < t.size(); i++)
+            REQUIRE_EQ(out[i], AgeBucket(t[i], now));
+    }
+}
+
+TEST(AgeBucket_minutes_and_limits) {
+    REQUIRE_EQ(AgeBucket(NOW, NOW), 0);
+    REQUIRE_EQ(AgeBucket(NOW - 59, NOW), 0);
+    REQUIRE_EQ(AgeBucket(NOW - 60, NOW), 1);
+    REQUIRE_EQ(AgeBucket(NOW - 3599, NOW), 59);
+    REQUIRE_EQ(AgeBucket(NOW - 86399, NOW), 1439);
+    REQUIRE_EQ(AgeBucket(NOW - 86400, NOW), 1440);
+    REQUIRE_EQ(AgeBucket(NOW - 86401, NOW), AGE_BUCKET_OLD);
+    REQUIRE_EQ(AgeBucket(NOW + 3600, NOW), 0);          // clock skew
+    REQUIRE_EQ(AgeBucket(TIME_UNKNOWN, NOW), AGE_BUCKET_UNKNOWN);
+    REQUIRE_EQ(AgeBucket(INT64_MIN + 1, NOW), AGE_BUCKET_OLD);
+    REQUIRE_EQ(AgeBucket(INT64_MAX, NOW), 0);
+}
+
+TEST(AgeBuckets_every_second_of_the_fade) {
+    std::vector<int64_t> times;
+    for (int64_t age = -120; age <= AGE_FADE_SECONDS + 120; age++)
+        times.push_back(NOW - age);
+    RequireSameBuckets(times, NOW);
+}
+
+TEST(AgeBuckets_extremes) {
+    std::vector<int64_t> times = {
+        TIME_UNKNOWN, INT64_MIN + 1, INT64_MIN + 86400, INT64_MAX, INT64_MAX - 1,
+        0, -1, 1, NOW - (int64_t(1) << 32), NOW + (int64_t(1) << 32),
+        NOW - (int64_t(1) << 32) - 60, NOW - 0x7fffffff, NOW - 0x80000000LL,
+        NOW + 0x7fffffff, NOW + 0x80000000LL, TIME_UNKNOWN, NOW - 86401,
+    };
+    RequireSameBuckets(times, NOW);
+    RequireSameBuckets(times, 0);
+    RequireSameBuckets(times, -NOW);                   // before 1970
+    RequireSameBuckets(times, INT64_MAX);
+    RequireSameBuckets(times, INT64_MIN + 86401);
+}
+
+TEST(AgeBuckets_short_and_empty) {
+    uint16_t out[3] = {7, 7, 7};
+    AgeBuckets(nullptr, 0, NOW, out);
+    REQUIRE_EQ(out[0], 7);
+    int64_t t[3] = {NOW - 120, TIME_UNKNOWN, NOW - 90000};
+    AgeBuckets(t, 3, NOW, out);
+    REQUIRE_EQ(out[0], 2);
+    REQUIRE_EQ(out[1], AGE_BUCKET_UNKNOWN);
+    REQUIRE_EQ(out[2], AGE_BUCKET_OLD);
+}
+
+TEST(AgeOpacity_fade) {
+    REQUIRE_NEAR(AgeOpacity(NOW, NOW), 1.0, 1e-6);
+    REQUIRE_NEAR(AgeOpacity(NOW - 43200, NOW), 0.65, 1e-6);
+    REQUIRE_NEAR(AgeOpacity(NOW - 86400, NOW), 0.3, 1e-6);
+    REQUIRE_NEAR(AgeOpacity(NOW - 86401, NOW), 0.15, 1e-6);
+    REQUIRE_NEAR(AgeOpacity(NOW + 600, NOW), 1.0, 1e-6);
+    REQUIRE_NEAR(AgeOpacity(TIME_UNKNOWN, NOW), 0.5, 1e-6);
+    for (uint16_t b = 1; b <= AGE_FADE_SECONDS / 60; b++)
+        REQUIRE(AgeBucketOpacity(b) < AgeBucketOpacity(b - 1));
+}
+
+int main(int argc, char **argv) { return run_tests(argc, argv); }
@@ -0,0 +1,139 @@
+#include "test_runner.h"
+#include "../src/glyph_atlas.h"
+
+#include <string>
+
+static const BatchColor GRAY = {77, 77, 77, 255};
+
+// Cells of w x h for every byte of s (ASCII only).
+static void AddGlyphs(GlyphAtlas &atlas, const std::string &s, int w, int h) {
+    for (char c : s) atlas.Add(static_cast<unsigned char>(c), w, h);
+}
+
+// ---- UTF-8 -----------------------------------------------------------------
+
+TEST(NextCodePoint_decodes_utf8) {
+    std::string s = "A\xc3\xa9\xe2\x82\xac\xf0\x9f\x8c\x8a";  // A é € 🌊
+    const char *p = s.data(), *end = p + s.size();
+    REQUIRE_EQ(NextCodePoint(p, end), 0x41u);
+    REQUIRE_EQ(NextCodePoint(p, end), 0xE9u);
+    REQUIRE_EQ(NextCodePoint(p, end), 0x20ACu);
+    REQUIRE_EQ(NextCodePoint(p, end), 0x1F30Au);
+    REQUIRE(p == end);
+}
+
+TEST(NextCodePoint_malformed_yields_replacement) {
+    std::string s = "\xc3" "A" "\xe2\x82";  // truncated sequences
+    const char *p = s.data(), *end = p + s.size();
+    REQUIRE_EQ(NextCodePoint(p, end), 0xFFFDu);
+    REQUIRE_EQ(NextCodePoint(p, end), 0x41u);
+    REQUIRE_EQ(NextCodePoint(p, end), 0xFFFDu);
+    REQUIRE_EQ(NextCodePoint(p, end), 0xFFFDu);
+    REQUIRE(p == end);
+}
+
+// ---- packing ---------------------------------------------------------------
+
+TEST(GlyphAtlas_cells_do_not_overlap) {
+    GlyphAtlas atlas(64, 64);
+    for (uint32_t cp = 0; cp < 30; cp++)
+        REQUIRE(atlas.Add(cp, 5 + cp % 4, 9) != nullptr);
+    for (uint32_t a = 0; a < 30; a++) {
+        const GlyphCell *ca = atlas.Find(a);
+        REQUIRE(ca->x + ca->w < 64 && ca->y + ca->h < 64);
+        for (uint32_t b = a + 1; b < 30; b++) {
+            const GlyphCell *cb = atlas.Find(b);
+            bool apart = ca->x + ca->w < cb->x || cb->x + cb->w < ca->x ||
+                         ca->y + ca->h < cb->y || cb->y + cb->h < ca->y;
+            REQUIRE(apart);
+        }
+    }
+}
+
+TEST(GlyphAtlas_full_then_reset) {
+    GlyphAtlas atlas(32, 32);
+    uint32_t cp = 0;
+    while (atlas.Add(cp, 8, 8)) cp++;
+    REQUIRE_EQ(cp, 9u);  // 3 x 3 cells with gutters
+    atlas.ClearDirty();
+    atlas.Reset();
+    REQUIRE(atlas.IsDirty());
+    REQUIRE(atlas.Find(0) == nullptr);
+    REQUIRE(atlas.Add(100, 8, 8) != nullptr);
+}
+
+// ---- layout ----------------------------------------------------------------
+
+TEST(GlyphAtlas_label_quads_and_advance) {
+    GlyphAtlas atlas(128, 128);
+    AddGlyphs(atlas, "AB", 6, 10);
+    atlas.Add(0xE9, 5, 10);
+    std::vector<LabelVertex> v;
+    std::vector<uint32_t> missing;
+    float w = atlas.AppendLabel("AB\xc3\xa9", 4, 20, 30, GRAY, v, &missing);
+    REQUIRE_EQ(w, 17.0f);
+    REQUIRE_EQ(v.size(), 18u);
+    REQUIRE(missing.empty());
+    // Second glyph starts where the first ends; texcoords map its cell
+    const GlyphCell *b = atlas.Find('B');
+    REQUIRE_EQ(v[6].x, 26.0f);
+    REQUIRE_EQ(v[6].y, 30.0f);
+    REQUIRE_EQ(v[6].u, b->x / 128.0f);
+    REQUIRE_EQ(v[8].v, (b->y + b->h) / 128.0f);
+    REQUIRE_EQ(v[17].color.r, 77);
+}
+
+TEST(GlyphAtlas_reports_missing_glyphs) {
+    GlyphAtlas atlas(128, 128);
+    AddGlyphs(atlas, "A", 6, 10);
+    std::vector<LabelVertex> v;
+    std::vector<uint32_t> missing;
+    atlas.AppendLabel("AZA", 3, 0, 0, GRAY, v, &missing);
+    REQUIRE_EQ(v.size(), 12u);
+    REQUIRE_EQ(missing.size(), 1u);
+    REQUIRE_EQ(missing[0], uint32_t('Z'));
+}
+
+// As RasterizeGlyphs does it: a full atlas starts over.
+static void AddMissing(GlyphAtlas &atlas, const std::vector<uint32_t> &cps) {
+    for (uint32_t cp : cps) {
+        if (atlas.Find(cp)) continue;
+        if (!atlas.Add(cp, 8, 8)) {
+            atlas.Reset();
+            atlas.Add(cp, 8, 8);
+        }
+    }
+}
+
+TEST(GlyphAtlas_relayout_after_reset_finds_dropped_glyphs) {
+    GlyphAtlas atlas(32, 32);   // 9 cells of 8 x 8
+    AddGlyphs(atlas, "ABCDEFGH", 8, 8);
+    std::vector<LabelVertex> v;
+    std::vector<uint32_t> missing;
+    atlas.AppendLabel("AXY", 3, 0, 0, GRAY, v, &missing);
+    REQUIRE_EQ(missing.size(), 2u);
+
+    // Y does not fit after X: the reset drops A, which the layout had
+    unsigned generation = atlas.Generation();
+    AddMissing(atlas, missing);
+    REQUIRE(atlas.Generation() != generation);
+    REQUIRE(atlas.Find('A') == nullptr);
+
+    // Laying out again reports it, and the next pass completes the label
+    v.clear();
+    missing.clear();
+    atlas.AppendLabel("AXY", 3, 0, 0, GRAY, v, &missing);
+    REQUIRE_EQ(missing.size(), 2u);
+    generation = atlas.Generation();
+    AddMissing(atlas, missing);
+    REQUIRE_EQ(atlas.Generation(), generation);
+    v.clear();
+    missing.clear();
+    atlas.AppendLabel("AXY", 3, 0, 0, GRAY, v, &missing);
+    REQUIRE(missing.empty());
+    REQUIRE_EQ(v.size(), 18u);
+}
+
+int main(int argc, char **argv) {
+    return run_tests(argc, argv);
+}
@@ -1,8 +1,10 @@
 #include "test_runner.h"
 #include "../src/gpx_builder.h"
+#include "../src/station_view.h"
 
 #include <cmath>
 #include <cstdio>
+#include <utility>
 #include <wx/log.h>
 
 // ---- helpers ---------------------------------------------------------------
@@ -17,7 +19,7 @@ static ObservationStation make_station(const char *id, double lat, double lon,
     st.lon  = lon;
     st.wind_spd = wind_spd_ms;
     st.wind_dir = wind_dir;
-    st.time.ParseISOCombined(wxT("2026-02-20T14:30:00Z"));
+    st.time = 1771597800;   // 2026-02-20T14:30:00Z
     return st;
 }
 
@@ -80,7 +82,7 @@ TEST(BuildGPXString_nan_latlon_station_skipped) {
     bad.id  = wxT("BAD");
     bad.lat = NAN;
     bad.lon = NAN;
-    bad.time.ParseISOCombined(wxT("2026-02-20T14:30:00Z"));
+    bad.time = 1771597800;
     ObservationList stns = {bad};
     wxString gpx = BuildGPXString(fetch_time(), stns);
     REQUIRE(!gpx.Contains(wxT("<wpt")));
@@ -114,6 +116,19 @@ TEST(BuildGPXString_fetched_at_in_desc) {
     REQUIRE(gpx.Contains(wxT("2026-02-20T15:00:00Z")));
 }
 
+TEST(BuildGPXString_reads_interned_country_from_store) {
+    ObservationStation a = make_station("A", 1.0, 2.0);
+    ObservationStation b = make_station("B", 3.0, 4.0);
+    a.country = wxT("NO");
+    StationColumns cols;
+    StationsToColumns({a, b}, cols);
+    StationStore store;
+    store.SetColumns(std::move(cols));
+    wxString gpx = BuildGPXString(fetch_time(), store);
+    REQUIRE(gpx.Contains(wxT("Country: NO")));
+    REQUIRE_EQ(gpx.find(wxT("Country:")), gpx.rfind(wxT("Country:")));
+}
+
 // ---- ISO time in <time> element --------------------------------------------
 
 TEST(BuildGPXString_obs_time_element) {
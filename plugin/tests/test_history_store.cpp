@@ -0,0 +1,369 @@
+#include "test_runner.h"
+#include "../src/history_store.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+// ---- helpers ---------------------------------------------------------------
+
+// Store files are created in the working directory (the build tree under
+// ctest) and removed before each test.
+static const char *BASE = "test_history_store_tmp";
+
+static void CleanStore(const std::string &base = BASE) {
+    std::remove((base + ".idx").c_str());
+    std::remove((base + ".idx.tmp").c_str());
+    for (int gen = 0; gen < 16; gen++)
+        std::remove((base + "." + std::to_string(gen) + ".dat").c_str());
+}
+
+// n stations with distinct positions; ids unique, types/countries shared.
+static StationColumns MakeColumns(int n, int seed = 0) {
+    static const char *types[] = {"ship", "buoy", "shore"};
+    StationColumns c;
+    for (int i = 0; i < n; i++) {
+        c.lat.push_back(-60.0 + (i + seed) * 0.5);
+        c.lon.push_back(-170.0 + (i + seed) * 0.25);
+        c.time.push_back(i % 4 == 0 ? TIME_UNKNOWN : 1771597800 + i * 60);
+        for (int m = 0; m < METRIC_COUNT; m++)
+            c.metric[m].push_back(i % 3 == m % 3 ? NAN : float(m * 100 + i) + 0.5f);
+        c.id.push_back(c.Intern("ST" + std::to_string(seed) + "_" + std::to_string(i)));
+        c.type.push_back(c.Intern(types[i % 3]));
+        c.country.push_back(c.Intern(i % 2 ? "US" : ""));
+    }
+    return c;
+}
+
+static bool FileExists(const std::string &path) {
+    FILE *f = std::fopen(path.c_str(), "rb");
+    if (f) std::fclose(f);
+    return f != nullptr;
+}
+
+static HistoryRecordInfo MakeInfo(const std::string &label, int64_t at) {
+    HistoryRecordInfo info;
+    info.label = label;
+    info.fetched_at = at;
+    info.lat_min = 30; info.lat_max = 45.5;
+    info.lon_min = -80; info.lon_max = -60.25;
+    return info;
+}
+
+static bool SameFloat(float a, float b) {
+    return (std::isnan(a) && std::isnan(b)) || a == b;
+}
+
+// Element-wise comparison of a view against the columns it was made from.
+static bool SameView(const StationColumns &a, const StationView &v) {
+    if (a.Size() != v.Size()) return false;
+    for (size_t i = 0; i < a.Size(); i++) {
+        if (a.lat[i] != v.lat[i] || a.lon[i] != v.lon[i]) return false;
+        if (a.time[i] != v.time[i]) return false;
+        for (int m = 0; m < METRIC_COUNT; m++)
+            if (!SameFloat(a.metric[m][i], v.metric[m][i])) return false;
+        if (!v.StringEquals(v.id[i], a.String(a.id[i]))) return false;
+        if (!v.StringEquals(v.type[i], a.String(a.type[i]))) return false;
+        if (!v.StringEquals(v.country[i], a.String(a.country[i]))) return false;
+    }
+    return true;
+}
+
+static bool SameColumns(const StationColumns &a, const StationColumns &b) {
+    if (a.Size() != b.Size()) return false;
+    for (size_t i = 0; i < a.Size(); i++) {
+        if (a.lat[i] != b.lat[i] || a.lon[i] != b.lon[i]) return false;
+        if (a.time[i] != b.time[i]) return false;
+        for (int m = 0; m < METRIC_COUNT; m++)
+            if (!SameFloat(a.metric[m][i], b.metric[m][i])) return false;
+        if (a.String(a.id[i]) != b.String(b.id[i])) return false;
+        if (a.String(a.type[i]) != b.String(b.type[i])) return false;
+        if (a.String(a.country[i]) != b.String(b.country[i])) return false;
+    }
+    return true;
+}
+
+// ---- dates -----------------------------------------------------------------
+
+TEST(DaysFromCivil_round_trip) {
+    REQUIRE_EQ(DaysFromCivil(1970, 1, 1), 0);
+    REQUIRE_EQ(DaysFromCivil(2026, 2, 20), 20504);
+    REQUIRE_EQ(DaysFromCivil(1969, 12, 31), -1);
+    for (int64_t d = -800000; d < 800000; d += 997) {
+        int y, m, dd;
+        CivilFromDays(d, y, m, dd);
+        REQUIRE_EQ(DaysFromCivil(y, m, dd), d);
+    }
+}
+
+// ---- blocks ----------------------------------------------------------------
+
+TEST(FormatIsoTime_utc) {
+    REQUIRE_EQ(FormatIsoTime(0), "1970-01-01T00:00:00Z");
+    REQUIRE_EQ(FormatIsoTime(1771597800), "2026-02-20T14:30:00Z");
+    REQUIRE_EQ(FormatIsoTime(-1), "1969-12-31T23:59:59Z");
+}
+
+TEST(ParseIsoTime_fixed_format) {
+    REQUIRE_EQ(ParseIsoTime("2026-02-20T14:30:00Z", 20), int64_t(1771597800));
+    REQUIRE_EQ(ParseIsoTime("1970-01-01T00:00:00Z", 20), int64_t(0));
+    REQUIRE_EQ(ParseIsoTime("1969-12-31T23:59:59Z", 20), int64_t(-1));
+    REQUIRE_EQ(ParseIsoTime("2024-02-29T12:00:00Z", 20),
+               DaysFromCivil(2024, 2, 29) * 86400 + 12 * 3600);
+    for (int64_t t = -4000000000LL; t < 4000000000LL; t += 7777777) {
+        std::string s = FormatIsoTime(t);
+        REQUIRE_EQ(ParseIsoTime(s.data(), s.size()), t);
+    }
+}
+
+TEST(ParseIsoTime_rejects_other_forms) {
+    const char *bad[] = {
+        "2026-02-20T14:30:00",  "2026-02-20 14:30:00Z", "2026-02-20T14:30:00.5Z",
+        "2026-02-20T14:30Z",    "2026-2-20T14:30:00Z",  "2026-02-20T14:30:00+00:00",
+        "2026-13-01T00:00:00Z", "2026-00-01T00:00:00Z", "2026-02-29T00:00:00Z",
+        "2026-04-31T00:00:00Z", "2026-02-00T00:00:00Z", "2026-02-20T24:00:00Z",
+        "2026-02-20T14:60:00Z", "2026-02-20T14:30:60Z", "2026-02-2xT14:30:00Z",
+        "1900-02-29T00:00:00Z", "", "Z",
+    };
+    for (const char *s : bad)
+        REQUIRE_EQ(ParseIsoTime(s, std::strlen(s)), TIME_UNKNOWN);
+    REQUIRE_EQ(ParseIsoTime("2000-02-29T00:00:00Z", 20), DaysFromCivil(2000, 2, 29) * 86400);
+}
+
+TEST(StationColumns_intern_dedups_strings) {
+    StationColumns c = MakeColumns(30);
+    // "" + 30 ids + 3 types + "US"
+    REQUIRE_EQ(c.StringCount(), 35u);
+    REQUIRE_EQ(c.Intern(""), 0u);
+    REQUIRE_EQ(c.Intern("buoy"), c.type[1]);
+}
+
+TEST(Block_round_trip_preserves_columns) {
+    StationColumns in = MakeColumns(37), out;
+    std::string block = EncodeBlock(in);
+    REQUIRE_EQ(block.size() % 8, 0u);
+    REQUIRE(DecodeBlock(block.data(), block.size(), out));
+    REQUIRE(SameColumns(in, out));
+}
+
+TEST(Block_layout_sections_are_8_byte_aligned) {
+    BlockLayout lay(13, 5, 21);
+    REQUIRE_EQ(lay.lat % 8, 0u);
+    REQUIRE_EQ(lay.time % 8, 0u);
+    for (int m = 0; m < METRIC_COUNT; m++) REQUIRE_EQ(lay.metric[m] % 8, 0u);
+    REQUIRE_EQ(lay.country % 8, 0u);
+    REQUIRE_EQ(lay.string_bytes % 8, 0u);
+    REQUIRE_EQ(lay.total % 8, 0u);
+}
+
+TEST(Block_decode_rejects_damage) {
+    StationColumns in = MakeColumns(5), out;
+    std::string block = EncodeBlock(in);
+    REQUIRE(!DecodeBlock(block.data(), block.size() - 8, out));
+    std::string bad = block;
+    bad[0] = 'X';
+    REQUIRE(!DecodeBlock(bad.data(), bad.size(), out));
+    bad = block;
+    BlockLayout lay(5, in.StringCount(), 0);
+    bad[lay.id] = '\x7f';  // id index out of range
+    REQUIRE(!DecodeBlock(bad.data(), bad.size(), out));
+}
+
+// ---- store -----------------------------------------------------------------
+
+TEST(HistoryStore_append_load_and_reopen) {
+    CleanStore();
+    StationColumns a = MakeColumns(10, 1), b = MakeColumns(0), c = MakeColumns(25, 2);
+    {
+        HistoryStore store;
+        REQUIRE(store.Open(BASE));
+        REQUIRE(store.IsNew());
+        REQUIRE(store.Append(MakeInfo("first", 1771597800), a));
+        REQUIRE(store.Append(MakeInfo("empty", TIME_UNKNOWN), b));
+        REQUIRE(store.Append(MakeInfo("dritte \xc3\xa9", 1771601400), c));
+    }
+    HistoryStore store;
+    REQUIRE(store.Open(BASE));
+    REQUIRE(!store.IsNew());
+    REQUIRE_EQ(store.Records().size(), 3u);
+    const HistoryRecordInfo &r = store.Records()[2];
+    REQUIRE_EQ(r.label, std::string("dritte \xc3\xa9"));
+    REQUIRE_EQ(r.fetched_at, 1771601400);
+    REQUIRE_EQ(r.station_count, 25u);
+    REQUIRE_EQ(r.lon_max, -60.25);
+    REQUIRE_EQ(store.Records()[1].fetched_at, TIME_UNKNOWN);
+
+    StationColumns out;
+    REQUIRE(store.Load(0, out));
+    REQUIRE(SameColumns(a, out));
+    REQUIRE(store.Load(1, out));
+    REQUIRE_EQ(out.Size(), 0u);
+    REQUIRE(store.Load(2, out));
+    REQUIRE(SameColumns(c, out));
+    REQUIRE(!store.Load(3, out));
+    CleanStore();
+}
+
+TEST(HistoryStore_remove_and_trim_keep_order) {
+    CleanStore();
+    HistoryStore store;
+    REQUIRE(store.Open(BASE));
+    for (int i = 0; i < 5; i++)
+        REQUIRE(store.Append(MakeInfo("r" + std::to_string(i), i), MakeColumns(4, i)));
+    REQUIRE(store.Remove(1));
+    REQUIRE_EQ(store.Records().size(), 4u);
+    REQUIRE_EQ(store.Records()[1].label, std::string("r2"));
+    REQUIRE(store.GetDeadBytes() > 0);
+
+    REQUIRE(store.TrimTo(2));
+    REQUIRE_EQ(store.Records().size(), 2u);
+    REQUIRE_EQ(store.Records()[0].label, std::string("r3"));
+
+    StationColumns out;
+    REQUIRE(store.Load(1, out));
+    REQUIRE(SameColumns(MakeColumns(4, 4), out));
+    REQUIRE(!store.Remove(7));
+    CleanStore();
+}
+
+TEST(HistoryStore_compaction_moves_to_next_generation) {
+    CleanStore();
+    HistoryStore store;
+    REQUIRE(store.Open(BASE));
+    for (int i = 0; i < 4; i++)
+        REQUIRE(store.Append(MakeInfo("r" + std::to_string(i), i), MakeColumns(3000, i)));
+    std::string gen0 = store.GetDataPath();
+
+    // Removing three of four big records leaves mostly dead space.
+    REQUIRE(store.TrimTo(1));
+    REQUIRE_EQ(store.GetDeadBytes(), 0u);
+    REQUIRE(store.GetDataPath() != gen0);
+    REQUIRE(!FileExists(gen0));
+
+    HistoryStore reopened;
+    REQUIRE(reopened.Open(BASE));
+    REQUIRE_EQ(reopened.Records().size(), 1u);
+    REQUIRE_EQ(reopened.Records()[0].offset, 0u);
+    StationColumns out;
+    REQUIRE(reopened.Load(0, out));
+    REQUIRE(SameColumns(MakeColumns(3000, 3), out));
+    REQUIRE(reopened.Append(MakeInfo("after", 9), MakeColumns(2)));
+    REQUIRE(reopened.Load(1, out));
+    REQUIRE_EQ(out.Size(), 2u);
+    CleanStore();
+}
+
+TEST(StationColumns_view_reads_columns_in_place) {
+    StationColumns c = MakeColumns(12);
+    StationView v = c.View();
+    REQUIRE(v.lat == c.lat.data());
+    REQUIRE(SameView(c, v));
+    REQUIRE(StationColumns().View().Empty());
+}
+
+TEST(HistoryStore_map_matches_load) {
+    CleanStore();
+    HistoryStore store;
+    REQUIRE(store.Open(BASE));
+    // Odd sizes so later blocks start mid-page
+    for (int i = 0; i < 3; i++)
+        REQUIRE(store.Append(MakeInfo("r", i), MakeColumns(7 + 13 * i, i)));
+
+    for (size_t i = 0; i < 3; i++) {
+        MappedRecord rec;
+        REQUIRE(store.Map(i, rec));
+        REQUIRE(rec.IsValid());
+        REQUIRE(SameView(MakeColumns(7 + 13 * int(i), int(i)), rec.View()));
+    }
+    MappedRecord none;
+    REQUIRE(!store.Map(3, none));
+    REQUIRE(!none.IsValid());
+    REQUIRE(none.View().Empty());
+    CleanStore();
+}
+
+TEST(HistoryStore_mapping_survives_remove_and_compaction) {
+    CleanStore();
+    HistoryStore store;
+    REQUIRE(store.Open(BASE));
+    for (int i = 0; i < 3; i++)
+        REQUIRE(store.Append(MakeInfo("r", i), MakeColumns(3000, i)));
+    MappedRecord rec;
+    REQUIRE(store.Map(0, rec));
+    REQUIRE(store.TrimTo(0));  // compacts; the mapped block is no longer live
+    REQUIRE(SameView(MakeColumns(3000, 0), rec.View()));
+    rec.Reset();
+    REQUIRE(rec.View().Empty());
+    CleanStore();
+}
+
+TEST(HistoryStore_corrupt_index_fails_to_open) {
+    CleanStore();
+    FILE *f = std::fopen((std::string(BASE) + ".idx").c_str(), "wb");
+    REQUIRE(f != nullptr);
+    std::fputs("not an index", f);
+    std::fclose(f);
+    HistoryStore store;
+    REQUIRE(!store.Open(BASE));
+    REQUIRE(!store.IsOpen());
+    CleanStore();
+}
+
+TEST(HistoryStore_index_block_past_the_data_fails_to_open) {
+    CleanStore();
+    {
+        HistoryStore store;
+        REQUIRE(store.Open(BASE));
+        REQUIRE(store.Append(MakeInfo("one", 1771597800), MakeColumns(5)));
+    }
+    std::string path = std::string(BASE) + ".idx", buf;
+    REQUIRE(ReadFileBytes(path, buf));
+    // First record: offset and size after the 24-byte header and 40 bytes
+    // of time and area. Offset + size wraps to a small number.
+    uint64_t offset = UINT64_MAX - 7, size = 16;
+    std::memcpy(&buf[24 + 40], &offset, 8);
+    std::memcpy(&buf[24 + 48], &size, 8);
+    REQUIRE(WriteFileAtomic(path, buf));
+    HistoryStore store;
+    REQUIRE(!store.Open(BASE));
+    CleanStore();
+}
+
+TEST(HistoryStore_move_into_place_and_clear) {
+    std::string temp = std::string(BASE) + ".migrating";
+    CleanStore();
+    CleanStore(temp);
+    StationColumns a = MakeColumns(10, 1);
+    {
+        HistoryStore store;
+        REQUIRE(store.Open(temp));
+        REQUIRE(store.Append(MakeInfo("one", 1771597800), a));
+        REQUIRE(store.MoveTo(BASE));
+        REQUIRE(!FileExists(temp + ".idx"));
+        REQUIRE(!FileExists(temp + ".0.dat"));
+        // Still usable at the new place
+        REQUIRE(store.Append(MakeInfo("two", 1771601400), MakeColumns(3)));
+    }
+    HistoryStore store;
+    REQUIRE(store.Open(BASE));
+    REQUIRE_EQ(store.Records().size(), 2u);
+    StationColumns out;
+    REQUIRE(store.Load(0, out));
+    REQUIRE(SameColumns(a, out));
+
+    store.Clear();
+    REQUIRE(store.IsNew());
+    REQUIRE(store.Records().empty());
+    REQUIRE(!FileExists(std::string(BASE) + ".idx"));
+    REQUIRE(!FileExists(std::string(BASE) + ".0.dat"));
+    HistoryStore reopened;
+    REQUIRE(reopened.Open(BASE));
+    REQUIRE(reopened.IsNew());
+    CleanStore();
+}
+
+int main(int argc, char **argv) {
+    return run_tests(argc, argv);
+}
@@ -0,0 +1,252 @@
+#include "test_runner.h"
+#include "../src/json_number.h"
+
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+
+static bool ParseD(const char *s, double *d) {
+    return JsonParseDouble(s, std::strlen(s), d);
+}
+
+static uint64_t Bits(double d) {
+    uint64_t b;
+    std::memcpy(&b, &d, sizeof b);
+    return b;
+}
+
+static std::string Format(double d, bool keep_type = false) {
+    char buf[JSON_DOUBLE_CHARS];
+    size_t n = JsonFormatDouble(d, buf, keep_type);
+    REQUIRE_EQ(n, std::strlen(buf));
+    return std::string(buf, n);
+}
+
+// JsonParseDouble() must give strtod()'s (correctly rounded) result, and
+// reject what strtod() reports as overflow.
+static void RequireSameAsStrtod(const std::string &s) {
+    errno = 0;
+    double expected = std::strtod(s.c_str(), nullptr);
+    bool overflow = errno == ERANGE && std::isinf(expected);
+    double got = 0;
+    bool ok = JsonParseDouble(s.data(), s.size(), &got);
+    if (ok == overflow || (ok && Bits(got) != Bits(expected)))
+        std::fprintf(stderr, "  input %s: got %d %.17g, want %.17g\n",
+                     s.c_str(), ok, got, expected);
+    REQUIRE(ok != overflow);
+    if (ok) REQUIRE_EQ(Bits(got), Bits(expected));
+}
+
+TEST(JsonParseInt64_limits_and_syntax) {
+    int64_t v = 0;
+    REQUIRE(JsonParseInt64("170", 3, &v) && v == 170);
+    REQUIRE(JsonParseInt64("-5", 2, &v) && v == -5);
+    REQUIRE(JsonParseInt64("+7", 2, &v) && v == 7);
+    REQUIRE(JsonParseInt64("007", 3, &v) && v == 7);
+    REQUIRE(JsonParseInt64("9223372036854775807", 19, &v) && v == INT64_MAX);
+    REQUIRE(JsonParseInt64("-9223372036854775808", 20, &v) && v == INT64_MIN);
+    REQUIRE(!JsonParseInt64("9223372036854775808", 19, &v));
+    REQUIRE(!JsonParseInt64("-9223372036854775809", 20, &v));
+    REQUIRE(!JsonParseInt64("", 0, &v));
+    REQUIRE(!JsonParseInt64("-", 1, &v));
+    REQUIRE(!JsonParseInt64("1.0", 3, &v));
+    REQUIRE(!JsonParseInt64("1e3", 3, &v));
+    REQUIRE(!JsonParseInt64("12a", 3, &v));
+}
+
+TEST(JsonParseUInt64_limits_and_syntax) {
+    uint64_t v = 0;
+    REQUIRE(JsonParseUInt64("18446744073709551615", 20, &v) && v == UINT64_MAX);
+    REQUIRE(JsonParseUInt64("+9223372036854775808", 20, &v) &&
+            v == uint64_t(INT64_MAX) + 1);
+    // wxJSONReader::DoStrto_ll let the last digit wrap around
+    REQUIRE(!JsonParseUInt64("18446744073709551616", 20, &v));
+    REQUIRE(!JsonParseUInt64("184467440737095516150", 21, &v));
+    REQUIRE(!JsonParseUInt64("-1", 2, &v));
+    REQUIRE(!JsonParseUInt64("+", 1, &v));
+}
+
+TEST(JsonParseDouble_syntax) {
+    double d = 0;
+    REQUIRE(ParseD("1014.7", &d) && d == 1014.7);
+    REQUIRE(ParseD("-80.87", &d) && d == -80.87);
+    REQUIRE(ParseD("+1.5", &d) && d == 1.5);
+    REQUIRE(ParseD(".5", &d) && d == 0.5);
+    REQUIRE(ParseD("5.", &d) && d == 5.0);
+    REQUIRE(ParseD("-.5E1", &d) && d == -5.0);
+    REQUIRE(ParseD("2e-3", &d) && d == 0.002);
+    REQUIRE(ParseD("-0", &d) && d == 0 && std::signbit(d));
+    REQUIRE(ParseD("0e999999999", &d) && d == 0);
+    const char *bad[] = {"", "-", "+", ".", "-.", "e5", "1e", "1e+", "1.2.3",
+                         "0x10", "inf", "-Infinity", "nan", "1 ", " 1", "1,5",
+                         "1e5.0", "--1"};
+    for (const char *s : bad) {
+        if (ParseD(s, &d)) std::fprintf(stderr, "  accepted \"%s\"\n", s);
+        REQUIRE(!ParseD(s, &d));
+    }
+}
+
+TEST(JsonParseDouble_hard_cases) {
+    const char *cases[] = {
+        "9007199254740993",            // 2^53 + 1: halfway, rounds to even
+        "9007199254740995",
+        "9007199254740993.0000000001", // just above halfway
+        "0.1000000000000000055511151231257827021181583404541015625",
+        "3.14159265358979323846264338327950288",
+        "1.7976931348623157e308",      // DBL_MAX
+        "1.7976931348623158e308",      // still rounds to DBL_MAX
+        "1.7976931348623159e308",      // overflow
+        "1e309", "-1e400",
+        "2.2250738585072014e-308",     // DBL_MIN
+        "2.2250738585072011e-308",     // largest subnormal
+        "4.9406564584124654e-324",     // smallest subnormal
+        "2.4703282292062328e-324",     // just over half of it
+        "2.4703282292062327e-324",     // just under half: zero
+        "1e-400",
+        "7.3177701707893310e+15",      // needs the second 64 bits of 5^q
+        "1448997445238699",
+        "123456789012345678901234567890",
+        "0.000000000000000000000000000000000000000000001",
+        "1e23", "8.98846567431158e307", "5e-324", "1e-342", "1e-343",
+        "100000000000000016777215", "100000000000000016777216",
+        "4503599627370496.5", "4503599627370497.5",
+        "179769313486231570000000000000000000000000000000000000000000000000000"
+        "000000000000000000000000000000000000000000000000000000000000000000000"
+        "000000000000000000000000000000000000000000000000000000000000000000000"
+        "000000000000000000000000000000000000000000000000000000000000000000000"
+        "00000000000000000000000000000000000000000000000000000000000000",
+    };
+    for (const char *s : cases) RequireSameAsStrtod(s);
+}
+
+TEST(JsonParseDouble_matches_strtod_random) {
+    std::mt19937_64 rng(20260220);
+    char buf[64];
+    for (int i = 0; i < 100000; i++) {
+        // Random doubles (every 16th subnormal) at a random precision
+        uint64_t bits = rng();
+        if (i % 16 == 0) bits &= ~(uint64_t(0x7ff) << 52);
+        double d;
+        std::memcpy(&d, &bits, sizeof d);
+        if (!std::isfinite(d)) continue;
+        std::snprintf(buf, sizeof buf, "%.*g", 1 + static_cast<int>(rng() % 17), d);
+        RequireSameAsStrtod(buf);
+        std::snprintf(buf, sizeof buf, "%.17g", d);
+        RequireSameAsStrtod(buf);
+    }
+    for (int i = 0; i < 100000; i++) {
+        // Random digit strings, up to 25 digits, across the whole exponent range
+        std::string s;
+        int digits = 1 + static_cast<int>(rng() % 25);
+        int point = static_cast<int>(rng() % (digits + 1));
+        for (int k = 0; k < digits; k++) {
+            if (k == point && k > 0) s += '.';
+            s += static_cast<char>('0' + rng() % 10);
+        }
+        s += 'e';
+        s += std::to_string(static_cast<int>(rng() % 700) - 360);
+        RequireSameAsStrtod(s);
+    }
+}
+
+TEST(JsonFormatDouble_known_output) {
+    REQUIRE_EQ(Format(200.0), "200");
+    REQUIRE_EQ(Format(200.0, true), "200.0");
+    REQUIRE_EQ(Format(1014.7), "1014.7");
+    REQUIRE_EQ(Format(1014.7, true), "1014.7");
+    REQUIRE_EQ(Format(-80.87), "-80.87");
+    REQUIRE_EQ(Format(0.1), "0.1");
+    REQUIRE_EQ(Format(0.3), "0.3");
+    REQUIRE_EQ(Format(0.1 + 0.2), "0.30000000000000004");
+    REQUIRE_EQ(Format(2.0 / 3), "0.6666666666666666");
+    REQUIRE_EQ(Format(0.001), "0.001");
+    REQUIRE_EQ(Format(0.0001), "0.0001");
+    REQUIRE_EQ(Format(0.00001), "1e-5");
+    REQUIRE_EQ(Format(1.5e-7), "1.5e-7");
+    REQUIRE_EQ(Format(123456789012345.0), "123456789012345");
+    REQUIRE_EQ(Format(1e15), "1000000000000000");
+    REQUIRE_EQ(Format(1e15, true), "1000000000000000.0");
+    REQUIRE_EQ(Format(1e17), "1e17");
+    REQUIRE_EQ(Format(1e17, true), "1e17");
+    REQUIRE_EQ(Format(1.5e300), "1.5e300");
+    REQUIRE_EQ(Format(5e-324), "5e-324");
+    REQUIRE_EQ(Format(1.7976931348623157e308), "1.7976931348623157e308");
+    REQUIRE_EQ(Format(0.0), "0");
+    REQUIRE_EQ(Format(0.0, true), "0.0");
+    REQUIRE_EQ(Format(-0.0, true), "-0.0");
+    REQUIRE_EQ(Format(std::numeric_limits<double>::quiet_NaN()), "null");
+    REQUIRE_EQ(Format(-std::numeric_limits<double>::infinity()), "null");
+}
+
+// Every finite double reads back bit-exact, in no more characters than
+// %.17g needs.
+TEST(JsonFormatDouble_round_trips) {
+    std::mt19937_64 rng(1771599600);
+    char ref[64];
+    for (int i = 0; i < 200000; i++) {
+        uint64_t bits = rng();
+        double d;
+        std::memcpy(&d, &bits, sizeof d);
+        if (!std::isfinite(d)) continue;
+        for (int keep = 0; keep < 2; keep++) {
+            std::string s = Format(d, keep != 0);
+            double back = 0;
+            REQUIRE(JsonParseDouble(s.data(), s.size(), &back));
+            if (Bits(back) != Bits(d))
+                std::fprintf(stderr, "  %.17g -> %s\n", d, s.c_str());
+            REQUIRE_EQ(Bits(back), Bits(d));
+            REQUIRE_EQ(std::strtod(s.c_str(), nullptr), d);
+            std::snprintf(ref, sizeof ref, "%.17g", d);
+            REQUIRE(s.size() <= std::strlen(ref) + 2);
+        }
+    }
+}
+
+static size_t SignificantDigits(const std::string &s) {
+    // Leading and trailing zeros of plain notation are not significant
+    size_t first = s.find_first_of("123456789");
+    size_t last = s.find_last_of("123456789", s.find('e'));
+    size_t n = 0;
+    for (size_t k = first; k <= last && k < s.size(); k++)
+        if (s[k] >= '0' && s[k] <= '9') n++;
+    return n;
+}
+
+// Grisu2 picks the shortest digits in nearly all cases: every reading with
+// up to three decimals, and all but a few in a thousand random decimals of
+// up to 15 digits.
+TEST(JsonFormatDouble_short_decimals_stay_short) {
+    char ref[64];
+    for (int k = -2000000; k <= 2000000; k += 7) {
+        std::snprintf(ref, sizeof ref, "%.3f", k / 1000.0);
+        std::string s = Format(std::strtod(ref, nullptr));
+        double back = std::strtod(s.c_str(), nullptr);
+        REQUIRE_EQ(back, std::strtod(ref, nullptr));
+        std::string r(ref);
+        r.erase(r.find_last_not_of('0') + 1);
+        if (r.back() == '.') r.pop_back();
+        if (s != r) std::fprintf(stderr, "  %s -> %s\n", ref, s.c_str());
+        REQUIRE_EQ(s, r);
+    }
+
+    std::mt19937_64 rng(1771599600);
+    int longer = 0;
+    const int N = 100000;
+    for (int i = 0; i < N; i++) {
+        int digits = 1 + static_cast<int>(rng() % 15);
+        std::snprintf(ref, sizeof ref, "%.*e", digits - 1,
+                      std::ldexp(static_cast<double>(rng() >> 11), -53) *
+                          std::pow(10.0, static_cast<int>(rng() % 40) - 20));
+        if (SignificantDigits(Format(std::strtod(ref, nullptr))) >
+            static_cast<size_t>(digits))
+            longer++;
+    }
+    REQUIRE(longer < N / 200);
+}
+
+int main(int argc, char **argv) { return run_tests(argc, argv); }
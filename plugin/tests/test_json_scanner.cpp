@@ -0,0 +1,191 @@
+#include "test_runner.h"
+#include "../src/json_scanner.h"
+#include "../src/json_simd.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+
+// ---- helpers ---------------------------------------------------------------
+
+// Records every event as a compact string, e.g. {k:id s:A k:n n:1}
+struct Recorder : public JsonHandler {
+    std::string log;
+    void OnBeginObject() { log += "{"; }
+    void OnEndObject()   { log += "}"; }
+    void OnBeginArray()  { log += "["; }
+    void OnEndArray()    { log += "]"; }
+    void OnKey(const char *s, size_t n)    { log += " k:" + std::string(s, n); }
+    void OnString(const char *s, size_t n) { log += " s:" + std::string(s, n); }
+    void OnNumber(const char *s, size_t n) { log += " n:" + std::string(s, n); }
+    void OnLiteral(JsonLiteral lit) {
+        log += lit == JSON_NULL ? " null" : lit == JSON_TRUE ? " true" : " false";
+    }
+};
+
+// Feed doc in chunks of chunk bytes; returns the event log or "ERR".
+static std::string scan(const std::string &doc, size_t chunk = 0) {
+    Recorder rec;
+    JsonScanner sc(&rec);
+    if (chunk == 0) chunk = doc.size() ? doc.size() : 1;
+    for (size_t i = 0; i < doc.size(); i += chunk)
+        sc.Feed(doc.data() + i, std::min(chunk, doc.size() - i));
+    if (!sc.Finish()) return "ERR";
+    return rec.log;
+}
+
+static const char *SAMPLE =
+    "{\"stations\": [{\"id\": \"41008\", \"lat\": 31.4, \"lon\": -80.87,"
+    " \"ok\": true, \"x\": null, \"esc\": \"a\\\"b\\u00e9\"}], \"count\": 1}";
+
+// ---- tokens ----------------------------------------------------------------
+
+TEST(JsonScanner_events_in_order) {
+    REQUIRE_EQ(scan(SAMPLE),
+               "{ k:stations[{ k:id s:41008 k:lat n:31.4 k:lon n:-80.87"
+               " k:ok true k:x null k:esc s:a\"b\xc3\xa9}] k:count n:1}");
+}
+
+TEST(JsonScanner_any_chunk_size_gives_same_events) {
+    std::string whole = scan(SAMPLE);
+    for (size_t chunk = 1; chunk < 16; chunk++)
+        REQUIRE_EQ(scan(SAMPLE, chunk), whole);
+}
+
+TEST(JsonScanner_surrogate_pair_to_utf8) {
+    REQUIRE_EQ(scan("[\"\\ud83d\\ude00\"]"), "[ s:\xf0\x9f\x98\x80]");
+}
+
+TEST(JsonScanner_lone_high_surrogate_at_end_of_input) {
+    REQUIRE_EQ(scan("{\"a\":\"\\uD800\"}"), "{ k:a s:\xef\xbf\xbd}");
+    for (size_t chunk = 1; chunk < 8; chunk++)
+        REQUIRE_EQ(scan("[\"\\uD800x\"]", chunk), "[ s:\xef\xbf\xbdx]");
+    REQUIRE_EQ(scan("[\"\\uD800\\u00"), "ERR");
+}
+
+TEST(JsonScanner_number_at_end_of_document) {
+    REQUIRE_EQ(scan("42", 1), " n:42");
+}
+
+// ---- vectorised searches ---------------------------------------------------
+
+static size_t RefQuoteOrEscape(const std::string &s, size_t from, size_t len) {
+    size_t i = 0;
+    while (i < len && s[from + i] != '"' && s[from + i] != '\\') i++;
+    return i;
+}
+
+static size_t RefDelimiter(const std::string &s, size_t from, size_t len) {
+    static const std::string delims = " \t\n\r,:[]{}\"";
+    size_t i = 0;
+    while (i < len && delims.find(s[from + i]) == std::string::npos) i++;
+    return i;
+}
+
+TEST(JsonSimd_searches_match_scalar_at_every_level) {
+    // Mostly token bytes, with every delimiter, near misses ('Z' = '[' ^ 1,
+    // '|', ';', '\x0b', 0xfb = '{' | 0x80) and high bytes mixed in.
+    const std::string alphabet =
+        "0123456789.-eEabcnultrsf \t\n\r,:[]{}\"\\Z|;\x0b\xfb\x80\xff";
+    std::minstd_rand rng(7);
+    std::string buf(200, 'x');
+    for (char &c : buf)
+        c = rng() % 4 ? 'a' + rng() % 26 : alphabet[rng() % alphabet.size()];
+
+    JsonSimdLevel best = JsonSimdBest();
+    for (int level = JSON_SIMD_SCALAR; level <= best; level++) {
+        JsonSimdUse(static_cast<JsonSimdLevel>(level));
+        REQUIRE_EQ(int(JsonSimdActive()), level);
+        for (size_t from = 0; from < 40; from++) {
+            for (size_t len = 0; from + len <= buf.size(); len += 7) {
+                REQUIRE_EQ(JsonFindQuoteOrEscape(buf.data() + from, len),
+                           RefQuoteOrEscape(buf, from, len));
+                REQUIRE_EQ(JsonFindDelimiter(buf.data() + from, len),
+                           RefDelimiter(buf, from, len));
+            }
+        }
+        // A match in the last byte of a full vector, and none at all.
+        std::string plain(64, 'q');
+        REQUIRE_EQ(JsonFindQuoteOrEscape(plain.data(), plain.size()), size_t(64));
+        REQUIRE_EQ(JsonFindDelimiter(plain.data(), plain.size()), size_t(64));
+        plain[31] = '}';
+        plain[15] = '\\';
+        REQUIRE_EQ(JsonFindDelimiter(plain.data(), plain.size()), size_t(31));
+        REQUIRE_EQ(JsonFindQuoteOrEscape(plain.data(), plain.size()), size_t(15));
+    }
+    JsonSimdUse(best);
+}
+
+TEST(JsonScanner_same_events_at_every_simd_level) {
+    std::string doc = std::string("{\"stations\": [") +
+        "{\"id\": \"a long station identifier well past one vector\", "
+        "\"note\": \"escapes \\\"after\\\" a long run of plain text \\u00e9 and"
+        " more plain text after them\", \"lat\": -12.3456789012345678,"
+        " \"lon\": 123456789012345678901234567890, \"ok\": false}]}";
+    JsonSimdLevel best = JsonSimdBest();
+    JsonSimdUse(JSON_SIMD_SCALAR);
+    std::string expected = scan(doc);
+    REQUIRE(expected != "ERR");
+    for (int level = JSON_SIMD_SSE2; level <= best; level++) {
+        JsonSimdUse(static_cast<JsonSimdLevel>(level));
+        for (size_t chunk : {size_t(0), size_t(1), size_t(13), size_t(40)})
+            REQUIRE_EQ(scan(doc, chunk), expected);
+    }
+    JsonSimdUse(best);
+}
+
+// ---- syntax errors ---------------------------------------------------------
+
+TEST(JsonScanner_rejects_malformed_documents) {
+    REQUIRE_EQ(scan(""), "ERR");
+    REQUIRE_EQ(scan("{not json}"), "ERR");
+    REQUIRE_EQ(scan("{\"a\" 1}"), "ERR");
+    REQUIRE_EQ(scan("{\"a\": 1,}"), "ERR");
+    REQUIRE_EQ(scan("[1 2]"), "ERR");
+    REQUIRE_EQ(scan("[1]]"), "ERR");
+    REQUIRE_EQ(scan("{\"a\": [1}"), "ERR");
+    REQUIRE_EQ(scan("[\"open"), "ERR");
+    REQUIRE_EQ(scan("[01]"), "ERR");
+    REQUIRE_EQ(scan("[1.]"), "ERR");
+    REQUIRE_EQ(scan("[nul]"), "ERR");
+    REQUIRE_EQ(scan("{} {}"), "ERR");
+}
+
+TEST(JsonScanner_error_stops_feeding) {
+    Recorder rec;
+    JsonScanner sc(&rec);
+    REQUIRE(!sc.Feed("[1,,2]", 6));
+    REQUIRE(sc.HasError());
+    REQUIRE(!sc.Feed("]", 1));
+    REQUIRE(!sc.Finish());
+}
+
+// ---- numbers ---------------------------------------------------------------
+
+TEST(JsonNumberIsInteger_matches_wxjson_int_rules) {
+    REQUIRE(JsonNumberIsInteger("170", 3));
+    REQUIRE(JsonNumberIsInteger("-5", 2));
+    REQUIRE(!JsonNumberIsInteger("170.0", 5));
+    REQUIRE(!JsonNumberIsInteger("1e3", 3));
+    REQUIRE(JsonNumberIsInteger("18446744073709551615", 20));
+    REQUIRE(!JsonNumberIsInteger("18446744073709551616", 20));
+    REQUIRE(JsonNumberIsInteger("-9223372036854775808", 20));
+    REQUIRE(!JsonNumberIsInteger("-9223372036854775809", 20));
+}
+
+TEST(JsonNumberToDouble_exact_values) {
+    REQUIRE_EQ(JsonNumberToDouble("1014.7", 6), 1014.7);
+    REQUIRE_EQ(JsonNumberToDouble("-80.87", 6), -80.87);
+    REQUIRE_EQ(JsonNumberToDouble("0.000123", 8), 0.000123);
+    REQUIRE_EQ(JsonNumberToDouble("1.5E2", 5), 150.0);
+    REQUIRE_EQ(JsonNumberToDouble("2e-3", 4), 0.002);
+    // Slow path: more digits than the fast path handles exactly
+    REQUIRE_EQ(JsonNumberToDouble("3.14159265358979323846", 22),
+               3.14159265358979323846);
+    REQUIRE_EQ(JsonNumberToDouble("1e300", 5), 1e300);
+}
+
+int main(int argc, char **argv) {
+    return run_tests(argc, argv);
+}
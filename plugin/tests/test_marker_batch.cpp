@@ -0,0 +1,80 @@
+#include "test_runner.h"
+#include "../src/marker_batch.h"
+
+#include <cmath>
+
+static const BatchColor RED = {255, 0, 0, 128};
+
+// ---- markers ---------------------------------------------------------------
+
+TEST(MarkerBatch_marker_vertex_counts) {
+    MarkerBatch b;
+    b.AddMarker(PLATFORM_SHIP, 0, 0, RED);
+    REQUIRE_EQ(b.Fills().size(), 3u);
+    b.AddMarker(PLATFORM_SHORE, 0, 0, RED);
+    REQUIRE_EQ(b.Fills().size(), 9u);
+    b.AddMarker(PLATFORM_DRIFTER, 0, 0, RED);
+    REQUIRE_EQ(b.Fills().size(), 15u);
+    b.AddMarker(PLATFORM_BUOY, 0, 0, RED);
+    REQUIRE_EQ(b.Fills().size(), 15u + 16 * 3);
+    REQUIRE(b.Lines().empty());
+    REQUIRE(b.Pennants().empty());
+}
+
+TEST(MarkerBatch_disc_stays_on_radius) {
+    MarkerBatch b;
+    b.AddDisc(100, 50, 15, RED);
+    const std::vector<BatchVertex> &v = b.Fills();
+    for (size_t i = 0; i < v.size(); i += 3) {
+        REQUIRE_EQ(v[i].x, 100.0f);
+        REQUIRE_EQ(v[i].y, 50.0f);
+        REQUIRE_NEAR(std::hypot(v[i + 1].x - 100, v[i + 1].y - 50), 15.0, 1e-4);
+    }
+    REQUIRE_EQ(v[7].color.r, 255);
+    REQUIRE_EQ(v[7].color.a, 128);
+}
+
+TEST(MarkerBatch_color_from_float) {
+    BatchColor c = BatchColor::FromFloat(1.0f, 0.0f, 0.5f, 0.15f);
+    REQUIRE_EQ(c.r, 255);
+    REQUIRE_EQ(c.g, 0);
+    REQUIRE_EQ(c.b, 128);
+    REQUIRE_EQ(c.a, 38);
+    REQUIRE_EQ(sizeof(BatchVertex), 12u);
+}
+
+// ---- wind barbs ------------------------------------------------------------
+
+TEST(MarkerBatch_barb_ticks_match_speed) {
+    MarkerBatch b;
+    // 65 kt rounds to 67: one pennant, one long barb, one short barb
+    b.AddWindBarb(0, 0, 90.0, 65.0, RED);
+    REQUIRE_EQ(b.Pennants().size(), 3u);
+    REQUIRE_EQ(b.Lines().size(), 6u);  // shaft + long + short
+    // Shaft runs east for wind from 090
+    REQUIRE_NEAR(b.Lines()[1].x, 25.0, 1e-4);
+    REQUIRE_NEAR(b.Lines()[1].y, 0.0, 1e-4);
+}
+
+TEST(MarkerBatch_calm_or_missing_wind_adds_nothing) {
+    MarkerBatch b;
+    b.AddWindBarb(0, 0, 180.0, 0.2, RED);
+    b.AddWindBarb(0, 0, NAN, 10.0, RED);
+    b.AddWindBarb(0, 0, 180.0, NAN, RED);
+    REQUIRE(b.Lines().empty());
+    REQUIRE(b.Pennants().empty());
+}
+
+TEST(MarkerBatch_clear_empties_all_classes) {
+    MarkerBatch b;
+    b.AddMarker(PLATFORM_OTHER, 1, 2, RED);
+    b.AddWindBarb(1, 2, 10.0, 120.0, RED);
+    b.Clear();
+    REQUIRE(b.Fills().empty());
+    REQUIRE(b.Lines().empty());
+    REQUIRE(b.Pennants().empty());
+}
+
+int main(int argc, char **argv) {
+    return run_tests(argc, argv);
+}
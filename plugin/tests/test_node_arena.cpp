@@ -0,0 +1,145 @@
+#include "test_runner.h"
+#include "../src/node_arena.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Nodes use the arena as wxJSON's do: class operator new and sized delete.
+struct Node {
+    explicit Node(int v) : value(v) {}
+    virtual ~Node() {}
+
+    static void *operator new(size_t size) { return NodeArena::Allocate(size); }
+    static void operator delete(void *p, size_t size) { NodeArena::Free(p, size); }
+
+    int value;
+    std::string text;   // owns heap memory of its own, as wxString does
+};
+
+struct BigNode : Node {
+    explicit BigNode(int v) : Node(v) {}
+    char payload[300];
+};
+
+TEST(NodeArena_outside_a_scope_uses_the_heap) {
+    Node *n = new Node(1);
+    REQUIRE_EQ(NodeArena::Count(), 0);
+    delete n;
+    NodeArena::Scope off(false);
+    REQUIRE(off.Get() == nullptr);
+    n = new Node(2);
+    REQUIRE_EQ(NodeArena::Count(), 0);
+    delete n;
+}
+
+TEST(NodeArena_outlives_its_scope_until_the_last_node) {
+    std::vector<Node *> nodes;
+    {
+        NodeArena::Scope scope;
+        REQUIRE_EQ(NodeArena::Count(), 1);
+        for (int i = 0; i < 1000; i++) {
+            nodes.push_back(new Node(i));
+            nodes.back()->text.assign(40, 'x');
+        }
+        REQUIRE_EQ(scope.Get()->Live(), 1000u);
+    }
+    // The nodes stay valid after the parse...
+    REQUIRE_EQ(NodeArena::Count(), 1);
+    for (int i = 0; i < 1000; i++) REQUIRE_EQ(nodes[i]->value, i);
+    // ...and the blocks go with the last of them
+    for (Node *n : nodes) delete n;
+    REQUIRE_EQ(NodeArena::Count(), 0);
+}
+
+TEST(NodeArena_empty_scope_frees_its_arena) {
+    { NodeArena::Scope scope; }
+    REQUIRE_EQ(NodeArena::Count(), 0);
+}
+
+TEST(NodeArena_reuses_freed_nodes_of_the_same_size) {
+    NodeArena::Scope scope;
+    Node *a = new Node(1);
+    BigNode *big = new BigNode(2);
+    Node *keep = new Node(3);
+    delete a;
+    delete big;   // sized delete: the dynamic size comes back
+    REQUIRE_EQ(scope.Get()->Live(), 1u);
+    Node *b = new Node(4);
+    Node *big2 = new BigNode(5);
+    REQUIRE(b == a);
+    REQUIRE(big2 == big);
+    delete b;
+    delete big2;
+    delete keep;
+    REQUIRE_EQ(scope.Get()->Live(), 0u);
+}
+
+TEST(NodeArena_takes_few_large_blocks) {
+    const size_t N = 100000;
+    std::vector<Node *> nodes(N);
+    size_t reserved;
+    {
+        NodeArena::Scope scope;
+        for (size_t i = 0; i < N; i++) {
+            nodes[i] = new Node(static_cast<int>(i));
+            REQUIRE_EQ(reinterpret_cast<uintptr_t>(nodes[i]) % NodeArena::ALIGN, 0u);
+        }
+        reserved = scope.Get()->Reserved();
+    }
+    size_t used = N * (sizeof(Node) + 8);
+    REQUIRE(reserved >= used);
+    REQUIRE(reserved < used + 2 * 1024 * 1024);
+    for (Node *n : nodes) delete n;
+    REQUIRE_EQ(NodeArena::Count(), 0);
+}
+
+TEST(NodeArena_objects_larger_than_a_block) {
+    struct Huge : Node {
+        Huge() : Node(0) {}
+        char payload[64 * 1024];
+    };
+    NodeArena::Scope scope;
+    Node *small = new Node(1);
+    Node *huge = new Huge;
+    Node *after = new Node(2);
+    REQUIRE_EQ(small->value, 1);
+    REQUIRE_EQ(after->value, 2);
+    delete huge;
+    delete small;
+    delete after;
+}
+
+TEST(NodeArena_scopes_nest) {
+    NodeArena::Scope outer;
+    Node *a = new Node(1);
+    {
+        NodeArena::Scope inner;
+        REQUIRE_EQ(NodeArena::Count(), 2);
+        Node *b = new Node(2);
+        REQUIRE_EQ(inner.Get()->Live(), 1u);
+        REQUIRE_EQ(outer.Get()->Live(), 1u);
+        delete b;
+    }
+    REQUIRE_EQ(NodeArena::Count(), 1);
+    Node *c = new Node(3);
+    REQUIRE_EQ(outer.Get()->Live(), 2u);
+    delete a;
+    delete c;
+}
+
+TEST(NodeArena_mixes_heap_and_arena_nodes) {
+    Node *heap = new Node(1);
+    Node *arena;
+    {
+        NodeArena::Scope scope;
+        arena = new Node(2);
+        delete heap;   // freed to the heap although a scope is open
+    }
+    heap = new Node(3);
+    delete arena;
+    REQUIRE_EQ(NodeArena::Count(), 0);
+    delete heap;
+}
+
+int main(int argc, char **argv) { return run_tests(argc, argv); }
@@ -1,8 +1,16 @@
 #include "test_runner.h"
+#include "../src/node_arena.h"
 #include "../src/obs_parser.h"
 
 #include <wx/app.h>
+#include <wx/jsonreader.h>
+#include <wx/jsonwriter.h>
 #include <wx/log.h>
+#include <wx/mstream.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
 
 // ---- helpers ---------------------------------------------------------------
 
@@ -53,12 +61,7 @@ TEST(ParseObservations_full_station_fields) {
     REQUIRE_NEAR(s.sea_temp, 18.2, 1e-6);
     REQUIRE_NEAR(s.wave_ht, 1.2, 1e-6);
     REQUIRE_NEAR(s.vis, 10000.0, 1e-6);
-    REQUIRE(s.time.IsValid());
-    REQUIRE_EQ(s.time.GetYear(), 2026);
-    REQUIRE_EQ((int)s.time.GetMonth(), (int)wxDateTime::Feb);
-    REQUIRE_EQ(s.time.GetDay(), 20);
-    REQUIRE_EQ(s.time.GetHour(), 14);
-    REQUIRE_EQ(s.time.GetMinute(), 30);
+    REQUIRE_EQ(FormatIsoTime(s.time), "2026-02-20T14:30:00Z");
 }
 
 TEST(ParseObservations_missing_optional_fields_are_nan) {
@@ -131,6 +134,14 @@ TEST(ParseObservations_invalid_time_drops_station) {
     REQUIRE_EQ((int)parse(json).size(), 0);
 }
 
+TEST(ParseObsTime_fixed_form_and_fallback) {
+    REQUIRE_EQ(ParseObsTime("2026-02-20T14:30:00Z", 20), int64_t(1771597800));
+    // Other forms wxDateTime accepts still work
+    REQUIRE_EQ(ParseObsTime("2026-02-20T14:30:00", 19), int64_t(1771597800));
+    REQUIRE_EQ(ParseObsTime("not-a-date", 10), TIME_UNKNOWN);
+    REQUIRE_EQ(ParseObsTime("2026-02-30T14:30:00Z", 20), TIME_UNKNOWN);
+}
+
 TEST(ParseObservations_valid_and_invalid_mixed) {
     const char *json = R"({"stations": [
         {"id": "GOOD", "type": "ship", "lat": 10.0, "lon": 20.0, "time": "2026-01-01T00:00:00Z"},
@@ -158,6 +169,347 @@ TEST(ParseObservations_missing_stations_key_returns_false) {
     REQUIRE(!ok);
 }
 
+// ---- streaming parser ------------------------------------------------------
+
+TEST(ObsStreamParser_byte_at_a_time_matches_whole_buffer) {
+    std::string doc(FULL_STATION);
+    ObsStreamParser p;
+    for (size_t i = 0; i < doc.size(); i++)
+        REQUIRE(p.Feed(doc.data() + i, 1));
+    ObservationList out;
+    wxString err;
+    REQUIRE(p.Finish(out, err));
+    REQUIRE_EQ((int)out.size(), 1);
+    REQUIRE_EQ(std::string(out[0].id.mb_str()), "41008");
+    REQUIRE_NEAR(out[0].pressure, 1014.7, 1e-9);
+    REQUIRE_NEAR(out[0].vis, 10000.0, 1e-9);
+}
+
+TEST(ObsStreamParser_integer_lat_drops_station_like_dom) {
+    // wxJSON stores "31" as an int, so IsDouble() fails and the station is
+    // dropped; the streaming path must agree.
+    const char *json = R"({"stations": [
+        {"id": "X", "type": "buoy", "lat": 31, "lon": 20.0, "time": "2026-01-01T00:00:00Z"}
+    ]})";
+    REQUIRE_EQ((int)parse(json).size(), 0);
+}
+
+TEST(ObsStreamParser_null_and_integer_optionals_are_nan) {
+    const char *json = R"({"stations": [{
+        "id": "A", "type": "ship", "lat": 10.0, "lon": 20.0,
+        "time": "2026-01-01T00:00:00Z", "wind_dir": 170, "sea_temp": null,
+        "extra": {"nested": [1, 2, {"id": "ignored"}]}
+    }]})";
+    auto stns = parse(json);
+    REQUIRE_EQ((int)stns.size(), 1);
+    REQUIRE(std::isnan(stns[0].wind_dir));
+    REQUIRE(std::isnan(stns[0].sea_temp));
+}
+
+TEST(ObsStreamParser_projected_away_fields_are_nan) {
+    // Only wind and pressure requested; a server that ignores "fields"
+    // still sends the rest, which must read as missing.
+    ObsStreamParser p;
+    p.SetFields((1u << 0) | (1u << 1) | (1u << 3));
+    REQUIRE(p.Feed(FULL_STATION, std::strlen(FULL_STATION)));
+    ObservationList out;
+    wxString err;
+    REQUIRE(p.Finish(out, err));
+    REQUIRE_EQ((int)out.size(), 1);
+    REQUIRE_NEAR(out[0].wind_dir, 170.0, 1e-9);
+    REQUIRE_NEAR(out[0].wind_spd, 5.0, 1e-9);
+    REQUIRE_NEAR(out[0].pressure, 1014.7, 1e-9);
+    REQUIRE(std::isnan(out[0].gust));
+    REQUIRE(std::isnan(out[0].air_temp));
+    REQUIRE(std::isnan(out[0].sea_temp));
+    REQUIRE(std::isnan(out[0].wave_ht));
+    REQUIRE(std::isnan(out[0].vis));
+    REQUIRE_EQ(std::string(out[0].type.mb_str()), "buoy");
+}
+
+// Records what a StationSink is told.
+struct CollectSink : StationSink {
+    std::vector<std::string> ids;
+    int resets = 0;
+    void OnStation(const ObservationStation &st) {
+        ids.push_back(std::string(st.id.mb_str()));
+    }
+    void OnReset() { ids.clear(); resets++; }
+};
+
+TEST(ObsStreamParser_sink_gets_each_station_as_it_closes) {
+    const char *doc =
+        R"({"stations": [{"id": "A", "lat": 1.5, "lon": 2.5, "time": "2026-02-20T14:00:00Z"},)"
+        R"( {"id": "B", "lat": 1.5, "lon": 2.5, "time": "2026-02-20T14:00:00Z"}]})";
+    const char *second = std::strstr(doc, "{\"id\": \"B\"");
+    ObsStreamParser p;
+    CollectSink sink;
+    p.SetSink(&sink);
+    // A is complete before B has even started.
+    REQUIRE(p.Feed(doc, second - doc));
+    REQUIRE_EQ(sink.ids.size(), size_t(1));
+    REQUIRE(p.Feed(second, std::strlen(second)));
+    ObservationList out;
+    wxString err;
+    REQUIRE(p.Finish(out, err));
+    REQUIRE(out.empty());
+    REQUIRE_EQ(sink.ids.size(), size_t(2));
+    REQUIRE_EQ(sink.ids[1], "B");
+
+    // A repeated "stations" key voids the stations before it.
+    const char *twice =
+        R"({"stations": [{"id": "A", "lat": 1.5, "lon": 2.5, "time": "2026-02-20T14:00:00Z"}],)"
+        R"( "stations": []})";
+    ObsStreamParser q;
+    CollectSink sink2;
+    q.SetSink(&sink2);
+    REQUIRE(q.Feed(twice, std::strlen(twice)));
+    REQUIRE(q.Finish(out, err));
+    REQUIRE(sink2.ids.empty());
+    REQUIRE_EQ(sink2.resets, 2);
+}
+
+TEST(ObsStreamParser_truncated_document_returns_false) {
+    ObservationList out;
+    wxString err;
+    std::string doc(FULL_STATION);
+    doc.resize(doc.size() / 2);
+    REQUIRE(!ParseObservations(doc.data(), doc.size(), out, err));
+    REQUIRE(!err.IsEmpty());
+}
+
+TEST(ObsStreamParser_matches_dom_on_mixed_corpus) {
+    const char *corpus[] = {
+        FULL_STATION,
+        R"({"stations": []})",
+        R"({"stations": [
+            {"id": "GOOD", "type": "ship", "lat": 10.0, "lon": 20.0, "time": "2026-01-01T00:00:00Z"},
+            {"id": 5, "lat": 10.0, "lon": 20.0, "time": "2026-01-01T00:00:00Z"},
+            {"id": "LAT", "lat": "10.0", "lon": 20.0, "time": "2026-01-01T00:00:00Z"},
+            {"id": "T", "lat": 10.0, "lon": 20.0, "time": 12},
+            [1, 2], "str", null,
+            {"id": "DUP", "lat": 91.0, "lat": 45.5, "lon": -1.5, "time": "2026-01-01T00:00:00Z"}
+        ], "count": 8})",
+        R"({"count": 0})",
+        R"({"stations": {"id": "X"}})",
+        R"([1, 2, 3])",
+        "{not json}",
+    };
+    for (const char *doc : corpus) {
+        ObservationList dom, stream;
+        wxString dom_err, stream_err;
+        wxString json = wxString::FromUTF8(doc);
+        bool dom_ok = ParseObservationsDOM(json, dom, dom_err);
+        bool stream_ok = ParseObservations(json, stream, stream_err);
+        REQUIRE_EQ(dom_ok, stream_ok);
+        REQUIRE(dom_err == stream_err);
+        REQUIRE_EQ(dom.size(), stream.size());
+        for (size_t i = 0; i < dom.size(); i++) {
+            REQUIRE(dom[i].id == stream[i].id);
+            REQUIRE_EQ(dom[i].lat, stream[i].lat);
+            REQUIRE_EQ(dom[i].lon, stream[i].lon);
+            REQUIRE(dom[i].time == stream[i].time);
+        }
+    }
+}
+
+// ---- wxJSONReader: buffer vs. stream input ---------------------------------
+
+// Parse doc from a memory stream and from the buffer itself; the trees,
+// errors and warnings must be the same.
+static void RequireSameParse(int flags, const std::string &doc) {
+    wxJSONReader stream_reader(flags), buffer_reader(flags);
+    wxJSONValue stream_root, buffer_root;
+    wxMemoryInputStream is(doc.data(), doc.size());
+    int stream_errors = stream_reader.Parse(is, &stream_root);
+    int buffer_errors = buffer_reader.Parse(doc.data(), doc.size(), &buffer_root);
+
+    REQUIRE_EQ(stream_errors, buffer_errors);
+    REQUIRE_EQ(stream_reader.GetWarningCount(), buffer_reader.GetWarningCount());
+    REQUIRE_EQ(stream_reader.GetDepth(), buffer_reader.GetDepth());
+    REQUIRE(stream_reader.GetErrors() == buffer_reader.GetErrors());
+    REQUIRE(stream_reader.GetWarnings() == buffer_reader.GetWarnings());
+
+    wxString stream_text, buffer_text;
+    wxJSONWriter writer(wxJSONWRITER_STYLED | wxJSONWRITER_WRITE_COMMENTS);
+    writer.Write(stream_root, stream_text);
+    writer.Write(buffer_root, buffer_text);
+    REQUIRE(stream_text == buffer_text);
+}
+
+TEST(JSONReader_buffer_matches_stream_on_corpus) {
+    const std::string corpus[] = {
+        FULL_STATION,
+        "{}",
+        "[]",
+        "",
+        "   ",
+        R"({"a": 1, "b": -2, "c": 18446744073709551615, "d": 1.5e300, "e": -0.0})",
+        R"({"s": "plain", "esc": "q\"b\\s\/t\tn\nu\u00e9\u20ac", "utf8": "caf\u00e9 €"})",
+        R"(["multi" "line", 'deadbeef', true, false, null, TRUE, Null])",
+        "{\"crlf\": 1,\r\n \"cr\": 2,\r \"lf\": 3\n}",
+        "{\"a\": 1}\r",
+        "[1, 2, 3]\r\n",
+        "// leading comment\r\n{\"a\": /* inline */ 1, // trailing\r\n \"b\": 2}",
+        "{\"a\": 1 /* unterminated *",
+        "{\"a\": 1 // comment to eof\r",
+        "{\"a\": / 1}",
+        "{\"a\": \"unterminated",
+        "{\"a\": \"bad escape \\q\", \"u\": \"\\u12\"}",
+        "{\"a\": \"bad utf8 \xff\xfe\"}",
+        std::string("{\"nul\": \"a\0b\", \"k\": 1}", 22),
+        R"({"a": 1,, "b": [1,, 2], "c" 3, "d": })",
+        R"({"a": {"b": {"c": [[[[{}]]]]}}})",
+        R"({"a": [1, 2)",
+        R"(]})",
+        "{not json}",
+        "garbage before [1] and after",
+        R"({"a": {"b": [1, {"c": "x"}, []]}, "blob": 'dead' 'beef', "l": [[1], 'ca']})",
+    };
+    for (const std::string &doc : corpus) {
+        RequireSameParse(wxJSONREADER_TOLERANT, doc);
+        RequireSameParse(wxJSONREADER_STRICT, doc);
+        RequireSameParse(wxJSONREADER_TOLERANT | wxJSONREADER_STORE_COMMENTS |
+                         wxJSONREADER_MEMORYBUFF, doc);
+        RequireSameParse(wxJSONREADER_TOLERANT | wxJSONREADER_ARENA, doc);
+    }
+}
+
+TEST(JSONReader_arena_tree_matches_heap_tree) {
+    std::string doc = "// stations\n{\"stations\": [";
+    for (int i = 0; i < 200; i++)
+        doc += std::string(i ? ", " : "") + FULL_STATION;
+    doc += "], \"blob\": 'deadbeef', \"blob\": 'cafe'}";
+
+    const int flags = wxJSONREADER_TOLERANT | wxJSONREADER_STORE_COMMENTS |
+                      wxJSONREADER_MEMORYBUFF;
+    wxJSONValue heap_root, arena_root;
+    REQUIRE_EQ(wxJSONReader(flags).Parse(doc.data(), doc.size(), &heap_root), 0);
+    REQUIRE_EQ(NodeArena::Count(), 0);
+    wxJSONValue kept;
+    {
+        wxJSONValue *root = new wxJSONValue;
+        wxJSONReader reader(flags | wxJSONREADER_ARENA);
+        REQUIRE_EQ(reader.Parse(doc.data(), doc.size(), root), 0);
+        arena_root = *root;
+        kept = (*root)[wxT("stations")][7];
+        delete root;
+    }
+    // The document outlives its reader and its first owner
+    REQUIRE_EQ(NodeArena::Count(), 1);
+    REQUIRE(arena_root.IsSameAs(heap_root));
+    REQUIRE_EQ(arena_root[wxT("stations")].Size(), 200);
+    REQUIRE(arena_root[wxT("blob")].IsMemoryBuff());
+    REQUIRE_EQ(arena_root[wxT("blob")].AsMemoryBuff().GetDataLen(), 2u);
+
+    wxString heap_text, arena_text;
+    wxJSONWriter writer(wxJSONWRITER_STYLED | wxJSONWRITER_WRITE_COMMENTS);
+    writer.Write(heap_root, heap_text);
+    writer.Write(arena_root, arena_text);
+    REQUIRE(heap_text == arena_text);
+
+    // Changing a copy after the parse takes heap memory
+    arena_root[wxT("stations")][0][wxT("count")] = 2;
+    REQUIRE(!arena_root.IsSameAs(heap_root));
+
+    arena_root = wxJSONValue();
+    REQUIRE_EQ(NodeArena::Count(), 1);
+    REQUIRE(kept[wxT("stations")][0][wxT("id")].AsString() == wxT("41008"));
+    kept = wxJSONValue();
+    REQUIRE_EQ(NodeArena::Count(), 0);
+}
+
+// The reader moves each value into its parent instead of copying it; the
+// tree must be the one built by hand, memory buffers included.
+TEST(JSONReader_default_flags_tree_matches_baseline) {
+    const char *doc =
+        R"({"a": {"b": [1, {"c": "x"}, []], "d": {}}, "blob": 'dead' 'beef',)"
+        R"( "list": [[true, null], 'cafe', -2.5]})";
+    wxJSONValue root;
+    wxJSONReader reader;
+    // Memory buffers are an error without wxJSONREADER_MEMORYBUFF, but are
+    // read all the same.
+    REQUIRE_EQ(reader.Parse(doc, strlen(doc), &root), 3);
+
+    const unsigned char dead_beef[] = {0xde, 0xad, 0xbe, 0xef};
+    const unsigned char cafe[] = {0xca, 0xfe};
+    wxJSONValue expected;
+    wxJSONValue c;
+    c[wxT("c")] = wxT("x");
+    wxJSONValue b;
+    b.Append(1);
+    b.Append(c);
+    b.Append(wxJSONValue(wxJSONTYPE_ARRAY));
+    expected[wxT("a")][wxT("b")] = b;
+    expected[wxT("a")][wxT("d")] = wxJSONValue(wxJSONTYPE_OBJECT);
+    expected[wxT("blob")] = wxJSONValue(dead_beef, sizeof(dead_beef));
+    wxJSONValue inner;
+    inner.Append(true);
+    inner.Append(wxJSONValue(wxJSONTYPE_NULL));
+    expected[wxT("list")].Append(inner);
+    expected[wxT("list")].Append(wxJSONValue(cafe, sizeof(cafe)));
+    expected[wxT("list")].Append(-2.5);
+
+    REQUIRE(root.IsSameAs(expected));
+    wxMemoryBuffer blob = root[wxT("blob")].AsMemoryBuff();
+    REQUIRE_EQ(blob.GetDataLen(), sizeof(dead_beef));
+    REQUIRE(std::memcmp(blob.GetData(), dead_beef, sizeof(dead_beef)) == 0);
+    REQUIRE_EQ(root[wxT("list")][1].AsMemoryBuff().GetDataLen(), sizeof(cafe));
+    REQUIRE(root[wxT("a")][wxT("b")][1][wxT("c")].AsString() == wxT("x"));
+}
+
+TEST(JSONReader_buffer_matches_string) {
+    const char *doc = R"({"id": "41008", "lat": 31.4, "tags": ["a", "b"]})";
+    wxJSONReader reader;
+    wxJSONValue from_string, from_buffer;
+    REQUIRE_EQ(reader.Parse(wxString::FromUTF8(doc), &from_string), 0);
+    REQUIRE_EQ(reader.Parse(doc, strlen(doc), &from_buffer), 0);
+    REQUIRE(from_string.IsSameAs(from_buffer));
+    REQUIRE(from_buffer[wxT("tags")][1].AsString() == wxT("b"));
+}
+
+TEST(JSONWriter_doubles_round_trip_and_keep_type) {
+    const double values[] = {200.0, 0.1, 1014.7, -80.87, 1.0 / 3, 1.5e-7,
+                             1e300, -0.0, 4.9406564584124654e-324};
+    wxJSONValue root;
+    for (double d : values) root.Append(d);
+
+    wxString text;
+    wxJSONWriter(wxJSONWRITER_NONE | wxJSONWRITER_RECOGNIZE_DOUBLE).Write(root, text);
+    REQUIRE(text.Contains(wxT("200.0,0.1,1014.7,-80.87,0.3333333333333333,1.5e-7")));
+    wxJSONValue back;
+    REQUIRE_EQ(wxJSONReader().Parse(text, &back), 0);
+    for (int i = 0; i < root.Size(); i++) {
+        REQUIRE(back[i].IsDouble());
+        double got = back[i].AsDouble();
+        REQUIRE(std::memcmp(&values[i], &got, sizeof got) == 0);
+    }
+
+    // Without the style an integral double reads back as an integer
+    text.clear();
+    wxJSONWriter(wxJSONWRITER_NONE).Write(root, text);
+    REQUIRE(text.StartsWith(wxT("[200,0.1,")));
+    REQUIRE_EQ(wxJSONReader().Parse(text, &back), 0);
+    REQUIRE(back[0].IsInt() || back[0].IsLong());
+}
+
+TEST(JSONReader_number_literals) {
+    const char *doc = "[18446744073709551615, 18446744073709551616, "
+                      "-9223372036854775809, 1E2, +7]";
+    wxJSONValue root;
+    REQUIRE_EQ(wxJSONReader().Parse(doc, strlen(doc), &root), 0);
+    REQUIRE(root[0].IsUInt64());
+    // one past the limit no longer wraps around to 0: it becomes a double
+    REQUIRE(root[1].IsDouble() && root[1].AsDouble() == 18446744073709551616.0);
+    REQUIRE(root[2].IsDouble());
+    REQUIRE(root[3].IsDouble() && root[3].AsDouble() == 100.0);
+    REQUIRE(root[4].IsUInt());
+
+    const char *bad[] = {"[0x10]", "[inf]", "[nan]", "[1e]", "[1.5.2]"};
+    for (const char *b : bad)
+        REQUIRE(wxJSONReader().Parse(b, strlen(b), &root) > 0);
+}
+
 int main(int argc, char **argv) {
     // Suppress wx log output during tests
     wxLogNull null_log;
@@ -0,0 +1,136 @@
+#include "test_runner.h"
+#include "../src/projection_cache.h"
+
+#include <cmath>
+#include <string>
+#include <utility>
+
+// Stations at (lat, lon) = (i, 10 * i); station 2 has no position.
+static void Fill(StationStore &store, int n) {
+    StationColumns c;
+    for (int i = 0; i < n; i++) {
+        c.lat.push_back(i == 2 ? NAN : double(i));
+        c.lon.push_back(10.0 * i);
+        c.time.push_back(TIME_UNKNOWN);
+        for (int m = 0; m < METRIC_COUNT; m++) c.metric[m].push_back(NAN);
+        c.id.push_back(c.Intern("S" + std::to_string(i)));
+        c.type.push_back(0);
+        c.country.push_back(0);
+    }
+    store.SetColumns(std::move(c));
+}
+
+static ProjectionKey Key(int w, int h) {
+    ProjectionKey k;
+    k.clat = 10; k.clon = 20; k.view_scale_ppm = 0.001;
+    k.pix_width = w; k.pix_height = h;
+    return k;
+}
+
+// Screen x = lon * 2, y = lat * 20; counts calls.
+struct Linear {
+    int *calls;
+    void operator()(double lat, double lon, float &x, float &y) const {
+        (*calls)++;
+        x = float(lon * 2);
+        y = float(lat * 20);
+    }
+};
+
+TEST(ProjectionCache_projects_every_station_once) {
+    StationStore store;
+    Fill(store, 10);
+    ProjectionCache cache;
+    int calls = 0;
+    ProjectionKey key = Key(100, 100);
+    REQUIRE(!cache.IsCurrent(key));
+    cache.Rebuild(key, store, Linear{&calls});
+    REQUIRE(cache.IsCurrent(key));
+    REQUIRE_EQ(calls, 9);  // station 2 has no position
+    REQUIRE_EQ(cache.X(3), 60.0f);
+    REQUIRE_EQ(cache.Y(3), 60.0f);
+    REQUIRE(std::isnan(cache.X(2)));
+}
+
+TEST(ProjectionCache_visible_subset_uses_margin) {
+    StationStore store;
+    Fill(store, 10);
+    ProjectionCache cache;
+    int calls = 0;
+    cache.Rebuild(Key(100, 100), store, Linear{&calls});
+    // y = 20 * i must be <= 100 + VIEW_MARGIN: stations 0..7, minus 2
+    std::vector<uint32_t> expected = {0, 1, 3, 4, 5, 6, 7};
+    REQUIRE(cache.Visible() == expected);
+    REQUIRE_EQ(cache.Hits().Size(), expected.size());
+    REQUIRE_EQ(cache.Hits().Nearest(81, 79, 15), 4);
+}
+
+TEST(ProjectionCache_key_changes_and_invalidate) {
+    StationStore store;
+    Fill(store, 4);
+    ProjectionCache cache;
+    int calls = 0;
+    ProjectionKey key = Key(100, 100);
+    cache.Rebuild(key, store, Linear{&calls});
+    uint64_t serial = cache.Serial();
+
+    ProjectionKey moved = key;
+    moved.clon += 0.5;
+    REQUIRE(!cache.IsCurrent(moved));
+    ProjectionKey rotated = key;
+    rotated.rotation = 0.1;
+    REQUIRE(!cache.IsCurrent(rotated));
+
+    cache.Invalidate();
+    REQUIRE(!cache.IsCurrent(key));
+    REQUIRE_EQ(cache.Hits().Nearest(0, 0, 15), -1);
+    cache.Rebuild(key, store, Linear{&calls});
+    REQUIRE(cache.Serial() != serial);
+}
+
+TEST(ProjectionCache_carry_skips_unmoved_stations) {
+    StationStore store;
+    Fill(store, 6);
+    ProjectionCache cache;
+    int calls = 0;
+    ProjectionKey key = Key(100, 100);
+    cache.Rebuild(key, store, Linear{&calls});
+    REQUIRE_EQ(calls, 5);
+
+    // New set: old stations 0, 1, 3 (1 moved), then one new station.
+    StationColumns c;
+    const double lat[] = {0, 1.5, 3, 9};
+    const double lon[] = {0, 10, 30, 90};
+    for (int i = 0; i < 4; i++) {
+        c.lat.push_back(lat[i]);
+        c.lon.push_back(lon[i]);
+        c.time.push_back(TIME_UNKNOWN);
+        for (int m = 0; m < METRIC_COUNT; m++) c.metric[m].push_back(NAN);
+        c.id.push_back(0);
+        c.type.push_back(0);
+        c.country.push_back(0);
+    }
+    store.SetColumns(std::move(c));
+    cache.Invalidate(std::vector<uint32_t>{0, 1, 3, NO_STATION});
+    REQUIRE(!cache.IsCurrent(key));
+
+    calls = 0;
+    cache.Rebuild(key, store, Linear{&calls});
+    REQUIRE_EQ(calls, 2);  // the moved and the new station
+    REQUIRE_EQ(cache.X(2), 60.0f);
+    REQUIRE_EQ(cache.Y(2), 60.0f);
+    REQUIRE_EQ(cache.Y(1), 30.0f);
+    REQUIRE_EQ(cache.X(3), 180.0f);
+
+    // A hint for another viewport is ignored.
+    cache.Invalidate(std::vector<uint32_t>{0, 1, 2, 3});
+    ProjectionKey moved = key;
+    moved.clon += 1;
+    calls = 0;
+    cache.Rebuild(moved, store, Linear{&calls});
+    REQUIRE_EQ(calls, 4);
+}
+
+int main(int argc, char **argv) {
+    return run_tests(argc, argv);
+}
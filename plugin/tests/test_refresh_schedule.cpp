@@ -0,0 +1,144 @@
+#include "test_runner.h"
+#include "../src/refresh_schedule.h"
+
+static const BBox AREA  = {40.0, 50.0, -20.0, -10.0};
+static const BBox INNER = {42.0, 48.0, -18.0, -12.0};
+static const BBox OTHER = {40.0, 50.0, 0.0, 10.0};
+
+static RefreshOptions Options() {
+    RefreshOptions opt;
+    opt.interval_ms  = 60000;
+    opt.debounce_ms  = 1000;
+    opt.retry_ms     = 5000;
+    opt.retry_max_ms = 20000;
+    opt.jitter       = 0.0;
+    return opt;
+}
+
+TEST(Refresh_first_right_away_then_every_interval) {
+    RefreshSchedule s;
+    BBox area;
+    REQUIRE(!s.Due(0, area));             // not started
+    s.Start(Options(), AREA, 100);
+    REQUIRE(s.Due(100, area));
+    REQUIRE_EQ(area.lon_min, AREA.lon_min);
+    REQUIRE_EQ(s.NextWake(), REFRESH_NEVER);   // running
+    REQUIRE(!s.Due(200, area));
+    s.Done(true, 500);
+    REQUIRE_EQ(s.NextWake(), int64_t(60500));
+    REQUIRE(!s.Due(60499, area));
+    REQUIRE(s.Due(60500, area));
+    s.Stop();
+    REQUIRE_EQ(s.NextWake(), REFRESH_NEVER);
+}
+
+TEST(Refresh_debounces_area_changes) {
+    RefreshSchedule s;
+    BBox area;
+    s.Start(Options(), AREA, 0);
+    s.Due(0, area);
+    s.Done(true, 0);
+
+    // Panning: each change pushes the refresh back.
+    s.SetArea(OTHER, 1000);
+    REQUIRE_EQ(s.NextWake(), int64_t(2000));
+    s.SetArea({40.0, 50.0, 1.0, 11.0}, 1500);
+    REQUIRE_EQ(s.NextWake(), int64_t(2500));
+    REQUIRE(!s.Due(2000, area));
+    REQUIRE(s.Due(2500, area));
+    REQUIRE_EQ(area.lon_min, 1.0);
+}
+
+TEST(Refresh_skips_area_covered_by_fresh_data) {
+    RefreshSchedule s;
+    BBox area;
+    s.Start(Options(), AREA, 0);
+    s.Due(0, area);
+    s.Done(true, 0);
+
+    s.SetArea(INNER, 1000);                    // zoomed in
+    REQUIRE_EQ(s.NextWake(), int64_t(60000));
+    s.SetArea(OTHER, 2000);                    // panned away...
+    REQUIRE_EQ(s.NextWake(), int64_t(3000));
+    s.SetArea(AREA, 2500);                     // ...and back
+    REQUIRE_EQ(s.NextWake(), int64_t(60000));
+
+    // Fresh no longer: the regular refresh is due anyway.
+    s.SetArea(INNER, 60000);
+    REQUIRE(s.Due(60000, area));
+}
+
+TEST(Refresh_backs_off_after_failures) {
+    RefreshSchedule s;
+    BBox area;
+    s.Start(Options(), AREA, 0);
+    int64_t now = 0;
+    const int64_t expected[] = {5000, 10000, 20000, 20000};
+    for (int64_t delay : expected) {
+        REQUIRE(s.Due(now, area));
+        s.Done(false, now);
+        REQUIRE_EQ(s.NextWake(), now + delay);
+        // A new area doesn't cut the wait short.
+        s.SetArea(area.lon_min == AREA.lon_min ? OTHER : AREA, now + 10);
+        REQUIRE_EQ(s.NextWake(), now + delay);
+        now += delay;
+    }
+    REQUIRE_EQ(s.Failures(), 4);
+    REQUIRE(s.Due(now, area));
+    s.Done(true, now);
+    REQUIRE_EQ(s.Failures(), 0);
+    REQUIRE_EQ(s.NextWake(), now + 60000);
+}
+
+TEST(Refresh_area_changed_while_running) {
+    RefreshSchedule s;
+    BBox area;
+    s.Start(Options(), AREA, 0);
+    REQUIRE(s.Due(0, area));
+    s.SetArea(OTHER, 100);
+    s.Done(true, 400);
+    REQUIRE_EQ(s.NextWake(), int64_t(1400));
+    REQUIRE(s.Due(1400, area));
+    REQUIRE_EQ(area.lon_min, OTHER.lon_min);
+
+    // A cancelled refresh is tried again after the interval.
+    s.Skipped(1500);
+    REQUIRE_EQ(s.NextWake(), int64_t(61500));
+    REQUIRE_EQ(s.Failures(), 0);
+}
+
+TEST(Refresh_jitter_stays_in_range) {
+    RefreshOptions opt = Options();
+    opt.jitter = 0.1;
+    RefreshSchedule s(42);
+    BBox area;
+    s.Start(opt, AREA, 0);
+    bool varies = false;
+    int64_t first = -1;
+    for (int i = 0; i < 50; i++) {
+        int64_t now = s.NextWake();
+        REQUIRE(s.Due(now, area));
+        s.Done(true, now);
+        int64_t delay = s.NextWake() - now;
+        REQUIRE(delay >= 54000 && delay <= 66000);
+        if (first < 0) first = delay;
+        varies |= delay != first;
+    }
+    REQUIRE(varies);
+}
+
+TEST(Refresh_covers_across_antimeridian) {
+    RefreshSchedule s;
+    BBox area;
+    s.Start(Options(), {-10.0, 10.0, 170.0, -170.0}, 0);
+    s.Due(0, area);
+    s.Done(true, 0);
+    s.SetArea({-5.0, 5.0, 175.0, 185.0}, 100);   // same place, lon past 180
+    REQUIRE_EQ(s.NextWake(), int64_t(60000));
+    s.SetArea({-5.0, 5.0, 160.0, 175.0}, 200);
+    REQUIRE_EQ(s.NextWake(), int64_t(1200));
+}
+
+int main(int argc, char **argv) {
+    return run_tests(argc, argv);
+}
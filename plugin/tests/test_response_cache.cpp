@@ -0,0 +1,157 @@
+#include "test_runner.h"
+#include "../src/response_cache.h"
+
+#include <cstdio>
+#include <string>
+
+// ---- helpers ---------------------------------------------------------------
+
+// Cache files are created in the working directory (the build tree under
+// ctest) and removed before each test.
+static const char *BASE = "test_response_cache_tmp";
+
+static void CleanCache() {
+    std::string base(BASE);
+    for (unsigned slot = 0; slot < CACHE_SLOTS; slot++) {
+        std::string path = base + "." + std::to_string(slot) + ".resp";
+        std::remove(path.c_str());
+        std::remove((path + ".tmp").c_str());
+    }
+}
+
+static StationColumns MakeColumns(int n) {
+    StationColumns c;
+    for (int i = 0; i < n; i++) {
+        c.lat.push_back(10.0 + i);
+        c.lon.push_back(-20.0 - i);
+        c.time.push_back(1771597800 + i * 60);
+        for (int m = 0; m < METRIC_COUNT; m++)
+            c.metric[m].push_back(static_cast<float>(i + m));
+        c.id.push_back(c.Intern("ID" + std::to_string(i)));
+        c.type.push_back(c.Intern("buoy"));
+        c.country.push_back(c.Intern(""));
+    }
+    return c;
+}
+
+static const std::string URL_A =
+    "http://localhost:8080/api/v1/observations?lat_min=10.0000&lat_max=20.0000"
+    "&lon_min=-30.0000&lon_max=-10.0000&max_age=6h&types=buoy,ship";
+
+// ---- tests -----------------------------------------------------------------
+
+TEST(ResponseCache_round_trip) {
+    CleanCache();
+    ResponseCache cache;
+    cache.Open(BASE);
+    StationColumns cols = MakeColumns(5);
+    REQUIRE(cache.Store(URL_A, "\"abc123\"", "Sat, 17 Oct 2026 12:00:00 GMT",
+                        cols, 1791201600));
+
+    CachedResponse hit;
+    REQUIRE(cache.Load(URL_A, hit));
+    REQUIRE_EQ(hit.etag, std::string("\"abc123\""));
+    REQUIRE_EQ(hit.last_modified, std::string("Sat, 17 Oct 2026 12:00:00 GMT"));
+    REQUIRE_EQ(hit.stored_at, int64_t(1791201600));
+    REQUIRE_EQ(hit.stations.Size(), size_t(5));
+    REQUIRE_EQ(hit.stations.String(hit.stations.id[3]), std::string("ID3"));
+    REQUIRE_EQ(hit.stations.lat[4], 14.0);
+    REQUIRE_EQ(hit.stations.time[2], int64_t(1771597920));
+    CleanCache();
+}
+
+TEST(ResponseCache_store_replaces_entry) {
+    CleanCache();
+    ResponseCache cache;
+    cache.Open(BASE);
+    REQUIRE(cache.Store(URL_A, "\"v1\"", "", MakeColumns(3), 0));
+    REQUIRE(cache.Store(URL_A, "\"v2\"", "", MakeColumns(7), 0));
+
+    CachedResponse hit;
+    REQUIRE(cache.Load(URL_A, hit));
+    REQUIRE_EQ(hit.etag, std::string("\"v2\""));
+    REQUIRE(hit.last_modified.empty());
+    REQUIRE_EQ(hit.stations.Size(), size_t(7));
+    CleanCache();
+}
+
+TEST(ResponseCache_misses) {
+    CleanCache();
+    ResponseCache cache;
+    CachedResponse hit;
+    REQUIRE(!cache.Load(URL_A, hit));  // not opened
+    REQUIRE(!cache.Store(URL_A, "\"x\"", "", MakeColumns(1), 0));
+
+    cache.Open(BASE);
+    REQUIRE(!cache.Load(URL_A, hit));  // nothing stored
+    CleanCache();
+}
+
+TEST(ResponseCache_entry_without_validators) {
+    CleanCache();
+    ResponseCache cache;
+    cache.Open(BASE);
+    REQUIRE(cache.Store("tile|3|7", "", "", MakeColumns(2), 42));
+    CachedResponse hit;
+    REQUIRE(cache.Load("tile|3|7", hit));
+    REQUIRE(hit.etag.empty() && hit.last_modified.empty());
+    REQUIRE_EQ(hit.stored_at, int64_t(42));
+    REQUIRE_EQ(hit.stations.Size(), size_t(2));
+    CleanCache();
+}
+
+TEST(ResponseCache_slot_count) {
+    ResponseCache small(4);
+    small.Open(BASE);
+    for (int i = 0; i < 50; i++) {
+        std::string path = small.PathFor("url" + std::to_string(i));
+        std::string slot = path.substr(std::string(BASE).size() + 1);
+        REQUIRE(slot == "0.resp" || slot == "1.resp" || slot == "2.resp" ||
+                slot == "3.resp");
+    }
+}
+
+TEST(ResponseCache_slot_collision_is_a_miss) {
+    CleanCache();
+    ResponseCache cache;
+    cache.Open(BASE);
+    // Find another URL hashing to URL_A's slot.
+    std::string other;
+    for (int i = 0; other.empty(); i++) {
+        std::string u = URL_A + "&n=" + std::to_string(i);
+        if (cache.PathFor(u) == cache.PathFor(URL_A)) other = u;
+    }
+    REQUIRE(cache.Store(URL_A, "\"a\"", "", MakeColumns(2), 0));
+    CachedResponse hit;
+    REQUIRE(!cache.Load(other, hit));
+
+    // Storing the other URL takes the slot over.
+    REQUIRE(cache.Store(other, "\"b\"", "", MakeColumns(4), 0));
+    REQUIRE(!cache.Load(URL_A, hit));
+    REQUIRE(cache.Load(other, hit));
+    REQUIRE_EQ(hit.stations.Size(), size_t(4));
+    CleanCache();
+}
+
+TEST(ResponseCache_rejects_damaged_file) {
+    CleanCache();
+    ResponseCache cache;
+    cache.Open(BASE);
+    REQUIRE(cache.Store(URL_A, "\"a\"", "", MakeColumns(6), 0));
+
+    // Truncate the file inside the station block.
+    std::string path = cache.PathFor(URL_A);
+    std::string buf;
+    REQUIRE(ReadFileBytes(path, buf));
+    REQUIRE(WriteFileAtomic(path, buf.substr(0, buf.size() - 40)));
+    CachedResponse hit;
+    REQUIRE(!cache.Load(URL_A, hit));
+
+    REQUIRE(WriteFileAtomic(path, "garbage"));
+    REQUIRE(!cache.Load(URL_A, hit));
+    CleanCache();
+}
+
+int main(int argc, char **argv) {
+    return run_tests(argc, argv);
+}
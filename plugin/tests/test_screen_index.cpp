@@ -0,0 +1,89 @@
+#include "test_runner.h"
+#include "../src/screen_index.h"
+
+#include <cstdlib>
+#include <vector>
+
+struct Pt { float x, y; };
+
+// Reference: linear scan with the same tie rule as ScreenIndex::Nearest.
+static int BruteNearest(const std::vector<Pt> &pts, float x, float y, float radius) {
+    int best = -1;
+    double best_dist_sq = double(radius) * radius;
+    for (size_t i = 0; i < pts.size(); i++) {
+        double dx = x - pts[i].x, dy = y - pts[i].y;
+        double d = dx * dx + dy * dy;
+        if (d < best_dist_sq) { best_dist_sq = d; best = int(i); }
+    }
+    return best;
+}
+
+static std::vector<Pt> RandomPoints(int n, int w, int h, int margin) {
+    std::srand(12345);
+    std::vector<Pt> pts;
+    for (int i = 0; i < n; i++) {
+        Pt p = {float(std::rand() % (w + 2 * margin) - margin),
+                float(std::rand() % (h + 2 * margin) - margin)};
+        pts.push_back(p);
+    }
+    return pts;
+}
+
+static void Build(ScreenIndex &index, const std::vector<Pt> &pts, int w, int h) {
+    index.Begin(w, h, 50);
+    for (size_t i = 0; i < pts.size(); i++)
+        index.Add(uint32_t(i), pts[i].x, pts[i].y);
+    index.Finish();
+}
+
+TEST(ScreenIndex_matches_linear_scan) {
+    const int W = 1280, H = 800;
+    std::vector<Pt> pts = RandomPoints(10000, W, H, 50);
+    ScreenIndex index;
+    Build(index, pts, W, H);
+    REQUIRE_EQ(index.Size(), 10000u);
+    for (int q = 0; q < 2000; q++) {
+        float x = float(std::rand() % (W + 40) - 20);
+        float y = float(std::rand() % (H + 40) - 20);
+        REQUIRE_EQ(index.Nearest(x, y, 15), BruteNearest(pts, x, y, 15));
+    }
+}
+
+TEST(ScreenIndex_returns_position_and_respects_radius) {
+    std::vector<Pt> pts = {{100, 100}, {130, 100}};
+    ScreenIndex index;
+    Build(index, pts, 640, 480);
+    float sx = 0, sy = 0;
+    REQUIRE_EQ(index.Nearest(112, 100, 15, &sx, &sy), 0);
+    REQUIRE_EQ(sx, 100.0f);
+    REQUIRE_EQ(index.Nearest(120, 100, 15, &sx, &sy), 1);
+    REQUIRE_EQ(sx, 130.0f);
+    REQUIRE_EQ(index.Nearest(115, 120, 15), -1);   // 15 px away is not a hit
+    REQUIRE_EQ(index.Nearest(100, 115, 15), -1);
+}
+
+TEST(ScreenIndex_ties_go_to_lower_station) {
+    ScreenIndex index;
+    index.Begin(640, 480, 50);
+    index.Add(7, 200, 200);
+    index.Add(3, 200, 200);
+    index.Add(5, 210, 200);
+    index.Finish();
+    REQUIRE_EQ(index.Nearest(201, 200, 15), 3);
+}
+
+TEST(ScreenIndex_edges_and_clear) {
+    std::vector<Pt> pts = {{-49, -49}, {689, 529}};
+    ScreenIndex index;
+    Build(index, pts, 640, 480);
+    REQUIRE_EQ(index.Nearest(-40, -40, 15), 0);
+    REQUIRE_EQ(index.Nearest(680, 520, 15), 1);
+    index.Clear();
+    REQUIRE_EQ(index.Size(), 0u);
+    REQUIRE_EQ(index.Nearest(680, 520, 15), -1);
+    REQUIRE_EQ(ScreenIndex().Nearest(0, 0, 15), -1);
+}
+
+int main(int argc, char **argv) {
+    return run_tests(argc, argv);
+}
@@ -0,0 +1,149 @@
+#include "test_runner.h"
+#include "../src/station_clusters.h"
+
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct Point { float x, y; const char *type; int64_t time; };
+
+// One station per point; the projection maps (lat, lon) straight to (y, x).
+static void Fill(StationStore &store, const std::vector<Point> &pts) {
+    StationColumns c;
+    for (size_t i = 0; i < pts.size(); i++) {
+        c.lat.push_back(pts[i].y);
+        c.lon.push_back(pts[i].x);
+        c.time.push_back(pts[i].time);
+        for (int m = 0; m < METRIC_COUNT; m++) c.metric[m].push_back(NAN);
+        c.id.push_back(c.Intern("S" + std::to_string(i)));
+        c.type.push_back(c.Intern(pts[i].type));
+        c.country.push_back(0);
+    }
+    store.SetColumns(std::move(c));
+}
+
+struct Identity {
+    void operator()(double lat, double lon, float &x, float &y) const {
+        x = float(lon);
+        y = float(lat);
+    }
+};
+
+static void Project(ProjectionCache &cache, const StationStore &store,
+                    int w = 1000, int h = 1000) {
+    ProjectionKey k;
+    k.pix_width = w;
+    k.pix_height = h;
+    k.view_scale_ppm = 1;
+    cache.Rebuild(k, store, Identity());
+}
+
+TEST(StationClusters_spread_stations_stay_single) {
+    StationStore store;
+    Fill(store, {{10, 10, "ship", 0}, {100, 10, "buoy", 0}, {10, 100, "ship", 0}});
+    ProjectionCache proj;
+    Project(proj, store);
+    StationClusters clusters;
+    clusters.Build(store, proj);
+    REQUIRE_EQ(clusters.Clusters().size(), size_t(3));
+    for (size_t c = 0; c < 3; c++) {
+        REQUIRE_EQ(clusters.Clusters()[c].count, 1u);
+        REQUIRE_EQ(clusters.Members(c)[0], clusters.Clusters()[c].seed);
+    }
+}
+
+TEST(StationClusters_close_stations_merge) {
+    StationStore store;
+    Fill(store, {{100, 100, "ship", 50}, {105, 100, "buoy", 70},
+                 {100, 110, "ship", TIME_UNKNOWN}, {400, 400, "shore", 10}});
+    ProjectionCache proj;
+    Project(proj, store);
+    StationClusters clusters;
+    clusters.Build(store, proj);
+    REQUIRE_EQ(clusters.Clusters().size(), size_t(2));
+
+    const StationCluster &a = clusters.Clusters()[0];
+    REQUIRE_EQ(a.count, 3u);
+    REQUIRE_EQ(a.seed, 0u);
+    REQUIRE_NEAR(a.x, 305.0f / 3, 1e-3);
+    REQUIRE_NEAR(a.y, 310.0f / 3, 1e-3);
+    REQUIRE_EQ(a.newest, int64_t(70));
+    REQUIRE_EQ(int(a.type_mask), (1 << PLATFORM_SHIP) | (1 << PLATFORM_BUOY));
+    REQUIRE_EQ(clusters.Members(0)[0], 0u);
+    REQUIRE_EQ(clusters.Members(0)[1], 1u);
+    REQUIRE_EQ(clusters.Members(0)[2], 2u);
+
+    REQUIRE_EQ(clusters.Clusters()[1].count, 1u);
+    REQUIRE_EQ(clusters.Members(1)[0], 3u);
+}
+
+TEST(StationClusters_join_nearest_seed) {
+    // Station 2 is within the radius of both seeds but closer to station 1.
+    StationStore store;
+    Fill(store, {{100, 100, "ship", 0}, {130, 100, "ship", 0},
+                 {118, 100, "ship", 0}});
+    ProjectionCache proj;
+    Project(proj, store);
+    StationClusters clusters(20);
+    clusters.Build(store, proj);
+    REQUIRE_EQ(clusters.Clusters().size(), size_t(2));
+    REQUIRE_EQ(clusters.Clusters()[0].count, 1u);
+    REQUIRE_EQ(clusters.Clusters()[1].count, 2u);
+}
+
+TEST(StationClusters_skip_offscreen_and_hit_test) {
+    StationStore store;
+    Fill(store, {{5000, 5000, "ship", 0}, {200, 200, "ship", 0},
+                 {204, 203, "drifter", 0}});
+    ProjectionCache proj;
+    Project(proj, store);
+    StationClusters clusters;
+    clusters.Build(store, proj);
+    REQUIRE_EQ(clusters.Clusters().size(), size_t(1));
+    REQUIRE_EQ(clusters.Clusters()[0].count, 2u);
+    REQUIRE_EQ(clusters.Hits().Nearest(201, 201, 15), 0);
+    REQUIRE_EQ(clusters.Hits().Nearest(600, 600, 15), -1);
+
+    clusters.Clear();
+    REQUIRE(clusters.Clusters().empty());
+    REQUIRE_EQ(clusters.Hits().Nearest(201, 201, 15), -1);
+}
+
+TEST(StationClusters_cover_every_visible_station_once) {
+    std::vector<Point> pts;
+    srand(7);
+    for (int i = 0; i < 20000; i++)
+        pts.push_back({float(rand() % 1000), float(rand() % 1000), "ship", 0});
+    StationStore store;
+    Fill(store, pts);
+    ProjectionCache proj;
+    Project(proj, store);
+    StationClusters clusters;
+    clusters.Build(store, proj);
+
+    // Dense data collapses to a screen-bounded number of markers.
+    size_t n = clusters.Clusters().size();
+    REQUIRE(n < 4000);
+
+    std::vector<int> seen(pts.size(), 0);
+    size_t total = 0;
+    for (size_t c = 0; c < n; c++) {
+        const StationCluster &cl = clusters.Clusters()[c];
+        const uint32_t *m = clusters.Members(c);
+        REQUIRE_EQ(m[0], cl.seed);
+        for (uint32_t k = 0; k < cl.count; k++) {
+            seen[m[k]]++;
+            float dx = proj.X(m[k]) - proj.X(cl.seed);
+            float dy = proj.Y(m[k]) - proj.Y(cl.seed);
+            REQUIRE(dx * dx + dy * dy < CLUSTER_RADIUS * CLUSTER_RADIUS);
+        }
+        total += cl.count;
+    }
+    REQUIRE_EQ(total, pts.size());
+    for (int s : seen) REQUIRE_EQ(s, 1);
+}
+
+int main(int argc, char **argv) {
+    return run_tests(argc, argv);
+}
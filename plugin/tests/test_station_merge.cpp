@@ -0,0 +1,123 @@
+#include "test_runner.h"
+#include "../src/station_merge.h"
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+struct Report { const char *id; double lat, lon; int64_t time; float wind; };
+
+static StationColumns Make(const std::vector<Report> &reports) {
+    StationColumns c;
+    for (const Report &r : reports) {
+        c.lat.push_back(r.lat);
+        c.lon.push_back(r.lon);
+        c.time.push_back(r.time);
+        for (int m = 0; m < METRIC_COUNT; m++)
+            c.metric[m].push_back(m == METRIC_WIND_SPD ? r.wind : NAN);
+        c.id.push_back(c.Intern(r.id));
+        c.type.push_back(c.Intern("buoy"));
+        c.country.push_back(c.Intern("US"));
+    }
+    return c;
+}
+
+static std::string Id(const StationColumns &c, size_t i) {
+    return c.String(c.id[i]);
+}
+
+TEST(NewestTime_ignores_unknown) {
+    StationColumns c = Make({{"A", 0, 0, 100, 0}, {"B", 0, 0, TIME_UNKNOWN, 0},
+                             {"C", 0, 0, 300, 0}});
+    REQUIRE_EQ(NewestTime(c.View()), int64_t(300));
+    REQUIRE_EQ(NewestTime(StationColumns().View()), TIME_UNKNOWN);
+}
+
+TEST(MergeStations_newer_report_wins_in_place) {
+    StationColumns base = Make({{"A", 10, 20, 100, 1}, {"B", 11, 21, 100, 2},
+                                {"C", 12, 22, 100, 3}});
+    StationColumns delta = Make({{"B", 11.5, 21.5, 200, 20}, {"D", 13, 23, 150, 4}});
+    StationColumns out;
+    std::vector<uint32_t> carry;
+    MergeStats st = MergeStations(base.View(), delta.View(), TIME_UNKNOWN,
+                                  out, &carry);
+    REQUIRE_EQ(st.kept, size_t(2));
+    REQUIRE_EQ(st.updated, size_t(1));
+    REQUIRE_EQ(st.added, size_t(1));
+    REQUIRE_EQ(st.expired, size_t(0));
+
+    REQUIRE_EQ(out.Size(), size_t(4));
+    REQUIRE_EQ(Id(out, 0), "A");
+    REQUIRE_EQ(Id(out, 1), "B");
+    REQUIRE_EQ(Id(out, 2), "C");
+    REQUIRE_EQ(Id(out, 3), "D");
+    REQUIRE_EQ(out.time[1], int64_t(200));
+    REQUIRE_EQ(out.lat[1], 11.5);
+    REQUIRE_EQ(out.metric[METRIC_WIND_SPD][1], 20.0f);
+    REQUIRE_EQ(out.String(out.type[3]), "buoy");
+
+    REQUIRE_EQ(carry.size(), size_t(4));
+    REQUIRE_EQ(carry[0], 0u);
+    REQUIRE_EQ(carry[1], 1u);
+    REQUIRE_EQ(carry[2], 2u);
+    REQUIRE_EQ(carry[3], NO_STATION);
+}
+
+TEST(MergeStations_older_or_equal_delta_keeps_base) {
+    StationColumns base = Make({{"A", 10, 20, 200, 1}, {"B", 11, 21, 200, 2}});
+    StationColumns delta = Make({{"A", 0, 0, 100, 9}, {"B", 0, 0, 200, 9}});
+    StationColumns out;
+    MergeStats st = MergeStations(base.View(), delta.View(), TIME_UNKNOWN,
+                                  out, nullptr);
+    REQUIRE_EQ(st.kept, size_t(2));
+    REQUIRE_EQ(st.updated + st.added, size_t(0));
+    REQUIRE_EQ(out.lat[0], 10.0);
+    REQUIRE_EQ(out.lat[1], 11.0);
+}
+
+TEST(MergeStations_drops_expired) {
+    StationColumns base = Make({{"A", 0, 0, 50, 0}, {"B", 0, 0, 150, 0}});
+    StationColumns delta = Make({{"C", 0, 0, 90, 0}, {"D", 0, 0, 200, 0}});
+    StationColumns out;
+    std::vector<uint32_t> carry;
+    MergeStats st = MergeStations(base.View(), delta.View(), 100, out, &carry);
+    REQUIRE_EQ(st.expired, size_t(1));
+    REQUIRE_EQ(out.Size(), size_t(2));
+    REQUIRE_EQ(Id(out, 0), "B");
+    REQUIRE_EQ(Id(out, 1), "D");
+    REQUIRE_EQ(carry[0], 1u);
+    REQUIRE_EQ(carry[1], NO_STATION);
+}
+
+TEST(MergeStations_placeholder_ships_never_merge) {
+    StationColumns base = Make({{"SHIP", 10, 20, 100, 0}});
+    StationColumns delta = Make({{"SHIP", 10, 20, 100, 0},    // same report
+                                 {"SHIP", 30, 40, 200, 0},    // another ship
+                                 {"SHIP", 10, 20, 300, 0}});  // later report
+    StationColumns out;
+    MergeStats st = MergeStations(base.View(), delta.View(), TIME_UNKNOWN,
+                                  out, nullptr);
+    REQUIRE_EQ(st.kept, size_t(1));
+    REQUIRE_EQ(st.added, size_t(2));
+    REQUIRE_EQ(out.Size(), size_t(3));
+    REQUIRE_EQ(out.time[0], int64_t(100));
+    REQUIRE_EQ(out.time[1], int64_t(200));
+    REQUIRE_EQ(out.time[2], int64_t(300));
+}
+
+TEST(MergeStations_duplicate_ids_in_delta_keep_newest) {
+    StationColumns base = Make({});
+    StationColumns delta = Make({{"A", 1, 1, 300, 0}, {"A", 2, 2, 100, 0},
+                                 {"B", 3, 3, 100, 0}});
+    StationColumns out;
+    MergeStats st = MergeStations(base.View(), delta.View(), TIME_UNKNOWN,
+                                  out, nullptr);
+    REQUIRE_EQ(st.added, size_t(2));
+    REQUIRE_EQ(Id(out, 0), "A");
+    REQUIRE_EQ(out.time[0], int64_t(300));
+    REQUIRE_EQ(Id(out, 1), "B");
+}
+
+int main(int argc, char **argv) {
+    return run_tests(argc, argv);
+}
@@ -0,0 +1,136 @@
+#include "test_runner.h"
+#include "../src/station_store.h"
+#include "../src/station_merge.h"
+
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <utility>
+
+// ---- helpers ---------------------------------------------------------------
+
+static const char *BASE = "test_station_store_tmp";
+
+static void CleanStore() {
+    std::string base(BASE);
+    std::remove((base + ".idx").c_str());
+    std::remove((base + ".idx.tmp").c_str());
+    for (int gen = 0; gen < 4; gen++)
+        std::remove((base + "." + std::to_string(gen) + ".dat").c_str());
+}
+
+static const char *TYPES[] = {"ship", "buoy", "shore", "drifter", "glider", ""};
+
+// n stations cycling through TYPES; ids unique, countries shared.
+static StationColumns MakeColumns(int n) {
+    StationColumns c;
+    for (int i = 0; i < n; i++) {
+        c.lat.push_back(10.0 + i);
+        c.lon.push_back(-20.0 - i);
+        c.time.push_back(1771597800 + i);
+        for (int m = 0; m < METRIC_COUNT; m++)
+            c.metric[m].push_back(float(m + i));
+        c.id.push_back(c.Intern("ST" + std::to_string(i)));
+        c.type.push_back(c.Intern(TYPES[i % 6]));
+        c.country.push_back(c.Intern(i % 2 ? "NO" : "US"));
+    }
+    return c;
+}
+
+static const PlatformType EXPECTED[] = {
+    PLATFORM_SHIP, PLATFORM_BUOY, PLATFORM_SHORE, PLATFORM_DRIFTER,
+    PLATFORM_OTHER, PLATFORM_OTHER};
+
+// ---- tests -----------------------------------------------------------------
+
+TEST(PlatformTypeFromString_known_and_unknown) {
+    REQUIRE_EQ(PlatformTypeFromString("ship", 4), PLATFORM_SHIP);
+    REQUIRE_EQ(PlatformTypeFromString("drifter", 7), PLATFORM_DRIFTER);
+    REQUIRE_EQ(PlatformTypeFromString("ships", 5), PLATFORM_OTHER);
+    REQUIRE_EQ(PlatformTypeFromString("shi", 3), PLATFORM_OTHER);
+    REQUIRE_EQ(PlatformTypeFromString("", 0), PLATFORM_OTHER);
+}
+
+TEST(StationStore_set_columns_reads_in_place) {
+    StationStore store;
+    REQUIRE(store.Empty());
+    store.SetColumns(MakeColumns(12));
+    REQUIRE_EQ(store.Size(), 12u);
+    for (size_t i = 0; i < store.Size(); i++) {
+        REQUIRE_EQ(store.Lat(i), 10.0 + i);
+        REQUIRE_EQ(store.Lon(i), -20.0 - i);
+        REQUIRE_EQ(store.Time(i), int64_t(1771597800 + i));
+        REQUIRE_EQ(store.Metric(METRIC_VIS, i), float(METRIC_VIS + i));
+        REQUIRE_EQ(store.Type(i), EXPECTED[i % 6]);
+    }
+    REQUIRE_EQ(sizeof(PlatformType), 1u);
+}
+
+TEST(StationStore_append_adds_at_the_end) {
+    StationColumns all = MakeColumns(12);
+    StationColumns first = MakeColumns(5);
+    StationStore store;
+    store.Append(first.View());           // empty store
+    REQUIRE_EQ(store.Size(), 5u);
+
+    StationColumns rest;
+    for (int i = 5; i < 12; i++) AppendStation(all.View(), i, rest);
+    store.Append(rest.View());
+    REQUIRE_EQ(store.Size(), 12u);
+    for (size_t i = 0; i < store.Size(); i++) {
+        REQUIRE_EQ(store.Lat(i), 10.0 + i);
+        REQUIRE_EQ(store.Type(i), EXPECTED[i % 6]);
+        REQUIRE_EQ(std::string(store.StringData(store.IdIndex(i)),
+                               store.StringLength(store.IdIndex(i))),
+                   "ST" + std::to_string(i));
+    }
+    // Countries are still shared after the append.
+    REQUIRE_EQ(store.CountryIndex(0), store.CountryIndex(6));
+}
+
+TEST(StationStore_interned_strings_compare_by_index) {
+    StationStore store;
+    store.SetColumns(MakeColumns(6));
+    REQUIRE_EQ(store.CountryIndex(0), store.CountryIndex(2));
+    REQUIRE(store.CountryIndex(0) != store.CountryIndex(1));
+    uint32_t id = store.FindString("ST3");
+    REQUIRE_EQ(id, store.IdIndex(3));
+    REQUIRE_EQ(std::string(store.StringData(id), store.StringLength(id)),
+               std::string("ST3"));
+    REQUIRE_EQ(store.FindString("ST99"), STRING_NOT_FOUND);
+}
+
+TEST(StationStore_maps_history_record) {
+    CleanStore();
+    HistoryStore history;
+    REQUIRE(history.Open(BASE));
+    HistoryRecordInfo info;
+    info.label = "r";
+    REQUIRE(history.Append(info, MakeColumns(30)));
+
+    StationStore store;
+    store.SetColumns(MakeColumns(3));
+    REQUIRE(store.MapRecord(history, 0));
+    REQUIRE_EQ(store.Size(), 30u);
+    for (size_t i = 0; i < store.Size(); i++)
+        REQUIRE_EQ(store.Type(i), EXPECTED[i % 6]);
+    REQUIRE_EQ(store.IdIndex(29), store.FindString("ST29"));
+
+    REQUIRE(!store.MapRecord(history, 1));
+    REQUIRE(store.Empty());
+    CleanStore();
+}
+
+TEST(StationStore_clear_empties) {
+    StationStore store;
+    store.SetColumns(MakeColumns(4));
+    store.Clear();
+    REQUIRE(store.Empty());
+    REQUIRE(store.Columns().Empty());
+    store.SetColumns(StationColumns());
+    REQUIRE(store.Empty());
+}
+
+int main(int argc, char **argv) {
+    return run_tests(argc, argv);
+}
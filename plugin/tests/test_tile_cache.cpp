@@ -0,0 +1,205 @@
+#include "test_runner.h"
+#include "../src/tile_cache.h"
+
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// ---- helpers ---------------------------------------------------------------
+
+// Tile files are created in the working directory (the build tree under
+// ctest) and removed before each test.
+static const char *BASE = "test_tile_cache_tmp";
+static const std::string QUERY = "http://localhost:8080|6h|buoy,ship";
+static const int64_t NOW = 1791201600;
+
+static void CleanDisk() {
+    std::string base(BASE);
+    for (unsigned slot = 0; slot < TILE_DISK_SLOTS; slot++) {
+        std::string path = base + "." + std::to_string(slot) + ".resp";
+        std::remove(path.c_str());
+    }
+}
+
+struct Report { const char *id; double lat, lon; int64_t time; };
+
+static StationColumns Make(const std::vector<Report> &reports) {
+    StationColumns c;
+    for (const Report &r : reports) {
+        c.lat.push_back(r.lat);
+        c.lon.push_back(r.lon);
+        c.time.push_back(r.time);
+        for (int m = 0; m < METRIC_COUNT; m++) c.metric[m].push_back(NAN);
+        c.id.push_back(c.Intern(r.id));
+        c.type.push_back(c.Intern("buoy"));
+        c.country.push_back(c.Intern(""));
+    }
+    return c;
+}
+
+static bool HasId(const StationColumns &c, const std::string &id) {
+    for (size_t i = 0; i < c.Size(); i++)
+        if (c.String(c.id[i]) == id) return true;
+    return false;
+}
+
+// ---- grid ------------------------------------------------------------------
+
+TEST(Tiles_grid_and_bounds) {
+    REQUIRE_EQ(TileRow(-90.0), 0);
+    REQUIRE_EQ(TileRow(90.0), TILE_ROWS - 1);
+    REQUIRE_EQ(TileCol(-180.0), 0);
+    REQUIRE_EQ(TileCol(180.0), TILE_COLS - 1);
+    REQUIRE_EQ(TileRow(5.0), 9);
+    REQUIRE_EQ(TileCol(-5.0), 17);
+
+    // Upper edges on a tile boundary don't pull in the next tile.
+    TileRect r = TilesCovering({10.0, 30.0, -40.0, -20.0});
+    REQUIRE_EQ(r.row0, 10);
+    REQUIRE_EQ(r.row1, 11);
+    REQUIRE_EQ(r.col0, 14);
+    REQUIRE_EQ(r.col1, 15);
+    BBox b = TileBounds(r);
+    REQUIRE_NEAR(b.lat_min, 10.0, 1e-9);
+    REQUIRE_NEAR(b.lat_max, 30.0, 1e-9);
+    REQUIRE_NEAR(b.lon_min, -40.0, 1e-9);
+    REQUIRE_NEAR(b.lon_max, -20.0, 1e-9);
+
+    TileRect world = TilesCovering({-90, 90, -180, 180});
+    REQUIRE_EQ(world.Count(), size_t(TILE_ROWS * TILE_COLS));
+}
+
+// ---- planning --------------------------------------------------------------
+
+TEST(TileCache_empty_cache_needs_one_request) {
+    TileCache tiles;
+    TilePlan plan = tiles.Plan(QUERY, {12, 38, -55, -21}, NOW, true);
+    REQUIRE_EQ(plan.cover.Count(), size_t(3 * 4));
+    REQUIRE_EQ(plan.requests.size(), size_t(1));
+    REQUIRE_EQ(plan.requests[0].since, TIME_UNKNOWN);
+    REQUIRE_EQ(plan.requests[0].rect.Count(), size_t(12));
+    REQUIRE_EQ(plan.stats.downloaded, size_t(12));
+    REQUIRE_EQ(plan.stats.cached, size_t(0));
+}
+
+TEST(TileCache_covered_area_needs_no_request) {
+    TileCache tiles;
+    BBox area = {10, 40, -60, -20};
+    TilePlan plan = tiles.Plan(QUERY, area, NOW, true);
+    StationColumns resp = Make({{"A", 15, -45, NOW - 600},
+                                {"B", 35, -25, NOW - 300},
+                                {"C", 40, -30, NOW - 300}});  // on the edge
+    for (const TileRequest &req : plan.requests)
+        tiles.Apply(QUERY, req, resp.View(), NOW, TIME_UNKNOWN);
+
+    // Pan and zoom inside the fetched area a minute later.
+    TilePlan again = tiles.Plan(QUERY, {12, 38, -55, -21}, NOW + 60, true);
+    REQUIRE(again.requests.empty());
+    REQUIRE_EQ(again.stats.cached, size_t(12));
+
+    StationColumns out;
+    REQUIRE(tiles.Assemble(QUERY, {12, 38, -55, -21}, TIME_UNKNOWN, out));
+    REQUIRE_EQ(out.Size(), size_t(2));
+    REQUIRE(HasId(out, "A"));
+    REQUIRE(HasId(out, "B"));
+
+    // "C" sits on the rect's northern edge: it belongs to the tile above,
+    // which this request did not cover.
+    StationColumns all;
+    REQUIRE(tiles.Assemble(QUERY, area, TIME_UNKNOWN, all));
+    REQUIRE(!HasId(all, "C"));
+}
+
+TEST(TileCache_fetches_only_missing_tiles) {
+    TileCache tiles;
+    TilePlan plan = tiles.Plan(QUERY, {0, 20, 0, 20}, NOW, true);
+    StationColumns none;
+    for (const TileRequest &req : plan.requests)
+        tiles.Apply(QUERY, req, none.View(), NOW, TIME_UNKNOWN);
+
+    // Panning east by one tile leaves one new column to fetch.
+    TilePlan pan = tiles.Plan(QUERY, {0, 20, 10, 30}, NOW + 10, true);
+    REQUIRE_EQ(pan.stats.cached, size_t(2));
+    REQUIRE_EQ(pan.stats.downloaded, size_t(2));
+    REQUIRE_EQ(pan.requests.size(), size_t(1));
+    const TileRect &r = pan.requests[0].rect;
+    REQUIRE_EQ(r.col0, TileCol(20.0));
+    REQUIRE_EQ(r.col1, TileCol(20.0));
+    REQUIRE_EQ(r.row0, TileRow(0.0));
+    REQUIRE_EQ(r.row1, TileRow(10.0));
+}
+
+TEST(TileCache_stale_tiles_get_delta_requests) {
+    TileCache tiles;
+    TilePlan plan = tiles.Plan(QUERY, {0, 10, 0, 20}, NOW, true);
+    StationColumns first = Make({{"A", 5, 5, NOW - 900}, {"B", 5, 15, NOW - 600}});
+    tiles.Apply(QUERY, plan.requests[0], first.View(), NOW, TIME_UNKNOWN);
+
+    int64_t later = NOW + TILE_TTL + 1;
+    TilePlan stale = tiles.Plan(QUERY, {0, 10, 0, 20}, later, true);
+    REQUIRE_EQ(stale.stats.refreshed, size_t(2));
+    REQUIRE_EQ(stale.requests.size(), size_t(1));
+    REQUIRE_EQ(stale.requests[0].since, NOW - 900);  // the older tile's newest
+
+    StationColumns delta = Make({{"A", 5.5, 5.5, NOW + 100}, {"D", 6, 16, NOW + 200}});
+    tiles.Apply(QUERY, stale.requests[0], delta.View(), later, TIME_UNKNOWN);
+    StationColumns out;
+    REQUIRE(tiles.Assemble(QUERY, {0, 10, 0, 20}, TIME_UNKNOWN, out));
+    REQUIRE_EQ(out.Size(), size_t(3));
+    for (size_t i = 0; i < out.Size(); i++)
+        if (out.String(out.id[i]) == "A") REQUIRE_EQ(out.time[i], NOW + 100);
+
+    // Without delta, stale tiles are downloaded again in full.
+    TilePlan full = tiles.Plan(QUERY, {0, 10, 0, 20}, later + TILE_TTL, false);
+    REQUIRE_EQ(full.stats.downloaded, size_t(2));
+    REQUIRE_EQ(full.requests[0].since, TIME_UNKNOWN);
+}
+
+TEST(TileCache_assemble_dedupes_moving_ship) {
+    TileCache tiles;
+    TilePlan plan = tiles.Plan(QUERY, {0, 10, 0, 20}, NOW, true);
+    // The same ship reported from both tiles: only the newest report stays.
+    StationColumns resp = Make({{"V7", 5, 9.5, NOW - 3600}, {"V7", 5, 10.5, NOW - 60}});
+    tiles.Apply(QUERY, plan.requests[0], resp.View(), NOW, TIME_UNKNOWN);
+    StationColumns out;
+    REQUIRE(tiles.Assemble(QUERY, {0, 10, 0, 20}, TIME_UNKNOWN, out));
+    REQUIRE_EQ(out.Size(), size_t(1));
+    REQUIRE_NEAR(out.lon[0], 10.5, 1e-9);
+
+    // And reports past the cutoff are dropped.
+    REQUIRE(tiles.Assemble(QUERY, {0, 10, 0, 20}, NOW, out));
+    REQUIRE_EQ(out.Size(), size_t(0));
+}
+
+TEST(TileCache_queries_are_separate) {
+    TileCache tiles;
+    TilePlan plan = tiles.Plan(QUERY, {0, 10, 0, 10}, NOW, true);
+    StationColumns none;
+    tiles.Apply(QUERY, plan.requests[0], none.View(), NOW, TIME_UNKNOWN);
+    TilePlan other = tiles.Plan(QUERY + "x", {0, 10, 0, 10}, NOW, true);
+    REQUIRE_EQ(other.requests.size(), size_t(1));
+}
+
+TEST(TileCache_tiles_survive_restart) {
+    CleanDisk();
+    {
+        TileCache tiles;
+        tiles.Open(BASE);
+        TilePlan plan = tiles.Plan(QUERY, {0, 10, 0, 10}, NOW, true);
+        StationColumns resp = Make({{"A", 5, 5, NOW - 60}});
+        tiles.Apply(QUERY, plan.requests[0], resp.View(), NOW, TIME_UNKNOWN);
+    }
+    TileCache tiles;
+    tiles.Open(BASE);
+    TilePlan plan = tiles.Plan(QUERY, {0, 10, 0, 10}, NOW + 30, true);
+    REQUIRE(plan.requests.empty());
+    StationColumns out;
+    REQUIRE(tiles.Assemble(QUERY, {0, 10, 0, 10}, TIME_UNKNOWN, out));
+    REQUIRE_EQ(out.Size(), size_t(1));
+    CleanDisk();
+}
+
+int main(int argc, char **argv) {
+    return run_tests(argc, argv);
+}
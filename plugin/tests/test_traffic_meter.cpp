@@ -0,0 +1,61 @@
+#include "test_runner.h"
+#include "../src/traffic_meter.h"
+
+static const int64_t NOON = 1791201600;   // 2026-10-17 12:00Z
+
+TEST(TrafficMeter_counts_session_and_day) {
+    TrafficMeter meter;
+    meter.Add(1000, NOON);
+    meter.Add(500, NOON + 60);
+    REQUIRE_EQ(meter.SessionBytes(), uint64_t(1500));
+    REQUIRE_EQ(meter.DayBytes(NOON + 120), uint64_t(1500));
+    REQUIRE_EQ(meter.Day(), TrafficMeter::DayOf(NOON));
+}
+
+TEST(TrafficMeter_day_starts_over_at_midnight_utc) {
+    TrafficMeter meter;
+    meter.Add(1000, NOON);
+    int64_t tomorrow = NOON + 12 * 3600;   // 00:00Z next day
+    REQUIRE_EQ(meter.DayBytes(tomorrow - 1), uint64_t(1000));
+    REQUIRE_EQ(meter.DayBytes(tomorrow), uint64_t(0));
+    meter.Add(200, tomorrow + 5);
+    REQUIRE_EQ(meter.DayBytes(tomorrow + 10), uint64_t(200));
+    REQUIRE_EQ(meter.SessionBytes(), uint64_t(1200));
+}
+
+TEST(TrafficMeter_restored_day_survives_restart) {
+    TrafficMeter before;
+    before.Add(4096, NOON);
+    TrafficMeter after;
+    after.Restore(before.Day(), before.StoredDayBytes());
+    REQUIRE_EQ(after.DayBytes(NOON + 3600), uint64_t(4096));
+    REQUIRE_EQ(after.SessionBytes(), uint64_t(0));
+    after.Add(4, NOON + 3600);
+    REQUIRE_EQ(after.DayBytes(NOON + 3600), uint64_t(4100));
+
+    // Yesterday's count doesn't carry over.
+    REQUIRE_EQ(after.DayBytes(NOON + 86400), uint64_t(0));
+}
+
+TEST(TrafficMeter_budget) {
+    TrafficMeter meter;
+    REQUIRE(!meter.OverBudget(0, NOON));
+    meter.Add(10 * 1024, NOON);
+    REQUIRE(!meter.OverBudget(0, NOON));            // no budget
+    REQUIRE(!meter.OverBudget(20 * 1024, NOON));
+    REQUIRE(meter.OverBudget(10 * 1024, NOON));
+    REQUIRE(!meter.OverBudget(10 * 1024, NOON + 86400));
+}
+
+TEST(TrafficMeter_day_of) {
+    REQUIRE_EQ(TrafficMeter::DayOf(0), int64_t(0));
+    REQUIRE_EQ(TrafficMeter::DayOf(86399), int64_t(0));
+    REQUIRE_EQ(TrafficMeter::DayOf(86400), int64_t(1));
+    REQUIRE_EQ(TrafficMeter::DayOf(-1), int64_t(-1));
+    REQUIRE_EQ(TrafficMeter::DayOf(-86400), int64_t(-1));
+    REQUIRE_EQ(TrafficMeter::DayOf(-86401), int64_t(-2));
+}
+
+int main(int argc, char **argv) {
+    return run_tests(argc, argv);
+}
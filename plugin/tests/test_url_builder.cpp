@@ -92,6 +92,102 @@ TEST(ClampBbox_lon_very_negative) {
     REQUIRE_NEAR(b.lon_max, -120.0, 1e-9);
 }
 
+// ---- SplitBbox -------------------------------------------------------------
+
+TEST(SplitBbox_inside_range_is_one_box) {
+    BBox b[2];
+    REQUIRE_EQ(SplitBbox(-95.0, 10.0, -30.0, -10.0, b), 1);
+    REQUIRE_NEAR(b[0].lat_min, -90.0, 1e-9);
+    REQUIRE_NEAR(b[0].lon_min, -30.0, 1e-9);
+    REQUIRE_NEAR(b[0].lon_max, -10.0, 1e-9);
+}
+
+TEST(SplitBbox_lon_max_past_180) {
+    BBox b[2];
+    REQUIRE_EQ(SplitBbox(-10.0, 10.0, 170.0, 190.0, b), 2);
+    REQUIRE_NEAR(b[0].lon_min, 170.0, 1e-9);
+    REQUIRE_NEAR(b[0].lon_max, 180.0, 1e-9);
+    REQUIRE_NEAR(b[1].lon_min, -180.0, 1e-9);
+    REQUIRE_NEAR(b[1].lon_max, -170.0, 1e-9);
+    REQUIRE_NEAR(b[1].lat_min, -10.0, 1e-9);
+    REQUIRE_NEAR(b[1].lat_max, 10.0, 1e-9);
+}
+
+TEST(SplitBbox_lon_min_greater_than_lon_max) {
+    BBox b[2];
+    REQUIRE_EQ(SplitBbox(0.0, 10.0, 160.0, -140.0, b), 2);
+    REQUIRE_NEAR(b[0].lon_min, 160.0, 1e-9);
+    REQUIRE_NEAR(b[0].lon_max, 180.0, 1e-9);
+    REQUIRE_NEAR(b[1].lon_min, -180.0, 1e-9);
+    REQUIRE_NEAR(b[1].lon_max, -140.0, 1e-9);
+}
+
+TEST(SplitBbox_panned_a_full_turn) {
+    BBox b[2];
+    REQUIRE_EQ(SplitBbox(0.0, 10.0, -550.0, -530.0, b), 2);  // 170..190
+    REQUIRE_NEAR(b[0].lon_min, 170.0, 1e-9);
+    REQUIRE_NEAR(b[1].lon_max, -170.0, 1e-9);
+    REQUIRE_EQ(SplitBbox(0.0, 10.0, 180.0, 200.0, b), 1);    // -180..-160
+    REQUIRE_NEAR(b[0].lon_min, -180.0, 1e-9);
+    REQUIRE_NEAR(b[0].lon_max, -160.0, 1e-9);
+}
+
+TEST(SplitBbox_full_world) {
+    BBox b[2];
+    REQUIRE_EQ(SplitBbox(-80.0, 80.0, -200.0, 200.0, b), 1);
+    REQUIRE_NEAR(b[0].lon_min, -180.0, 1e-9);
+    REQUIRE_NEAR(b[0].lon_max, 180.0, 1e-9);
+}
+
+// ---- MaxAgeSeconds ---------------------------------------------------------
+
+TEST(MaxAgeSeconds_units) {
+    REQUIRE_EQ(MaxAgeSeconds("6h"), 6 * 3600LL);
+    REQUIRE_EQ(MaxAgeSeconds("24h"), 24 * 3600LL);
+    REQUIRE_EQ(MaxAgeSeconds("2d"), 2 * 86400LL);
+    REQUIRE_EQ(MaxAgeSeconds("90m"), 90 * 60LL);
+    REQUIRE_EQ(MaxAgeSeconds("12"), 12 * 3600LL);
+}
+
+TEST(MaxAgeSeconds_rejects_garbage) {
+    REQUIRE_EQ(MaxAgeSeconds(""), 0LL);
+    REQUIRE_EQ(MaxAgeSeconds("h"), 0LL);
+    REQUIRE_EQ(MaxAgeSeconds("6x"), 0LL);
+    REQUIRE_EQ(MaxAgeSeconds("6hours"), 0LL);
+}
+
+// ---- NormalizeTypes --------------------------------------------------------
+
+TEST(NormalizeTypes_sorts_and_dedups) {
+    REQUIRE_EQ(NormalizeTypes("ship,buoy"), std::string("buoy,ship"));
+    REQUIRE_EQ(NormalizeTypes("Buoy, ship,buoy"), std::string("buoy,ship"));
+    REQUIRE_EQ(NormalizeTypes("ship,,shore,"), std::string("ship,shore"));
+    REQUIRE_EQ(NormalizeTypes(""), std::string(""));
+}
+
+// ---- FetchProfile ----------------------------------------------------------
+
+TEST(FetchProfile_full_adds_nothing) {
+    FetchProfile full;
+    REQUIRE(full.IsFull());
+    REQUIRE_EQ(full.Query(), std::string(""));
+}
+
+TEST(FetchProfile_fields_in_column_order) {
+    FetchProfile p((1u << 3) | (1u << 0) | (1u << 1), -1);  // pressure, wind
+    REQUIRE(!p.IsFull());
+    REQUIRE_EQ(p.Query(), std::string("&fields=wind_dir,wind_spd,pressure"));
+    FetchProfile none(0, -1);
+    REQUIRE_EQ(none.Query(), std::string("&fields="));
+}
+
+TEST(FetchProfile_precision_keeps_a_decimal) {
+    REQUIRE_EQ(FetchProfile(ALL_FIELDS, 1).Query(), std::string("&precision=1"));
+    REQUIRE_EQ(FetchProfile(ALL_FIELDS, 0).Query(), std::string("&precision=1"));
+    REQUIRE_EQ(FetchProfile(1u << 7, 2).Query(),
+               std::string("&fields=vis&precision=2"));
+}
+
 int main(int argc, char **argv) {
     return run_tests(argc, argv);
 }
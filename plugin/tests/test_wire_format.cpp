@@ -0,0 +1,136 @@
+#include "test_runner.h"
+#include "../src/wire_format.h"
+
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <string>
+
+// ---- helpers ---------------------------------------------------------------
+
+struct Report {
+    const char *id, *type, *country;
+    double lat, lon;
+    int64_t time;
+};
+
+static void Add(StationColumns &c, const Report &r) {
+    c.lat.push_back(r.lat);
+    c.lon.push_back(r.lon);
+    c.time.push_back(r.time);
+    for (int m = 0; m < METRIC_COUNT; m++) c.metric[m].push_back(NAN);
+    c.id.push_back(c.Intern(r.id));
+    c.type.push_back(c.Intern(r.type));
+    c.country.push_back(c.Intern(r.country));
+}
+
+static StationColumns MakeColumns() {
+    StationColumns c;
+    Add(c, {"41008", "buoy", "US", 31.4, -80.9, 1771597800});
+    Add(c, {"VRZN9", "ship", "", -12.34567, 179.99999, 1771598400});
+    Add(c, {"41009", "buoy", "US", 28.5, -80.18, 1771596000});
+    c.metric[METRIC_WIND_DIR][0] = 170.0f;
+    c.metric[METRIC_WIND_SPD][0] = 5.0f;
+    c.metric[METRIC_PRESSURE][0] = 1014.7f;
+    c.metric[METRIC_VIS][1]      = 20000.0f;
+    c.metric[METRIC_SEA_TEMP][2] = -1.8f;
+    return c;
+}
+
+// ---- tests -----------------------------------------------------------------
+
+TEST(Wire_round_trip) {
+    StationColumns in = MakeColumns();
+    std::string body = EncodeWire(in);
+    StationColumns out;
+    REQUIRE(DecodeWire(body.data(), body.size(), out));
+    REQUIRE_EQ(out.Size(), in.Size());
+    for (size_t i = 0; i < in.Size(); i++) {
+        REQUIRE_EQ(out.String(out.id[i]), in.String(in.id[i]));
+        REQUIRE_EQ(out.String(out.type[i]), in.String(in.type[i]));
+        REQUIRE_EQ(out.String(out.country[i]), in.String(in.country[i]));
+        REQUIRE_EQ(out.time[i], in.time[i]);
+        // Positions are quantized to 1e-5 degrees.
+        REQUIRE_NEAR(out.lat[i], in.lat[i], 0.5 / WIRE_DEG_SCALE + 1e-12);
+        REQUIRE_NEAR(out.lon[i], in.lon[i], 0.5 / WIRE_DEG_SCALE + 1e-12);
+        for (int m = 0; m < METRIC_COUNT; m++) {
+            float a = in.metric[m][i], b = out.metric[m][i];
+            REQUIRE(std::isnan(a) == std::isnan(b));
+            if (!std::isnan(a)) REQUIRE_EQ(a, b);
+        }
+    }
+    // Strings are shared, as interned by the decoder.
+    REQUIRE_EQ(out.type[0], out.type[2]);
+    REQUIRE_EQ(out.country[1], uint32_t(0));
+}
+
+TEST(Wire_missing_position_and_empty_body) {
+    // Dropped as ObsStreamParser drops them from JSON.
+    StationColumns in;
+    Add(in, {"X", "other", "", NAN, 10.0, 1771597800});
+    Add(in, {"Y", "other", "", 91.0, 10.0, 1771597800});
+    Add(in, {"Z", "other", "", 10.0, -180.5, 1771597800});
+    Add(in, {"T", "other", "", 10.0, 10.0, TIME_UNKNOWN});
+    Add(in, {"", "other", "", 10.0, 10.0, 1771597800});
+    Add(in, {"OK", "ship", "", -90.0, 180.0, 1771597800});
+    in.metric[METRIC_GUST][5] = 12.5f;
+    std::string body = EncodeWire(in);
+    StationColumns out;
+    REQUIRE(DecodeWire(body.data(), body.size(), out));
+    REQUIRE_EQ(out.Size(), size_t(1));
+    REQUIRE_EQ(out.String(out.id[0]), std::string("OK"));
+    REQUIRE_EQ(out.String(out.type[0]), std::string("ship"));
+    REQUIRE_NEAR(out.lat[0], -90.0, 1e-9);
+    REQUIRE_EQ(out.time[0], int64_t(1771597800));
+    REQUIRE_EQ(out.metric[METRIC_GUST][0], 12.5f);
+    REQUIRE(std::isnan(out.metric[METRIC_WIND_DIR][0]));
+
+    std::string none = EncodeWire(StationColumns());
+    REQUIRE(DecodeWire(none.data(), none.size(), out));
+    REQUIRE_EQ(out.Size(), size_t(0));
+}
+
+TEST(Wire_is_smaller_than_block) {
+    StationColumns in;
+    for (int i = 0; i < 200; i++)
+        Add(in, {("ST" + std::to_string(i)).c_str(), "buoy", "US",
+                 10.0 + i * 0.01, -20.0 - i * 0.01, 1771597800 + i * 60});
+    std::string wire = EncodeWire(in);
+    // 3 one-byte indices + 8 position + 2 time + 1 mask bytes per station,
+    // plus the strings.
+    REQUIRE(wire.size() < 200 * 20 + in.string_bytes.size() + 400);
+    REQUIRE(wire.size() * 3 < EncodeBlock(in).size());
+}
+
+TEST(Wire_rejects_damaged_body) {
+    std::string body = EncodeWire(MakeColumns());
+    StationColumns out;
+    for (size_t cut = 0; cut < body.size(); cut++)
+        REQUIRE(!DecodeWire(body.data(), cut, out));
+    REQUIRE_EQ(out.Size(), size_t(0));
+
+    std::string extra = body + "x";
+    REQUIRE(!DecodeWire(extra.data(), extra.size(), out));
+
+    std::string bad = body;
+    bad[4] = 9;  // version
+    REQUIRE(!DecodeWire(bad.data(), bad.size(), out));
+
+    std::string json = "{\"stations\": []}";
+    REQUIRE(!DecodeWire(json.data(), json.size(), out));
+
+    // A huge station count must not be trusted for allocation.
+    bad = body;
+    bad[8] = bad[9] = bad[10] = bad[11] = '\xff';
+    REQUIRE(!DecodeWire(bad.data(), bad.size(), out));
+
+    // Nor may a time offset overflow the time base.
+    bad = body;
+    int64_t late = INT64_MAX - 100;
+    std::memcpy(&bad[16], &late, sizeof(late));
+    REQUIRE(!DecodeWire(bad.data(), bad.size(), out));
+}
+
+int main(int argc, char **argv) {
+    return run_tests(argc, argv);
+}
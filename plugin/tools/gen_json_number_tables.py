@@ -0,0 +1,86 @@
+#!/usr/bin/env python3
+"""Generate the power-of-ten tables used by src/json_number.cpp.
+
+Usage: gen_json_number_tables.py output.h
+
+POW5_128: for q in [-342, 308], the 128 most significant bits of 5^q
+(rounded up for q < 0), as used by the Eisel-Lemire parser.
+CACHED_POW10: every 8th power of ten from 10^-300 to 10^324, normalised to
+a 64-bit significand (rounded to nearest) and binary exponent, as used by
+the Grisu2 formatter.
+"""
+import sys
+
+POW5_MIN, POW5_MAX = -342, 308
+CACHED_MIN, CACHED_MAX, CACHED_STEP = -300, 324, 8
+
+
+def pow5_128(q):
+    if q >= 0:
+        v = 5 ** q
+        while v < (1 << 127):
+            v <<= 1
+        while v >= (1 << 128):
+            v >>= 1
+        return v
+    p = 5 ** -q
+    z = p.bit_length()
+    b = z + 127 if q >= -27 else 2 * z + 128
+    v = (1 << b) // p + 1
+    while v >= (1 << 128):
+        v >>= 1
+    return v
+
+
+def cached_pow10(k):
+    # 10^k ~= f * 2^e with 2^63 <= f < 2^64, f rounded to nearest
+    num, den = (10 ** k, 1) if k >= 0 else (1, 10 ** -k)
+    e = num.bit_length() - den.bit_length() - 64
+    while True:
+        n, d = (num, den << e) if e >= 0 else (num << -e, den)
+        f = (2 * n + d) // (2 * d)
+        if f >= (1 << 64):
+            e += 1
+        elif f < (1 << 63):
+            e -= 1
+        else:
+            return f, e
+
+
+def main():
+    out = []
+    out.append('#ifndef _JSON_NUMBER_TABLES_H_')
+    out.append('#define _JSON_NUMBER_TABLES_H_')
+    out.append('')
+    out.append('// Generated by tools/gen_json_number_tables.py; do not edit.')
+    out.append('// Included only by json_number.cpp.')
+    out.append('')
+    out.append('#include <cstdint>')
+    out.append('')
+    out.append('static const int POW5_128_MIN = %d, POW5_128_MAX = %d;' % (POW5_MIN, POW5_MAX))
+    out.append('')
+    out.append('// {high, low} 64 bits of 5^q, q = POW5_128_MIN + index')
+    out.append('static const uint64_t POW5_128[][2] = {')
+    for q in range(POW5_MIN, POW5_MAX + 1):
+        v = pow5_128(q)
+        out.append('    {0x%016xULL, 0x%016xULL},  // 5^%d' % (v >> 64, v & ((1 << 64) - 1), q))
+    out.append('};')
+    out.append('')
+    out.append('static const int CACHED_POW10_MIN = %d, CACHED_POW10_STEP = %d;'
+               % (CACHED_MIN, CACHED_STEP))
+    out.append('')
+    out.append('struct CachedPow10 { uint64_t f; int e; int k; };   // 10^k ~= f * 2^e')
+    out.append('')
+    out.append('static const CachedPow10 CACHED_POW10[] = {')
+    for k in range(CACHED_MIN, CACHED_MAX + 1, CACHED_STEP):
+        f, e = cached_pow10(k)
+        out.append('    {0x%016xULL, %5d, %4d},' % (f, e, k))
+    out.append('};')
+    out.append('')
+    out.append('#endif // _JSON_NUMBER_TABLES_H_')
+    with open(sys.argv[1], 'w') as fh:
+        fh.write('\n'.join(out) + '\n')
+
+
+if __name__ == '__main__':
+    main()